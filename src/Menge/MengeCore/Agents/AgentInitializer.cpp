@@ -63,6 +63,8 @@ const float NEIGHBOR_DIST = 5.f;         ///< The default neighbor distance
 const float RADIUS = 0.2f;               ///< The default radius
 const size_t CLASS = 0;                  ///< The default class
 const float PRIORITY = 0.f;              ///< The default priority
+const float SLEEP_SPEED = 0.f;           ///< The default sleep speed (agents never sleep)
+const float SLEEP_DELAY = 1.f;           ///< The default idle time before sleeping
 const float MAX_ANGLE_VEL = TWOPI;       ///< The default maximum angular velocity
 const size_t OBSTACLE_SET = 0xFFFFFFFF;  ///< The default obstacle set (all obstacles)
 
@@ -85,6 +87,8 @@ AgentInitializer::AgentInitializer() {
   // single values
   _obstacleSet = OBSTACLE_SET;
   _priority = PRIORITY;
+  _sleepSpeed = SLEEP_SPEED;
+  _sleepDelay = SLEEP_DELAY;
   _class = CLASS;
 }
 
@@ -100,6 +104,8 @@ AgentInitializer::AgentInitializer(const AgentInitializer& init) {
   _maxAngVel = init._maxAngVel->copy();
   _obstacleSet = init._obstacleSet;
   _priority = init._priority;
+  _sleepSpeed = init._sleepSpeed;
+  _sleepDelay = init._sleepDelay;
   _class = init._class;
 
   std::vector<BFSM::VelModifier*>::const_iterator vItr = init._velModifiers.begin();
@@ -141,6 +147,8 @@ void AgentInitializer::setDefaults() {
   _maxAngVel = new ConstFloatGenerator(MAX_ANGLE_VEL);
   // single values
   _priority = PRIORITY;
+  _sleepSpeed = SLEEP_SPEED;
+  _sleepDelay = SLEEP_DELAY;
   _obstacleSet = OBSTACLE_SET;
   _class = CLASS;
 }
@@ -195,6 +203,8 @@ bool AgentInitializer::setProperties(BaseAgent* agent) {
   agent->_maxAngVel = _maxAngVel->getValue();
   agent->_obstacleSet = _obstacleSet;
   agent->_priority = _priority;
+  agent->_sleepSpeed = _sleepSpeed;
+  agent->_sleepDelay = _sleepDelay;
   agent->_class = _class;
 
   std::vector<BFSM::VelModifier*>::iterator vItr = _velModifiers.begin();
@@ -236,6 +246,10 @@ AgentInitializer::ParseResult AgentInitializer::setFromXMLAttribute(const ::std:
     result = constSizet(_class, value);
   } else if (paramName == "priority") {
     result = constFloat(_priority, value);
+  } else if (paramName == "sleep_speed") {
+    result = constFloat(_sleepSpeed, value);
+  } else if (paramName == "sleep_delay") {
+    result = constFloat(_sleepDelay, value);
   }
 
   if (result == FAILURE) {
@@ -385,6 +385,17 @@ class MENGE_API AgentInitializer {
    */
   float _priority;
 
+  /*!
+   @brief    The speed at or below which agents are idle.  See Agents::BaseAgent::_sleepSpeed for
+            details.
+   */
+  float _sleepSpeed;
+
+  /*!
+   @brief    The idle time before agents sleep.  See Agents::BaseAgent::_sleepDelay for details.
+   */
+  float _sleepDelay;
+
   /*!
    @brief    The population class for this agent.  See Agents::BaseAgent::_class for details.
    */
@@ -0,0 +1,171 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#include "MengeCore/Agents/AgentSource.h"
+
+#include "MengeCore/Agents/AgentGenerators/AgentGenerator.h"
+#include "MengeCore/Agents/BaseAgent.h"
+#include "MengeCore/Agents/ProfileSelectors/ProfileSelector.h"
+#include "MengeCore/Agents/SimulatorInterface.h"
+#include "MengeCore/Agents/SpatialQueries/ProximityQuery.h"
+#include "MengeCore/Agents/SpatialQueries/SpatialQuery.h"
+#include "MengeCore/Agents/StateSelectors/StateSelector.h"
+#include "MengeCore/Runtime/Logger.h"
+
+#include <algorithm>
+
+namespace Menge {
+
+namespace Agents {
+
+using Math::Vector2;
+
+namespace {
+/*!
+ @brief    A proximity query which reports if any agent overlaps a disk.
+ */
+class ClearanceQuery : public ProximityQuery {
+ public:
+  /*!
+   @brief    Constructor.
+
+   @param    agent    The agent to place; it is ignored if the spatial query already knows it.
+   */
+  explicit ClearanceQuery(const BaseAgent* agent)
+      : _agent(agent),
+        _pos(agent->_pos),
+        _radius(agent->_radius),
+        _range(9.f * _radius * _radius),
+        _clear(true) {}
+
+  virtual void startQuery() { _clear = true; }
+  virtual Vector2 getQueryPoint() { return _pos; }
+  // Assumes no agent is more than twice the size of the candidate.
+  virtual float getMaxAgentRange() { return _range; }
+  virtual float getMaxObstacleRange() { return 0.f; }
+  virtual void filterAgent(const BaseAgent* agent, float distSq) {
+    // The spatial query may still refer to a retired agent whose storage has been reused.
+    if (agent == _agent) return;
+    const float minDist = _radius + agent->_radius;
+    if (distSq < minDist * minDist) {
+      _clear = false;
+      _range = 0.f;  // No need to look any further.
+    }
+  }
+  virtual void filterObstacle(const Obstacle* obstacle, float distSq) {}
+
+  /*!
+   @brief    Reports if no agent overlaps the disk.
+   */
+  bool isClear() const { return _clear; }
+
+ private:
+  const BaseAgent* _agent;
+  Vector2 _pos;
+  float _radius;
+  float _range;
+  bool _clear;
+};
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////
+//                   Implementation of AgentSource
+/////////////////////////////////////////////////////////////////////
+
+AgentSource::AgentSource(ProfileSelector* profileSel, StateSelector* stateSel,
+                         AgentGenerator* generator, float rate, float startTime, float endTime,
+                         size_t maxAgents)
+    : _profileSel(profileSel),
+      _stateSel(stateSel),
+      _generator(generator),
+      _rate(rate),
+      _startTime(startTime),
+      _endTime(endTime),
+      _maxAgents(maxAgents),
+      _spawned(0),
+      _nextPosition(0) {}
+
+/////////////////////////////////////////////////////////////////////
+
+AgentSource::~AgentSource() {
+  _profileSel->destroy();
+  _stateSel->destroy();
+  _generator->destroy();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void AgentSource::update(SimulatorInterface* sim, float time) {
+  if (time < _startTime || !isActive(time)) return;
+  // The small bias protects against the accumulated error in the simulation time.
+  size_t due = static_cast<size_t>((std::min(time, _endTime) - _startTime) * _rate + 1e-4f) + 1;
+  if (_maxAgents > 0 && due > _maxAgents) due = _maxAgents;
+
+  const size_t POS_COUNT = _generator->agentCount();
+  _placed.clear();
+  // Each position is tried at most once per update.
+  for (size_t attempt = 0; attempt < POS_COUNT && _spawned < due; ++attempt) {
+    const size_t index = _nextPosition;
+    _nextPosition = (_nextPosition + 1) % POS_COUNT;
+    BaseAgent* agent = sim->addAgent(Vector2(0.f, 0.f), _profileSel->getProfile());
+    if (agent == 0x0) {
+      // The profile itself is broken; it won't get better.
+      ++_spawned;
+      continue;
+    }
+    try {
+      _generator->setAgentPosition(index, agent);
+    } catch (AgentGeneratorException& e) {
+      logger << Logger::ERR_MSG << "Agent source failed to position an agent: " << e.what();
+      sim->discardAgent(agent);
+      ++_spawned;
+      continue;
+    }
+    if (!isClear(sim, agent)) {
+      sim->discardAgent(agent);
+      continue;
+    }
+    ++_spawned;
+    if (sim->activateAgent(agent, _stateSel->getState())) {
+      _placed.push_back(std::make_pair(agent->_pos, agent->_radius));
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool AgentSource::isActive(float time) const {
+  if (_maxAgents > 0 && _spawned >= _maxAgents) return false;
+  if (time < _endTime) return true;
+  // Agents which were delayed by a lack of space are still due.
+  return _spawned < static_cast<size_t>((_endTime - _startTime) * _rate + 1e-4f) + 1;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool AgentSource::isClear(const SimulatorInterface* sim, const BaseAgent* agent) const {
+  for (size_t i = 0; i < _placed.size(); ++i) {
+    const float minDist = agent->_radius + _placed[i].second;
+    if (absSq(_placed[i].first - agent->_pos) < minDist * minDist) return false;
+  }
+  ClearanceQuery query(agent);
+  sim->_spatialQuery->agentQuery(&query);
+  return query.isClear();
+}
+}  // namespace Agents
+}  // namespace Menge
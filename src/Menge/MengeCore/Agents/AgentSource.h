@@ -0,0 +1,159 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+/*!
+ @file    AgentSource.h
+ @brief   The definition of a source of agents which enter the simulation as it runs.
+ */
+
+#ifndef __AGENT_SOURCE_H__
+#define __AGENT_SOURCE_H__
+
+#include "MengeCore/CoreConfig.h"
+#include "MengeCore/Math/Vector2.h"
+
+#include <vector>
+
+namespace Menge {
+
+namespace Agents {
+// forward declaration
+class AgentGenerator;
+class BaseAgent;
+class ProfileSelector;
+class SimulatorInterface;
+class StateSelector;
+
+/*!
+ @brief    Spawns agents into a running simulation at a fixed rate.
+
+ An agent source is defined in the scene specification much like an AgentGroup: a profile selector
+ and a state selector define the properties and initial state of each agent, and an agent generator
+ defines the positions at which agents appear. The positions are used in turn, cycling through the
+ generator's positions as many times as necessary.
+
+ Agents are spawned at `rate` agents per second, starting at `start_time` (the first agent appears
+ at that time), until `end_time` has passed or `max_agents` agents have been spawned. A position is
+ skipped while it is occupied (i.e., the new agent would overlap an existing agent); if all of the
+ positions are occupied, the agents which are due are delayed until space becomes available.
+ */
+class MENGE_API AgentSource {
+ public:
+  /*!
+   @brief    Constructor.
+
+   The source takes ownership of the selectors and the generator.
+
+   @param    profileSel    The profile selector for the spawned agents.
+   @param    stateSel      The state selector for the spawned agents.
+   @param    generator     The generator of the spawn positions.
+   @param    rate          The number of agents spawned per second.
+   @param    startTime     The simulation time at which the first agent is spawned.
+   @param    endTime       The simulation time after which no agents are spawned.
+   @param    maxAgents     The maximum number of agents spawned (zero for no limit).
+   */
+  AgentSource(ProfileSelector* profileSel, StateSelector* stateSel, AgentGenerator* generator,
+              float rate, float startTime, float endTime, size_t maxAgents);
+
+  /*!
+   @brief    Destructor.
+   */
+  ~AgentSource();
+
+  /*!
+   @brief    Spawns the agents which are due at the given time.
+
+   @param    sim     The simulator to which agents are added.
+   @param    time    The current simulation time.
+   */
+  void update(SimulatorInterface* sim, float time);
+
+  /*!
+   @brief    Reports if the source will spawn more agents after the given time.
+   */
+  bool isActive(float time) const;
+
+  /*!
+   @brief    Reports the number of agents the source has spawned (or failed to spawn).
+   */
+  size_t getSpawnCount() const { return _spawned; }
+
+ protected:
+  /*!
+   @brief    Reports if the newly positioned agent can be placed where it is.
+
+   @param    sim       The simulator.
+   @param    agent     The candidate agent.
+   @returns  True if the agent doesn't overlap any agent in the simulation (or one spawned by this
+            source in the current update).
+   */
+  bool isClear(const SimulatorInterface* sim, const BaseAgent* agent) const;
+
+  /*!
+   @brief    The profile selector for the spawned agents.
+   */
+  ProfileSelector* _profileSel;
+
+  /*!
+   @brief    The state selector for the spawned agents.
+   */
+  StateSelector* _stateSel;
+
+  /*!
+   @brief    The generator of spawn positions.
+   */
+  AgentGenerator* _generator;
+
+  /*!
+   @brief    The number of agents spawned per second.
+   */
+  float _rate;
+
+  /*!
+   @brief    The time at which the source starts spawning.
+   */
+  float _startTime;
+
+  /*!
+   @brief    The time after which the source stops spawning.
+   */
+  float _endTime;
+
+  /*!
+   @brief    The maximum number of agents spawned (zero for no limit).
+   */
+  size_t _maxAgents;
+
+  /*!
+   @brief    The number of agents spawned so far.
+   */
+  size_t _spawned;
+
+  /*!
+   @brief    The index of the next generator position to use.
+   */
+  size_t _nextPosition;
+
+  /*!
+   @brief    The agents spawned in the current update (position and radius).
+   */
+  std::vector<std::pair<Math::Vector2, float> > _placed;
+};
+}  // namespace Agents
+}  // namespace Menge
+#endif  // __AGENT_SOURCE_H__
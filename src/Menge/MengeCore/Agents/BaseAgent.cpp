@@ -69,6 +69,10 @@ BaseAgent::BaseAgent() {
   _priority = 0.f;
   _id = 0;
   _radius = 0.19f;
+  _sleepSpeed = 0.f;
+  _sleepDelay = 1.f;
+  _asleep = false;
+  _idleTime = 0.f;
 }
 
 ////////////////////////////////////////////////////////////////
@@ -172,6 +176,28 @@ void BaseAgent::computeNewVelocity() { throw AgentImplementationException(); }
 
 ////////////////////////////////////////////////////////////////
 
+void BaseAgent::updateIdleTime(float timeStep) {
+  const float speedSq = _sleepSpeed * _sleepSpeed;
+  bool idle = _sleepSpeed > 0.f && _velPref.getSpeed() <= _sleepSpeed && absSq(_velNew) <= speedSq;
+  for (size_t i = 0; idle && i < _nearAgents.size(); ++i) {
+    idle = absSq(_nearAgents[i].agent->_vel) <= speedSq;
+  }
+  _idleTime = idle ? _idleTime + timeStep : 0.f;
+}
+
+////////////////////////////////////////////////////////////////
+
+void BaseAgent::sleep() {
+  _asleep = true;
+  _vel.set(0.f, 0.f);
+  _velNew.set(0.f, 0.f);
+  // The neighbor sets are not maintained while asleep.
+  _nearAgents.clear();
+  _nearObstacles.clear();
+}
+
+////////////////////////////////////////////////////////////////
+
 void BaseAgent::insertAgentNeighbor(const BaseAgent* agent, float distSq) {
   if (this != agent) {
     if (_nearAgents.size() != _maxNeighbors || distSq <= getMaxAgentRange()) {
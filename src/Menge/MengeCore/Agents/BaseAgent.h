@@ -172,6 +172,44 @@ class MENGE_API BaseAgent : public ProximityQuery {
    */
   void setPreferredVelocity(PrefVelocity& velocity);
 
+  /*!
+   @brief    Updates the time the agent has spent idle.
+
+   An agent is idle if it can sleep (_sleepSpeed is positive) and its preferred speed, its new
+   velocity and the velocities of all of its neighbors are no greater than _sleepSpeed. This must
+   be called after computeNewVelocity() and before the neighbors' velocities are updated.
+
+   @param    timeStep    The duration of the simulation time step.
+   */
+  void updateIdleTime(float timeStep);
+
+  /*!
+   @brief    Reports if the agent has been idle long enough to be put to sleep.
+   */
+  bool isDrowsy() const { return _sleepSpeed > 0.f && _idleTime >= _sleepDelay; }
+
+  /*!
+   @brief    Reports if the agent is asleep.
+
+   A sleeping agent is skipped by the simulator's step; it doesn't move and its velocity is zero.
+   It still belongs to the spatial query, so other agents continue to avoid it.
+   */
+  bool isAsleep() const { return _asleep; }
+
+  /*!
+   @brief    Puts the agent to sleep.
+   */
+  void sleep();
+
+  /*!
+   @brief    Wakes the agent; it won't be put to sleep again until it has been idle for _sleepDelay
+              seconds.
+   */
+  void wake() {
+    _asleep = false;
+    _idleTime = 0.f;
+  }
+
   /*!
    @brief    Add an velocity modifier to the agent
 
@@ -281,6 +319,17 @@ class MENGE_API BaseAgent : public ProximityQuery {
    */
   size_t _id;
 
+  /*!
+   @brief    The speed at or below which the agent is considered idle; zero means the agent never
+              sleeps. See updateIdleTime().
+   */
+  float _sleepSpeed;
+
+  /*!
+   @brief    The time (in seconds) the agent must be idle before it is put to sleep.
+   */
+  float _sleepDelay;
+
   /*!
    @brief    The agent's radius.
 
@@ -389,6 +438,17 @@ class MENGE_API BaseAgent : public ProximityQuery {
             are met.
    */
   virtual float getMaxObstacleRange() { return _neighborDist * _neighborDist; };
+
+ protected:
+  /*!
+   @brief    Reports if the agent is asleep.
+   */
+  bool _asleep;
+
+  /*!
+   @brief    The time (in seconds) the agent has been continuously idle.
+   */
+  float _idleTime;
 };
 
 }  // namespace Agents
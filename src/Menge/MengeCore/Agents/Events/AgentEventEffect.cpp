@@ -55,6 +55,7 @@ void AgentEventEffect::apply(EventTarget* target) {
   std::vector<Agents::BaseAgent*>::iterator itr = tgt->begin();
   std::vector<Agents::BaseAgent*>::iterator end = tgt->end();
   for (; itr != end; ++itr) {
+    (*itr)->wake();
     agentEffect(*itr);
   }
 }
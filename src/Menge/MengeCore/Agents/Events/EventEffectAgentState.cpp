@@ -1,12 +1,16 @@
 #include "MengeCore/Agents/Events/EventEffectAgentState.h"
 
 #include "MengeCore/Agents/BaseAgent.h"
+#include "MengeCore/Agents/Events/AgentEventTarget.h"
 #include "MengeCore/Agents/Events/EventException.h"
 #include "MengeCore/Agents/StateSelectors/StateSelectorDatabase.h"
 #include "MengeCore/BFSM/FSM.h"
 #include "MengeCore/BFSM/State.h"
 #include "MengeCore/Core.h"
 
+#include <algorithm>
+#include <vector>
+
 namespace Menge {
 
 using Agents::BaseAgent;
@@ -28,6 +32,30 @@ EventEffectAgentState::~EventEffectAgentState() {
 
 /////////////////////////////////////////////////////////////////////
 
+void EventEffectAgentState::apply(EventTarget* target) {
+  assert(isCompatible(target) && "Incompatible target type passed to an AgentEventEffect instance");
+  AgentEventTarget* tgt = static_cast<AgentEventTarget*>(target);
+  // The agents are grouped by target state in the order the states are first selected.
+  std::vector<State*> states;
+  std::vector<std::vector<BaseAgent*> > groups;
+  std::vector<BaseAgent*>::iterator itr = tgt->begin();
+  for (; itr != tgt->end(); ++itr) {
+    (*itr)->wake();
+    State* nextState = StateForAgent();
+    size_t s = std::find(states.begin(), states.end(), nextState) - states.begin();
+    if (s == states.size()) {
+      states.push_back(nextState);
+      groups.push_back(std::vector<BaseAgent*>());
+    }
+    groups[s].push_back(*itr);
+  }
+  for (size_t s = 0; s < states.size(); ++s) {
+    ACTIVE_FSM->forceStateTransitions(groups[s], states[s], _reenter);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
 void EventEffectAgentState::agentEffect(BaseAgent* agent) {
   State* nextState = StateForAgent();
   State* currState = ACTIVE_FSM->getCurrentState(agent);
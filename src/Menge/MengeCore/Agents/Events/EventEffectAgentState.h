@@ -70,6 +70,16 @@ class MENGE_API EventEffectAgentState : public AgentEventEffect {
 
   friend class EventEffectAgentStateFactory;
 
+  /*!
+   @brief    Applies the effect to the target agents as a batch.
+
+   The target state is selected for each agent (in order) and the agents headed to the same state
+   are moved together via BFSM::FSM::forceStateTransitions().
+
+   @param    target    The target to apply the event to.
+   */
+  void apply(EventTarget* target) override;
+
  protected:
   /*!
    @brief    The actual work of the effect.
@@ -65,13 +65,17 @@ void NamedStateMemberTarget::finalize() {
 
 void NamedStateMemberTarget::update() {
   if (_lastUpdate != SIM_TIME) {
-    _elements.clear();
-    const size_t AGENT_COUNT = SIMULATOR->getNumAgents();
-    for (size_t i = 0; i < AGENT_COUNT; ++i) {
-      Agents::BaseAgent* agent = SIMULATOR->getAgent(i);
-      BFSM::State* state = ACTIVE_FSM->getCurrentState(agent);
-      if ((state != _state) ^ _inState) {
-        _elements.push_back(agent);
+    if (_inState) {
+      const std::vector<Agents::BaseAgent*>& members = _state->getMembers();
+      _elements.assign(members.begin(), members.end());
+    } else {
+      _elements.clear();
+      const size_t AGENT_COUNT = SIMULATOR->getNumAgents();
+      for (size_t i = 0; i < AGENT_COUNT; ++i) {
+        Agents::BaseAgent* agent = SIMULATOR->getAgent(i);
+        if (ACTIVE_FSM->getCurrentState(agent) != _state) {
+          _elements.push_back(agent);
+        }
       }
     }
     AgentEventTarget::update();
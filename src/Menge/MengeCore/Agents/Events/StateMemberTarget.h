@@ -58,8 +58,9 @@ class MENGE_API NamedStateMemberTarget : public AgentEventTarget {
   /*!
    @brief    Gives the target a chance to update its knowledge of the target entities.
 
-   If a sub-class needs to do particular computation to evaluate the target, it should be
-   implemented here.
+   The members of the state are read from the state's membership (see BFSM::State::getMembers()),
+   in time proportional to the state's population. Targeting the agents *not* in the state
+   requires visiting every agent.
    */
   virtual void update();
 
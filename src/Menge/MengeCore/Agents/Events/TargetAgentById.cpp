@@ -12,7 +12,7 @@ namespace Menge {
 
 void TargetAgentById::update() {
   _elements.clear();
-  Agents::BaseAgent* agent = SIMULATOR->getAgent(_agentId);
+  Agents::BaseAgent* agent = SIMULATOR->getAgentById(_agentId);
   if (agent) {
     _elements.push_back(agent);
   } else {
@@ -1,7 +1,10 @@
 #include "MengeCore/Agents/Events/change_state_effect.h"
 
+#include <cassert>
 #include <sstream>
 
+#include "MengeCore/Agents/BaseAgent.h"
+#include "MengeCore/Agents/Events/AgentEventTarget.h"
 #include "MengeCore/Agents/Events/EventSystem.h"
 #include "MengeCore/BFSM/FSM.h"
 #include "MengeCore/BFSM/State.h"
@@ -24,6 +27,18 @@ void ChangeStateEffect::finalize() {
 
 /////////////////////////////////////////////////////////////////////
 
+void ChangeStateEffect::apply(EventTarget* target) {
+  assert(isCompatible(target) && "Incompatible target type passed to an AgentEventEffect instance");
+  AgentEventTarget* tgt = static_cast<AgentEventTarget*>(target);
+  std::vector<Agents::BaseAgent*> agents(tgt->begin(), tgt->end());
+  for (size_t i = 0; i < agents.size(); ++i) {
+    agents[i]->wake();
+  }
+  ACTIVE_FSM->forceStateTransitions(agents, _state, _force_reentry);
+}
+
+/////////////////////////////////////////////////////////////////////
+
 void ChangeStateEffect::agentEffect(Agents::BaseAgent* agent) {
   ACTIVE_FSM->forceStateTransition(agent, _state, _force_reentry);
 }
@@ -45,6 +45,10 @@ class MENGE_API ChangeStateEffect : public AgentEventEffect {
   /** @brief  Implementation of EventEffect::finalize().  */
   void finalize() override;
 
+  /** @brief  Moves all of the target agents to the state as a single batch (see
+              BFSM::FSM::forceStateTransitions()).  */
+  void apply(EventTarget* target) override;
+
   friend class ChangeStateEffectFactory;
 
  protected:
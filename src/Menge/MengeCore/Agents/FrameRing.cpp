@@ -0,0 +1,248 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#include "MengeCore/Agents/FrameRing.h"
+
+#include "MengeCore/Agents/BaseAgent.h"
+#include "MengeCore/Agents/SimulatorInterface.h"
+#include "MengeCore/BFSM/FSM.h"
+#include "MengeCore/Core.h"
+
+#include <chrono>
+#include <cstring>
+#include <new>
+
+namespace Menge {
+
+namespace Agents {
+
+namespace {
+const char RING_MAGIC[8] = {'M', 'E', 'N', 'G', 'E', 'R', 'N', 'G'};
+const unsigned int RING_VERSION = 1;
+
+// Rounds the size up to a whole number of cache lines.
+size_t cacheAlign(size_t size) { return (size + 63) & ~static_cast<size_t>(63); }
+
+unsigned long long steadyNanoseconds() {
+  return static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                             std::chrono::steady_clock::now().time_since_epoch())
+                                             .count());
+}
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////
+//                   Implementation of FrameRingWriter
+/////////////////////////////////////////////////////////////////////
+
+const size_t FrameRingWriter::DEFAULT_SLOT_COUNT = 8;
+
+/////////////////////////////////////////////////////////////////////
+
+FrameRingWriter::FrameRingWriter() : _region(), _sequence(0), _truncationReported(false) {}
+
+/////////////////////////////////////////////////////////////////////
+
+bool FrameRingWriter::open(const std::string& name, size_t maxAgents, size_t slotCount) {
+  if (slotCount == 0 || maxAgents == 0) {
+    logger << Logger::ERR_MSG << "FRAMERING: the ring requires at least one slot and one agent.";
+    return false;
+  }
+  const size_t slotSize = cacheAlign(sizeof(FrameRingSlot) + maxAgents * sizeof(FrameRingAgent));
+  if (!_region.create(name, sizeof(FrameRingHeader) + slotCount * slotSize)) {
+    logger << Logger::ERR_MSG << "FRAMERING: unable to create the shared region \"" << name
+           << "\".";
+    return false;
+  }
+  char* data = _region.data();
+  FrameRingHeader* header = reinterpret_cast<FrameRingHeader*>(data);
+  header->version = RING_VERSION;
+  header->slotCount = static_cast<unsigned int>(slotCount);
+  header->maxAgents = static_cast<unsigned int>(maxAgents);
+  header->recordSize = sizeof(FrameRingAgent);
+  header->slotSize = slotSize;
+  new (&header->latest) std::atomic<unsigned long long>(0);
+  for (size_t s = 0; s < slotCount; ++s) {
+    new (data + sizeof(FrameRingHeader) + s * slotSize) std::atomic<unsigned long long>(0);
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+  memcpy(header->magic, RING_MAGIC, sizeof(RING_MAGIC));
+  _sequence = 0;
+  _truncationReported = false;
+  logger << Logger::INFO_MSG << "FRAMERING: publishing frames to \"" << name << "\" (" << slotCount
+         << " slots of " << maxAgents << " agents).";
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void FrameRingWriter::publish(SimulatorInterface* sim, BFSM::FSM* fsm) {
+  if (!_region.isOpen()) return;
+  FrameRingHeader* header = reinterpret_cast<FrameRingHeader*>(_region.data());
+  const unsigned long long sequence = _sequence + 1;
+  FrameRingSlot* slot = reinterpret_cast<FrameRingSlot*>(
+      _region.data() + sizeof(FrameRingHeader) + ((sequence - 1) % header->slotCount) *
+                                                     header->slotSize);
+  FrameRingAgent* records = reinterpret_cast<FrameRingAgent*>(slot + 1);
+
+  size_t agentCount = sim->getNumAgents();
+  if (agentCount > header->maxAgents) {
+    if (!_truncationReported) {
+      logger << Logger::WARN_MSG << "FRAMERING: the simulation has " << agentCount
+             << " agents, but the ring only holds " << header->maxAgents
+             << "; the remaining agents are not published.";
+      _truncationReported = true;
+    }
+    agentCount = header->maxAgents;
+  }
+
+  // Mark the slot as being written before touching its contents.
+  slot->sequence.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  const bool hasElevation = sim->hasElevation();
+  const int count = static_cast<int>(agentCount);
+#pragma omp parallel for
+  for (int i = 0; i < count; ++i) {
+    const BaseAgent* agt = sim->getAgent(i);
+    FrameRingAgent& rec = records[i];
+    rec.x = agt->_pos._x;
+    rec.y = agt->_pos._y;
+    rec.elevation = hasElevation ? sim->getElevation(agt) : 0.f;
+    rec.orientX = agt->_orient._x;
+    rec.orientY = agt->_orient._y;
+    rec.velX = agt->_vel._x;
+    rec.velY = agt->_vel._y;
+    rec.stateID = fsm != 0x0 ? static_cast<unsigned int>(fsm->getAgentStateID(agt)) : 0;
+    rec.classID = static_cast<unsigned int>(agt->_class);
+    rec.id = static_cast<unsigned int>(agt->_id);
+  }
+  slot->simTime = sim->getGlobalTime();
+  slot->agentCount = static_cast<unsigned int>(agentCount);
+  slot->publishTime = steadyNanoseconds();
+
+  slot->sequence.store(sequence, std::memory_order_release);
+  header->latest.store(sequence, std::memory_order_release);
+  _sequence = sequence;
+}
+
+/////////////////////////////////////////////////////////////////////
+//                   Implementation of FrameRingReader
+/////////////////////////////////////////////////////////////////////
+
+FrameRingReader::FrameRingReader() : _region(), _header(0x0) {}
+
+/////////////////////////////////////////////////////////////////////
+
+bool FrameRingReader::open(const std::string& name) {
+  close();
+  if (!_region.open(name)) return false;
+  const FrameRingHeader* header = reinterpret_cast<const FrameRingHeader*>(_region.data());
+  if (_region.size() < sizeof(FrameRingHeader) ||
+      memcmp(header->magic, RING_MAGIC, sizeof(RING_MAGIC)) != 0) {
+    close();
+    return false;
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (header->version != RING_VERSION || header->recordSize != sizeof(FrameRingAgent) ||
+      _region.size() < sizeof(FrameRingHeader) + header->slotCount * header->slotSize) {
+    close();
+    return false;
+  }
+  _header = header;
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void FrameRingReader::close() {
+  _header = 0x0;
+  _region.close();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t FrameRingReader::getSlotCount() const { return _header ? _header->slotCount : 0; }
+
+/////////////////////////////////////////////////////////////////////
+
+size_t FrameRingReader::getMaxAgents() const { return _header ? _header->maxAgents : 0; }
+
+/////////////////////////////////////////////////////////////////////
+
+unsigned long long FrameRingReader::getLatestSequence() const {
+  return _header ? _header->latest.load(std::memory_order_acquire) : 0;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+const FrameRingSlot* FrameRingReader::slot(unsigned long long sequence) const {
+  return reinterpret_cast<const FrameRingSlot*>(
+      _region.data() + sizeof(FrameRingHeader) +
+      ((sequence - 1) % _header->slotCount) * _header->slotSize);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool FrameRingReader::acquire(unsigned long long sequence, FrameView& view) const {
+  if (_header == 0x0 || sequence == 0) return false;
+  const FrameRingSlot* s = slot(sequence);
+  if (s->sequence.load(std::memory_order_acquire) != sequence) return false;
+  view.sequence = sequence;
+  view.publishTime = s->publishTime;
+  view.simTime = s->simTime;
+  view.agentCount = s->agentCount;
+  if (view.agentCount > _header->maxAgents) return false;  // Torn; validate() would fail.
+  view.agents = reinterpret_cast<const FrameRingAgent*>(s + 1);
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool FrameRingReader::acquireLatest(FrameView& view) const {
+  return acquire(getLatestSequence(), view);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool FrameRingReader::validate(const FrameView& view) const {
+  if (_header == 0x0) return false;
+  // Everything read from the slot must be complete before the sequence is re-checked.
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return slot(view.sequence)->sequence.load(std::memory_order_relaxed) == view.sequence;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool FrameRingReader::copyLatest(std::vector<FrameRingAgent>& agents, FrameView& view) const {
+  // The writer can only lap the reader if the ring is very short or the reader is descheduled;
+  // give up after a few attempts rather than spin indefinitely.
+  for (int attempt = 0; attempt < 16; ++attempt) {
+    FrameView candidate;
+    if (!acquireLatest(candidate)) continue;
+    agents.assign(candidate.agents, candidate.agents + candidate.agentCount);
+    if (validate(candidate)) {
+      view = candidate;
+      view.agents = agents.empty() ? 0x0 : &agents[0];
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace Agents
+}  // namespace Menge
@@ -0,0 +1,290 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+/*!
+ @file    FrameRing.h
+ @brief   Publication of simulation frames to other processes through a shared-memory ring buffer.
+ */
+
+#ifndef __FRAME_RING_H__
+#define __FRAME_RING_H__
+
+#include "MengeCore/CoreConfig.h"
+#include "MengeCore/Runtime/SharedMemoryRegion.h"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace Menge {
+
+namespace BFSM {
+class FSM;
+}
+
+namespace Agents {
+
+class SimulatorInterface;
+
+/*!
+ @brief    The per-agent record published in each frame of a FrameRing.
+ */
+struct FrameRingAgent {
+  /*! @brief  The agent's position. */
+  float x, y;
+  /*! @brief  The agent's elevation (zero if the simulator has no elevation). */
+  float elevation;
+  /*! @brief  The agent's orientation (a unit vector). */
+  float orientX, orientY;
+  /*! @brief  The agent's velocity. */
+  float velX, velY;
+  /*! @brief  The id of the agent's current BFSM state (zero if there is no BFSM). */
+  unsigned int stateID;
+  /*! @brief  The agent's class. */
+  unsigned int classID;
+  /*! @brief  The agent's id. */
+  unsigned int id;
+};
+
+/*!
+ @brief    The header at the start of the shared region.
+
+ The ring is laid out as this header followed by `slotCount` slots of `slotSize` bytes. Each slot is
+ a FrameRingSlot followed by up to `maxAgents` FrameRingAgent records.
+ */
+struct FrameRingHeader {
+  /*! @brief  The identifier "MENGERNG"; written last, so readers never see a partial header. */
+  char magic[8];
+  /*! @brief  The layout version (currently 1). */
+  unsigned int version;
+  /*! @brief  The number of slots in the ring. */
+  unsigned int slotCount;
+  /*! @brief  The maximum number of agents a slot can hold. */
+  unsigned int maxAgents;
+  /*! @brief  The size, in bytes, of a FrameRingAgent record. */
+  unsigned int recordSize;
+  /*! @brief  The size, in bytes, of each slot (including its FrameRingSlot header). */
+  unsigned long long slotSize;
+  /*! @brief  The sequence number of the most recently published frame (zero before the first). */
+  std::atomic<unsigned long long> latest;
+  /*! @brief  Pads the header to a cache line. */
+  char padding[24];
+};
+
+/*!
+ @brief    The header of a single slot in the ring.
+ */
+struct FrameRingSlot {
+  /*! @brief  The sequence number of the frame in the slot; zero while the slot is being written. */
+  std::atomic<unsigned long long> sequence;
+  /*! @brief  The time the frame was published, in nanoseconds of the steady clock. */
+  unsigned long long publishTime;
+  /*! @brief  The simulation time of the frame. */
+  float simTime;
+  /*! @brief  The number of agent records in the frame. */
+  unsigned int agentCount;
+  /*! @brief  Pads the slot header to a cache line. */
+  char padding[40];
+};
+
+/*!
+ @brief    Publishes each simulation frame into a named shared-memory ring buffer.
+
+ Frames are numbered from one. Frame n is written into slot `(n - 1) % slotCount`, overwriting the
+ oldest frame. Each slot is guarded by its sequence number (a "sequence lock"): the writer clears it
+ before writing the slot and sets it to the frame's number afterwards, so readers can detect a frame
+ which was overwritten while they were reading it. The writer never waits on readers and readers
+ never modify the region, so any number of processes can read the ring concurrently.
+ */
+class MENGE_API FrameRingWriter {
+ public:
+  /*!
+   @brief    The default number of slots in the ring.
+   */
+  static const size_t DEFAULT_SLOT_COUNT;
+
+  /*!
+   @brief    Constructor.
+   */
+  FrameRingWriter();
+
+  /*!
+   @brief    Creates the shared region.
+
+   @param    name         The name of the shared region.
+   @param    maxAgents    The maximum number of agents published per frame; additional agents are
+                          omitted.
+   @param    slotCount    The number of frames the ring holds.
+   @returns  True if the region was created.
+   */
+  bool open(const std::string& name, size_t maxAgents, size_t slotCount = DEFAULT_SLOT_COUNT);
+
+  /*!
+   @brief    Reports if the shared region has been created.
+   */
+  bool isOpen() const { return _region.isOpen(); }
+
+  /*!
+   @brief    Publishes the current state of the simulator's agents as the next frame.
+
+   @param    sim    The simulator.
+   @param    fsm    The behavior finite state machine (may be NULL).
+   */
+  void publish(SimulatorInterface* sim, BFSM::FSM* fsm);
+
+  /*!
+   @brief    Reports the sequence number of the last published frame.
+   */
+  unsigned long long getSequence() const { return _sequence; }
+
+ private:
+  /*!
+   @brief    The shared region.
+   */
+  SharedMemoryRegion _region;
+
+  /*!
+   @brief    The sequence number of the last published frame.
+   */
+  unsigned long long _sequence;
+
+  /*!
+   @brief    Indicates that the truncation of the population has already been reported.
+   */
+  bool _truncationReported;
+};
+
+/*!
+ @brief    A frame acquired from a FrameRingReader.
+
+ The records point directly into the shared region; they are only valid if
+ FrameRingReader::validate reports true *after* they have been read.
+ */
+struct FrameView {
+  /*! @brief  The frame's sequence number. */
+  unsigned long long sequence;
+  /*! @brief  The time the frame was published, in nanoseconds of the steady clock. */
+  unsigned long long publishTime;
+  /*! @brief  The simulation time of the frame. */
+  float simTime;
+  /*! @brief  The number of agent records. */
+  size_t agentCount;
+  /*! @brief  The agent records. */
+  const FrameRingAgent* agents;
+};
+
+/*!
+ @brief    Reads frames published by a FrameRingWriter in another (or the same) process.
+
+ Reading is zero-copy: acquire() returns a view into the shared region. Because the writer never
+ waits, the slot may be overwritten while it is being read; after consuming the view, the reader
+ calls validate() and discards what it read if the frame is no longer intact. copyLatest() wraps this
+ protocol for readers that simply want a consistent copy of the newest frame.
+ */
+class MENGE_API FrameRingReader {
+ public:
+  /*!
+   @brief    Constructor.
+   */
+  FrameRingReader();
+
+  /*!
+   @brief    Maps the named ring.
+
+   @param    name    The name of the shared region.
+   @returns  True if the region exists and contains a ring of a supported version.
+   */
+  bool open(const std::string& name);
+
+  /*!
+   @brief    Unmaps the ring.
+   */
+  void close();
+
+  /*!
+   @brief    Reports if a ring is mapped.
+   */
+  bool isOpen() const { return _header != 0x0; }
+
+  /*!
+   @brief    Reports the number of slots in the ring.
+   */
+  size_t getSlotCount() const;
+
+  /*!
+   @brief    Reports the maximum number of agents per frame.
+   */
+  size_t getMaxAgents() const;
+
+  /*!
+   @brief    Reports the sequence number of the most recently published frame (zero if none).
+   */
+  unsigned long long getLatestSequence() const;
+
+  /*!
+   @brief    Acquires a view of the frame with the given sequence number.
+
+   @param    sequence    The frame's sequence number.
+   @param    view        Set to the frame's contents on success.
+   @returns  True if the frame is currently in the ring. False if it has not been published yet,
+            has already been overwritten, or is being written.
+   */
+  bool acquire(unsigned long long sequence, FrameView& view) const;
+
+  /*!
+   @brief    Acquires a view of the most recently published frame.
+
+   @param    view    Set to the frame's contents on success.
+   @returns  True if a frame was acquired.
+   */
+  bool acquireLatest(FrameView& view) const;
+
+  /*!
+   @brief    Reports if the frame viewed is still intact; call after reading its contents.
+   */
+  bool validate(const FrameView& view) const;
+
+  /*!
+   @brief    Copies the most recently published frame.
+
+   @param    agents    Set to the frame's agent records.
+   @param    view      Set to the frame's meta data (its agents pointer refers to `agents`).
+   @returns  True if a consistent frame was copied.
+   */
+  bool copyLatest(std::vector<FrameRingAgent>& agents, FrameView& view) const;
+
+ private:
+  /*!
+   @brief    Returns the header of the slot for the given sequence number.
+   */
+  const FrameRingSlot* slot(unsigned long long sequence) const;
+
+  /*!
+   @brief    The shared region.
+   */
+  SharedMemoryRegion _region;
+
+  /*!
+   @brief    The ring's header (or NULL if no ring is mapped).
+   */
+  const FrameRingHeader* _header;
+};
+
+}  // namespace Agents
+}  // namespace Menge
+#endif  // __FRAME_RING_H__
@@ -0,0 +1,419 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#include "MengeCore/Agents/SCBCodec.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace Menge {
+
+namespace Agents {
+
+namespace {
+// The encoded fields of each agent, in payload order.
+enum Field { X_FIELD = 0, Y_FIELD, ORIENT_FIELD, STATE_FIELD, FIELD_COUNT };
+
+// Residuals are coded in blocks of this many values, each block with its own rice parameter.
+const size_t BLOCK_SIZE = 64;
+// The rice parameter which marks a block whose residuals are all zero.
+const unsigned int ZERO_BLOCK = 31;
+// Quotients at or above this value are escaped and written verbatim.
+const unsigned int ESCAPE_QUOTIENT = 24;
+
+const size_t HEADER_SIZE = 32;
+const double TWO_PI = 6.283185307179586;
+
+inline unsigned long long zigzag(long long v) {
+  return (static_cast<unsigned long long>(v) << 1) ^ static_cast<unsigned long long>(v >> 63);
+}
+
+inline long long unzigzag(unsigned long long v) {
+  return static_cast<long long>(v >> 1) ^ -static_cast<long long>(v & 1);
+}
+
+inline unsigned int bitLength(unsigned long long v) {
+  unsigned int len = 0;
+  while (v) {
+    ++len;
+    v >>= 1;
+  }
+  return len;
+}
+
+// Maps a value into the range [0, steps).
+inline long long wrapPositive(long long v, long long steps) {
+  v %= steps;
+  return v < 0 ? v + steps : v;
+}
+
+// Maps a value into the range [-steps/2, steps/2).
+inline long long wrapSigned(long long v, long long steps) {
+  v = wrapPositive(v, steps);
+  return 2 * v >= steps ? v - steps : v;
+}
+
+// The value predicted by a predictor of the given order (0: none, 1: constant, 2: linear
+// extrapolation) from the two preceding frames.
+inline long long predict(unsigned int order, long long prev, long long prevPrev) {
+  return order == 0 ? 0 : (order == 1 ? prev : 2 * prev - prevPrev);
+}
+
+// The number of bits required to rice code v with parameter k.
+inline unsigned int riceCost(unsigned long long v, unsigned int k) {
+  const unsigned long long q = v >> k;
+  return q < ESCAPE_QUOTIENT ? static_cast<unsigned int>(q) + 1 + k
+                             : ESCAPE_QUOTIENT + 6 + bitLength(v);
+}
+
+// The rice parameter which minimizes the coded size of the given block; the size (in bits) is
+// reported in cost.
+unsigned int selectRiceParameter(const unsigned long long* values, size_t count,
+                                 unsigned long long& cost) {
+  unsigned long long sum = 0;
+  for (size_t i = 0; i < count; ++i) sum += values[i];
+  cost = 0;
+  if (sum == 0) return ZERO_BLOCK;
+  const unsigned int guess = bitLength(sum / count);
+  unsigned int bestK = 0;
+  cost = ~0ull;
+  const unsigned int lo = guess > 1 ? guess - 1 : 0;
+  const unsigned int hi = guess + 1 < ZERO_BLOCK ? guess + 1 : ZERO_BLOCK - 1;
+  for (unsigned int k = lo; k <= hi; ++k) {
+    unsigned long long kCost = 0;
+    for (size_t i = 0; i < count; ++i) kCost += riceCost(values[i], k);
+    if (kCost < cost) {
+      cost = kCost;
+      bestK = k;
+    }
+  }
+  return bestK;
+}
+
+// Reads bits (most-significant first) from an encoded payload.
+class BitReader {
+ public:
+  BitReader(const unsigned char* data, size_t size) : _data(data), _size(size), _bit(0) {}
+
+  bool read(unsigned int count, unsigned long long& value) {
+    value = 0;
+    while (count > 0) {
+      const size_t byte = _bit >> 3;
+      if (byte >= _size) return false;
+      const unsigned int offset = static_cast<unsigned int>(_bit & 7);
+      const unsigned int take = count < 8 - offset ? count : 8 - offset;
+      const unsigned int bits = (_data[byte] >> (8 - offset - take)) & ((1u << take) - 1);
+      value = (value << take) | bits;
+      _bit += take;
+      count -= take;
+    }
+    return true;
+  }
+
+  // Reads a rice coded value with parameter k.
+  bool readRice(unsigned int k, unsigned long long& value) {
+    unsigned long long bit;
+    unsigned int q = 0;
+    while (q < ESCAPE_QUOTIENT) {
+      if (!read(1, bit)) return false;
+      if (bit == 0) break;
+      ++q;
+    }
+    if (q == ESCAPE_QUOTIENT) {
+      unsigned long long length;
+      if (!read(6, length)) return false;
+      return read(static_cast<unsigned int>(length) + 1, value);
+    }
+    unsigned long long remainder = 0;
+    if (k > 0 && !read(k, remainder)) return false;
+    value = (static_cast<unsigned long long>(q) << k) | remainder;
+    return true;
+  }
+
+ private:
+  const unsigned char* _data;
+  size_t _size;
+  size_t _bit;
+};
+
+template <typename T>
+inline void writeValue(std::ostream& out, const T& value) {
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+inline void readValue(const char*& data, T& value) {
+  memcpy(&value, data, sizeof(T));
+  data += sizeof(T);
+}
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////
+
+unsigned int scbChecksum(const unsigned char* data, size_t size) {
+  unsigned int hash = 2166136261u;
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= data[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+/////////////////////////////////////////////////////////////////////
+//                   Implementation of SCBChunkEncoder
+/////////////////////////////////////////////////////////////////////
+
+const size_t SCBChunkEncoder::DEFAULT_FRAMES_PER_CHUNK = 32;
+
+/////////////////////////////////////////////////////////////////////
+
+const float SCBChunkEncoder::DEFAULT_POSITION_QUANTUM = 0.005f;
+
+/////////////////////////////////////////////////////////////////////
+
+const unsigned int SCBChunkEncoder::DEFAULT_ORIENTATION_STEPS = 1024;
+
+/////////////////////////////////////////////////////////////////////
+
+SCBChunkEncoder::SCBChunkEncoder(size_t framesPerChunk, float positionQuantum,
+                                 unsigned int orientationSteps)
+    : _framesPerChunk(framesPerChunk < 1 ? 1 : (framesPerChunk > 0xFFFF ? 0xFFFF : framesPerChunk)),
+      _positionQuantum(positionQuantum),
+      _orientationSteps(orientationSteps),
+      _nextFrame(0),
+      _chunkFrames(0),
+      _agentCount(0),
+      _bitBuffer(0),
+      _bitCount(0) {}
+
+/////////////////////////////////////////////////////////////////////
+
+void SCBChunkEncoder::addFrame(const SCBAgentRecord* agents, size_t agentCount,
+                               std::ostream& out) {
+  if (_chunkFrames > 0 && agentCount != _agentCount) finish(out);
+  if (_chunkFrames == 0) {
+    _agentCount = agentCount;
+    _history[0].assign(agentCount * FIELD_COUNT, 0);
+    _history[1].assign(agentCount * FIELD_COUNT, 0);
+  }
+
+  _quantized.resize(agentCount * FIELD_COUNT);
+  const double orientScale = _orientationSteps / TWO_PI;
+  for (size_t a = 0; a < agentCount; ++a) {
+    long long* q = &_quantized[a * FIELD_COUNT];
+    q[X_FIELD] = static_cast<long long>(std::floor(agents[a].x / _positionQuantum + 0.5));
+    q[Y_FIELD] = static_cast<long long>(std::floor(agents[a].y / _positionQuantum + 0.5));
+    q[ORIENT_FIELD] =
+        wrapPositive(static_cast<long long>(std::floor(agents[a].orientation * orientScale + 0.5)),
+                     _orientationSteps);
+    q[STATE_FIELD] = agents[a].stateID;
+  }
+  for (int f = 0; f < FIELD_COUNT; ++f) encodeField(f);
+
+  // The current frame becomes the previous frame; the oldest buffer is recycled.
+  _history[1].swap(_history[0]);
+  _history[0].swap(_quantized);
+
+  ++_nextFrame;
+  ++_chunkFrames;
+  if (_chunkFrames == _framesPerChunk) finish(out);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void SCBChunkEncoder::finish(std::ostream& out) {
+  if (_chunkFrames == 0) return;
+  if (_bitCount > 0) {
+    _payload.push_back(static_cast<unsigned char>((_bitBuffer << (8 - _bitCount)) & 0xFF));
+  }
+  const unsigned int payloadSize = static_cast<unsigned int>(_payload.size());
+  out.write("CHNK", 4);
+  writeValue(out, static_cast<unsigned int>(_nextFrame - _chunkFrames));
+  writeValue(out, static_cast<unsigned short>(_chunkFrames));
+  writeValue(out, static_cast<unsigned short>(FIELD_COUNT));
+  writeValue(out, static_cast<unsigned int>(_agentCount));
+  writeValue(out, _positionQuantum);
+  writeValue(out, _orientationSteps);
+  writeValue(out, payloadSize);
+  writeValue(out, payloadSize > 0 ? scbChecksum(&_payload[0], payloadSize) : scbChecksum(0x0, 0));
+  if (payloadSize > 0) out.write(reinterpret_cast<const char*>(&_payload[0]), payloadSize);
+
+  _payload.clear();
+  _bitBuffer = 0;
+  _bitCount = 0;
+  _chunkFrames = 0;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void SCBChunkEncoder::encodeField(int field) {
+  const std::vector<long long>& prev = _history[0];
+  const std::vector<long long>& prevPrev = _history[1];
+  const long long steps = _orientationSteps;
+  // Predictors can only reference frames in the current chunk; state ids are always XOR'd.
+  const unsigned int maxOrder =
+      field == STATE_FIELD ? 0 : (_chunkFrames < 2 ? static_cast<unsigned int>(_chunkFrames) : 2);
+  _residuals.resize(3 * BLOCK_SIZE);
+
+  for (size_t start = 0; start < _agentCount; start += BLOCK_SIZE) {
+    const size_t count = _agentCount - start < BLOCK_SIZE ? _agentCount - start : BLOCK_SIZE;
+    unsigned int bestOrder = 0;
+    unsigned int bestK = 0;
+    unsigned long long bestCost = ~0ull;
+    for (unsigned int order = 0; order <= maxOrder; ++order) {
+      unsigned long long* r = &_residuals[order * BLOCK_SIZE];
+      for (size_t i = 0; i < count; ++i) {
+        const size_t idx = (start + i) * FIELD_COUNT + field;
+        const long long q = _quantized[idx];
+        if (field == STATE_FIELD) {
+          r[i] = _chunkFrames == 0 ? q : q ^ prev[idx];
+        } else {
+          long long delta = q - predict(order, prev[idx], prevPrev[idx]);
+          if (field == ORIENT_FIELD) delta = wrapSigned(delta, steps);
+          r[i] = zigzag(delta);
+        }
+      }
+      unsigned long long cost;
+      const unsigned int k = selectRiceParameter(r, count, cost);
+      if (cost < bestCost) {
+        bestCost = cost;
+        bestOrder = order;
+        bestK = k;
+      }
+    }
+
+    if (field != STATE_FIELD) writeBits(bestOrder, 2);
+    writeBits(bestK, 5);
+    if (bestK == ZERO_BLOCK) continue;
+    const unsigned long long* values = &_residuals[bestOrder * BLOCK_SIZE];
+    for (size_t i = 0; i < count; ++i) {
+      const unsigned long long v = values[i];
+      const unsigned long long q = v >> bestK;
+      if (q < ESCAPE_QUOTIENT) {
+        // q ones followed by a zero.
+        writeBits(((1ull << q) - 1) << 1, static_cast<unsigned int>(q) + 1);
+        writeBits(v, bestK);
+      } else {
+        const unsigned int length = bitLength(v);
+        writeBits((1ull << ESCAPE_QUOTIENT) - 1, ESCAPE_QUOTIENT);
+        writeBits(length - 1, 6);
+        writeBits(v, length);
+      }
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void SCBChunkEncoder::writeBits(unsigned long long value, unsigned int bitCount) {
+  if (bitCount > 32) {
+    writeBits(value >> 32, bitCount - 32);
+    bitCount = 32;
+  }
+  if (bitCount == 0) return;
+  const unsigned long long mask = (1ull << bitCount) - 1;
+  _bitBuffer = (_bitBuffer << bitCount) | (value & mask);
+  _bitCount += bitCount;
+  while (_bitCount >= 8) {
+    _bitCount -= 8;
+    _payload.push_back(static_cast<unsigned char>((_bitBuffer >> _bitCount) & 0xFF));
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+//                   Implementation of SCBChunkDecoder
+/////////////////////////////////////////////////////////////////////
+
+bool SCBChunkDecoder::decode(const char* data, size_t size, size_t& consumed) {
+  if (size < HEADER_SIZE) return false;
+  const char* cursor = data;
+  readValue(cursor, _header.magic);
+  readValue(cursor, _header.firstFrame);
+  readValue(cursor, _header.frameCount);
+  readValue(cursor, _header.fieldCount);
+  readValue(cursor, _header.agentCount);
+  readValue(cursor, _header.positionQuantum);
+  readValue(cursor, _header.orientationSteps);
+  readValue(cursor, _header.payloadSize);
+  readValue(cursor, _header.checksum);
+  if (memcmp(_header.magic, "CHNK", 4) != 0 || _header.fieldCount != FIELD_COUNT ||
+      _header.orientationSteps == 0 || _header.payloadSize > size - HEADER_SIZE) {
+    return false;
+  }
+  const unsigned char* payload = reinterpret_cast<const unsigned char*>(cursor);
+  if (scbChecksum(payload, _header.payloadSize) != _header.checksum) return false;
+
+  const size_t agentCount = _header.agentCount;
+  _records.resize(agentCount * _header.frameCount);
+  if (_records.empty()) {
+    consumed = HEADER_SIZE + _header.payloadSize;
+    return true;
+  }
+  const long long steps = _header.orientationSteps;
+  const double orientScale = TWO_PI / steps;
+  // The current, previous and second previous frames' quantized values.
+  std::vector<long long> history[3];
+  for (int i = 0; i < 3; ++i) history[i].assign(agentCount * FIELD_COUNT, 0);
+  BitReader reader(payload, _header.payloadSize);
+
+  for (size_t frame = 0; frame < _header.frameCount; ++frame) {
+    std::vector<long long>& curr = history[0];
+    const std::vector<long long>& prev = history[1];
+    const std::vector<long long>& prevPrev = history[2];
+    for (int f = 0; f < FIELD_COUNT; ++f) {
+      for (size_t start = 0; start < agentCount; start += BLOCK_SIZE) {
+        const size_t count = agentCount - start < BLOCK_SIZE ? agentCount - start : BLOCK_SIZE;
+        unsigned long long order = 0;
+        unsigned long long k;
+        if (f != STATE_FIELD && (!reader.read(2, order) || order > 2)) return false;
+        if (!reader.read(5, k)) return false;
+        for (size_t i = 0; i < count; ++i) {
+          unsigned long long v = 0;
+          if (k != ZERO_BLOCK && !reader.readRice(static_cast<unsigned int>(k), v)) return false;
+          const size_t idx = (start + i) * FIELD_COUNT + f;
+          if (f == STATE_FIELD) {
+            const long long state = static_cast<long long>(v);
+            curr[idx] = frame == 0 ? state : state ^ prev[idx];
+          } else {
+            const long long value =
+                predict(static_cast<unsigned int>(order), prev[idx], prevPrev[idx]) + unzigzag(v);
+            curr[idx] = f == ORIENT_FIELD ? wrapPositive(value, steps) : value;
+          }
+        }
+      }
+    }
+    SCBAgentRecord* records = &_records[frame * agentCount];
+    for (size_t a = 0; a < agentCount; ++a) {
+      const long long* q = &curr[a * FIELD_COUNT];
+      records[a].x = static_cast<float>(q[X_FIELD] * (double)_header.positionQuantum);
+      records[a].y = static_cast<float>(q[Y_FIELD] * (double)_header.positionQuantum);
+      double angle = q[ORIENT_FIELD] * orientScale;
+      if (2 * q[ORIENT_FIELD] > steps) angle -= TWO_PI;
+      records[a].orientation = static_cast<float>(angle);
+      records[a].stateID = static_cast<unsigned int>(q[STATE_FIELD]);
+    }
+    // The current frame becomes the previous frame; the oldest buffer is recycled.
+    history[2].swap(history[1]);
+    history[1].swap(history[0]);
+  }
+  consumed = HEADER_SIZE + _header.payloadSize;
+  return true;
+}
+
+}  // namespace Agents
+}  // namespace Menge
@@ -0,0 +1,299 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+/*!
+ @file  SCBCodec.h
+ @brief  The chunk encoder and decoder for the compressed (version 3.0) scb trajectory format.
+
+ See @ref page_outSpec for the specification of the format.
+ */
+
+#ifndef __SCB_CODEC_H__
+#define __SCB_CODEC_H__
+
+#include "MengeCore/CoreConfig.h"
+
+#include <ostream>
+#include <vector>
+
+namespace Menge {
+
+namespace Agents {
+
+/*!
+ @brief    The per-agent data stored in each frame of a version 3.0 scb file.
+ */
+struct MENGE_API SCBAgentRecord {
+  /*!
+   @brief    The x-component of the agent's position.
+   */
+  float x;
+
+  /*!
+   @brief    The y-component of the agent's position.
+   */
+  float y;
+
+  /*!
+   @brief    The agent's orientation (in radians).
+   */
+  float orientation;
+
+  /*!
+   @brief    The id of the agent's current BFSM state.
+   */
+  unsigned int stateID;
+};
+
+/////////////////////////////////////////////////////////////////////
+
+/*!
+ @brief    The fixed-size header which precedes every chunk of a version 3.0 scb file.
+ */
+struct MENGE_API SCBChunkHeader {
+  /*!
+   @brief    The chunk marker; always the bytes "CHNK".
+   */
+  char magic[4];
+
+  /*!
+   @brief    The (global) index of the first frame in the chunk.
+   */
+  unsigned int firstFrame;
+
+  /*!
+   @brief    The number of frames in the chunk.
+   */
+  unsigned short frameCount;
+
+  /*!
+   @brief    The number of encoded fields per agent (currently always 4).
+   */
+  unsigned short fieldCount;
+
+  /*!
+   @brief    The number of agents in every frame of the chunk.
+   */
+  unsigned int agentCount;
+
+  /*!
+   @brief    The size of a position quantization step (in world units).
+   */
+  float positionQuantum;
+
+  /*!
+   @brief    The number of quantization steps in a full circle of orientation.
+   */
+  unsigned int orientationSteps;
+
+  /*!
+   @brief    The size of the encoded payload (in bytes) which follows the header.
+   */
+  unsigned int payloadSize;
+
+  /*!
+   @brief    The 32-bit FNV-1a hash of the payload.
+   */
+  unsigned int checksum;
+};
+
+/////////////////////////////////////////////////////////////////////
+
+/*!
+ @brief    Quantizes, delta-encodes and entropy codes agent frames into self-contained chunks.
+
+ Frames are encoded as they are added; a chunk is written to the output stream when it holds the
+ configured number of frames, when the agent count changes, or when finish() is called.
+ */
+class MENGE_API SCBChunkEncoder {
+ public:
+  /*!
+   @brief    Constructor.
+
+   @param    framesPerChunk      The maximum number of frames in a chunk.
+   @param    positionQuantum     The size of a position quantization step (in world units).
+   @param    orientationSteps    The number of quantization steps in a full circle of orientation.
+   */
+  SCBChunkEncoder(size_t framesPerChunk = DEFAULT_FRAMES_PER_CHUNK,
+                  float positionQuantum = DEFAULT_POSITION_QUANTUM,
+                  unsigned int orientationSteps = DEFAULT_ORIENTATION_STEPS);
+
+  /*!
+   @brief    Adds a frame to the current chunk.
+
+   @param    agents        The agent records for the frame.
+   @param    agentCount    The number of agent records.
+   @param    out           The stream any completed chunk is written to.
+   */
+  void addFrame(const SCBAgentRecord* agents, size_t agentCount, std::ostream& out);
+
+  /*!
+   @brief    Writes the current (partial) chunk to the stream, if it has any frames.
+
+   @param    out           The stream the chunk is written to.
+   */
+  void finish(std::ostream& out);
+
+  /*!
+   @brief    The default maximum number of frames per chunk.
+   */
+  static const size_t DEFAULT_FRAMES_PER_CHUNK;
+
+  /*!
+   @brief    The default position quantization step (five millimeters, assuming meters).
+   */
+  static const float DEFAULT_POSITION_QUANTUM;
+
+  /*!
+   @brief    The default number of orientation quantization steps per circle.
+   */
+  static const unsigned int DEFAULT_ORIENTATION_STEPS;
+
+ protected:
+  /*!
+   @brief    Encodes one field of the current frame, choosing the cheapest predictor for each block.
+
+   @param    field    The index of the field to encode.
+   */
+  void encodeField(int field);
+
+  /*!
+   @brief    Appends the given number of low-order bits of value to the payload.
+   */
+  void writeBits(unsigned long long value, unsigned int bitCount);
+
+  /*!
+   @brief    The maximum number of frames per chunk.
+   */
+  size_t _framesPerChunk;
+
+  /*!
+   @brief    The size of a position quantization step.
+   */
+  float _positionQuantum;
+
+  /*!
+   @brief    The number of orientation quantization steps per circle.
+   */
+  unsigned int _orientationSteps;
+
+  /*!
+   @brief    The global index of the next frame to be added.
+   */
+  unsigned int _nextFrame;
+
+  /*!
+   @brief    The number of frames in the current chunk.
+   */
+  size_t _chunkFrames;
+
+  /*!
+   @brief    The number of agents in each frame of the current chunk.
+   */
+  size_t _agentCount;
+
+  /*!
+   @brief    The quantized values of the current frame (four fields per agent).
+   */
+  std::vector<long long> _quantized;
+
+  /*!
+   @brief    The quantized values of the previous (0) and second previous (1) frames; used for
+              prediction.
+   */
+  std::vector<long long> _history[2];
+
+  /*!
+   @brief    The encoded payload of the current chunk.
+   */
+  std::vector<unsigned char> _payload;
+
+  /*!
+   @brief    Bits waiting to be appended to the payload.
+   */
+  unsigned long long _bitBuffer;
+
+  /*!
+   @brief    The number of valid bits in _bitBuffer.
+   */
+  unsigned int _bitCount;
+
+  /*!
+   @brief    Scratch space for a block's residuals under each predictor.
+   */
+  std::vector<unsigned long long> _residuals;
+};
+
+/////////////////////////////////////////////////////////////////////
+
+/*!
+ @brief    Decodes a single chunk of a version 3.0 scb file.
+ */
+class MENGE_API SCBChunkDecoder {
+ public:
+  /*!
+   @brief    Decodes the chunk starting at the given location.
+
+   @param    data       The start of the chunk (i.e., its header).
+   @param    size       The number of bytes available at data.
+   @param    consumed   Set to the total size of the chunk (header and payload) on success.
+   @returns  True if a complete, valid chunk was decoded.  False if the data is truncated or
+              corrupt.
+   */
+  bool decode(const char* data, size_t size, size_t& consumed);
+
+  /*!
+   @brief    Reports the header of the most recently decoded chunk.
+   */
+  const SCBChunkHeader& getHeader() const { return _header; }
+
+  /*!
+   @brief    Reports the number of frames in the most recently decoded chunk.
+   */
+  size_t getFrameCount() const { return _header.frameCount; }
+
+  /*!
+   @brief    Reports the number of agents in the most recently decoded chunk.
+   */
+  size_t getAgentCount() const { return _header.agentCount; }
+
+  /*!
+   @brief    Returns the agent records for the ith frame of the decoded chunk.
+   */
+  const SCBAgentRecord* getFrame(size_t i) const { return &_records[i * _header.agentCount]; }
+
+ protected:
+  /*!
+   @brief    The header of the decoded chunk.
+   */
+  SCBChunkHeader _header;
+
+  /*!
+   @brief    The decoded agent records for all frames of the chunk.
+   */
+  std::vector<SCBAgentRecord> _records;
+};
+
+/*!
+ @brief    Computes the 32-bit FNV-1a hash of the given data.
+ */
+MENGE_API unsigned int scbChecksum(const unsigned char* data, size_t size);
+
+}  // namespace Agents
+}  // namespace Menge
+#endif  // __SCB_CODEC_H__
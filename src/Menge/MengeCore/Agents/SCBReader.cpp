@@ -0,0 +1,300 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#include "MengeCore/Agents/SCBReader.h"
+
+#include "MengeCore/Runtime/Logger.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+namespace Menge {
+
+namespace Agents {
+
+namespace {
+// The size of a version 3.0 chunk header (see SCBChunkHeader).
+const size_t CHUNK_HEADER_SIZE = 32;
+
+// The marker at the start of a chunk index file.
+const char INDEX_MAGIC[4] = {'S', 'C', 'B', 'I'};
+
+template <typename T>
+inline T readValue(const char* data) {
+  T value;
+  memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+// The number of floats per agent record for each supported version; 0 for unsupported versions.
+size_t agentStride(int major, int minor) {
+  if (major == 1 && minor == 0) return 3;
+  if (major == 2) {
+    switch (minor) {
+      case 0:
+        return 3;
+      case 1:
+        return 4;
+      case 2:
+        return 8;
+      case 3:
+        return 4;
+      case 4:
+        return 4;
+    }
+  }
+  if (major == 3 && minor == 0) return 4;
+  return 0;
+}
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////
+//                   Implementation of SCBReader
+/////////////////////////////////////////////////////////////////////
+
+SCBReader::SCBReader()
+    : _agentCount(0),
+      _timeStep(0.f),
+      _classIDs(0x0),
+      _stride(0),
+      _dataOffset(0),
+      _frameCount(0),
+      _decodedChunk(-1),
+      _bufferedFrame(-1) {
+  _version[0] = _version[1] = 0;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool SCBReader::open(const std::string& fileName, const std::string& indexFile) {
+  close();
+  if (!_file.open(fileName)) {
+    logger << Logger::ERR_MSG << "Unable to open scb file: " << fileName << "\n";
+    return false;
+  }
+  if (!readHeader()) {
+    logger << Logger::ERR_MSG << "Not a supported scb file: " << fileName << "\n";
+    close();
+    return false;
+  }
+  if (_version[0] == 3) {
+    if (indexFile == "" || !loadIndex(indexFile)) {
+      buildIndex();
+      if (indexFile != "" && !writeIndex(indexFile)) {
+        logger << Logger::WARN_MSG << "Unable to write scb index file: " << indexFile << "\n";
+      }
+    }
+    indexFrames();
+  } else {
+    const size_t frameSize = _agentCount * _stride * sizeof(float);
+    _frameCount = frameSize > 0 ? (_file.size() - _dataOffset) / frameSize : 0;
+  }
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void SCBReader::close() {
+  _file.close();
+  _version[0] = _version[1] = 0;
+  _agentCount = 0;
+  _timeStep = 0.f;
+  _classIDs = 0x0;
+  _stride = 0;
+  _dataOffset = 0;
+  _frameCount = 0;
+  _chunkOffsets.clear();
+  _chunkFirstFrames.clear();
+  _frameChunks.clear();
+  _decodedChunk = -1;
+  _bufferedFrame = -1;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t SCBReader::getFrameAgentCount(size_t i) const {
+  if (_version[0] != 3) return _agentCount;
+  const size_t offset = _chunkOffsets[_frameChunks[i]];
+  return readValue<unsigned int>(_file.data() + offset + 12);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+const float* SCBReader::getFrame(size_t i) {
+  if (i >= _frameCount) return 0x0;
+  if (_version[0] != 3) {
+    // Fixed-size frames; the records are used in place.
+    const size_t frameSize = _agentCount * _stride * sizeof(float);
+    return reinterpret_cast<const float*>(_file.data() + _dataOffset + i * frameSize);
+  }
+
+  if (_bufferedFrame == static_cast<long long>(i)) return _frameBuffer.data();
+  const unsigned int chunk = _frameChunks[i];
+  if (_decodedChunk != static_cast<int>(chunk)) {
+    const size_t offset = _chunkOffsets[chunk];
+    size_t consumed;
+    if (!_decoder.decode(_file.data() + offset, _file.size() - offset, consumed)) {
+      logger << Logger::ERR_MSG << "Corrupt scb chunk at byte " << offset << "\n";
+      _decodedChunk = -1;
+      return 0x0;
+    }
+    _decodedChunk = static_cast<int>(chunk);
+  }
+  const size_t agentCount = _decoder.getAgentCount();
+  const SCBAgentRecord* records = _decoder.getFrame(i - _chunkFirstFrames[chunk]);
+  _frameBuffer.resize(agentCount * _stride);
+  for (size_t a = 0; a < agentCount; ++a) {
+    float* rec = &_frameBuffer[a * _stride];
+    rec[0] = records[a].x;
+    rec[1] = records[a].y;
+    rec[2] = records[a].orientation;
+    rec[3] = static_cast<float>(records[a].stateID);
+  }
+  _bufferedFrame = static_cast<long long>(i);
+  return _frameBuffer.data();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool SCBReader::readHeader() {
+  const char* data = _file.data();
+  const size_t size = _file.size();
+  // The header starts with a null-terminated version string of the form "major.minor".
+  size_t len = 0;
+  while (len < size && len < 8 && data[len] != 0) ++len;
+  if (len == size || len == 8) return false;
+  const std::string version(data, len);
+  const size_t dot = version.find('.');
+  if (dot == std::string::npos) return false;
+  _version[0] = atoi(version.substr(0, dot).c_str());
+  _version[1] = atoi(version.substr(dot + 1).c_str());
+  _stride = agentStride(_version[0], _version[1]);
+  if (_stride == 0) return false;
+
+  size_t offset = len + 1;
+  if (offset + sizeof(int) > size) return false;
+  const int agentCount = readValue<int>(data + offset);
+  if (agentCount < 0) return false;
+  _agentCount = static_cast<size_t>(agentCount);
+  offset += sizeof(int);
+  if (_version[0] >= 2) {
+    if (offset + sizeof(float) + _agentCount * sizeof(unsigned int) > size) return false;
+    _timeStep = readValue<float>(data + offset);
+    offset += sizeof(float);
+    _classIDs = reinterpret_cast<const unsigned int*>(data + offset);
+    offset += _agentCount * sizeof(unsigned int);
+  }
+  _dataOffset = offset;
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void SCBReader::buildIndex() {
+  _chunkOffsets.clear();
+  _chunkFirstFrames.clear();
+  const char* data = _file.data();
+  const size_t size = _file.size();
+  size_t offset = _dataOffset;
+  size_t frame = 0;
+  // Only the chunk headers are touched; a truncated final chunk is ignored.
+  while (offset + CHUNK_HEADER_SIZE <= size && memcmp(data + offset, "CHNK", 4) == 0) {
+    const size_t payloadSize = readValue<unsigned int>(data + offset + 24);
+    if (offset + CHUNK_HEADER_SIZE + payloadSize > size) break;
+    _chunkOffsets.push_back(offset);
+    _chunkFirstFrames.push_back(frame);
+    frame += readValue<unsigned short>(data + offset + 8);
+    offset += CHUNK_HEADER_SIZE + payloadSize;
+  }
+  _frameCount = frame;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void SCBReader::indexFrames() {
+  _frameChunks.resize(_frameCount);
+  for (size_t c = 0; c < _chunkFirstFrames.size(); ++c) {
+    const size_t end = c + 1 < _chunkFirstFrames.size() ? _chunkFirstFrames[c + 1] : _frameCount;
+    for (size_t f = _chunkFirstFrames[c]; f < end; ++f) {
+      _frameChunks[f] = static_cast<unsigned int>(c);
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool SCBReader::writeIndex(const std::string& fileName) const {
+  std::ofstream out(fileName.c_str(), std::ios::out | std::ios::binary);
+  if (!out.is_open()) return false;
+  // Layout: magic, scb file size (uint64), chunk count (uint32), frame count (uint32), then a
+  // (uint64 offset, uint64 first frame) pair per chunk.
+  const unsigned long long fileSize = _file.size();
+  const unsigned int chunkCount = static_cast<unsigned int>(_chunkOffsets.size());
+  const unsigned int frameCount = static_cast<unsigned int>(_frameCount);
+  out.write(INDEX_MAGIC, 4);
+  out.write(reinterpret_cast<const char*>(&fileSize), sizeof(fileSize));
+  out.write(reinterpret_cast<const char*>(&chunkCount), sizeof(chunkCount));
+  out.write(reinterpret_cast<const char*>(&frameCount), sizeof(frameCount));
+  for (size_t c = 0; c < _chunkOffsets.size(); ++c) {
+    const unsigned long long entry[2] = {_chunkOffsets[c], _chunkFirstFrames[c]};
+    out.write(reinterpret_cast<const char*>(entry), sizeof(entry));
+  }
+  return out.good();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool SCBReader::loadIndex(const std::string& fileName) {
+  MemoryMappedFile index;
+  if (!index.open(fileName)) return false;
+  const size_t PREFIX_SIZE = 4 + sizeof(unsigned long long) + 2 * sizeof(unsigned int);
+  const size_t ENTRY_SIZE = 2 * sizeof(unsigned long long);
+  const char* data = index.data();
+  if (index.size() < PREFIX_SIZE || memcmp(data, INDEX_MAGIC, 4) != 0) return false;
+  // An index is only valid for the exact file it was built from; a file which has grown since
+  // (e.g., a simulation in progress) gets a new index.
+  if (readValue<unsigned long long>(data + 4) != _file.size()) return false;
+  const unsigned int chunkCount = readValue<unsigned int>(data + 12);
+  const unsigned int frameCount = readValue<unsigned int>(data + 16);
+  if (index.size() != PREFIX_SIZE + chunkCount * ENTRY_SIZE) return false;
+
+  std::vector<size_t> offsets(chunkCount);
+  std::vector<size_t> firstFrames(chunkCount);
+  for (unsigned int c = 0; c < chunkCount; ++c) {
+    const char* entry = data + PREFIX_SIZE + c * ENTRY_SIZE;
+    offsets[c] = static_cast<size_t>(readValue<unsigned long long>(entry));
+    firstFrames[c] = static_cast<size_t>(readValue<unsigned long long>(entry + 8));
+    if (offsets[c] + CHUNK_HEADER_SIZE > _file.size() ||
+        memcmp(_file.data() + offsets[c], "CHNK", 4) != 0 || firstFrames[c] > frameCount) {
+      return false;
+    }
+    // The chunks follow one another; frames are found by searching the first frames in order.
+    if (c == 0 ? firstFrames[c] != 0
+               : offsets[c] <= offsets[c - 1] || firstFrames[c] <= firstFrames[c - 1]) {
+      return false;
+    }
+  }
+  _chunkOffsets.swap(offsets);
+  _chunkFirstFrames.swap(firstFrames);
+  _frameCount = frameCount;
+  return true;
+}
+
+}  // namespace Agents
+}  // namespace Menge
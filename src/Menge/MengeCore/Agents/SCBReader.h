@@ -0,0 +1,246 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+/*!
+ @file  SCBReader.h
+ @brief  Random-access reading of scb trajectory files.
+ */
+
+#ifndef __SCB_READER_H__
+#define __SCB_READER_H__
+
+#include "MengeCore/Agents/SCBCodec.h"
+#include "MengeCore/CoreConfig.h"
+#include "MengeCore/Runtime/MemoryMappedFile.h"
+
+#include <string>
+#include <vector>
+
+namespace Menge {
+
+namespace Agents {
+
+/*!
+ @brief    Provides random access to the frames of an scb trajectory file.
+
+ The file is memory mapped. For versions 1.0 through 2.4 every frame has the same size, so the
+ location of any frame is computed directly and getFrame() returns a pointer into the mapped file
+ (no data is copied). For version 3.0, an index of the file's chunks is built when the file is
+ opened (or loaded from an index file written previously); getFrame() decodes the frame's chunk
+ into an internal buffer, so other frames in the same chunk are then cheap to read.
+
+ Each frame is an array of `getFrameAgentCount()` records of `getAgentStride()` floats. The
+ contents of a record depend on the version (see @ref page_outSpec); version 3.0 frames are
+ presented with the version 2.1 layout (x, y, orientation, state id).
+
+ A file which is still being written (or was truncated) is read up to its last complete frame (or
+ chunk, for version 3.0).
+ */
+class MENGE_API SCBReader {
+ public:
+  /*!
+   @brief    Constructor.
+   */
+  SCBReader();
+
+  /*!
+   @brief    Opens the given scb file.
+
+   @param    fileName     The path to the scb file.
+   @param    indexFile    An optional path to a frame index (only used for version 3.0). If the
+                          index exists and matches the file, it is loaded rather than built. If
+                          it doesn't, the index is built and written to this path.
+   @returns  True if the file was successfully opened.
+   */
+  bool open(const std::string& fileName, const std::string& indexFile = "");
+
+  /*!
+   @brief    Closes the file; all pointers previously returned by getFrame() become invalid.
+   */
+  void close();
+
+  /*!
+   @brief    Reports if a file is open.
+   */
+  bool isOpen() const { return _file.isOpen(); }
+
+  /*!
+   @brief    Reports the major version of the open file.
+   */
+  int getMajorVersion() const { return _version[0]; }
+
+  /*!
+   @brief    Reports the minor version of the open file.
+   */
+  int getMinorVersion() const { return _version[1]; }
+
+  /*!
+   @brief    Reports the number of agents declared in the file header.
+   */
+  size_t getAgentCount() const { return _agentCount; }
+
+  /*!
+   @brief    Reports the simulation time step between frames (zero for version 1.0 files, which do
+              not record it).
+   */
+  float getTimeStep() const { return _timeStep; }
+
+  /*!
+   @brief    Returns the agent class ids (or NULL for version 1.0 files, which do not record them).
+   */
+  const unsigned int* getClassIDs() const { return _classIDs; }
+
+  /*!
+   @brief    Reports the number of floats in each agent record.
+   */
+  size_t getAgentStride() const { return _stride; }
+
+  /*!
+   @brief    Reports the number of (complete) frames in the file.
+   */
+  size_t getFrameCount() const { return _frameCount; }
+
+  /*!
+   @brief    Reports the number of agents in the ith frame.
+
+   This is always getAgentCount() for versions prior to 3.0; version 3.0 files can record a
+   changing population.
+
+   @param    i    The index of the frame. Must be less than getFrameCount().
+   */
+  size_t getFrameAgentCount(size_t i) const;
+
+  /*!
+   @brief    Returns the agent records of the ith frame.
+
+   @param    i    The index of the frame. Must be less than getFrameCount().
+   @returns  A pointer to `getFrameAgentCount(i) * getAgentStride()` floats. For versions prior to
+            3.0 this points directly into the mapped file. For version 3.0, it is valid until
+            another frame is requested. NULL if the frame cannot be read.
+   */
+  const float* getFrame(size_t i);
+
+  /*!
+   @brief    Writes the current (version 3.0) chunk index to the given file.
+
+   @param    fileName    The path to the index file.
+   @returns  True if the index was written.
+   */
+  bool writeIndex(const std::string& fileName) const;
+
+ protected:
+  /*!
+   @brief    Parses the file header; returns false if the file is not a supported scb file.
+   */
+  bool readHeader();
+
+  /*!
+   @brief    Builds the chunk index of a version 3.0 file by walking the chunk headers.
+   */
+  void buildIndex();
+
+  /*!
+   @brief    Loads the chunk index of a version 3.0 file; returns false if the index doesn't exist
+              or doesn't match the open file.
+   */
+  bool loadIndex(const std::string& fileName);
+
+  /*!
+   @brief    Populates the frame-to-chunk table from the chunk index.
+   */
+  void indexFrames();
+
+  /*!
+   @brief    The mapped scb file.
+   */
+  MemoryMappedFile _file;
+
+  /*!
+   @brief    The major and minor version of the file.
+   */
+  int _version[2];
+
+  /*!
+   @brief    The number of agents declared in the header.
+   */
+  size_t _agentCount;
+
+  /*!
+   @brief    The time step between frames.
+   */
+  float _timeStep;
+
+  /*!
+   @brief    The agent class ids (pointing into the mapped file).
+   */
+  const unsigned int* _classIDs;
+
+  /*!
+   @brief    The number of floats per agent record.
+   */
+  size_t _stride;
+
+  /*!
+   @brief    The offset of the first frame (or chunk) in the file.
+   */
+  size_t _dataOffset;
+
+  /*!
+   @brief    The number of complete frames.
+   */
+  size_t _frameCount;
+
+  /*!
+   @brief    The byte offsets of each chunk (version 3.0 only).
+   */
+  std::vector<size_t> _chunkOffsets;
+
+  /*!
+   @brief    The global index of each chunk's first frame (version 3.0 only).
+   */
+  std::vector<size_t> _chunkFirstFrames;
+
+  /*!
+   @brief    The chunk which contains each frame (version 3.0 only).
+   */
+  std::vector<unsigned int> _frameChunks;
+
+  /*!
+   @brief    The chunk decoder (version 3.0 only).
+   */
+  SCBChunkDecoder _decoder;
+
+  /*!
+   @brief    The index of the chunk currently held by the decoder (-1 if none).
+   */
+  int _decodedChunk;
+
+  /*!
+   @brief    The agent records of the frame most recently requested from a version 3.0 file.
+   */
+  std::vector<float> _frameBuffer;
+
+  /*!
+   @brief    The index of the frame held in _frameBuffer (-1 if none).
+   */
+  long long _bufferedFrame;
+};
+
+}  // namespace Agents
+}  // namespace Menge
+#endif  // __SCB_READER_H__
@@ -41,6 +41,9 @@ Any questions or comments should be sent to the authors {menge,geom}@cs.unc.edu
 #include "MengeCore/Agents/SimulatorInterface.h"
 #include "MengeCore/Core.h"
 
+#include <algorithm>
+#include <chrono>
+
 namespace Menge {
 
 namespace Agents {
@@ -49,9 +52,20 @@ namespace Agents {
 //                   Implementation of SCBWriter
 /////////////////////////////////////////////////////////////////////
 
+const size_t SCBWriter::DEFAULT_QUEUE_DEPTH = 2;
+
+/////////////////////////////////////////////////////////////////////
+
 SCBWriter::SCBWriter(const std::string& pathName, const std::string& version,
-                     SimulatorInterface* sim)
-    : _frameWriter(0x0) {
+                     SimulatorInterface* sim, size_t queueDepth)
+    : _frameWriter(0x0),
+      _headerAgentCount(0),
+      _populationWarned(false),
+      _stopping(false),
+      _ioFailed(false),
+      _ioFailureReported(false),
+      _stallCount(0),
+      _stallTime(0.0) {
   if (!validateVersion(version)) {
     logger << Logger::ERR_MSG << "Invalid SCB version: " << version << "\n";
     throw SCBVersionException();
@@ -64,12 +78,34 @@ SCBWriter::SCBWriter(const std::string& pathName, const std::string& version,
   }
   _sim = sim;
   writeHeader();
+
+  // The frame buffers are sized lazily (in writeFrame) so they track the agent population.
+  _buffers.resize(queueDepth > 0 ? queueDepth : 1);
+  for (size_t i = 0; i < _buffers.size(); ++i) _freeBuffers.push_back(i);
+  if (queueDepth > 0) {
+    _ioThread = std::thread(&SCBWriter::ioLoop, this);
+  }
 }
 
 /////////////////////////////////////////////////////////////////////
 
 SCBWriter::~SCBWriter() {
-  if (_file.is_open()) _file.close();
+  if (_ioThread.joinable()) {
+    {
+      std::lock_guard<std::mutex> guard(_queueLock);
+      _stopping = true;
+    }
+    _frameQueued.notify_one();
+    _ioThread.join();
+  }
+  if (_stallCount > 0) {
+    logger << Logger::INFO_MSG << "SCBWRITER: the simulation waited on trajectory output ";
+    logger << _stallCount << " time(s) for a total of " << _stallTime << " seconds.";
+  }
+  if (_file.is_open()) {
+    _frameWriter->finish(_file);
+    _file.close();
+  }
   if (_frameWriter) delete _frameWriter;
 }
 
@@ -78,7 +114,7 @@ SCBWriter::~SCBWriter() {
 bool SCBWriter::validateVersion(const std::string& version) {
   bool valid = (version == "1.0" ||  // a simple exhaustive list of valid versions
                 version == "2.0" || version == "2.1" || version == "2.2" || version == "2.3" ||
-                version == "2.4");
+                version == "2.4" || version == "3.0");
   if (valid) {
     // convert string to ints
     size_t dotPos = version.find_first_of(".");
@@ -98,6 +134,8 @@ bool SCBWriter::validateVersion(const std::string& version) {
       } else if (_version[1] == 4) {
         _frameWriter = new SCBFrameWriter2_4();
       }
+    } else if (_version[0] == 3 && _version[1] == 0) {
+      _frameWriter = new SCBFrameWriter3_0();
     }
     assert(_frameWriter != 0x0 && "Valid version didn't produce a frame writer");
   }
@@ -106,7 +144,110 @@ bool SCBWriter::validateVersion(const std::string& version) {
 
 /////////////////////////////////////////////////////////////////////
 
-void SCBWriter::writeFrame(BFSM::FSM* fsm) { _frameWriter->writeFrame(_file, _sim, fsm); }
+void SCBWriter::writeFrame(BFSM::FSM* fsm) {
+  if (!_ioThread.joinable()) {
+    // Synchronous output; the single buffer is always available.
+    std::vector<char>& buffer = _buffers[0];
+    fillBuffer(buffer, fsm);
+    if (buffer.empty()) return;
+    _frameWriter->writeBlock(_file, &buffer[0], buffer.size() / _frameWriter->agentSize());
+    return;
+  }
+
+  const size_t index = acquireBuffer();
+  fillBuffer(_buffers[index], fsm);
+  {
+    std::lock_guard<std::mutex> guard(_queueLock);
+    _pendingBuffers.push_back(index);
+  }
+  _frameQueued.notify_one();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void SCBWriter::fillBuffer(std::vector<char>& buffer, BFSM::FSM* fsm) {
+  const size_t AGENT_SIZE = _frameWriter->agentSize();
+  const size_t AGT_COUNT = _sim->getNumAgents();
+  // Only version 3.0 frames record their own agent count; older versions have exactly as many
+  // records as the header declares.
+  const size_t RECORD_COUNT = _version[0] < 3 ? _headerAgentCount : AGT_COUNT;
+  if (RECORD_COUNT != AGT_COUNT && !_populationWarned) {
+    logger << Logger::WARN_MSG << "The agent population changed from " << _headerAgentCount;
+    logger << " to " << AGT_COUNT << "; scb version " << _version[0] << "." << _version[1];
+    logger << " can't represent it. Frames are truncated or padded with empty records; use version";
+    logger << " 3.0.";
+    _populationWarned = true;
+  }
+  buffer.resize(AGENT_SIZE * std::max(AGT_COUNT, RECORD_COUNT));
+  if (AGT_COUNT > 0) _frameWriter->writeFrame(&buffer[0], _sim, fsm);
+  if (RECORD_COUNT > AGT_COUNT) {
+    std::fill(buffer.begin() + AGENT_SIZE * AGT_COUNT, buffer.end(), 0);
+  }
+  buffer.resize(AGENT_SIZE * RECORD_COUNT);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void SCBWriter::flush() {
+  if (_ioThread.joinable()) {
+    std::unique_lock<std::mutex> guard(_queueLock);
+    _bufferFreed.wait(guard, [this] { return _freeBuffers.size() == _buffers.size(); });
+  }
+  // The I/O thread is idle; it is safe to let the frame writer touch the file.
+  _frameWriter->finish(_file);
+  _file.flush();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t SCBWriter::acquireBuffer() {
+  std::unique_lock<std::mutex> guard(_queueLock);
+  if (_freeBuffers.empty()) {
+    // Back-pressure: the disk is not keeping up with the simulation.
+    if (_stallCount == 0) {
+      logger << Logger::WARN_MSG << "SCBWRITER: trajectory output cannot keep up with the ";
+      logger << "simulation; the simulation will wait for frames to be written.";
+    }
+    ++_stallCount;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    _bufferFreed.wait(guard, [this] { return !_freeBuffers.empty(); });
+    _stallTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+  if (_ioFailed && !_ioFailureReported) {
+    logger << Logger::ERR_MSG << "SCBWRITER: error writing to the trajectory file; subsequent ";
+    logger << "frames will be discarded.";
+    _ioFailureReported = true;
+  }
+  const size_t index = _freeBuffers.front();
+  _freeBuffers.pop_front();
+  return index;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void SCBWriter::ioLoop() {
+  std::unique_lock<std::mutex> guard(_queueLock);
+  while (true) {
+    _frameQueued.wait(guard, [this] { return _stopping || !_pendingBuffers.empty(); });
+    if (_pendingBuffers.empty()) break;  // stopping and fully drained
+    const size_t index = _pendingBuffers.front();
+    _pendingBuffers.pop_front();
+    const bool failed = _ioFailed;
+    guard.unlock();
+
+    const std::vector<char>& buffer = _buffers[index];
+    bool ok = true;
+    if (!failed && !buffer.empty()) {
+      _frameWriter->writeBlock(_file, &buffer[0], buffer.size() / _frameWriter->agentSize());
+      ok = _file.good();
+    }
+
+    guard.lock();
+    if (!ok) _ioFailed = true;
+    _freeBuffers.push_back(index);
+    _bufferFreed.notify_one();
+  }
+}
 
 /////////////////////////////////////////////////////////////////////
 
@@ -114,7 +255,8 @@ void SCBWriter::writeHeader() {
   _file << _version[0] << "." << _version[1] << (char)0x0;
   if (_version[0] == 1) {
     writeHeader1_0();
-  } else if (_version[0] == 2) {
+  } else if (_version[0] == 2 || _version[0] == 3) {
+    // Version 3 shares the version 2 header; only the frame data differs.
     writeHeader2_0();
   }
 }
@@ -122,14 +264,14 @@ void SCBWriter::writeHeader() {
 /////////////////////////////////////////////////////////////////////
 
 void SCBWriter::writeHeader1_0() {
-  const size_t AGT_COUNT = _sim->getNumAgents();
+  const size_t AGT_COUNT = _headerAgentCount = _sim->getNumAgents();
   _file.write((char*)&AGT_COUNT, sizeof(int));
 }
 
 /////////////////////////////////////////////////////////////////////
 
 void SCBWriter::writeHeader2_0() {
-  const size_t AGT_COUNT = _sim->getNumAgents();
+  const size_t AGT_COUNT = _headerAgentCount = _sim->getNumAgents();
   _file.write((char*)&AGT_COUNT, sizeof(int));
   float step = _sim->getTimeStep();
   _file.write((char*)&step, sizeof(float));
@@ -147,111 +289,160 @@ void SCBWriter::writeHeader2_0() {
 
 const int SCBFrameWriter::ZERO = 0;
 
+/////////////////////////////////////////////////////////////////////
+
+void SCBFrameWriter::writeFrame(char* buffer, SimulatorInterface* sim, BFSM::FSM* fsm) const {
+  const int AGT_COUNT = static_cast<int>(sim->getNumAgents());
+  const size_t AGT_SIZE = agentSize();
+#pragma omp parallel for
+  for (int i = 0; i < AGT_COUNT; ++i) {
+    writeAgent(buffer + i * AGT_SIZE, sim->getAgent(i), sim, fsm);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void SCBFrameWriter::writeBlock(std::ofstream& file, const char* buffer, size_t agentCount) {
+  file.write(buffer, agentCount * agentSize());
+}
+
 /////////////////////////////////////////////////////////////////////
 //                   Implementation of SCBFrameWriter1_0
 /////////////////////////////////////////////////////////////////////
 
-void SCBFrameWriter1_0::writeFrame(std::ofstream& file, SimulatorInterface* sim, BFSM::FSM* fsm) {
-  const size_t AGT_COUNT = sim->getNumAgents();
-  for (size_t i = 0; i < AGT_COUNT; ++i) {
-    Agents::BaseAgent* agt = sim->getAgent(i);
-    const Math::Vector2& p = agt->_pos;
-    file.write((char*)&p, 2 * sizeof(float));
-    float orient = atan2(agt->_orient.y(), agt->_orient.x());
-    file.write((char*)&orient, sizeof(float));
-  }
+size_t SCBFrameWriter1_0::agentSize() const { return 3 * sizeof(float); }
+
+/////////////////////////////////////////////////////////////////////
+
+void SCBFrameWriter1_0::writeAgent(char* buffer, const BaseAgent* agt, SimulatorInterface* sim,
+                                   BFSM::FSM* fsm) const {
+  float* data = reinterpret_cast<float*>(buffer);
+  data[0] = agt->_pos._x;
+  data[1] = agt->_pos._y;
+  data[2] = atan2(agt->_orient.y(), agt->_orient.x());
 }
 
 /////////////////////////////////////////////////////////////////////
 //                   Implementation of SCBFrameWriter2_0
 /////////////////////////////////////////////////////////////////////
 
-void SCBFrameWriter2_0::writeFrame(std::ofstream& file, SimulatorInterface* sim, BFSM::FSM* fsm) {
-  const size_t AGT_COUNT = sim->getNumAgents();
-  for (size_t i = 0; i < AGT_COUNT; ++i) {
-    Agents::BaseAgent* agt = sim->getAgent(i);
-    const Math::Vector2& p = agt->_pos;
-    file.write((char*)&p, 2 * sizeof(float));
-    float orient = atan2(agt->_orient.y(), agt->_orient.x());
-    file.write((char*)&orient, sizeof(float));
-  }
+size_t SCBFrameWriter2_0::agentSize() const { return 3 * sizeof(float); }
+
+/////////////////////////////////////////////////////////////////////
+
+void SCBFrameWriter2_0::writeAgent(char* buffer, const BaseAgent* agt, SimulatorInterface* sim,
+                                   BFSM::FSM* fsm) const {
+  float* data = reinterpret_cast<float*>(buffer);
+  data[0] = agt->_pos._x;
+  data[1] = agt->_pos._y;
+  data[2] = atan2(agt->_orient.y(), agt->_orient.x());
 }
 
 /////////////////////////////////////////////////////////////////////
 //                   Implementation of SCBFrameWriter2_1
 /////////////////////////////////////////////////////////////////////
 
-void SCBFrameWriter2_1::writeFrame(std::ofstream& file, SimulatorInterface* sim, BFSM::FSM* fsm) {
-  const size_t AGT_COUNT = sim->getNumAgents();
-  for (size_t i = 0; i < AGT_COUNT; ++i) {
-    Agents::BaseAgent* agt = sim->getAgent(i);
-    const Math::Vector2& p = agt->_pos;
-    file.write((char*)&p, 2 * sizeof(float));
-    float orient = atan2(agt->_orient.y(), agt->_orient.x());
-    file.write((char*)&orient, sizeof(float));
-    float state = (float)fsm->getAgentStateID(i);
-    file.write((char*)&state, sizeof(float));
-  }
+size_t SCBFrameWriter2_1::agentSize() const { return 4 * sizeof(float); }
+
+/////////////////////////////////////////////////////////////////////
+
+void SCBFrameWriter2_1::writeAgent(char* buffer, const BaseAgent* agt, SimulatorInterface* sim,
+                                   BFSM::FSM* fsm) const {
+  float* data = reinterpret_cast<float*>(buffer);
+  data[0] = agt->_pos._x;
+  data[1] = agt->_pos._y;
+  data[2] = atan2(agt->_orient.y(), agt->_orient.x());
+  data[3] = (float)fsm->getAgentStateID(agt);
 }
 
 /////////////////////////////////////////////////////////////////////
 //                   Implementation of SCBFrameWriter2_2
 /////////////////////////////////////////////////////////////////////
 
-void SCBFrameWriter2_2::writeFrame(std::ofstream& file, SimulatorInterface* sim, BFSM::FSM* fsm) {
-  const size_t AGT_COUNT = sim->getNumAgents();
-  for (size_t i = 0; i < AGT_COUNT; ++i) {
-    Agents::BaseAgent* agt = sim->getAgent(i);
-    const Math::Vector2& p = agt->_pos;
-    file.write((char*)&p, 2 * sizeof(float));
-    float orient = atan2(agt->_orient.y(), agt->_orient.x());
-    file.write((char*)&orient, sizeof(float));
-    float state = (float)fsm->getAgentStateID(i);
-    file.write((char*)&state, sizeof(float));
-    // pref velocity
-    // NOTE: This does not use _velPref.getSpeed() because it may be modified
-    //    by intention filters.  This factors those out.
-    const Math::Vector2 vDir = agt->_velPref.getPreferredVel();
-    file.write((char*)&vDir, 2 * sizeof(float));
-    // velocity
-    const Math::Vector2& v = agt->_vel;
-    file.write((char*)&v, 2 * sizeof(float));
-  }
+size_t SCBFrameWriter2_2::agentSize() const { return 8 * sizeof(float); }
+
+/////////////////////////////////////////////////////////////////////
+
+void SCBFrameWriter2_2::writeAgent(char* buffer, const BaseAgent* agt, SimulatorInterface* sim,
+                                   BFSM::FSM* fsm) const {
+  float* data = reinterpret_cast<float*>(buffer);
+  data[0] = agt->_pos._x;
+  data[1] = agt->_pos._y;
+  data[2] = atan2(agt->_orient.y(), agt->_orient.x());
+  data[3] = (float)fsm->getAgentStateID(agt);
+  // pref velocity
+  // NOTE: This does not use _velPref.getSpeed() because it may be modified
+  //    by intention filters.  This factors those out.
+  const Math::Vector2 vDir = agt->_velPref.getPreferredVel();
+  data[4] = vDir._x;
+  data[5] = vDir._y;
+  // velocity
+  data[6] = agt->_vel._x;
+  data[7] = agt->_vel._y;
 }
 
 /////////////////////////////////////////////////////////////////////
 //                   Implementation of SCBFrameWriter2_3
 /////////////////////////////////////////////////////////////////////
 
-void SCBFrameWriter2_3::writeFrame(std::ofstream& file, SimulatorInterface* sim, BFSM::FSM* fsm) {
-  const size_t AGT_COUNT = sim->getNumAgents();
-  for (size_t i = 0; i < AGT_COUNT; ++i) {
-    Agents::BaseAgent* agt = sim->getAgent(i);
-    const Math::Vector2& p = agt->_pos;
-    file.write((char*)&p, 2 * sizeof(float));
-    file.write((char*)&agt->_orient, 2 * sizeof(float));
-  }
+size_t SCBFrameWriter2_3::agentSize() const { return 4 * sizeof(float); }
+
+/////////////////////////////////////////////////////////////////////
+
+void SCBFrameWriter2_3::writeAgent(char* buffer, const BaseAgent* agt, SimulatorInterface* sim,
+                                   BFSM::FSM* fsm) const {
+  float* data = reinterpret_cast<float*>(buffer);
+  data[0] = agt->_pos._x;
+  data[1] = agt->_pos._y;
+  data[2] = agt->_orient._x;
+  data[3] = agt->_orient._y;
 }
 
 /////////////////////////////////////////////////////////////////////
 //                   Implementation of SCBFrameWriter2_4
 /////////////////////////////////////////////////////////////////////
 
-void SCBFrameWriter2_4::writeFrame(std::ofstream& file, SimulatorInterface* sim, BFSM::FSM* fsm) {
-  const size_t AGT_COUNT = sim->getNumAgents();
-  for (size_t i = 0; i < AGT_COUNT; ++i) {
-    Agents::BaseAgent* agt = sim->getAgent(i);
-    const Math::Vector2& p = agt->_pos;
-    float elevation = sim->getElevation(agt);
-    file.write((char*)&p._x, sizeof(float));
-    file.write((char*)&elevation, sizeof(float));
-    file.write((char*)&p._y, sizeof(float));
-    float orient = atan2(agt->_orient.y(), agt->_orient.x());
-    file.write((char*)&orient, sizeof(float));
-  }
+size_t SCBFrameWriter2_4::agentSize() const { return 4 * sizeof(float); }
+
+/////////////////////////////////////////////////////////////////////
+
+void SCBFrameWriter2_4::writeAgent(char* buffer, const BaseAgent* agt, SimulatorInterface* sim,
+                                   BFSM::FSM* fsm) const {
+  float* data = reinterpret_cast<float*>(buffer);
+  data[0] = agt->_pos._x;
+  data[1] = sim->getElevation(agt);
+  data[2] = agt->_pos._y;
+  data[3] = atan2(agt->_orient.y(), agt->_orient.x());
+}
+
+/////////////////////////////////////////////////////////////////////
+//                   Implementation of SCBFrameWriter3_0
+/////////////////////////////////////////////////////////////////////
+
+size_t SCBFrameWriter3_0::agentSize() const { return sizeof(SCBAgentRecord); }
+
+/////////////////////////////////////////////////////////////////////
+
+void SCBFrameWriter3_0::writeAgent(char* buffer, const BaseAgent* agt, SimulatorInterface* sim,
+                                   BFSM::FSM* fsm) const {
+  SCBAgentRecord* record = reinterpret_cast<SCBAgentRecord*>(buffer);
+  record->x = agt->_pos._x;
+  record->y = agt->_pos._y;
+  record->orientation = atan2(agt->_orient.y(), agt->_orient.x());
+  record->stateID = fsm != 0x0 ? static_cast<unsigned int>(fsm->getAgentStateID(agt)) : 0;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void SCBFrameWriter3_0::writeBlock(std::ofstream& file, const char* buffer, size_t agentCount) {
+  _encoder.addFrame(reinterpret_cast<const SCBAgentRecord*>(buffer), agentCount, file);
 }
 
 /////////////////////////////////////////////////////////////////////
 
+void SCBFrameWriter3_0::finish(std::ofstream& file) { _encoder.finish(file); }
+
+/////////////////////////////////////////////////////////////////////
+
 }  // namespace Agents
 }  // namespace Menge
@@ -25,11 +25,17 @@
 #define __SCB_WRITER_H__
 
 #include "MengeCore/Agents/BaseAgent.h"
+#include "MengeCore/Agents/SCBCodec.h"
 #include "MengeCore/BFSM/FSM.h"
 #include "MengeCore/mengeCommon.h"
 
+#include <condition_variable>
+#include <deque>
 #include <fstream>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace Menge {
 
@@ -122,6 +128,15 @@ class SimulatorInterface;
 
 /*!
  @brief    Class responsible for writing the agent state of the simulator and fsm into a file.
+
+ Each frame is snapshotted (in parallel) into a preallocated frame buffer on the simulation thread.
+ By default, the filled buffers are handed off to a background I/O thread which writes each frame
+ as a single block. The number of frames which can be in flight is bounded by the queue depth; if
+ the disk cannot keep up, writeFrame() blocks until a buffer becomes available. These stalls are
+ reported to the logger and can be queried with getStallCount() and getStallTime().
+
+ With a queue depth of zero, frames are written synchronously on the simulation thread (but still
+ as a single block per frame).
  */
 class SCBWriter {
  public:
@@ -131,13 +146,18 @@ class SCBWriter {
    @param    pathName    The path for the desired output file.
    @param    version      A string representing the version to write out.
    @param    sim          A pointer to the simulator to process
+   @param    queueDepth   The number of frame buffers that can be queued for the background writer.
+                          Zero disables the background writer.
    @throws  SCBVersionException  if the version string is not considered to be a valid version.
    @throws  SCBFileException if there is a problem opening the given path for writing.
    */
-  SCBWriter(const std::string& pathName, const std::string& version, SimulatorInterface* sim);
+  SCBWriter(const std::string& pathName, const std::string& version, SimulatorInterface* sim,
+            size_t queueDepth = DEFAULT_QUEUE_DEPTH);
 
   /*!
    @brief    Destructor.
+
+   All pending frames are written before the file is closed.
    */
   ~SCBWriter();
 
@@ -148,6 +168,28 @@ class SCBWriter {
    */
   void writeFrame(BFSM::FSM* fsm);
 
+  /*!
+   @brief    Blocks until all pending frames have been written and flushes the file.
+   */
+  void flush();
+
+  /*!
+   @brief    Reports the number of times writeFrame() had to wait for the background writer.
+   */
+  size_t getStallCount() const { return _stallCount; }
+
+  /*!
+   @brief    Reports the total time (in seconds) writeFrame() has spent waiting for the background
+              writer.
+   */
+  double getStallTime() const { return _stallTime; }
+
+  /*!
+   @brief    The default number of frame buffers available to the background writer (i.e., double
+              buffering).
+   */
+  static const size_t DEFAULT_QUEUE_DEPTH;
+
  protected:
   /*!
    @brief    The frame writer -- defines the format of the frame's data.
@@ -187,6 +229,25 @@ class SCBWriter {
    */
   void writeHeader();
 
+  /*!
+   @brief    Fills the buffer with the agent records of the current frame.
+
+   @param    buffer    The buffer to fill; it is resized to the frame's records.
+   @param    fsm       The behavior FSM (for state ids).
+   */
+  void fillBuffer(std::vector<char>& buffer, BFSM::FSM* fsm);
+
+  /*!
+   @brief    The number of agents declared in the file header.
+   */
+  size_t _headerAgentCount;
+
+  /*!
+   @brief    Reports if the user has been warned that the file can't represent a changing
+            population.
+   */
+  bool _populationWarned;
+
   /*!
    @brief    Writes the header appropriate to major version 1 formats.
    */
@@ -196,6 +257,78 @@ class SCBWriter {
    @brief    Writes the header appropriate to major version 2 formats.
    */
   void writeHeader2_0();
+
+  /*!
+   @brief    The body of the background I/O thread.
+   */
+  void ioLoop();
+
+  /*!
+   @brief    Acquires an unused frame buffer, blocking (and recording the stall) if none is free.
+
+   @returns  The index of the acquired buffer in _buffers.
+   */
+  size_t acquireBuffer();
+
+  /*!
+   @brief    The frame buffers. With the background writer disabled, there is exactly one.
+   */
+  std::vector<std::vector<char> > _buffers;
+
+  /*!
+   @brief    Indices of the buffers available for snapshotting.
+   */
+  std::deque<size_t> _freeBuffers;
+
+  /*!
+   @brief    Indices of the filled buffers waiting to be written (in frame order).
+   */
+  std::deque<size_t> _pendingBuffers;
+
+  /*!
+   @brief    Guards the buffer queues and the writer's status flags.
+   */
+  std::mutex _queueLock;
+
+  /*!
+   @brief    Signaled when a buffer is returned to the free list.
+   */
+  std::condition_variable _bufferFreed;
+
+  /*!
+   @brief    Signaled when a filled buffer is queued (or the writer is asked to stop).
+   */
+  std::condition_variable _frameQueued;
+
+  /*!
+   @brief    The background I/O thread (not joinable if the background writer is disabled).
+   */
+  std::thread _ioThread;
+
+  /*!
+   @brief    Indicates that the I/O thread should exit once the pending queue is drained.
+   */
+  bool _stopping;
+
+  /*!
+   @brief    Indicates that writing to the file has failed; subsequent frames are discarded.
+   */
+  bool _ioFailed;
+
+  /*!
+   @brief    Indicates that the I/O failure has been reported to the logger.
+   */
+  bool _ioFailureReported;
+
+  /*!
+   @brief    The number of times the simulation thread has waited on the I/O thread.
+   */
+  size_t _stallCount;
+
+  /*!
+   @brief    The total time (in seconds) the simulation thread has waited on the I/O thread.
+   */
+  double _stallTime;
 };
 
 /////////////////////////////////////////////////////////////////////
@@ -204,6 +337,10 @@ class SCBWriter {
 
 /*!
  @brief    This base class for writing a single frame of simulation data to the scb file.
+
+ A frame writer serializes each agent into a fixed-size record. The records of all agents are
+ written into a contiguous frame buffer (in parallel) which is then written to the file as a single
+ block.
  */
 class SCBFrameWriter {
  public:
@@ -218,13 +355,48 @@ class SCBFrameWriter {
   virtual ~SCBFrameWriter() {}
 
   /*!
-   @brief    Function to write current frame's state to the file.
+   @brief    Reports the number of bytes each agent contributes to a frame.
+   */
+  virtual size_t agentSize() const = 0;
+
+  /*!
+   @brief    Writes a single agent's record into the given buffer.
+
+   @param    buffer    The location of the agent's record; it must have agentSize() bytes.
+   @param    agent     The agent to write.
+   @param    sim       A pointer to the simulator.
+   @param    fsm       A pointer to the behavior fsm for the simulator.
+   */
+  virtual void writeAgent(char* buffer, const BaseAgent* agent, SimulatorInterface* sim,
+                          BFSM::FSM* fsm) const = 0;
+
+  /*!
+   @brief    Function to write current frame's state into the given buffer.
+
+   @param    buffer    The frame buffer; it must have `agentSize() * sim->getNumAgents()` bytes.
+   @param    sim       A pointer to the simulator.
+   @param    fsm       A pointer to the behavior fsm for the simulator.
+   */
+  void writeFrame(char* buffer, SimulatorInterface* sim, BFSM::FSM* fsm) const;
+
+  /*!
+   @brief    Writes a snapshotted frame to the file.
+
+   The default implementation writes the frame buffer verbatim. This is only ever called from one
+   thread at a time (the I/O thread, if there is one).
+
+   @param    file          The file object to write to.
+   @param    buffer        The frame buffer populated by writeFrame().
+   @param    agentCount    The number of agents in the frame.
+   */
+  virtual void writeBlock(std::ofstream& file, const char* buffer, size_t agentCount);
+
+  /*!
+   @brief    Writes any data the frame writer is still holding (e.g., a partially filled chunk).
 
    @param    file    The file object to write to.
-   @param    sim      A pointer to the simulator.
-   @param    fsm      A pointer to the behavior fsm for the simulator.
    */
-  virtual void writeFrame(std::ofstream& file, SimulatorInterface* sim, BFSM::FSM* fsm) = 0;
+  virtual void finish(std::ofstream& file) {}
 };
 
 /////////////////////////////////////////////////////////////////////
@@ -239,7 +411,9 @@ class SCBFrameWriter {
  */
 class SCBFrameWriter1_0 : public SCBFrameWriter {
  public:
-  virtual void writeFrame(std::ofstream& file, SimulatorInterface* sim, BFSM::FSM* fsm);
+  virtual size_t agentSize() const;
+  virtual void writeAgent(char* buffer, const BaseAgent* agent, SimulatorInterface* sim,
+                          BFSM::FSM* fsm) const;
 };
 
 /////////////////////////////////////////////////////////////////////
@@ -254,7 +428,9 @@ class SCBFrameWriter1_0 : public SCBFrameWriter {
  */
 class SCBFrameWriter2_0 : public SCBFrameWriter {
  public:
-  virtual void writeFrame(std::ofstream& file, SimulatorInterface* sim, BFSM::FSM* fsm);
+  virtual size_t agentSize() const;
+  virtual void writeAgent(char* buffer, const BaseAgent* agent, SimulatorInterface* sim,
+                          BFSM::FSM* fsm) const;
 };
 
 /////////////////////////////////////////////////////////////////////
@@ -270,7 +446,9 @@ class SCBFrameWriter2_0 : public SCBFrameWriter {
  */
 class SCBFrameWriter2_1 : public SCBFrameWriter {
  public:
-  virtual void writeFrame(std::ofstream& file, SimulatorInterface* sim, BFSM::FSM* fsm);
+  virtual size_t agentSize() const;
+  virtual void writeAgent(char* buffer, const BaseAgent* agent, SimulatorInterface* sim,
+                          BFSM::FSM* fsm) const;
 };
 
 /////////////////////////////////////////////////////////////////////
@@ -290,7 +468,9 @@ class SCBFrameWriter2_1 : public SCBFrameWriter {
  */
 class SCBFrameWriter2_2 : public SCBFrameWriter {
  public:
-  virtual void writeFrame(std::ofstream& file, SimulatorInterface* sim, BFSM::FSM* fsm);
+  virtual size_t agentSize() const;
+  virtual void writeAgent(char* buffer, const BaseAgent* agent, SimulatorInterface* sim,
+                          BFSM::FSM* fsm) const;
 };
 
 /////////////////////////////////////////////////////////////////////
@@ -308,7 +488,9 @@ class SCBFrameWriter2_2 : public SCBFrameWriter {
  */
 class SCBFrameWriter2_3 : public SCBFrameWriter {
  public:
-  virtual void writeFrame(std::ofstream& file, SimulatorInterface* sim, BFSM::FSM* fsm);
+  virtual size_t agentSize() const;
+  virtual void writeAgent(char* buffer, const BaseAgent* agent, SimulatorInterface* sim,
+                          BFSM::FSM* fsm) const;
 };
 
 /////////////////////////////////////////////////////////////////////
@@ -324,7 +506,34 @@ class SCBFrameWriter2_3 : public SCBFrameWriter {
  */
 class SCBFrameWriter2_4 : public SCBFrameWriter {
  public:
-  virtual void writeFrame(std::ofstream& file, SimulatorInterface* sim, BFSM::FSM* fsm);
+  virtual size_t agentSize() const;
+  virtual void writeAgent(char* buffer, const BaseAgent* agent, SimulatorInterface* sim,
+                          BFSM::FSM* fsm) const;
+};
+
+/////////////////////////////////////////////////////////////////////
+
+/*!
+ @brief    Writer for version 3.0
+
+ Frames are quantized, delta-encoded against the preceding frames and entropy coded in
+ self-contained chunks (see SCBChunkEncoder and @ref page_outSpec). The data for an agent consists
+ of its position, orientation (radians) and state id. The encoding work is performed by the I/O
+ thread.
+ */
+class SCBFrameWriter3_0 : public SCBFrameWriter {
+ public:
+  virtual size_t agentSize() const;
+  virtual void writeAgent(char* buffer, const BaseAgent* agent, SimulatorInterface* sim,
+                          BFSM::FSM* fsm) const;
+  virtual void writeBlock(std::ofstream& file, const char* buffer, size_t agentCount);
+  virtual void finish(std::ofstream& file);
+
+ protected:
+  /*!
+   @brief    The chunk encoder.
+   */
+  SCBChunkEncoder _encoder;
 };
 
 }  // namespace Agents
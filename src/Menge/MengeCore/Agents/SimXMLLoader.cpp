@@ -40,6 +40,7 @@ Any questions or comments should be sent to the authors {menge,geom}@cs.unc.edu
 
 #include "MengeCore/Agents/AgentGenerators/AgentGeneratorDatabase.h"
 #include "MengeCore/Agents/AgentInitializer.h"
+#include "MengeCore/Agents/AgentSource.h"
 #include "MengeCore/Agents/BaseAgent.h"
 #include "MengeCore/Agents/Elevations/ElevationDatabase.h"
 #include "MengeCore/Agents/ObstacleSets/ObstacleSetDatabase.h"
@@ -52,6 +53,7 @@ Any questions or comments should be sent to the authors {menge,geom}@cs.unc.edu
 #include "MengeCore/Runtime/os.h"
 
 #include <iostream>
+#include <limits>
 #include <list>
 #include <vector>
 
@@ -63,7 +65,8 @@ namespace Agents {
 //      Implementation of SimXMLLoader
 ////////////////////////////////////////////////////////////////////
 
-SimXMLLoader::SimXMLLoader(XMLSimulatorBase* sim) : _sceneFldr("."), _sim(sim), _agtCount(0) {}
+SimXMLLoader::SimXMLLoader(XMLSimulatorBase* sim)
+    : _sceneFldr("."), _sim(sim), _agtCount(0), _srcCount(0) {}
 
 ////////////////////////////////////////////////////////////////////
 
@@ -148,6 +151,14 @@ bool SimXMLLoader::loadFromXML(const std::string& filename, AgentInitializer* ag
           return false;
         }
       }
+    } else if (child->ValueStr() == "AgentSource") {
+      if (!(commonDone || targetDone || spatialQueryDone)) {
+        tagQueue.push_back(child);
+      } else {
+        if (!parseAgentSource(child)) {
+          return false;
+        }
+      }
     } else if (child->ValueStr() == "ObstacleSet") {
       if (!(commonDone || targetDone || spatialQueryDone)) {
         tagQueue.push_back(child);
@@ -235,6 +246,10 @@ bool SimXMLLoader::loadFromXML(const std::string& filename, AgentInitializer* ag
       if (!parseAgentGroup(child, agentInit)) {
         return false;
       }
+    } else if (child->ValueStr() == "AgentSource") {
+      if (!parseAgentSource(child)) {
+        return false;
+      }
     } else if (child->ValueStr() == "ObstacleSet") {
       if (!parseObstacleSet(child)) {
         return false;
@@ -246,19 +261,19 @@ bool SimXMLLoader::loadFromXML(const std::string& filename, AgentInitializer* ag
     }
   }
 
-  if (_agtCount == 0) {
-    // TODO: Change this test when agent sources are introduced
-    //  in this case, it is possible to start with no agents and then add them
-    //  w.r.t. time.
-    logger << Logger::ERR_MSG << "No agents defined in simulation.";
+  if (_agtCount == 0 && _srcCount == 0) {
+    logger << Logger::ERR_MSG << "No agents or agent sources defined in simulation.";
     return false;
   }
 
-  // free up the profiles
-  //  TODO: I'll need to save these when I have AgentSources.
+  // free up the profiles -- agent sources continue to use them while the simulation runs.
   for (HASH_MAP<std::string, AgentInitializer*>::iterator itr = _profiles.begin();
        itr != _profiles.end(); ++itr) {
-    delete itr->second;
+    if (_srcCount > 0) {
+      _sim->addSourceProfile(itr->second);
+    } else {
+      delete itr->second;
+    }
   }
   _profiles.clear();
 
@@ -267,27 +282,17 @@ bool SimXMLLoader::loadFromXML(const std::string& filename, AgentInitializer* ag
 
 ////////////////////////////////////////////////////////////////////
 
-bool SimXMLLoader::parseAgentGroup(TiXmlElement* node, AgentInitializer* agentInit) {
-  // 2-pass approach
-  // Pass 1 get the profile selector
-  // Pass 2 initialize AgentGenerator (Generator for short)
-
-  // Get the profile selector -
+bool SimXMLLoader::parseSelectors(TiXmlElement* node, ProfileSelector*& profileSel,
+                                  StateSelector*& stateSel) {
   TiXmlElement* child;
-  ProfileSelector* profileSel = 0x0;
-  StateSelector* stateSel = 0x0;
-  // First pass, skip Agents
   for (child = node->FirstChildElement(); child; child = child->NextSiblingElement()) {
     if (child->ValueStr() == "ProfileSelector") {
       if (profileSel != 0x0) {
         // There should be only one.  If there are multiple, only the first will
         // have an effect.
-        logger << Logger::WARN_MSG
-               << "Found multiple ProfileSelector tags in the "
-                  "AgentGroup on line "
-               << node->Row()
-               << ".  "
-                  "Only the first will be used.";
+        logger << Logger::WARN_MSG << "Found multiple ProfileSelector tags in the "
+               << node->ValueStr() << " on line " << node->Row()
+               << ".  Only the first will be used.";
         continue;
       }
       profileSel = ProfileSelectorDB::getInstance(child, _sceneFldr);
@@ -307,8 +312,9 @@ bool SimXMLLoader::parseAgentGroup(TiXmlElement* node, AgentInitializer* agentIn
       if (stateSel != 0x0) {
         // There should be only one.  If there are multiple, only the first will
         //  have an effect.
-        logger << Logger::WARN_MSG << "Found multiple StateSelector tags in the AgentGroup on line "
-               << node->Row() << ".  Only the first will be used.";
+        logger << Logger::WARN_MSG << "Found multiple StateSelector tags in the "
+               << node->ValueStr() << " on line " << node->Row()
+               << ".  Only the first will be used.";
         continue;
       }
       stateSel = StateSelectorDB::getInstance(child, _sceneFldr);
@@ -322,16 +328,33 @@ bool SimXMLLoader::parseAgentGroup(TiXmlElement* node, AgentInitializer* agentIn
   }
   if (profileSel == 0x0) {
     logger << Logger::ERR_MSG
-           << "No profile selector defined for the AgentGroup on line " << node->Row() << ".";
+           << "No profile selector defined for the " << node->ValueStr() << " on line "
+           << node->Row() << ".";
     return false;
   }
   if (stateSel == 0x0) {
     logger << Logger::ERR_MSG
-           << "No state selector defined for the AgentGroup on line " << node->Row() << ".";
+           << "No state selector defined for the " << node->ValueStr() << " on line "
+           << node->Row() << ".";
     return false;
   }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+
+bool SimXMLLoader::parseAgentGroup(TiXmlElement* node, AgentInitializer* agentInit) {
+  // 2-pass approach
+  // Pass 1 get the profile selector
+  // Pass 2 initialize AgentGenerator (Generator for short)
+
+  // First pass, get the selectors
+  ProfileSelector* profileSel = 0x0;
+  StateSelector* stateSel = 0x0;
+  if (!parseSelectors(node, profileSel, stateSel)) return false;
 
   // Second pass, parse Generators
+  TiXmlElement* child;
   for (child = node->FirstChildElement(); child; child = child->NextSiblingElement()) {
     if (child->ValueStr() == "Generator") {
       AgentGenerator* generator = AgentGeneratorDB::getInstance(child, _sceneFldr);
@@ -361,6 +384,55 @@ bool SimXMLLoader::parseAgentGroup(TiXmlElement* node, AgentInitializer* agentIn
 
 ////////////////////////////////////////////////////////////////////
 
+bool SimXMLLoader::parseAgentSource(TiXmlElement* node) {
+  double rate = 0.0;
+  if (node->QueryDoubleAttribute("rate", &rate) != TIXML_SUCCESS || rate <= 0.0) {
+    logger << Logger::ERR_MSG << "The AgentSource on line " << node->Row();
+    logger << " requires a positive \"rate\" attribute.";
+    return false;
+  }
+  double startTime = 0.0;
+  node->QueryDoubleAttribute("start_time", &startTime);
+  double endTime = std::numeric_limits<double>::infinity();
+  node->QueryDoubleAttribute("end_time", &endTime);
+  int maxAgents = 0;
+  node->QueryIntAttribute("max_agents", &maxAgents);
+  if (endTime < startTime || maxAgents < 0) {
+    logger << Logger::ERR_MSG << "The AgentSource on line " << node->Row();
+    logger << " has an invalid \"end_time\" or \"max_agents\" attribute.";
+    return false;
+  }
+
+  ProfileSelector* profileSel = 0x0;
+  StateSelector* stateSel = 0x0;
+  if (!parseSelectors(node, profileSel, stateSel)) return false;
+
+  AgentGenerator* generator = 0x0;
+  TiXmlElement* child = node->FirstChildElement("Generator");
+  if (child != 0x0) generator = AgentGeneratorDB::getInstance(child, _sceneFldr);
+  if (generator == 0x0 || generator->agentCount() == 0) {
+    logger << Logger::ERR_MSG << "The AgentSource on line " << node->Row();
+    logger << " requires a Generator which defines at least one position.";
+    if (generator) generator->destroy();
+    profileSel->destroy();
+    stateSel->destroy();
+    return false;
+  }
+  if (child->NextSiblingElement("Generator") != 0x0) {
+    logger << Logger::WARN_MSG << "Found multiple Generator tags in the AgentSource on line "
+           << node->Row() << ".  Only the first will be used.";
+  }
+
+  _sim->addAgentSource(new AgentSource(profileSel, stateSel, generator, static_cast<float>(rate),
+                                       static_cast<float>(startTime),
+                                       static_cast<float>(endTime),
+                                       static_cast<size_t>(maxAgents)));
+  ++_srcCount;
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////
+
 bool SimXMLLoader::parseObstacleSet(TiXmlElement* node) {
   // pass through, try to get a generator, and then use it
   ObstacleSet* obSet = ObstacleSetDB::getInstance(node, _sceneFldr);
@@ -37,6 +37,8 @@ namespace Agents {
 // Forward declartion
 class XMLSimulatorBase;
 class AgentInitializer;
+class ProfileSelector;
+class StateSelector;
 
 /*!
  @brief    Class for parsing the SCENE XML specification and initialize a simulator.
@@ -84,6 +86,24 @@ class MENGE_API SimXMLLoader {
    */
   bool parseAgentGroup(TiXmlElement* node, AgentInitializer* agentInit);
 
+  /*!
+   @brief    Parses the definition of an AgentSource.
+
+   @param    node        A pointer to the XML node containing the definition.
+   @returns  A boolean reporting success (true) or failure (false).
+   */
+  bool parseAgentSource(TiXmlElement* node);
+
+  /*!
+   @brief    Parses the profile and state selectors of an AgentGroup or AgentSource.
+
+   @param    node          A pointer to the XML node containing the selectors.
+   @param    profileSel    Set to the parsed profile selector.
+   @param    stateSel      Set to the parsed state selector.
+   @returns  True if both selectors were successfully parsed.
+   */
+  bool parseSelectors(TiXmlElement* node, ProfileSelector*& profileSel, StateSelector*& stateSel);
+
   /*!
    @brief    Parses the definition of an obstacleset.
 
@@ -106,6 +126,11 @@ class MENGE_API SimXMLLoader {
    */
   unsigned int _agtCount;
 
+  /*!
+   @brief    The number of agent sources loaded.
+   */
+  unsigned int _srcCount;
+
   /*!
    @brief    Mapping from agent profile name to agent initializer.
    */
@@ -26,8 +26,11 @@
  */
 
 #include "MengeCore/Agents/AgentInitializer.h"
+#include "MengeCore/Agents/BaseAgent.h"
 #include "MengeCore/Agents/SimulatorInterface.h"
 #include "MengeCore/Agents/SpatialQueries/SpatialQuery.h"
+#include "MengeCore/Agents/SpatialQueries/SpatialQueryStructs.h"
+#include "MengeCore/Runtime/StepProfiler.h"
 #include "MengeCore/Runtime/Utils.h"
 #include "MengeCore/mengeCommon.h"
 
@@ -44,6 +47,15 @@ namespace Agents {
 /*!
  @brief      Defines the basic simulator. It is responsible for tracking agents and obstacles as
              well as initializing such from files.
+
+ The agents are stored in a pool of fixed-size blocks so that an agent's address never changes
+ while it is in the simulation. Removed agents leave their slot (and identifier) on a free list to
+ be reused by the next agent added. The active agents are tracked in a dense list which is what
+ the simulator iterates over; removing an agent moves the last active agent into its place.
+
+ Each step only advances the agents which are awake (see BaseAgent::isAsleep()). Sleeping agents
+ remain in the spatial query and are woken when their preferred speed rises or a moving agent
+ approaches them.
  */
 template <class Agent>
 class SimulatorBase : public SimulatorInterface {
@@ -88,7 +100,7 @@ class SimulatorBase : public SimulatorInterface {
                             in the simulator's local store.
    @returns    A pointer to the agent.
    */
-  virtual BaseAgent* getAgent(size_t agentNo) { return &_agents[agentNo]; }
+  virtual BaseAgent* getAgent(size_t agentNo) { return _active[agentNo]; }
 
   /*!
    @brief      Const accessor for agents.
@@ -98,7 +110,31 @@ class SimulatorBase : public SimulatorInterface {
                           simulator's local store.
    @returns    A pointer to the agent.
    */
-  virtual const BaseAgent* getAgent(size_t agentNo) const { return &_agents[agentNo]; }
+  virtual const BaseAgent* getAgent(size_t agentNo) const { return _active[agentNo]; }
+
+  /*!
+   @brief      Accessor for agents by identifier.
+
+   @param      id      The identifier of the agent (BaseAgent::_id).
+   @returns    A pointer to the agent, or NULL if no active agent has the identifier.
+   */
+  virtual BaseAgent* getAgentById(size_t id);
+
+  /*!
+   @brief      Creates a handle for the given (active) agent.
+
+   @param      agent    The agent.
+   @returns    The handle.
+   */
+  virtual AgentHandle getAgentHandle(const BaseAgent* agent) const;
+
+  /*!
+   @brief      Resolves a handle.
+
+   @param      handle    The handle (see getAgentHandle()).
+   @returns    A pointer to the agent, or NULL if the agent has been retired.
+   */
+  virtual BaseAgent* getAgentByHandle(const AgentHandle& handle);
 
   /*!
    @brief    Add an agent with specified position to the simulator whose properties are defined by
@@ -117,7 +153,7 @@ class SimulatorBase : public SimulatorInterface {
 
    @returns    The count of agents in the simulation.
    */
-  virtual size_t getNumAgents() const { return _agents.size(); }
+  virtual size_t getNumAgents() const { return _active.size(); }
 
   /*!
    @brief      Reports if there are non-common Experiment parameters that this simulator requires in
@@ -157,9 +193,83 @@ class SimulatorBase : public SimulatorInterface {
   void computeNeighbors(Agent* agent);
 
   /*!
-   @brief    The collection of agents in the simulation
+   @brief       Removes the agent from the pool; its identifier becomes available to the next agent
+                that is added.
+
+   @param       agent    The agent to remove.
+   */
+  virtual void removeAgent(BaseAgent* agent);
+
+  /*!
+   @brief       Gives the spatial query the current set of active agents.
+   */
+  void updateSpatialAgents();
+
+  /*!
+   @brief       Wakes the sleeping agents whose preferred speed has risen above their sleep
+                speed and collects the agents which are awake into _awake.
+   */
+  void collectAwakeAgents();
+
+  /*!
+   @brief       Wakes the sleeping agents which moving (awake) agents are approaching; the newly
+                woken agents are placed in _woken.
+
+   This must be called after the awake agents' new velocities have been computed.
+
+   @returns     True if any agent was woken.
+   */
+  bool wakeApproachedAgents();
+
+  /*!
+   @brief       Returns the pool slot for the agent with the given identifier.
    */
-  std::vector<Agent> _agents;
+  Agent& slot(size_t id) { return _blocks[id / BLOCK_SIZE][id % BLOCK_SIZE]; }
+
+  /*!
+   @brief       The number of agents in each block of the pool.
+   */
+  static const size_t BLOCK_SIZE = 1024;
+
+  /*!
+   @brief       The value of _activeIndex for identifiers which are not in use.
+   */
+  static const size_t INACTIVE = static_cast<size_t>(-1);
+
+  /*!
+   @brief       The blocks of agent storage; the agent with identifier i lives in slot(i).
+   */
+  std::vector<Agent*> _blocks;
+
+  /*!
+   @brief       The active agents, in local index order.
+   */
+  std::vector<Agent*> _active;
+
+  /*!
+   @brief       The active agents which are awake this step; only these agents are advanced.
+   */
+  std::vector<Agent*> _awake;
+
+  /*!
+   @brief       The agents woken during this step by approaching agents.
+   */
+  std::vector<Agent*> _woken;
+
+  /*!
+   @brief       For each identifier, the local index of its agent in _active (or INACTIVE).
+   */
+  std::vector<size_t> _activeIndex;
+
+  /*!
+   @brief       For each identifier, the number of times the identifier has been released.
+   */
+  std::vector<size_t> _generations;
+
+  /*!
+   @brief       The identifiers available for reuse.
+   */
+  std::vector<size_t> _freeIds;
 };
 
 ////////////////////////////////////////////////////////////////
@@ -167,13 +277,19 @@ class SimulatorBase : public SimulatorInterface {
 ////////////////////////////////////////////////////////////////
 
 template <class Agent>
-SimulatorBase<Agent>::SimulatorBase() : SimulatorInterface(), _agents() {}
+const size_t SimulatorBase<Agent>::BLOCK_SIZE;
+
+template <class Agent>
+const size_t SimulatorBase<Agent>::INACTIVE;
+
+template <class Agent>
+SimulatorBase<Agent>::SimulatorBase() : SimulatorInterface() {}
 
 ////////////////////////////////////////////////////////////////
 
 template <class Agent>
 SimulatorBase<Agent>::~SimulatorBase() {
-  _agents.clear();
+  for (size_t i = 0; i < _blocks.size(); ++i) delete[] _blocks[i];
 }
 
 ////////////////////////////////////////////////////////////////
@@ -182,17 +298,50 @@ template <class Agent>
 void SimulatorBase<Agent>::doStep() {
   assert(_spatialQuery != 0x0 && "Can't run without a spatial query instance defined");
 
-  _spatialQuery->updateAgents();
-  int AGT_COUNT = static_cast<int>(_agents.size());
+  {
+    ProfileScope timer(StepProfiler::SPATIAL_REBUILD);
+    if (_populationChanged) updateSpatialAgents();
+    _spatialQuery->updateAgents();
+  }
+  collectAwakeAgents();
+  int AGT_COUNT = static_cast<int>(_awake.size());
+  {
+    ProfileRegion region(StepProfiler::NEIGHBOR_QUERY, StepProfiler::NEW_VELOCITY);
+#pragma omp parallel for
+    for (int i = 0; i < AGT_COUNT; ++i) {
+      ProfileLap lap;
+      computeNeighbors(_awake[i]);
+      lap.lap(StepProfiler::NEIGHBOR_QUERY);
+      _awake[i]->computeNewVelocity();
+      _awake[i]->updateIdleTime(TIME_STEP);
+      lap.lap(StepProfiler::NEW_VELOCITY);
+    }
+  }
+
+  if (_awake.size() < _active.size() && wakeApproachedAgents()) {
+    ProfileRegion region(StepProfiler::NEIGHBOR_QUERY, StepProfiler::NEW_VELOCITY);
+    const int WOKEN_COUNT = static_cast<int>(_woken.size());
 #pragma omp parallel for
-  for (int i = 0; i < AGT_COUNT; ++i) {
-    computeNeighbors(&(_agents[i]));
-    _agents[i].computeNewVelocity();
+    for (int i = 0; i < WOKEN_COUNT; ++i) {
+      ProfileLap lap;
+      computeNeighbors(_woken[i]);
+      lap.lap(StepProfiler::NEIGHBOR_QUERY);
+      _woken[i]->computeNewVelocity();
+      lap.lap(StepProfiler::NEW_VELOCITY);
+    }
+    _awake.insert(_awake.end(), _woken.begin(), _woken.end());
+    AGT_COUNT = static_cast<int>(_awake.size());
   }
 
+  {
+    ProfileRegion region(StepProfiler::UPDATE);
 #pragma omp parallel for
-  for (int i = 0; i < AGT_COUNT; ++i) {
-    _agents[i].update(TIME_STEP);
+    for (int i = 0; i < AGT_COUNT; ++i) {
+      ProfileLap lap;
+      _awake[i]->update(TIME_STEP);
+      if (_awake[i]->isDrowsy()) _awake[i]->sleep();
+      lap.lap(StepProfiler::UPDATE);
+    }
   }
 
   _globalTime += TIME_STEP;
@@ -204,13 +353,7 @@ template <class Agent>
 bool SimulatorBase<Agent>::initSpatialQuery() {
   assert(_spatialQuery != 0x0 && "Can't run without a spatial query instance defined");
 
-  const size_t AGT_COUNT = _agents.size();
-  std::vector<BaseAgent*> agtPointers(AGT_COUNT);
-  for (size_t a = 0; a < AGT_COUNT; ++a) {
-    agtPointers[a] = &_agents[a];
-  }
-  _spatialQuery->setAgents(agtPointers);
-
+  updateSpatialAgents();
   _spatialQuery->processObstacles();
 
   return true;
@@ -223,8 +366,8 @@ void SimulatorBase<Agent>::finalize() {
   SimulatorInterface::finalize();
 
   // initialize agents
-  for (size_t i = 0; i < _agents.size(); ++i) {
-    _agents[i].initialize();
+  for (size_t i = 0; i < _active.size(); ++i) {
+    _active[i]->initialize();
   }
 }
 
@@ -235,14 +378,115 @@ BaseAgent* SimulatorBase<Agent>::addAgent(const Vector2& pos, AgentInitializer*
   Agent agent;
 
   agent._pos = pos;
-  agent._id = _agents.size();
+  agent._id = _freeIds.empty() ? _activeIndex.size() : _freeIds.back();
   if (!agentInit->setProperties(&agent)) {
     logger << Logger::ERR_MSG << "Error initializing agent " << agent._id << "\n";
     return 0x0;
   }
-  _agents.push_back(agent);
+  const size_t ID = agent._id;
+  if (_freeIds.empty()) {
+    if (ID % BLOCK_SIZE == 0) _blocks.push_back(new Agent[BLOCK_SIZE]);
+    _activeIndex.push_back(INACTIVE);
+    _generations.push_back(0);
+  } else {
+    _freeIds.pop_back();
+  }
+  Agent* stored = &slot(ID);
+  *stored = agent;
+  _activeIndex[ID] = _active.size();
+  _active.push_back(stored);
+  _populationChanged = true;
+
+  return stored;
+}
+
+////////////////////////////////////////////////////////////////
+
+template <class Agent>
+void SimulatorBase<Agent>::removeAgent(BaseAgent* agent) {
+  const size_t ID = agent->_id;
+  const size_t index = _activeIndex[ID];
+  assert(index != INACTIVE && _active[index] == agent && "Removing an inactive agent");
+  Agent* last = _active.back();
+  _active[index] = last;
+  _activeIndex[last->_id] = index;
+  _active.pop_back();
+  _activeIndex[ID] = INACTIVE;
+  ++_generations[ID];
+  _freeIds.push_back(ID);
+  _populationChanged = true;
+}
+
+////////////////////////////////////////////////////////////////
+
+template <class Agent>
+BaseAgent* SimulatorBase<Agent>::getAgentById(size_t id) {
+  if (id >= _activeIndex.size() || _activeIndex[id] == INACTIVE) return 0x0;
+  return &slot(id);
+}
+
+////////////////////////////////////////////////////////////////
+
+template <class Agent>
+AgentHandle SimulatorBase<Agent>::getAgentHandle(const BaseAgent* agent) const {
+  AgentHandle handle = {agent->_id, _generations[agent->_id]};
+  return handle;
+}
+
+////////////////////////////////////////////////////////////////
+
+template <class Agent>
+BaseAgent* SimulatorBase<Agent>::getAgentByHandle(const AgentHandle& handle) {
+  if (handle.id >= _generations.size() || _generations[handle.id] != handle.generation) {
+    return 0x0;
+  }
+  return getAgentById(handle.id);
+}
+
+////////////////////////////////////////////////////////////////
+
+template <class Agent>
+void SimulatorBase<Agent>::collectAwakeAgents() {
+  _awake.clear();
+  for (size_t i = 0; i < _active.size(); ++i) {
+    Agent* agent = _active[i];
+    if (agent->isAsleep() && agent->_velPref.getSpeed() > agent->_sleepSpeed) agent->wake();
+    if (!agent->isAsleep()) _awake.push_back(agent);
+  }
+}
+
+////////////////////////////////////////////////////////////////
+
+template <class Agent>
+bool SimulatorBase<Agent>::wakeApproachedAgents() {
+  _woken.clear();
+  for (size_t i = 0; i < _awake.size(); ++i) {
+    const Agent* mover = _awake[i];
+    for (size_t j = 0; j < mover->_nearAgents.size(); ++j) {
+      // Every neighbor is one of this simulator's agents.
+      const NearAgent& neighbor = mover->_nearAgents[j];
+      const Agent* near = static_cast<const Agent*>(neighbor.agent);
+      if (!near->isAsleep()) continue;
+      // The neighbors are const; the sleeping agent is one of ours.
+      Agent* sleeper = &slot(near->_id);
+      if (neighbor.distanceSquared <= sleeper->_neighborDist * sleeper->_neighborDist &&
+          absSq(mover->_velNew) > sleeper->_sleepSpeed * sleeper->_sleepSpeed &&
+          (sleeper->_pos - mover->_pos) * mover->_velNew > 0.f) {
+        sleeper->wake();
+        _woken.push_back(sleeper);
+      }
+    }
+  }
+  return !_woken.empty();
+}
 
-  return &_agents[_agents.size() - 1];
+////////////////////////////////////////////////////////////////
+
+template <class Agent>
+void SimulatorBase<Agent>::updateSpatialAgents() {
+  std::vector<BaseAgent*> agtPointers(_active.begin(), _active.end());
+  _spatialQuery->setAgents(agtPointers);
+  _populationChanged = false;
 }
 
 ////////////////////////////////////////////////////////////////
@@ -38,12 +38,19 @@ Any questions or comments should be sent to the authors {menge,geom}@cs.unc.edu
 
 #include "MengeCore/Agents/SimulatorInterface.h"
 
+#include "MengeCore/Agents/AgentInitializer.h"
+#include "MengeCore/Agents/AgentSource.h"
+#include "MengeCore/Agents/BaseAgent.h"
 #include "MengeCore/Agents/Elevations/ElevationFlat.h"
+#include "MengeCore/Agents/FrameRing.h"
 #include "MengeCore/Agents/Obstacle.h"
 #include "MengeCore/Agents/SCBWriter.h"
 #include "MengeCore/Agents/SpatialQueries/SpatialQuery.h"
 #include "MengeCore/BFSM/FSM.h"
+#include "MengeCore/BFSM/State.h"
 #include "MengeCore/Core.h"
+#include "MengeCore/Runtime/StepProfiler.h"
+#include "MengeCore/Runtime/TraceRecorder.h"
 
 namespace Menge {
 
@@ -68,15 +75,21 @@ SimulatorInterface::SimulatorInterface()
       _spatialQuery(0x0),
       _fsm(0x0),
       _scbWriter(0x0),
+      _frameRing(0x0),
       _isRunning(true),
-      _maxDuration(100.f) {}
+      _maxDuration(100.f),
+      _populationChanged(false) {}
 
 ////////////////////////////////////////////////////////////////////////////
 
 SimulatorInterface::~SimulatorInterface() {
+  if (_scbWriter) delete _scbWriter;
+  if (_frameRing) delete _frameRing;
   if (_fsm) delete _fsm;
   if (_spatialQuery != 0x0) _spatialQuery->destroy();
   if (_elevation) _elevation->destroy();
+  for (size_t i = 0; i < _sources.size(); ++i) delete _sources[i];
+  for (size_t i = 0; i < _sourceProfiles.size(); ++i) delete _sourceProfiles[i];
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -88,16 +101,24 @@ void SimulatorInterface::setBFSM(BFSM::FSM* fsm) { _fsm = fsm; }
 bool SimulatorInterface::step() {
   const int agtCount = static_cast<int>(getNumAgents());
   if (_isRunning) {
-    if (_scbWriter) _scbWriter->writeFrame(_fsm);
+    TRACER.beginStep();
+    PROFILER.beginStep();
+    {
+      ProfileScope timer(StepProfiler::OUTPUT);
+      if (_scbWriter) _scbWriter->writeFrame(_fsm);
+      if (_frameRing) _frameRing->publish(this, _fsm);
+    }
     if (_globalTime >= _maxDuration) {
       _isRunning = false;
     } else {
       for (size_t i = 0; i <= SUB_STEPS; ++i) {
         try {
           // TODO: doStep for FSM is a *bad* name; it should be "evaluate".
-          _isRunning = !_fsm->doStep();
+          _isRunning = !_fsm->doStep() || hasActiveSources();
           doStep();
+          ProfileScope timer(StepProfiler::TASKS);
           _fsm->doTasks();
+          updatePopulation();
         } catch (BFSM::FSMFatalException& e) {
           logger << Logger::ERR_MSG << "Error in updating the finite state ";
           logger << "machine -- stopping!\n";
@@ -106,12 +127,99 @@ bool SimulatorInterface::step() {
         }
       }
     }
+    // Frames may still be queued for the background writer; make sure the trajectory file is
+    // complete as soon as the simulation ends.
+    if (!_isRunning && _scbWriter) _scbWriter->flush();
+    PROFILER.endStep();
+    TRACER.endStep();
   }
   return _isRunning;
 }
 
 ////////////////////////////////////////////////////////////////////////////
 
+BaseAgent* SimulatorInterface::spawnAgent(const Vector2& pos, AgentInitializer* agentInit,
+                                          const std::string& stateName) {
+  BaseAgent* agent = addAgent(pos, agentInit);
+  if (agent == 0x0) return 0x0;
+  return activateAgent(agent, stateName) ? agent : 0x0;
+}
+
+////////////////////////////////////////////////////////////////////////////
+
+void SimulatorInterface::retireAgent(BaseAgent* agent) {
+  _retireLock.lock();
+  _retirements.push_back(agent);
+  _retireLock.release();
+}
+
+////////////////////////////////////////////////////////////////////////////
+
+void SimulatorInterface::addAgentSource(AgentSource* source) { _sources.push_back(source); }
+
+////////////////////////////////////////////////////////////////////////////
+
+void SimulatorInterface::addSourceProfile(AgentInitializer* profile) {
+  _sourceProfiles.push_back(profile);
+}
+
+////////////////////////////////////////////////////////////////////////////
+
+bool SimulatorInterface::hasActiveSources() const {
+  for (size_t i = 0; i < _sources.size(); ++i) {
+    if (_sources[i]->isActive(_globalTime)) return true;
+  }
+  return false;
+}
+
+////////////////////////////////////////////////////////////////////////////
+
+bool SimulatorInterface::activateAgent(BaseAgent* agent, const std::string& stateName) {
+  BFSM::State* state = _fsm->getNode(stateName);
+  if (state == 0x0) {
+    logger << Logger::ERR_MSG << "Agent " << agent->_id << " can't start in the state \"";
+    logger << stateName << "\"; the state doesn't exist.";
+    removeAgent(agent);
+    return false;
+  }
+  try {
+    _fsm->addAgent(agent, state);
+    agent->initialize();
+  } catch (MengeException& e) {
+    logger << Logger::ERR_MSG << "Unable to add agent " << agent->_id << " to the state \"";
+    logger << stateName << "\": " << e.what();
+    discardAgent(agent);
+    return false;
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////////
+
+void SimulatorInterface::discardAgent(BaseAgent* agent) {
+  _fsm->removeAgent(agent);
+  removeAgent(agent);
+}
+
+////////////////////////////////////////////////////////////////////////////
+
+void SimulatorInterface::updatePopulation() {
+  std::vector<BaseAgent*> retirements;
+  _retireLock.lock();
+  retirements.swap(_retirements);
+  _retireLock.release();
+  for (size_t i = 0; i < retirements.size(); ++i) {
+    BaseAgent* agent = retirements[i];
+    // An agent may have been retired more than once.
+    if (getAgentById(agent->_id) == agent) discardAgent(agent);
+  }
+  for (size_t i = 0; i < _sources.size(); ++i) {
+    _sources[i]->update(this, _globalTime);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+
 float SimulatorInterface::getElevation(const BaseAgent* agent) const {
   return _elevation->getElevation(agent);
 }
@@ -162,6 +270,21 @@ bool SimulatorInterface::setOutput(const std::string& outFileName, const std::st
   }
 }
 
+////////////////////////////////////////////////////////////////
+
+bool SimulatorInterface::setSharedOutput(const std::string& name, size_t slotCount,
+                                         size_t maxAgents) {
+  if (maxAgents == 0) maxAgents = getNumAgents();
+  FrameRingWriter* ring = new FrameRingWriter();
+  if (!ring->open(name, maxAgents, slotCount)) {
+    delete ring;
+    return false;
+  }
+  if (_frameRing) delete _frameRing;
+  _frameRing = ring;
+  return true;
+}
+
 ////////////////////////////////////////////////////////////////////////////
 
 }  // namespace Agents
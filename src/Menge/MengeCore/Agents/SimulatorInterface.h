@@ -27,6 +27,7 @@
 #include "MengeCore/Core.h"
 #include "MengeCore/CoreConfig.h"
 #include "MengeCore/Math/Vector2.h"
+#include "MengeCore/Runtime/SimpleLock.h"
 
 #include <vector>
 
@@ -39,14 +40,45 @@ class FSM;
 
 namespace Agents {
 // forward declaration
+class AgentInitializer;
+class AgentSource;
 class BaseAgent;
 class Elevation;
+class FrameRingWriter;
 class Obstacle;
 class SCBWriter;
 class SpatialQuery;
 
+/*!
+ @brief    A reference to an agent which can detect that the agent has been retired.
+
+ Agent identifiers are recycled; after an agent is retired, its identifier can be given to an agent
+ spawned later. The handle also records the generation of the identifier so that a stale handle
+ doesn't resolve to the new agent.
+ */
+struct AgentHandle {
+  /*!
+   @brief    The agent's identifier.
+   */
+  size_t id;
+
+  /*!
+   @brief    The number of agents which held the identifier before this one.
+   */
+  size_t generation;
+};
+
 /*!
  @brief    The basic simulator interface required by the fsm.
+
+ The population can change while the simulation runs. Agents are spawned by AgentSource instances
+ (or spawnAgent()) and retired with retireAgent(). The agents are indexed in two ways:
+
+   - The local index: getAgent() and getNumAgents() enumerate the *active* agents. A retired agent
+     is not enumerated and costs nothing per time step. The local index of an agent can change
+     whenever an agent is retired.
+   - The identifier (BaseAgent::_id): constant for the agent's lifetime, but reused after the agent
+     is retired. Use getAgentById() or an AgentHandle to refer to a particular agent.
  */
 class MENGE_API SimulatorInterface : public XMLSimulatorBase {
  public:
@@ -109,6 +141,75 @@ class MENGE_API SimulatorInterface : public XMLSimulatorBase {
    */
   virtual const BaseAgent* getAgent(size_t agentNo) const = 0;
 
+  /*!
+   @brief      Accessor for agents by identifier.
+
+   @param      id      The identifier of the agent (BaseAgent::_id).
+   @returns    A pointer to the agent, or NULL if no active agent has the identifier.
+   */
+  virtual BaseAgent* getAgentById(size_t id) = 0;
+
+  /*!
+   @brief      Creates a handle for the given (active) agent.
+
+   @param      agent    The agent.
+   @returns    The handle.
+   */
+  virtual AgentHandle getAgentHandle(const BaseAgent* agent) const = 0;
+
+  /*!
+   @brief      Resolves a handle.
+
+   @param      handle    The handle (see getAgentHandle()).
+   @returns    A pointer to the agent, or NULL if the agent has been retired.
+   */
+  virtual BaseAgent* getAgentByHandle(const AgentHandle& handle) = 0;
+
+  /*!
+   @brief      Adds an agent to the running simulation.
+
+   The agent enters the given state and its preferred velocity is computed immediately. This must
+   not be called while the simulator is stepping (e.g., from a BFSM element); use an AgentSource for
+   agents that should appear as the simulation runs.
+
+   @param      pos          The position of the agent.
+   @param      agentInit    The initializer which defines the agent's properties. The simulator
+                            does *not* take ownership.
+   @param      stateName    The name of the BFSM state the agent starts in.
+   @returns    A pointer to the agent, or NULL if the agent couldn't be added.
+   */
+  BaseAgent* spawnAgent(const Math::Vector2& pos, AgentInitializer* agentInit,
+                        const std::string& stateName);
+
+  /*!
+   @brief      Removes the agent from the simulation at the end of the current time step.
+
+   The agent leaves its BFSM state and its identifier is recycled. This can be called at any time,
+   from any thread (e.g., by the "retire" BFSM action).
+
+   @param      agent    The agent to retire.
+   */
+  void retireAgent(BaseAgent* agent);
+
+  /*!
+   @brief      Adds a source of agents to the simulation; the simulator takes ownership.
+
+   @param      source    The agent source.
+   */
+  virtual void addAgentSource(AgentSource* source);
+
+  /*!
+   @brief      Gives the simulator ownership of an agent profile used by its agent sources.
+
+   @param      profile    The agent profile.
+   */
+  virtual void addSourceProfile(AgentInitializer* profile);
+
+  /*!
+   @brief      Reports if any agent source will spawn more agents.
+   */
+  bool hasActiveSources() const;
+
   /*!
    @brief    After all agents and all obstacles have been added to the scene does the work to finish
             preparing the simulation to be run.
@@ -192,6 +293,11 @@ class MENGE_API SimulatorInterface : public XMLSimulatorBase {
    */
   inline float getGlobalTime() const { return _globalTime; }
 
+  /*!
+   @brief      Reports if the simulation is still running (i.e., step() can still advance it).
+   */
+  inline bool isRunning() const { return _isRunning; }
+
   /*!
    @brief      Sets the time step of the simulation.
 
@@ -247,6 +353,19 @@ class MENGE_API SimulatorInterface : public XMLSimulatorBase {
    */
   bool setOutput(const std::string& outFileName, const std::string& scbVersion);
 
+  /*!
+   @brief    Publishes every frame to a shared-memory ring buffer for other processes to read.
+
+   See FrameRingWriter for the protocol and FrameRingReader for reading the frames.
+
+   @param    name         The name of the shared region.
+   @param    slotCount    The number of frames the ring holds.
+   @param    maxAgents    The maximum number of agents per frame; if zero, the current number of
+                          agents is used.
+   @returns  True if the shared region has been created.
+   */
+  bool setSharedOutput(const std::string& name, size_t slotCount, size_t maxAgents = 0);
+
  protected:
   /*!
    @brief       Lets the simulator perform a simulation step and updates the two-dimensional _p and
@@ -254,6 +373,40 @@ class MENGE_API SimulatorInterface : public XMLSimulatorBase {
    */
   virtual void doStep() = 0;
 
+  /*!
+   @brief       Removes the agent from the simulator's store; its identifier becomes available to
+                the next agent that is added.
+
+   The agent must already have been removed from the BFSM.
+
+   @param       agent    The agent to remove.
+   */
+  virtual void removeAgent(BaseAgent* agent) = 0;
+
+  /*!
+   @brief       Places a new agent (already added to the store) in the BFSM.
+
+   @param       agent        The agent.
+   @param       stateName    The name of the agent's initial state.
+   @returns     True if the agent was successfully placed in its state. On failure, the agent has
+                been removed from the simulator.
+   */
+  bool activateAgent(BaseAgent* agent, const std::string& stateName);
+
+  /*!
+   @brief       Removes the agent from the BFSM and the simulator's store.
+
+   @param       agent    The agent.
+   */
+  void discardAgent(BaseAgent* agent);
+
+  /*!
+   @brief       Applies the pending retirements and lets the agent sources spawn their agents.
+
+   Called at the end of every time step.
+   */
+  void updatePopulation();
+
   /*!
    @brief    Updates the effective time step -- how large an actual simulation time step is due to
             computation sub-steps.
@@ -307,6 +460,11 @@ class MENGE_API SimulatorInterface : public XMLSimulatorBase {
    */
   SCBWriter* _scbWriter;
 
+  /*!
+   @brief    The optional shared-memory frame publisher.
+   */
+  FrameRingWriter* _frameRing;
+
   /*!
    @brief    Indicates if the simulation is running.
    */
@@ -316,6 +474,34 @@ class MENGE_API SimulatorInterface : public XMLSimulatorBase {
    @brief    Maximum length of simulation time to compute (in simulation time).
    */
   float _maxDuration;
+
+  /*!
+   @brief    The sources of agents.
+   */
+  std::vector<AgentSource*> _sources;
+
+  /*!
+   @brief    The agent profiles used by the agent sources.
+   */
+  std::vector<AgentInitializer*> _sourceProfiles;
+
+  /*!
+   @brief    The agents to retire at the end of the current time step.
+   */
+  std::vector<BaseAgent*> _retirements;
+
+  /*!
+   @brief    The lock protecting _retirements.
+   */
+  SimpleLock _retireLock;
+
+  /*!
+   @brief    Reports if agents have been added or removed since the spatial query was last given the
+            set of agents.
+   */
+  bool _populationChanged;
+
+  friend class AgentSource;
 };
 }  // namespace Agents
 }  // namespace Menge
@@ -63,7 +63,7 @@ void AgentKDTree::setAgents(const std::vector<BaseAgent*>& agents) {
   for (size_t i = 0; i < AGT_COUNT; ++i) {
     _agents[i] = agents[i];
   }
-  _tree.resize(2 * AGT_COUNT - 1);
+  _tree.resize(AGT_COUNT > 0 ? 2 * AGT_COUNT - 1 : 0);
 
   if (AGT_COUNT > 0) {
     buildTreeRecursive(0, AGT_COUNT, 0);
@@ -81,6 +81,7 @@ void AgentKDTree::buildTree() {
 /////////////////////////////////////////////////////////////////////////////
 
 void AgentKDTree::agentQuery(ProximityQuery* filter) const {
+  if (_agents.empty()) return;
   float range = filter->getMaxAgentRange();
   queryTreeRecursive(filter, filter->getQueryPoint(), range, 0);
 }
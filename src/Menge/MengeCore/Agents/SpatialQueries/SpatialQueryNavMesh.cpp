@@ -211,7 +211,13 @@ NavMeshSpatialQuery::NavMeshSpatialQuery() : _localizer(0x0) {}
 ////////////////////////////////////////////////////////////////
 
 void NavMeshSpatialQuery::setAgents(const std::vector<BaseAgent*>& agents) {
-  _agents.insert(_agents.begin(), agents.begin(), agents.end());
+  // The localizer's node occupants are agent identifiers.
+  _agents.assign(_agents.size(), 0x0);
+  for (size_t i = 0; i < agents.size(); ++i) {
+    const size_t ID = agents[i]->_id;
+    if (ID >= _agents.size()) _agents.resize(ID + 1, 0x0);
+    _agents[ID] = agents[i];
+  }
 }
 
 ////////////////////////////////////////////////////////////////
@@ -130,7 +130,8 @@ class MENGE_API NavMeshSpatialQuery : public SpatialQuery {
   //    a point, and it uses the agent's position and radius.
  protected:
   /*!
-   @brief    A vector of pointers to all the agents in the simulation
+   @brief    A vector of pointers to all the agents in the simulation, indexed by agent id (the
+            identifiers of retired agents map to NULL).
    */
   std::vector<BaseAgent*> _agents;
 
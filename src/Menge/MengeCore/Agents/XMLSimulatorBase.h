@@ -38,6 +38,7 @@ namespace Menge {
 
 namespace Agents {
 
+class AgentSource;
 class Elevation;
 class SpatialQuery;
 class BaseAgent;
@@ -159,6 +160,20 @@ class MENGE_API XMLSimulatorBase {
    */
   virtual BaseAgent* addAgent(const Math::Vector2& pos, AgentInitializer* agentInit) = 0;
 
+  /*!
+   @brief    Adds a source of agents to the simulation; the simulator takes ownership.
+
+   @param    source    The agent source.
+   */
+  virtual void addAgentSource(AgentSource* source) = 0;
+
+  /*!
+   @brief    Gives the simulator ownership of an agent profile used by its agent sources.
+
+   @param    profile    The agent profile.
+   */
+  virtual void addSourceProfile(AgentInitializer* profile) = 0;
+
   /*!
    @brief    Set the elevation instance of the simulator
 
@@ -56,6 +56,22 @@ void Action::onLeave(Agents::BaseAgent* agent) {
   leaveAction(agent);
 }
 
+/////////////////////////////////////////////////////////////////////
+
+void Action::onEnterBatch(const std::vector<Agents::BaseAgent*>& agents) {
+  for (size_t i = 0; i < agents.size(); ++i) {
+    onEnter(agents[i]);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void Action::onLeaveBatch(const std::vector<Agents::BaseAgent*>& agents) {
+  for (size_t i = 0; i < agents.size(); ++i) {
+    onLeave(agents[i]);
+  }
+}
+
 /////////////////////////////////////////////////////////////////////
 //          Implementation of parsing function
 /////////////////////////////////////////////////////////////////////
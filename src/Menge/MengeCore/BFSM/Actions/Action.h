@@ -35,6 +35,8 @@
 #include "MengeCore/CoreConfig.h"
 #include "MengeCore/PluginEngine/Element.h"
 
+#include <vector>
+
 // forward declaration
 class TiXmlElement;
 
@@ -86,6 +88,29 @@ class MENGE_API Action : public Element {
    */
   void onLeave(Agents::BaseAgent* agent);
 
+  /*!
+   @brief    Called when a batch of agents enters the state at once; it must be equivalent to
+            calling onEnter() for each agent, in order.
+
+   Sub-classes can override this to act on the whole batch more efficiently (e.g., acquiring shared
+   resources once or vectorizing the work). The default implementation calls onEnter() for each
+   agent serially; actions typically draw values from shared generators and applying them in order
+   keeps the results independent of the number of threads.
+
+   @param    agents    The agents to act on.
+   */
+  virtual void onEnterBatch(const std::vector<Agents::BaseAgent*>& agents);
+
+  /*!
+   @brief    Called when a batch of agents leaves the state at once; it must be equivalent to
+            calling onLeave() for each agent, in order.
+
+   The default implementation calls onLeave() for each agent serially.
+
+   @param    agents    The agents to act on.
+   */
+  virtual void onLeaveBatch(const std::vector<Agents::BaseAgent*>& agents);
+
   friend class ActionFactory;
 
  protected:
@@ -40,6 +40,7 @@ Any questions or comments should be sent to the authors {menge,geom}@cs.unc.edu
 
 #include "MengeCore/BFSM/Actions/ObstacleAction.h"
 #include "MengeCore/BFSM/Actions/PropertyAction.h"
+#include "MengeCore/BFSM/Actions/RetireAction.h"
 #include "MengeCore/BFSM/Actions/TeleportAction.h"
 
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
@@ -60,6 +61,7 @@ void ElementDB<BFSM::ActionFactory, BFSM::Action>::addBuiltins() {
   addFactory(new BFSM::OffsetPropertyActFactory());
   addFactory(new BFSM::ScalePropertyActFactory());
   addFactory(new BFSM::TeleportActFactory());
+  addFactory(new BFSM::RetireActFactory());
 }
 }  // namespace Menge
 
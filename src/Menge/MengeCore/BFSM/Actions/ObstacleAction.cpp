@@ -52,31 +52,19 @@ ObstacleAction::ObstacleAction() : Action(), _setOperand(0), _originalMap() {}
 
 /////////////////////////////////////////////////////////////////////
 
-ObstacleAction::~ObstacleAction() {
-  // Is this delete safe?  This may require a destroy method if it is
-  //  instantiated in MengeCore and used in external dll
-  _originalMap.clear();
-}
+ObstacleAction::~ObstacleAction() {}
 
 /////////////////////////////////////////////////////////////////////
 
 void ObstacleAction::onEnter(Agents::BaseAgent* agent) {
-  _lock.lock();
   if (_undoOnExit) _originalMap[agent->_id] = agent->_obstacleSet;
   agent->_obstacleSet = newValue(agent->_obstacleSet);
-  _lock.release();
 }
 
 /////////////////////////////////////////////////////////////////////
 
 void ObstacleAction::resetAction(Agents::BaseAgent* agent) {
-  _lock.lock();
-  std::map<size_t, size_t>::iterator itr = _originalMap.begin();
-  assert(itr != _originalMap.end() &&
-         "Trying to find an original value for an agent whose value was not cached");
-  agent->_obstacleSet = itr->second;
-  _originalMap.erase(itr);
-  _lock.release();
+  agent->_obstacleSet = _originalMap[agent->_id];
 }
 
 /////////////////////////////////////////////////////////////////////
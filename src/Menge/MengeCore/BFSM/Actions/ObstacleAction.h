@@ -24,14 +24,12 @@
 #ifndef __OBSTACLE_ACTION_H__
 #define __OBSTACLE_ACTION_H__
 
+#include "MengeCore/BFSM/AgentSideTable.h"
 #include "MengeCore/BFSM/Actions/Action.h"
 #include "MengeCore/BFSM/Actions/ActionFactory.h"
 #include "MengeCore/BFSM/FSMEnumeration.h"
 #include "MengeCore/BFSM/fsmCommon.h"
 #include "MengeCore/CoreConfig.h"
-#include "MengeCore/Runtime/SimpleLock.h"
-
-#include <map>
 
 // forward declaration
 
@@ -93,14 +91,9 @@ class MENGE_API ObstacleAction : public Action {
   size_t _setOperand;
 
   /*!
-   @brief    A mapping from agent id to the agent's obstacle set value before the action was applied.
-   */
-  std::map<size_t, size_t> _originalMap;
-
-  /*!
-   @brief    Lock for guaranteeing thread-safety.
+   @brief    The agents' obstacle set values before the action was applied.
    */
-  SimpleLock _lock;
+  AgentSideTable<size_t> _originalMap;
 };
 
 /////////////////////////////////////////////////////////////////////
@@ -0,0 +1,49 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#include "MengeCore/BFSM/Actions/RetireAction.h"
+
+#include "MengeCore/Agents/SimulatorInterface.h"
+#include "MengeCore/Core.h"
+
+namespace Menge {
+
+namespace BFSM {
+
+/////////////////////////////////////////////////////////////////////
+//                   Implementation of RetireAction
+/////////////////////////////////////////////////////////////////////
+
+void RetireAction::onEnter(Agents::BaseAgent* agent) { SIMULATOR->retireAgent(agent); }
+
+/////////////////////////////////////////////////////////////////////
+//                   Implementation of RetireActFactory
+/////////////////////////////////////////////////////////////////////
+
+bool RetireActFactory::setFromXML(Action* action, TiXmlElement* node,
+                                  const std::string& behaveFldr) const {
+  RetireAction* rAction = dynamic_cast<RetireAction*>(action);
+  assert(rAction != 0x0 && "Trying to set retire action properties on an incompatible object");
+
+  if (!ActionFactory::setFromXML(action, node, behaveFldr)) return false;
+  rAction->_undoOnExit = false;
+  return true;
+}
+
+}  // namespace BFSM
+}  // namespace Menge
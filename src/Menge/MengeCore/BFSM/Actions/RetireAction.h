@@ -0,0 +1,115 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+/*!
+ @file    RetireAction.h
+ @brief   Defines a BFSM action that removes agents from the simulation.
+ */
+
+#ifndef __RETIRE_ACTION_H__
+#define __RETIRE_ACTION_H__
+
+#include "MengeCore/BFSM/Actions/Action.h"
+#include "MengeCore/BFSM/Actions/ActionFactory.h"
+#include "MengeCore/CoreConfig.h"
+
+namespace Menge {
+
+// forward declaration
+namespace Agents {
+class BaseAgent;
+}
+
+namespace BFSM {
+// forward declaration
+class RetireActFactory;
+
+/*!
+ @brief    Removes the agent from the simulation (i.e., a sink for agents).
+
+ The agent is removed at the end of the time step in which it enters the state; its identifier can
+ then be reused by agents spawned by an AgentSource. There is nothing to undo, so this action
+ ignores the `exit_reset` attribute.
+ */
+class MENGE_API RetireAction : public Action {
+ public:
+  /*!
+   @brief    Upon entering the state, this is called -- it is the main work of the action.
+
+   @param    agent    The agent to act on.
+   */
+  virtual void onEnter(Agents::BaseAgent* agent);
+
+  friend class RetireActFactory;
+};
+
+/*!
+ @brief    Factory for the RetireAction.
+ */
+class MENGE_API RetireActFactory : public ActionFactory {
+ public:
+  /*!
+   @brief    The name of the action.
+
+   The action's name must be unique among all registered actions. Each action factory must override
+   this function.
+
+   @returns  A string containing the unique action name.
+   */
+  virtual const char* name() const { return "retire"; }
+
+  /*!
+   @brief    A description of the action.
+
+   Each action factory must override this function.
+
+   @returns  A string containing the action description.
+   */
+  virtual const char* description() const {
+    return "Removes the agent from the simulation at the end of the current time step.";
+  };
+
+ protected:
+  /*!
+   @brief    Create an instance of this class's action.
+
+   All ActionFactory sub-classes must override this by creating (on the heap) a new instance of its
+   corresponding action type. The various field values of the instance will be set in a subsequent
+   call to ActionFactory::setFromXML. The caller of this function takes ownership of the memory.
+
+   @returns    A pointer to a newly instantiated Action class.
+   */
+  Action* instance() const { return new RetireAction(); }
+
+  /*!
+   @brief    Given a pointer to an Action instance, sets the appropriate fields from the provided XML
+            node.
+
+   @param    action      A pointer to the action whose attributes are to be set.
+   @param    node        The XML node containing the action attributes.
+   @param    behaveFldr  The path to the behavior file.  If the action references resources in the
+                        file system, it should be defined relative to the behavior file location.
+                        This is the folder containing that path.
+   @returns  A boolean reporting success (true) or failure (false).
+   */
+  virtual bool setFromXML(Action* action, TiXmlElement* node, const std::string& behaveFldr) const;
+};
+
+}  // namespace BFSM
+}  // namespace Menge
+#endif  // __RETIRE_ACTION_H__
@@ -0,0 +1,104 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#include "MengeCore/BFSM/AgentSideTable.h"
+
+#include "MengeCore/Runtime/SimpleLock.h"
+
+#include <algorithm>
+
+namespace Menge {
+
+namespace BFSM {
+
+namespace {
+// The registry is constructed on first use so that tables in statically initialized objects can
+// register themselves safely.
+struct SideTableRegistry {
+  SideTableRegistry() : capacity(0) {}
+  std::vector<AgentSideTableBase*> tables;
+  size_t capacity;
+  SimpleLock lock;
+};
+
+SideTableRegistry& registry() {
+  static SideTableRegistry reg;
+  return reg;
+}
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////
+//                   Implementation of AgentSideTableBase
+/////////////////////////////////////////////////////////////////////
+
+AgentSideTableBase::AgentSideTableBase() {
+  SideTableRegistry& reg = registry();
+  reg.lock.lock();
+  reg.tables.push_back(this);
+  reg.lock.release();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+AgentSideTableBase::AgentSideTableBase(const AgentSideTableBase& table) {
+  SideTableRegistry& reg = registry();
+  reg.lock.lock();
+  reg.tables.push_back(this);
+  reg.lock.release();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+AgentSideTableBase::~AgentSideTableBase() {
+  SideTableRegistry& reg = registry();
+  reg.lock.lock();
+  std::vector<AgentSideTableBase*>::iterator itr =
+      std::find(reg.tables.begin(), reg.tables.end(), this);
+  if (itr != reg.tables.end()) {
+    *itr = reg.tables.back();
+    reg.tables.pop_back();
+  }
+  reg.lock.release();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void AgentSideTableBase::reserveAll(size_t count) {
+  SideTableRegistry& reg = registry();
+  reg.lock.lock();
+  if (count > reg.capacity) {
+    reg.capacity = count;
+    for (size_t i = 0; i < reg.tables.size(); ++i) {
+      reg.tables[i]->reserve(count);
+    }
+  }
+  reg.lock.release();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t AgentSideTableBase::getCapacity() {
+  SideTableRegistry& reg = registry();
+  reg.lock.lock();
+  const size_t capacity = reg.capacity;
+  reg.lock.release();
+  return capacity;
+}
+
+}  // namespace BFSM
+}  // namespace Menge
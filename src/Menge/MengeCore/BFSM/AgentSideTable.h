@@ -0,0 +1,215 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+/*!
+ @file    AgentSideTable.h
+ @brief    Dense, agent-indexed storage for the per-agent data of BFSM elements.
+ */
+
+#ifndef __AGENT_SIDE_TABLE_H__
+#define __AGENT_SIDE_TABLE_H__
+
+#include "MengeCore/CoreConfig.h"
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace Menge {
+
+namespace BFSM {
+
+/*!
+ @brief    The type-independent base of AgentSideTable.
+
+ Every table registers itself on construction so that the FSM can grow all tables together when it
+ makes room for more agents (see FSM::setAgentCount() and FSM::addAgent()). The capacity only
+ changes while the simulation is single-threaded; during the parallel parts of the simulation step
+ the tables never reallocate.
+ */
+class MENGE_API AgentSideTableBase {
+ public:
+  /*!
+   @brief    Constructor; the table is registered.
+   */
+  AgentSideTableBase();
+
+  /*!
+   @brief    Copy constructor; the copy is registered independently of the original.
+
+   @param    table    The table to copy.
+   */
+  AgentSideTableBase(const AgentSideTableBase& table);
+
+  /*!
+   @brief    Destructor; the table is unregistered.
+   */
+  virtual ~AgentSideTableBase();
+
+  /*!
+   @brief    Assignment operator; registration is unaffected.
+
+   @param    table    The table to copy.
+   @returns  A reference to this table.
+   */
+  AgentSideTableBase& operator=(const AgentSideTableBase& table) { return *this; }
+
+  /*!
+   @brief    Grows every registered table so that it can store data for agent identifiers in the
+            range [0, `count`). Tables are never shrunk.
+
+   This must not be called while agents are being evaluated in parallel.
+
+   @param    count    The required number of agent identifiers.
+   */
+  static void reserveAll(size_t count);
+
+  /*!
+   @brief    Reports the number of agent identifiers every table can currently hold; newly created
+            tables are created with this size.
+   */
+  static size_t getCapacity();
+
+ protected:
+  /*!
+   @brief    Grows the table so it can hold data for agent identifiers in the range [0, `count`).
+
+   @param    count    The required number of agent identifiers.
+   */
+  virtual void reserve(size_t count) = 0;
+};
+
+/////////////////////////////////////////////////////////////////////
+
+/*!
+ @brief    A dense table of per-agent values, indexed by agent identifier.
+
+ This replaces the common pattern of a (locked) map from agent id to value in BFSM elements
+ (conditions, targets, actions, velocity components, etc.), including those defined in plugins.
+ Each element owns its own table. Because the table is sized to the number of agents in advance,
+ different agents' entries can be read and written concurrently without a lock; all data for a
+ single agent is accessed by a single thread at a time during the FSM update.
+
+ Entries which have never been set (or have been cleared) hold the table's empty value.
+
+ `T` must be default constructible and copyable. Note: `bool` should be avoided as the entries of a
+ `std::vector<bool>` cannot be written concurrently; use a `char` or `int` instead.
+
+ @tparam  T    The type of the per-agent value.
+ */
+template <typename T>
+class AgentSideTable : public AgentSideTableBase {
+ public:
+  /*!
+   @brief    Constructor.
+
+   @param    empty    The value of entries which have not been set.
+   */
+  explicit AgentSideTable(const T& empty = T())
+      : AgentSideTableBase(), _empty(empty), _values(getCapacity(), empty) {}
+
+  /*!
+   @brief    Copy constructor.
+
+   @param    table    The table to copy.
+   */
+  AgentSideTable(const AgentSideTable& table)
+      : AgentSideTableBase(table), _empty(table._empty), _values(table._values) {
+    reserve(getCapacity());
+  }
+
+  /*!
+   @brief    Assignment operator.
+
+   @param    table    The table to copy.
+   @returns  A reference to this table.
+   */
+  AgentSideTable& operator=(const AgentSideTable& table) {
+    _empty = table._empty;
+    _values = table._values;
+    reserve(getCapacity());
+    return *this;
+  }
+
+  /*!
+   @brief    Provides access to the value for the agent with the given identifier.
+
+   @param    id    The agent identifier.
+   @returns  A reference to the agent's value.
+   */
+  T& operator[](size_t id) {
+    assert(id < _values.size() && "Agent side table hasn't been sized for the agent");
+    return _values[id];
+  }
+
+  /*!
+   @brief    Provides access to the value for the agent with the given identifier.
+
+   @param    id    The agent identifier.
+   @returns  A const reference to the agent's value.
+   */
+  const T& operator[](size_t id) const {
+    assert(id < _values.size() && "Agent side table hasn't been sized for the agent");
+    return _values[id];
+  }
+
+  /*!
+   @brief    Resets the value for the agent with the given identifier to the empty value.
+
+   @param    id    The agent identifier.
+   */
+  void clear(size_t id) { (*this)[id] = _empty; }
+
+  /*!
+   @brief    Reports if the given agent's value is the empty value.
+
+   @param    id    The agent identifier.
+   @returns  True if the agent's value equals the empty value.
+   */
+  bool isEmpty(size_t id) const { return (*this)[id] == _empty; }
+
+  /*!
+   @brief    Reports the number of agent identifiers the table can hold.
+   */
+  size_t size() const { return _values.size(); }
+
+ protected:
+  /*!
+   @brief    Grows the table so it can hold data for agent identifiers in the range [0, `count`).
+
+   @param    count    The required number of agent identifiers.
+   */
+  virtual void reserve(size_t count) {
+    if (count > _values.size()) _values.resize(count, _empty);
+  }
+
+  /*!
+   @brief    The value of entries which have not been set.
+   */
+  T _empty;
+
+  /*!
+   @brief    The per-agent values.
+   */
+  std::vector<T> _values;
+};
+
+}  // namespace BFSM
+}  // namespace Menge
+
+#endif  // __AGENT_SIDE_TABLE_H__
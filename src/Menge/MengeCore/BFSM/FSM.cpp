@@ -43,24 +43,76 @@ Any questions or comments should be sent to the authors {menge,geom}@cs.unc.edu
 #include "MengeCore/Agents/PrefVelocity.h"
 #include "MengeCore/Agents/SimulatorInterface.h"
 #include "MengeCore/Core.h"
+#include "MengeCore/Runtime/StepProfiler.h"
 #if 0
 #include "MengeCore/Agents/StateContext.h"
 #include "MengeCore/BFSM/FsmContext.h"
 #endif
+#include "MengeCore/BFSM/AgentSideTable.h"
 #include "MengeCore/BFSM/GoalSet.h"
 #include "MengeCore/BFSM/State.h"
 #include "MengeCore/BFSM/Tasks/Task.h"
 #include "MengeCore/BFSM/Transitions/Transition.h"
 
+#include <algorithm>
+#include <chrono>
+#include <exception>
+
 namespace Menge {
 
 namespace BFSM {
 
+namespace {
+/*!
+ @brief    The outcome of a task's work in one call to FSM::doTasks().
+ */
+enum TaskOutcome {
+  TASK_OK,        ///< The work completed.
+  TASK_ERROR,     ///< The task threw a TaskException.
+  TASK_FATAL,     ///< The task threw a TaskFatalException.
+  TASK_UNHANDLED  ///< The task threw any other exception; it is passed on to the caller.
+};
+
+/*!
+ @brief    Performs a task's work, capturing its failure so it can be reported outside of a parallel
+           region.
+
+ @param    task       The task to run.
+ @param    fsm        The FSM passed to the task.
+ @param    profile    If true, the task's duration is measured.
+ @param    seconds    Set to the task's duration (if profiling).
+ @param    error      Set to the exception thrown by the task if the outcome is TASK_UNHANDLED.
+ @returns  The outcome of the work.
+ */
+TaskOutcome runTask(Task* task, const FSM* fsm, bool profile, double& seconds,
+                    std::exception_ptr& error) {
+  TaskOutcome outcome = TASK_OK;
+  std::chrono::steady_clock::time_point start;
+  if (profile) start = std::chrono::steady_clock::now();
+  try {
+    task->doWork(fsm);
+  } catch (TaskFatalException) {
+    outcome = TASK_FATAL;
+  } catch (TaskException) {
+    outcome = TASK_ERROR;
+  } catch (...) {
+    // An exception can't leave a parallel region; it is rethrown once the wave is done.
+    outcome = TASK_UNHANDLED;
+    error = std::current_exception();
+  }
+  if (profile) {
+    seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  }
+  return outcome;
+}
+}  // namespace
+
 /////////////////////////////////////////////////////////////////////
 //                   Implementation of FSM
 /////////////////////////////////////////////////////////////////////
 
-FSM::FSM(Agents::SimulatorInterface* sim) : _sim(sim), _agtCount(0), _currNode(0x0) {
+FSM::FSM(Agents::SimulatorInterface* sim)
+    : _sim(sim), _agtCount(0), _currNode(0x0), _updateInterval(1), _stepCount(0), _nextUpdate(0) {
   setAgentCount(sim->getNumAgents());
 }
 
@@ -110,6 +162,7 @@ void FSM::addTask(Task* task) {
       }
     }
     _tasks.push_back(task);
+    _taskWaves.clear();
   }
 }
 
@@ -123,6 +176,7 @@ void FSM::setAgentCount(size_t count) {
   _agtCount = count;
   _currNode = new State*[count];
   memset(_currNode, 0x0, count * sizeof(State*));
+  AgentSideTableBase::reserveAll(count);
 }
 
 /////////////////////////////////////////////////////////////////////
@@ -130,9 +184,10 @@ void FSM::setAgentCount(size_t count) {
 void FSM::advance(Agents::BaseAgent* agent) {
   const size_t ID = agent->_id;
   // Evaluate the current state's transitions
-  State* newNode = _currNode[ID]->testTransitions(agent);
+  State* newNode = _transitionTable.advance(agent, _currNode[ID]);
   if (newNode) {
     _currNode[ID] = newNode;
+    agent->wake();
   }
 }
 
@@ -142,12 +197,61 @@ bool FSM::forceStateTransition(Agents::BaseAgent* agent, State* target_state, bo
     curr_state->leave(agent);
     target_state->enter(agent);
     _currNode[agent->_id] = target_state;
+    _nextUpdate.clear(agent->_id);
+    agent->wake();
   }
   return curr_state != target_state;
 }
 
 /////////////////////////////////////////////////////////////////////
 
+size_t FSM::forceStateTransitions(const std::vector<Agents::BaseAgent*>& agents,
+                                  State* target_state, bool force_reentry) {
+  // The agents are grouped by source state in the order the states are first encountered (rather
+  // than, e.g., by address) so that the result doesn't depend on the memory layout.
+  std::vector<State*> sources;
+  std::vector<std::vector<Agents::BaseAgent*> > leaving;
+  std::vector<Agents::BaseAgent*> moving;
+  size_t changed = 0;
+  for (size_t i = 0; i < agents.size(); ++i) {
+    State* curr_state = _currNode[agents[i]->_id];
+    if (curr_state != target_state) {
+      ++changed;
+    } else if (!force_reentry) {
+      continue;
+    }
+    size_t s = std::find(sources.begin(), sources.end(), curr_state) - sources.begin();
+    if (s == sources.size()) {
+      sources.push_back(curr_state);
+      leaving.push_back(std::vector<Agents::BaseAgent*>());
+    }
+    leaving[s].push_back(agents[i]);
+    moving.push_back(agents[i]);
+  }
+
+  for (size_t s = 0; s < sources.size(); ++s) {
+    sources[s]->leaveBatch(leaving[s]);
+  }
+  // As with forceStateTransition(), only the agents which actually entered the target state are
+  // recorded in it.
+  std::vector<Agents::BaseAgent*> entered;
+  bool complete = true;
+  try {
+    target_state->enterBatch(moving, entered);
+  } catch (StateException&) {
+    complete = false;
+  }
+  for (size_t i = 0; i < entered.size(); ++i) {
+    _currNode[entered[i]->_id] = target_state;
+    _nextUpdate.clear(entered[i]->_id);
+    entered[i]->wake();
+  }
+  if (!complete) throw StateException();
+  return changed;
+}
+
+/////////////////////////////////////////////////////////////////////
+
 void FSM::computePrefVelocity(Agents::BaseAgent* agent) {
   const size_t ID = agent->_id;
   // Evalute the new state's velocity
@@ -183,13 +287,61 @@ State* FSM::getNode(const std::string& name) {
 
 /////////////////////////////////////////////////////////////////////
 
+void FSM::addAgent(Agents::BaseAgent* agent, State* state) {
+  const size_t ID = agent->_id;
+  if (ID >= _agtCount) {
+    size_t count = _agtCount > 0 ? 2 * _agtCount : 64;
+    while (count <= ID) count *= 2;
+    State** nodes = new State*[count];
+    memset(nodes, 0x0, count * sizeof(State*));
+    if (_currNode) {
+      memcpy(nodes, _currNode, _agtCount * sizeof(State*));
+      delete[] _currNode;
+    }
+    _currNode = nodes;
+    _agtCount = count;
+    AgentSideTableBase::reserveAll(count);
+  }
+  for (size_t i = 0; i < _tasks.size(); ++i) {
+    _tasks[i]->addAgent(agent);
+  }
+  // The state is only recorded once it has been successfully entered.
+  state->enter(agent);
+  _currNode[ID] = state;
+  _nextUpdate.clear(ID);
+  agent->_vel.set(Math::Vector2(0.f, 0.f));
+  for (size_t i = 0; i < _velModifiers.size(); ++i) {
+    _velModifiers[i]->registerAgent(agent);
+  }
+  computePrefVelocity(agent);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void FSM::removeAgent(Agents::BaseAgent* agent) {
+  const size_t ID = agent->_id;
+  if (ID < _agtCount && _currNode[ID] != 0x0) {
+    _currNode[ID]->leave(agent);
+    _currNode[ID] = 0x0;
+    for (size_t i = 0; i < _velModifiers.size(); ++i) {
+      _velModifiers[i]->unregisterAgent(agent);
+    }
+  }
+  for (size_t i = 0; i < _tasks.size(); ++i) {
+    _tasks[i]->removeAgent(agent);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
 size_t FSM::addNode(State* node) {
-  if (_currNode[0] == 0x0) {
+  if (_agtCount > 0 && _currNode[0] == 0x0) {
     for (size_t i = 0; i < _agtCount; ++i) {
       _currNode[i] = node;
     }
   }
   _nodes.push_back(node);
+  _transitionTable.invalidate();
   return _nodes.size() - 1;
 }
 
@@ -199,6 +351,7 @@ bool FSM::addTransition(size_t fromNode, Transition* t) {
   if (fromNode >= _nodes.size()) return false;
   State* from = _nodes[fromNode];
   from->addTransition(t);
+  _transitionTable.invalidate();
   return true;
 }
 
@@ -208,7 +361,9 @@ bool FSM::addGoal(size_t goalSet, size_t goalID, Goal* goal) {
   if (_goalSets.find(goalSet) == _goalSets.end()) {
     _goalSets[goalSet] = new GoalSet();
   }
-  return _goalSets[goalSet]->addGoal(goalID, goal);
+  if (!_goalSets[goalSet]->addGoal(goalID, goal)) return false;
+  _goalSets[goalSet]->buildIndex();
+  return true;
 }
 
 /////////////////////////////////////////////////////////////////////
@@ -231,9 +386,18 @@ const GoalSet* FSM::getGoalSet(size_t goalSetID) {
 
 /////////////////////////////////////////////////////////////////////
 
+size_t FSM::getUpdateInterval(const State* state) const {
+  const size_t interval = state->getUpdateInterval();
+  return interval > 0 ? interval : _updateInterval;
+}
+
+/////////////////////////////////////////////////////////////////////
+
 void FSM::setCurrentState(Agents::BaseAgent* agent, size_t currNode) {
   assert(currNode < _nodes.size() && "Set invalid state as current state");
   _currNode[agent->_id] = _nodes[currNode];
+  _nextUpdate.clear(agent->_id);
+  agent->wake();
 }
 
 /////////////////////////////////////////////////////////////////////
@@ -253,9 +417,9 @@ size_t FSM::getAgentStateID(size_t agentID) const { return _currNode[agentID]->g
 /////////////////////////////////////////////////////////////////////
 
 bool FSM::allFinal() const {
-  // NOTE: This assumes that there are no holes in this memory
-  for (size_t a = 0; a < _agtCount; ++a) {
-    if (!_currNode[a]->getFinal()) return false;
+  const size_t AGT_COUNT = _sim->getNumAgents();
+  for (size_t a = 0; a < AGT_COUNT; ++a) {
+    if (!_currNode[_sim->getAgent(a)->_id]->getFinal()) return false;
   }
   return true;
 }
@@ -266,46 +430,122 @@ bool FSM::doStep() {
   // NOTE: This is a cast from size_t to int to be compatible with older implementations
   //    of openmp which require signed integers as loop variables
   SIM_TIME = this->_sim->getGlobalTime();
-  EVENT_SYSTEM->evaluateEvents();
+  if (!_transitionTable.isCompiled()) _transitionTable.compile(_nodes);
+  {
+    ProfileScope timer(StepProfiler::EVENTS);
+    EVENT_SYSTEM->evaluateEvents();
+  }
   int agtCount = (int)this->_sim->getNumAgents();
   size_t exceptionCount = 0;
+  const size_t step = ++_stepCount;
+  {
+    ProfileRegion region(StepProfiler::FSM_TRANSITIONS, StepProfiler::PREF_VELOCITY);
 #pragma omp parallel for reduction(+ : exceptionCount)
-  for (int a = 0; a < agtCount; ++a) {
-    Agents::BaseAgent* agt = this->_sim->getAgent(a);
-    try {
-      advance(agt);
-      this->computePrefVelocity(agt);
-    } catch (StateException& e) {
-      logger << Logger::ERR_MSG << e.what() << "\n";
-      ++exceptionCount;
+    for (int a = 0; a < agtCount; ++a) {
+      Agents::BaseAgent* agt = this->_sim->getAgent(a);
+      const size_t ID = agt->_id;
+      // Agents outside of this step's cohort keep their preferred velocity.
+      if (_nextUpdate[ID] > step) continue;
+      ProfileLap lap;
+      try {
+        advance(agt);
+        lap.lap(StepProfiler::FSM_TRANSITIONS);
+        this->computePrefVelocity(agt);
+        lap.lap(StepProfiler::PREF_VELOCITY);
+        // The next update is the agent's next cohort step; at most `interval` steps away.
+        const size_t interval = getUpdateInterval(_currNode[ID]);
+        _nextUpdate[ID] = step + interval - (step + ID) % interval;
+      } catch (StateException& e) {
+        MENGE_LOG(ERR_MSG) << e.what() << "\n";
+        ++exceptionCount;
+      }
     }
   }
   if (exceptionCount > 0) {
     throw FSMFatalException();
   }
+  for (size_t i = 0; i < _nodes.size(); ++i) {
+    _nodes[i]->mergeMembership();
+  }
   return this->allFinal();
 }
 
 /////////////////////////////////////////////////////////////////////
 
+void FSM::scheduleTasks() {
+  const size_t TASK_COUNT = _tasks.size();
+  std::vector<TaskResources> resources(TASK_COUNT);
+  std::vector<bool> declared(TASK_COUNT);
+  std::vector<size_t> waves(TASK_COUNT, 0);
+  size_t waveCount = 0;
+  for (size_t i = 0; i < TASK_COUNT; ++i) {
+    declared[i] = _tasks[i]->getResources(resources[i]);
+    for (size_t j = 0; j < i; ++j) {
+      // An undeclared task may touch anything; it conflicts with every other task.
+      if (!declared[i] || !declared[j] || resources[i].conflictsWith(resources[j])) {
+        waves[i] = std::max(waves[i], waves[j] + 1);
+      }
+    }
+    waveCount = std::max(waveCount, waves[i] + 1);
+  }
+  _taskWaves.assign(waveCount, std::vector<size_t>());
+  for (size_t i = 0; i < TASK_COUNT; ++i) _taskWaves[waves[i]].push_back(i);
+}
+
+/////////////////////////////////////////////////////////////////////
+
 void FSM::doTasks() {
-  for (size_t i = 0; i < this->_tasks.size(); ++i) {
-    try {
-      this->_tasks[i]->doWork(this);
-    } catch (TaskFatalException) {
-      logger << Logger::ERR_MSG << "Fatal error in FSM task: ";
-      logger << _tasks[i]->toString() << "\n";
-      throw FSMFatalException();
-    } catch (TaskException) {
-      logger << Logger::ERR_MSG << "Error in FSM task: ";
-      logger << _tasks[i]->toString() << "\n";
+  if (_taskWaves.empty() && !_tasks.empty()) scheduleTasks();
+  const bool profile = PROFILER.isEnabled();
+  std::vector<TaskOutcome> outcomes(_tasks.size(), TASK_OK);
+  std::vector<double> seconds(_tasks.size(), 0.0);
+  std::vector<std::exception_ptr> errors(_tasks.size());
+  std::vector<size_t> serial;
+  for (size_t w = 0; w < _taskWaves.size(); ++w) {
+    const std::vector<size_t>& wave = _taskWaves[w];
+    // Tasks which parallelize their own work get every thread; the rest share them.
+    serial.clear();
+    for (size_t i = 0; i < wave.size(); ++i) {
+      const size_t t = wave[i];
+      if (_tasks[t]->isParallel()) {
+        outcomes[t] = runTask(_tasks[t], this, profile, seconds[t], errors[t]);
+      } else {
+        serial.push_back(t);
+      }
+    }
+    const int SERIAL_COUNT = static_cast<int>(serial.size());
+#pragma omp parallel for schedule(dynamic, 1) if (SERIAL_COUNT > 1)
+    for (int i = 0; i < SERIAL_COUNT; ++i) {
+      const size_t t = serial[i];
+      outcomes[t] = runTask(_tasks[t], this, profile, seconds[t], errors[t]);
+    }
+
+    bool fatal = false;
+    std::exception_ptr unhandled;
+    for (size_t i = 0; i < wave.size(); ++i) {
+      const size_t t = wave[i];
+      if (profile) PROFILER.addTaskTime(_tasks[t]->toString(), seconds[t]);
+      if (outcomes[t] == TASK_UNHANDLED) {
+        // As if the tasks had run one at a time: the earliest task's exception propagates.
+        if (!unhandled && !fatal) unhandled = errors[t];
+      } else if (outcomes[t] == TASK_FATAL) {
+        logger << Logger::ERR_MSG << "Fatal error in FSM task: ";
+        logger << _tasks[t]->toString() << "\n";
+        fatal = true;
+      } else if (outcomes[t] == TASK_ERROR) {
+        logger << Logger::ERR_MSG << "Error in FSM task: ";
+        logger << _tasks[t]->toString() << "\n";
+      }
     }
+    if (unhandled) std::rethrow_exception(unhandled);
+    if (fatal) throw FSMFatalException();
   }
 }
 
 /////////////////////////////////////////////////////////////////////
 
 void FSM::finalize() {
+  _transitionTable.compile(_nodes);
   EVENT_SYSTEM->finalize();
   doTasks();
 }
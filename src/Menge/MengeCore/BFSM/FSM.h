@@ -27,7 +27,9 @@
 // Finite-state machine used to compute preferred velocity
 //  according to varying conditions
 
+#include "MengeCore/BFSM/AgentSideTable.h"
 #include "MengeCore/BFSM/FSMDescrip.h"
+#include "MengeCore/BFSM/TransitionTable.h"
 #include "MengeCore/BFSM/fsmCommon.h"
 #include "MengeCore/MengeException.h"
 
@@ -137,13 +139,43 @@ class MENGE_API FSM {
   /*!
    @brief    Initializes the memory required for the number of agents included in the FSM.
 
+   The per-agent tables of the FSM's elements (see AgentSideTable) are grown accordingly.
+
    @param    count    The number of agents.
    */
   void setAgentCount(size_t count);
 
+  /*!
+   @brief    Adds an agent to the FSM while the simulation is running.
+
+   The tasks are informed of the agent, then the agent enters the given state (i.e., the state's
+   actions and goal selection are applied), its velocity is zeroed, it is registered with the global
+   velocity modifiers, and its preferred velocity is computed. The storage for agent states grows as
+   necessary (including the elements' AgentSideTable instances).
+
+   @param    agent    The agent to add; its identifier may be one previously used by a removed
+                      agent.
+   @param    state    The state the agent starts in.
+   @throws    A StateException (or other MengeException) if the state cannot be entered. In that
+              case, the agent is left without a state and should be removed with removeAgent().
+   */
+  void addAgent(Agents::BaseAgent* agent, State* state);
+
+  /*!
+   @brief    Removes an agent from the FSM.
+
+   The agent leaves its current state (releasing its goal, undoing actions, etc.) and all tasks are
+   informed so they can release per-agent data.
+
+   @param    agent    The agent to remove.
+   */
+  void removeAgent(Agents::BaseAgent* agent);
+
   /*!
    @brief    Advances the FSM based on the current state for the given agent.
 
+   An agent which changes state is woken (see Agents::BaseAgent::isAsleep()).
+
    @param    agent    The agent to advance the FSM for.
    */
   void advance(Agents::BaseAgent* agent);
@@ -162,6 +194,23 @@ class MENGE_API FSM {
    @returns  true if the agent's previous state was different from its final state.  */
   bool forceStateTransition(Agents::BaseAgent* agent, State* target_state, bool force_reentry);
 
+  /** @brief  Forcibly moves the given agents to the indicated state as a batch.
+
+   The batch counterpart of forceStateTransition(). The agents are grouped by their current state;
+   each group leaves its state through State::leaveBatch() and then all of the moving agents enter
+   the `target_state` through State::enterBatch(), in the order given.
+
+   @param  agents         The agents whose state _may_ change.
+   @param  target_state   The target state to move the agents to.
+   @param  force_reentry  If true, agents already in the target state leave and re-enter it. If
+                          false, they are untouched.
+   @returns  The number of agents whose previous state was different from the `target_state`.
+   @throws   StateException if some agents couldn't enter the `target_state` (see
+            State::enterBatch()); as with forceStateTransition(), those agents' current state is
+            left unchanged.  */
+  size_t forceStateTransitions(const std::vector<Agents::BaseAgent*>& agents, State* target_state,
+                               bool force_reentry);
+
   /*!
    @brief    Computes the preferred velocity for the given agent based on the FSM's record of which
             state the agent is in.
@@ -244,6 +293,36 @@ class MENGE_API FSM {
    */
   bool doStep();
 
+  /*!
+   @brief    Sets how often (in steps) each agent evaluates its transitions and computes its
+            preferred velocity.
+
+   With an interval of N, the agents are split into N staggered cohorts (by agent id) and each
+   step only one cohort is updated; the other agents keep their previous preferred velocity. An
+   agent is updated at least once every N steps, so no transition is delayed by more than N steps.
+   A state can override the interval for the agents in it (see State::setUpdateInterval()); an
+   agent whose state is changed outside of doStep() (e.g., by an event) is updated in the next
+   step regardless of its cohort.
+
+   @param    interval    The number of steps between updates; one (the default) updates every
+                        agent every step.
+   */
+  void setUpdateInterval(size_t interval) {
+    assert(interval > 0 && "The FSM update interval must be at least one");
+    _updateInterval = interval;
+  }
+
+  /*!
+   @brief    Reports the FSM's update interval (see setUpdateInterval()).
+   */
+  size_t getUpdateInterval() const { return _updateInterval; }
+
+  /*!
+   @brief    Reports the update interval for agents in the given state: the state's interval if it
+            defines one, otherwise the FSM's.
+   */
+  size_t getUpdateInterval(const State* state) const;
+
   /*!
    @brief    Sets the current state for the given agent.
 
@@ -291,6 +370,15 @@ class MENGE_API FSM {
 
   /*!
    @brief    Performs the work in the FSM's tasks.
+
+   Tasks which declare the resources they read and write (see Task::getResources()) and don't
+   conflict run concurrently, each on one thread; a task which conflicts with an earlier task runs
+   after it. Tasks which don't declare their resources run alone, in the order in which they were
+   added. When the StepProfiler is enabled, the time of each task is recorded.
+
+   @throws   FSMFatalException if a task fails with a TaskFatalException. Any other exception
+            (other than a TaskException) thrown by a task is passed on once the tasks running
+            alongside it are done.
    */
   void doTasks();
 
@@ -300,7 +388,7 @@ class MENGE_API FSM {
   size_t getTaskCount() const { return _tasks.size(); }
 
   /*!
-   @brief    Finalize the FSM
+   @brief    Finalize the FSM; this compiles the transitions (see TransitionTable).
    */
   void finalize();
 
@@ -331,20 +419,29 @@ class MENGE_API FSM {
   friend FSM* buildFSM(FSMDescrip& fsmDescrip, Agents::SimulatorInterface* sim, bool VERBOSE);
 
  protected:
+  /*!
+   @brief    Partitions the tasks into waves (see _taskWaves) from their declared resources.
+
+   Each task is placed in the wave following the latest wave holding an earlier task with which it
+   conflicts.
+   */
+  void scheduleTasks();
+
   /*!
    @brief    The simulator on which the FSM acts.
    */
   Agents::SimulatorInterface* _sim;
 
   /*!
-   @brief    Number of agents attached to the state machine
+   @brief    The number of agent identifiers for which _currNode has space.
 
-   This should be the same as the number of agents in the simulator.
+   This is at least as large as the largest agent identifier in the simulator; when agents are
+   spawned and removed, not every entry belongs to an active agent.
    */
   size_t _agtCount;
 
   /*!
-   @brief    The active state for each agent in the system.
+   @brief    The active state for each agent in the system (indexed by agent id).
    */
   State** _currNode;
 
@@ -353,11 +450,39 @@ class MENGE_API FSM {
    */
   std::vector<State*> _nodes;
 
+  /*!
+   @brief    The compiled transitions of the states; used by advance().
+   */
+  TransitionTable _transitionTable;
+
+  /*!
+   @brief    The number of steps between updates of an agent (see setUpdateInterval()).
+   */
+  size_t _updateInterval;
+
+  /*!
+   @brief    The number of times doStep() has been called.
+   */
+  size_t _stepCount;
+
+  /*!
+   @brief    For each agent, the first step (see _stepCount) in which it will be updated; agents
+            whose entry is zero are updated in the next step.
+   */
+  AgentSideTable<size_t> _nextUpdate;
+
   /*!
    @brief    The set of tasks to perform at each time step
    */
   std::vector<Task*> _tasks;
 
+  /*!
+   @brief    The indices of the tasks in _tasks, grouped into waves; the tasks in a wave don't
+            conflict and the waves run in order. Built by scheduleTasks() on the first call to
+            doTasks() after a task is added.
+   */
+  std::vector<std::vector<size_t> > _taskWaves;
+
   /*!
    @brief    Mapping from goal set identifier to GoalSet.
    */
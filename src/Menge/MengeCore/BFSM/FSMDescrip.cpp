@@ -62,7 +62,7 @@ namespace BFSM {
 //                   Implementation of FSMDescrip
 /////////////////////////////////////////////////////////////////////
 
-FSMDescrip::FSMDescrip() {}
+FSMDescrip::FSMDescrip() : _updateInterval(1) {}
 
 /////////////////////////////////////////////////////////////////////
 
@@ -101,6 +101,7 @@ State* FSMDescrip::addState(StateDescrip* sData) {
   }
   State* node = new State(sData->_name);
   node->setFinal(sData->_isFinal);
+  node->setUpdateInterval(sData->_updateInterval);
   _stateNameMap[sData->_name] = node;
   return node;
 }
@@ -129,6 +130,16 @@ bool FSMDescrip::loadFromXML(const std::string& xmlName, bool verbose) {
     return false;
   }
 
+  int interval;
+  if (popNode->Attribute("update_interval", &interval)) {
+    if (interval < 1) {
+      logger << Logger::ERR_MSG << "The BFSM's update interval must be at least one; found ";
+      logger << interval << ".";
+      return false;
+    }
+    _updateInterval = static_cast<size_t>(interval);
+  }
+
   std::string absPath;
   os::path::absPath(xmlName, absPath);
   std::string junk;
@@ -157,6 +157,12 @@ class FSMDescrip {
    @brief    The folder in which the behavior specification file appears
    */
   std::string _behaviorFldr;
+
+  /*!
+   @brief    The number of steps between updates of an agent's transitions and preferred velocity
+            (see FSM::setUpdateInterval()).
+   */
+  size_t _updateInterval;
 };
 }  // namespace BFSM
 }  // namespace Menge
@@ -0,0 +1,259 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#include "MengeCore/BFSM/GoalKDTree.h"
+
+#include "MengeCore/BFSM/Goals/Goal.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+namespace Menge {
+
+namespace BFSM {
+
+using Math::Vector2;
+
+namespace {
+// Orders points along one axis; ties are broken by slot so that the tree is deterministic.
+struct AxisLess {
+  AxisLess(const std::vector<Vector2>& points, const std::vector<size_t>& slots, int axis)
+      : _points(points), _slots(slots), _axis(axis) {}
+  bool operator()(size_t a, size_t b) const {
+    const float va = _axis == 0 ? _points[a].x() : _points[a].y();
+    const float vb = _axis == 0 ? _points[b].x() : _points[b].y();
+    return va < vb || (va == vb && _slots[a] < _slots[b]);
+  }
+  const std::vector<Vector2>& _points;
+  const std::vector<size_t>& _slots;
+  int _axis;
+};
+
+// The squared distance from the point to the nearest point in the box.
+float minDistSq(const Vector2& pt, const Vector2& minPt, const Vector2& maxPt) {
+  const float dx = std::max(0.f, std::max(minPt.x() - pt.x(), pt.x() - maxPt.x()));
+  const float dy = std::max(0.f, std::max(minPt.y() - pt.y(), pt.y() - maxPt.y()));
+  return dx * dx + dy * dy;
+}
+
+// The squared distance from the point to the farthest point in the box.
+float maxDistSq(const Vector2& pt, const Vector2& minPt, const Vector2& maxPt) {
+  const float dx = std::max(pt.x() - minPt.x(), maxPt.x() - pt.x());
+  const float dy = std::max(pt.y() - minPt.y(), maxPt.y() - pt.y());
+  return dx * dx + dy * dy;
+}
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////
+//                   Implementation of GoalKDTree
+/////////////////////////////////////////////////////////////////////
+
+const size_t GoalKDTree::MAX_LEAF_SIZE = 8;
+
+/////////////////////////////////////////////////////////////////////
+
+const size_t GoalKDTree::NO_SLOT = static_cast<size_t>(-1);
+
+/////////////////////////////////////////////////////////////////////
+
+GoalKDTree::GoalKDTree() : _built(false) {}
+
+/////////////////////////////////////////////////////////////////////
+
+void GoalKDTree::build(const std::vector<Goal*>& goals) {
+  clear();
+  _built = true;
+  if (goals.empty()) return;
+  _goals = goals;
+  _available.resize(goals.size());
+  _leaves.resize(goals.size());
+  _points.resize(goals.size());
+  _pointSlots.resize(goals.size());
+  for (size_t i = 0; i < goals.size(); ++i) {
+    _points[i] = goals[i]->getCentroid();
+    _pointSlots[i] = i;
+    _available[i] = goals[i]->hasCapacity() ? 1 : 0;
+    _slots[goals[i]] = i;
+  }
+  buildNode(0, goals.size(), 0);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void GoalKDTree::clear() {
+  _built = false;
+  _nodes.clear();
+  _points.clear();
+  _pointSlots.clear();
+  _goals.clear();
+  _available.clear();
+  _leaves.clear();
+  _slots.clear();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t GoalKDTree::buildNode(size_t begin, size_t end, size_t parent) {
+  const size_t index = _nodes.size();
+  _nodes.push_back(Node());
+  Vector2 minPt = _points[begin];
+  Vector2 maxPt = _points[begin];
+  size_t available = 0;
+  for (size_t i = begin; i < end; ++i) {
+    minPt.set(std::min(minPt.x(), _points[i].x()), std::min(minPt.y(), _points[i].y()));
+    maxPt.set(std::max(maxPt.x(), _points[i].x()), std::max(maxPt.y(), _points[i].y()));
+    available += _available[_pointSlots[i]];
+  }
+  size_t left = 0;
+  size_t right = 0;
+  if (end - begin > MAX_LEAF_SIZE) {
+    // Split at the median along the longer axis.
+    const int axis = (maxPt.x() - minPt.x()) >= (maxPt.y() - minPt.y()) ? 0 : 1;
+    std::vector<size_t> order(end - begin);
+    for (size_t i = 0; i < order.size(); ++i) order[i] = begin + i;
+    const size_t mid = order.size() / 2;
+    std::nth_element(order.begin(), order.begin() + mid, order.end(),
+                     AxisLess(_points, _pointSlots, axis));
+    std::vector<Vector2> points(order.size());
+    std::vector<size_t> slots(order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+      points[i] = _points[order[i]];
+      slots[i] = _pointSlots[order[i]];
+    }
+    std::copy(points.begin(), points.end(), _points.begin() + begin);
+    std::copy(slots.begin(), slots.end(), _pointSlots.begin() + begin);
+    left = buildNode(begin, begin + mid, index);
+    right = buildNode(begin + mid, end, index);
+  } else {
+    for (size_t i = begin; i < end; ++i) _leaves[_pointSlots[i]] = index;
+  }
+  Node& node = _nodes[index];
+  node.minPt = minPt;
+  node.maxPt = maxPt;
+  node.begin = begin;
+  node.end = end;
+  node.left = left;
+  node.right = right;
+  node.parent = parent;
+  node.available = available;
+  return index;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void GoalKDTree::setAvailable(const Goal* goal, bool available) {
+  HASH_MAP<const Goal*, size_t>::const_iterator itr = _slots.find(goal);
+  assert(itr != _slots.end() && "Changing the availability of a goal which isn't in the tree");
+  const size_t slot = itr->second;
+  if ((_available[slot] != 0) == available) return;
+  _available[slot] = available ? 1 : 0;
+  size_t node = _leaves[slot];
+  while (true) {
+    if (available) {
+      ++_nodes[node].available;
+    } else {
+      --_nodes[node].available;
+    }
+    if (node == 0) break;
+    node = _nodes[node].parent;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+Goal* GoalKDTree::getNearest(const Vector2& pt) const {
+  if (_nodes.empty()) return 0x0;
+  float bestDistSq = std::numeric_limits<float>::max();
+  size_t bestSlot = NO_SLOT;
+  searchNearest(0, pt, bestDistSq, bestSlot);
+  return bestSlot == NO_SLOT ? 0x0 : _goals[bestSlot];
+}
+
+/////////////////////////////////////////////////////////////////////
+
+Goal* GoalKDTree::getFarthest(const Vector2& pt) const {
+  if (_nodes.empty()) return 0x0;
+  float bestDistSq = -1.f;
+  size_t bestSlot = NO_SLOT;
+  searchFarthest(0, pt, bestDistSq, bestSlot);
+  return bestSlot == NO_SLOT ? 0x0 : _goals[bestSlot];
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void GoalKDTree::searchNearest(size_t index, const Vector2& pt, float& bestDistSq,
+                               size_t& bestSlot) const {
+  const Node& node = _nodes[index];
+  // Nodes at exactly the best distance are still searched; they may hold a goal with a smaller
+  // slot.
+  if (node.available == 0 || minDistSq(pt, node.minPt, node.maxPt) > bestDistSq) return;
+  if (node.left == 0) {
+    for (size_t i = node.begin; i < node.end; ++i) {
+      const size_t slot = _pointSlots[i];
+      if (!_available[slot]) continue;
+      const float distSq = absSq(_points[i] - pt);
+      if (distSq < bestDistSq || (distSq == bestDistSq && slot < bestSlot)) {
+        bestDistSq = distSq;
+        bestSlot = slot;
+      }
+    }
+    return;
+  }
+  const Node& left = _nodes[node.left];
+  const Node& right = _nodes[node.right];
+  if (minDistSq(pt, left.minPt, left.maxPt) <= minDistSq(pt, right.minPt, right.maxPt)) {
+    searchNearest(node.left, pt, bestDistSq, bestSlot);
+    searchNearest(node.right, pt, bestDistSq, bestSlot);
+  } else {
+    searchNearest(node.right, pt, bestDistSq, bestSlot);
+    searchNearest(node.left, pt, bestDistSq, bestSlot);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void GoalKDTree::searchFarthest(size_t index, const Vector2& pt, float& bestDistSq,
+                                size_t& bestSlot) const {
+  const Node& node = _nodes[index];
+  if (node.available == 0 || maxDistSq(pt, node.minPt, node.maxPt) < bestDistSq) return;
+  if (node.left == 0) {
+    for (size_t i = node.begin; i < node.end; ++i) {
+      const size_t slot = _pointSlots[i];
+      if (!_available[slot]) continue;
+      const float distSq = absSq(_points[i] - pt);
+      if (distSq > bestDistSq || (distSq == bestDistSq && slot < bestSlot)) {
+        bestDistSq = distSq;
+        bestSlot = slot;
+      }
+    }
+    return;
+  }
+  const Node& left = _nodes[node.left];
+  const Node& right = _nodes[node.right];
+  if (maxDistSq(pt, left.minPt, left.maxPt) >= maxDistSq(pt, right.minPt, right.maxPt)) {
+    searchFarthest(node.left, pt, bestDistSq, bestSlot);
+    searchFarthest(node.right, pt, bestDistSq, bestSlot);
+  } else {
+    searchFarthest(node.right, pt, bestDistSq, bestSlot);
+    searchFarthest(node.left, pt, bestDistSq, bestSlot);
+  }
+}
+
+}  // namespace BFSM
+}  // namespace Menge
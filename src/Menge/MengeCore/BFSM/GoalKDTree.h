@@ -0,0 +1,233 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+/*!
+ @file    GoalKDTree.h
+ @brief    A spatial index over the centroids of the goals in a goal set.
+ */
+
+#ifndef __GOAL_KD_TREE_H__
+#define __GOAL_KD_TREE_H__
+
+#include "MengeCore/BFSM/fsmCommon.h"
+#include "MengeCore/CoreConfig.h"
+#include "MengeCore/Math/Vector2.h"
+
+#include <vector>
+
+namespace Menge {
+
+namespace BFSM {
+
+// forward declarations
+class Goal;
+
+/*!
+ @brief    A kd-tree over goal centroids which supports nearest and farthest queries restricted to
+            the goals with available capacity.
+
+ Every node counts the available goals in its sub-tree so that sub-trees without available goals
+ are skipped. When a goal fills or frees up, the counts are updated along the path from its leaf
+ to the root.
+
+ Goals are identified by the order in which they were given to build() (their "slot"). Among goals
+ at the same distance, the goal with the smallest slot is selected.
+ */
+class MENGE_API GoalKDTree {
+ public:
+  /*!
+   @brief    Constructor.
+   */
+  GoalKDTree();
+
+  /*!
+   @brief    Builds the tree over the given goals. A goal is initially available if it has capacity.
+
+   @param    goals    The goals; the goal's index in this vector is its slot.
+   */
+  void build(const std::vector<Goal*>& goals);
+
+  /*!
+   @brief    Discards the tree.
+   */
+  void clear();
+
+  /*!
+   @brief    Reports if the tree has been built (and not cleared since).
+   */
+  bool isBuilt() const { return _built; }
+
+  /*!
+   @brief    Sets whether the given goal is available.
+
+   This updates the availability counts shared by the goal's ancestors; the caller must have
+   exclusive access to the tree (see GoalSet::lockWrite()).
+
+   @param    goal         The goal; it must have been included in build().
+   @param    available    True if the goal has capacity to be assigned to more agents.
+   */
+  void setAvailable(const Goal* goal, bool available);
+
+  /*!
+   @brief    Finds the available goal whose centroid is nearest to the given point.
+
+   @param    pt    The query point.
+   @returns  The nearest available goal, or NULL if there are no available goals.
+   */
+  Goal* getNearest(const Math::Vector2& pt) const;
+
+  /*!
+   @brief    Finds the available goal whose centroid is farthest from the given point.
+
+   @param    pt    The query point.
+   @returns  The farthest available goal, or NULL if there are no available goals.
+   */
+  Goal* getFarthest(const Math::Vector2& pt) const;
+
+ protected:
+  /*!
+   @brief    A node of the tree.
+   */
+  struct Node {
+    /*!
+     @brief    The minimum corner of the bounding box of the centroids in the node.
+     */
+    Math::Vector2 minPt;
+
+    /*!
+     @brief    The maximum corner of the bounding box of the centroids in the node.
+     */
+    Math::Vector2 maxPt;
+
+    /*!
+     @brief    The node's centroids are _points[begin] through _points[end - 1].
+     */
+    size_t begin;
+
+    /*!
+     @brief    One past the last centroid of the node.
+     */
+    size_t end;
+
+    /*!
+     @brief    The index of the left child (zero for leaves).
+     */
+    size_t left;
+
+    /*!
+     @brief    The index of the right child (zero for leaves).
+     */
+    size_t right;
+
+    /*!
+     @brief    The index of the parent (zero for the root).
+     */
+    size_t parent;
+
+    /*!
+     @brief    The number of available goals in the node.
+     */
+    size_t available;
+  };
+
+  /*!
+   @brief    Builds the sub-tree over the centroids in the range [begin, end).
+
+   @param    begin     The first centroid.
+   @param    end       One past the last centroid.
+   @param    parent    The index of the parent node.
+   @returns  The index of the new node.
+   */
+  size_t buildNode(size_t begin, size_t end, size_t parent);
+
+  /*!
+   @brief    Recursively searches for the nearest available goal.
+
+   @param    node        The node to search.
+   @param    pt          The query point.
+   @param    bestDistSq  The squared distance to the best goal so far.
+   @param    bestSlot    The slot of the best goal so far.
+   */
+  void searchNearest(size_t node, const Math::Vector2& pt, float& bestDistSq,
+                     size_t& bestSlot) const;
+
+  /*!
+   @brief    Recursively searches for the farthest available goal.
+
+   @param    node        The node to search.
+   @param    pt          The query point.
+   @param    bestDistSq  The squared distance to the best goal so far.
+   @param    bestSlot    The slot of the best goal so far.
+   */
+  void searchFarthest(size_t node, const Math::Vector2& pt, float& bestDistSq,
+                      size_t& bestSlot) const;
+
+  /*!
+   @brief    The maximum number of goals in a leaf.
+   */
+  static const size_t MAX_LEAF_SIZE;
+
+  /*!
+   @brief    The slot value indicating that no goal has been found.
+   */
+  static const size_t NO_SLOT;
+
+  /*!
+   @brief    Reports if the tree has been built.
+   */
+  bool _built;
+
+  /*!
+   @brief    The nodes of the tree; the root is node zero.
+   */
+  std::vector<Node> _nodes;
+
+  /*!
+   @brief    The goal centroids, in tree order.
+   */
+  std::vector<Math::Vector2> _points;
+
+  /*!
+   @brief    The slot of each centroid in _points.
+   */
+  std::vector<size_t> _pointSlots;
+
+  /*!
+   @brief    The goals, by slot.
+   */
+  std::vector<Goal*> _goals;
+
+  /*!
+   @brief    Reports if each goal is available, by slot.
+   */
+  std::vector<char> _available;
+
+  /*!
+   @brief    The leaf containing each goal, by slot.
+   */
+  std::vector<size_t> _leaves;
+
+  /*!
+   @brief    The slot of each goal.
+   */
+  HASH_MAP<const Goal*, size_t> _slots;
+};
+}  // namespace BFSM
+}  // namespace Menge
+
+#endif  // __GOAL_KD_TREE_H__
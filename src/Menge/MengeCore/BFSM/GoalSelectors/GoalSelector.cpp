@@ -42,6 +42,8 @@ Any questions or comments should be sent to the authors {menge,geom}@cs.unc.edu
 #include "MengeCore/BFSM/GoalSelectors/GoalSelectorDatabase.h"
 #include "MengeCore/BFSM/Goals/Goal.h"
 
+#include <cassert>
+
 namespace Menge {
 
 namespace BFSM {
@@ -51,67 +53,88 @@ namespace BFSM {
 /////////////////////////////////////////////////////////////////////
 
 Goal* GoalSelector::assignGoal(const Agents::BaseAgent* agent) {
-  Goal* goal = 0x0;
-  if (_persistent) {
-    _lock.lockRead();
-    HASH_MAP<size_t, Goal*>::iterator itr = _assignedGoals.find(agent->_id);
-    if (itr != _assignedGoals.end()) {
-      goal = itr->second;
-    }
-    _lock.releaseRead();
-    if (goal) return goal;
-  }
+  if (_persistent && _assignedGoals[agent->_id] != 0x0) return _assignedGoals[agent->_id];
 
   // Either not persistent, or no goal previously assigned
   lockResources();
-  goal = getGoal(agent);
+  const Goal* full = 0x0;
+  Goal* goal = selectAndReserve(agent, full);
+  // The resources must be released before logging and throwing; other agents still need them.
+  releaseResources();
   if (goal == 0x0) {
-    logger << Logger::ERR_MSG << "Goal selector unable to create goal for agent ";
-    logger << agent->_id << ".";
+    if (full == 0x0) {
+      logger << Logger::ERR_MSG << "Goal selector unable to create goal for agent ";
+      logger << agent->_id << ".";
+    } else {
+      logger << Logger::ERR_MSG << "Couldn't assign agent " << agent->_id << " to goal ";
+      logger << full->getID() << ".";
+    }
     throw GoalSelectorException();
   }
-  try {
-    goal->assign(agent);
-  } catch (GoalException) {
-    logger << Logger::ERR_MSG << "Couldn't assign agent " << agent->_id << " to goal ";
-    logger << goal->getID() << ".";
-    throw GoalSelectorException();
+  recordGoal(agent, goal);
+  return goal;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t GoalSelector::assignGoals(const std::vector<const Agents::BaseAgent*>& agents,
+                                 std::vector<Goal*>& goals) {
+  goals.assign(agents.size(), 0x0);
+  size_t assigned = 0;
+  const Goal* full = 0x0;
+  lockResources();
+  for (size_t i = 0; i < agents.size(); ++i) {
+    const Agents::BaseAgent* agent = agents[i];
+    if (_persistent && _assignedGoals[agent->_id] != 0x0) {
+      goals[i] = _assignedGoals[agent->_id];
+    } else {
+      // Running out of capacity is expected; the caller learns of it from the count.
+      goals[i] = selectAndReserve(agent, full);
+      if (goals[i] == 0x0) continue;
+      recordGoal(agent, goals[i]);
+    }
+    ++assigned;
   }
   releaseResources();
+  return assigned;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+Goal* GoalSelector::selectAndReserve(const Agents::BaseAgent* agent, const Goal*& full) {
+  full = 0x0;
+  Goal* goal = getGoal(agent);
+  if (goal == 0x0) return 0x0;
+  if (!goal->tryAssign()) {
+    full = goal;
+    return 0x0;
+  }
+  return goal;
+}
 
+/////////////////////////////////////////////////////////////////////
+
+void GoalSelector::recordGoal(const Agents::BaseAgent* agent, Goal* goal) {
 #ifdef _DEBUG
   // In debug mode, always store the assigned goal
-  _lock.lockWrite();
   _assignedGoals[agent->_id] = goal;
-  _lock.releaseWrite();
 #else
   // In release mode, only assign it if persistent
-  if (_persistent) {
-    _lock.lockWrite();
-    _assignedGoals[agent->_id] = goal;
-    _lock.releaseWrite();
-  }
+  if (_persistent) _assignedGoals[agent->_id] = goal;
 #endif
-  return goal;
 }
 
 /////////////////////////////////////////////////////////////////////
 
 void GoalSelector::freeGoal(const Agents::BaseAgent* agent, Goal* goal) {
 #ifdef _DEBUG
-  _lock.lockWrite();
-  assert(_assignedGoals.count(agent->_id) == 1 &&
+  assert(!_assignedGoals.isEmpty(agent->_id) &&
          "Trying to free a goal from an agent that hasn't actually been assigned.");
   assert(_assignedGoals[agent->_id] == goal && "Trying to free the wrong goal from the agent");
-  _lock.releaseWrite();
 #endif
   if (!_persistent) {
     goal->free();
-#ifdef _DEBUG
-    _lock.lockWrite();
-    _assignedGoals.erase(agent->_id);
-    _lock.releaseWrite();
-#endif
+    _assignedGoals.clear(agent->_id);
   }
 }
 
@@ -24,13 +24,14 @@
 #ifndef __GOAL_SELECTOR_H__
 #define __GOAL_SELECTOR_H__
 
+#include "MengeCore/BFSM/AgentSideTable.h"
 #include "MengeCore/BFSM/fsmCommon.h"
 #include "MengeCore/CoreConfig.h"
 #include "MengeCore/MengeException.h"
 #include "MengeCore/PluginEngine/Element.h"
-#include "MengeCore/Runtime/ReadersWriterLock.h"
 
 #include <map>
+#include <vector>
 
 // forward declaration
 class TiXmlElement;
@@ -95,7 +96,7 @@ class MENGE_API GoalSelector : public Element {
   /*!
    @brief    Default constructor.
    */
-  GoalSelector() : Element(), _persistent(false), _assignedGoals() {}
+  GoalSelector() : Element(), _persistent(false), _assignedGoals(0x0) {}
 
  protected:
   /*!
@@ -116,6 +117,27 @@ class MENGE_API GoalSelector : public Element {
    */
   Goal* assignGoal(const Agents::BaseAgent* agent);
 
+  /*!
+   @brief    Assigns goals to a batch of agents.
+
+   This is equivalent to calling assignGoal() for each agent (in order), except that the selector's
+   resources are locked once for the whole batch and that failures are reported through the
+   returned count and the NULL goals instead of by exception or log message. If the goals run out
+   of capacity part way through the batch, the agents that couldn't be served receive no goal; no
+   goal is ever assigned beyond its capacity.
+
+   This is the hook used when a batch of agents enters a state (see State::enter()). Sub-classes can
+   override it to select goals for the whole batch at once, but must keep the bookkeeping of
+   selectAndReserve() and recordGoal().
+
+   @param    agents    The agents for whom goals are assigned.
+   @param    goals     The assigned goal of each agent; NULL for agents who couldn't be assigned a
+                      goal.
+   @returns  The number of agents who were assigned a goal.
+   */
+  virtual size_t assignGoals(const std::vector<const Agents::BaseAgent*>& agents,
+                             std::vector<Goal*>& goals);
+
   /*!
    @brief    Informs the goal selector that the agent is done with the goal.
 
@@ -178,6 +200,26 @@ class MENGE_API GoalSelector : public Element {
    */
   virtual void releaseResources() {}
 
+  /*!
+   @brief    Selects a goal for the agent and claims its capacity; the resources must be locked.
+
+   Nothing is logged; the caller decides whether a failure is worth reporting.
+
+   @param    agent    The agent for whom a goal is selected.
+   @param    full     Set to the selected goal if it had no capacity left; NULL otherwise.
+   @returns  The assigned goal; NULL if no goal could be assigned.
+   */
+  Goal* selectAndReserve(const Agents::BaseAgent* agent, const Goal*& full);
+
+  /*!
+   @brief    Records the goal assigned to the agent (as required by persistence and, in debug mode,
+            the validation in freeGoal()).
+
+   @param    agent    The agent.
+   @param    goal     The goal assigned to the agent.
+   */
+  void recordGoal(const Agents::BaseAgent* agent, Goal* goal);
+
   /*!
    @brief    Determines if the GoalSelector maintains persistent goals.
 
@@ -188,18 +230,15 @@ class MENGE_API GoalSelector : public Element {
   bool _persistent;
 
   /*!
-   @brief    A mapping from agent id to assigned goals.
+   @brief    The assigned goal of each agent (indexed by agent id; NULL if none).
 
    This will only contain meaningful values in one of two cases:
    - If the selector is persistent.
-   - If compiled in debug mode (and then node freeing will be tested against this map).
-   */
-  HASH_MAP<size_t, Goal*> _assignedGoals;
+   - If compiled in debug mode (and then node freeing will be tested against this table).
 
-  /*!
-   @brief    The lock to maintain readers-writer access to the _assignedGoals
+   Each agent's entry is only touched by the thread updating that agent; no lock is required.
    */
-  ReadersWriterLock _lock;
+  AgentSideTable<Goal*> _assignedGoals;
 };
 
 /*!
@@ -59,6 +59,14 @@ Goal* ExplicitGoalSelector::getGoal(const Agents::BaseAgent* agent) const { retu
 
 /////////////////////////////////////////////////////////////////////
 
+void ExplicitGoalSelector::lockResources() { _goal->getGoalSet()->lockWrite(); }
+
+/////////////////////////////////////////////////////////////////////
+
+void ExplicitGoalSelector::releaseResources() { _goal->getGoalSet()->releaseWrite(); }
+
+/////////////////////////////////////////////////////////////////////
+
 void ExplicitGoalSelector::setGoalSet(std::map<size_t, GoalSet*>& goalSets) {
   if (goalSets.count(_goalSetID) == 1) {
     GoalSet* gs = goalSets[_goalSetID];
@@ -81,6 +81,17 @@ class MENGE_API ExplicitGoalSelector : public GoalSelector {
   void setGoalID(size_t id) { _goalID = id; }
 
  protected:
+  /*!
+   @brief    Locks the goal's goal set for exclusive access; assigning the goal can fill it, which
+            changes the goal set's available goals (see SetGoalSelector::lockResources()).
+   */
+  virtual void lockResources();
+
+  /*!
+   @brief    Releases the goal set locked by lockResources().
+   */
+  virtual void releaseResources();
+
   /*!
    @brief    The id of the goal set to draw from.
    */
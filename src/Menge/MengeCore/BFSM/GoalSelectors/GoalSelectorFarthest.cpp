@@ -60,23 +60,7 @@ Goal* FarthestGoalSelector::getGoal(const Agents::BaseAgent* agent) const {
     logger << agent->_id << ".  There were no available goals in the goal set.";
     return 0x0;
   }
-  const Vector2 p = agent->_pos;
-
-  Goal* bestGoal;
-
-  bestGoal = _goalSet->getIthGoal(0);
-  Vector2 disp = bestGoal->getCentroid() - p;
-  float bestDist = absSq(disp);
-  for (size_t i = 1; i < GOAL_COUNT; ++i) {
-    Goal* testGoal = _goalSet->getIthGoal(i);
-    disp = testGoal->getCentroid() - p;
-    float testDist = absSq(disp);
-    if (testDist > bestDist) {
-      bestDist = testDist;
-      bestGoal = testGoal;
-    }
-  }
-  return bestGoal;
+  return _goalSet->getFarthestGoal(agent->_pos);
 }
 }  // namespace BFSM
 }  // namespace Menge
@@ -86,15 +86,20 @@ Goal* NearestNMGoalSelector::getGoal(const Agents::BaseAgent* agent) const {
   Goal* bestGoal = 0x0;
   float bestDist = 1e6f;
 
+  PathPlanner* planner = _localizer->getPlanner();
   for (size_t i = 0; i < GOAL_COUNT; ++i) {
     Goal* testGoal = _goalSet->getIthGoal(i);
-    unsigned int testNode = _localizer->getNode(testGoal->getCentroid());
+    unsigned int testNode = getGoalNode(testGoal);
     if (testNode == NavMeshLocation::NO_NODE) {
       // silently skip it.  The centroid is not on the mesh
       continue;
     }
-    PortalRoute* route = _localizer->getPlanner()->getRoute(start, testNode, agentDiameter);
-    float length = route->getLength();
+    // The lengths of the paths to the goal are shared by all agents with the same diameter.
+    float length = planner->getPathLengths(testNode, agentDiameter)[start];
+    if (length < 0.f) {
+      // silently skip it.  The goal can't be reached from the agent's node.
+      continue;
+    }
     if (length < bestDist) {
       bestDist = length;
       bestGoal = testGoal;
@@ -117,6 +122,24 @@ Goal* NearestNMGoalSelector::getGoal(const Agents::BaseAgent* agent) const {
 
 /////////////////////////////////////////////////////////////////////
 
+unsigned int NearestNMGoalSelector::getGoalNode(const Goal* goal) const {
+  unsigned int node = NavMeshLocation::NO_NODE;
+  _goalNodeLock.lockRead();
+  HASH_MAP<const Goal*, unsigned int>::const_iterator itr = _goalNodes.find(goal);
+  const bool found = itr != _goalNodes.end();
+  if (found) node = itr->second;
+  _goalNodeLock.releaseRead();
+  if (!found) {
+    node = _localizer->getNode(goal->getCentroid());
+    _goalNodeLock.lockWrite();
+    _goalNodes[goal] = node;
+    _goalNodeLock.releaseWrite();
+  }
+  return node;
+}
+
+/////////////////////////////////////////////////////////////////////
+
 BFSM::Task* NearestNMGoalSelector::getTask() {
   return new NavMeshLocalizerTask(_navMesh->getName(), true /*usePlanner*/);
 }
@@ -90,6 +90,16 @@ class MENGE_API NearestNMGoalSelector : public SetGoalSelector {
   void setNavMeshLocalizer(const NavMeshLocalizerPtr& nml) { _localizer = nml; }
 
  protected:
+  /*!
+   @brief    Reports the navigation mesh node containing the given goal's centroid.
+
+   Goals don't move; the node is located once per goal and cached.
+
+   @param    goal    The goal.
+   @returns  The index of the node; NavMeshLocation::NO_NODE if the centroid is not on the mesh.
+   */
+  unsigned int getGoalNode(const Goal* goal) const;
+
   /*!
    @brief    The navigation mesh.
    */
@@ -99,6 +109,16 @@ class MENGE_API NearestNMGoalSelector : public SetGoalSelector {
    @brief    The localizer for the navigation mesh.
    */
   NavMeshLocalizerPtr _localizer;
+
+  /*!
+   @brief    The cached navigation mesh node of each goal (see getGoalNode()).
+   */
+  mutable HASH_MAP<const Goal*, unsigned int> _goalNodes;
+
+  /*!
+   @brief    Lock for securing _goalNodes.
+   */
+  mutable ReadersWriterLock _goalNodeLock;
 };
 
 /*!
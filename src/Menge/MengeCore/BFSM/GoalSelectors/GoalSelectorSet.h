@@ -71,15 +71,18 @@ class MENGE_API SetGoalSelector : public GoalSelector {
    This is primarily here so that GoalSelectors which use shared resources have a chance to lock
    them (see SetGoalSelector). A call to lockResources should always be followed by a call to
    releeaseResources().
+
+   The goal set is locked for exclusive access: assigning a goal can fill it, which changes the
+   goal set's available goals and spatial index.
    */
-  virtual void lockResources() { _goalSet->lockRead(); }
+  virtual void lockResources() { _goalSet->lockWrite(); }
 
   /*!
    @brief    Allows the goal selector to release previously locked resources.
 
    Should be used in conjunction with lockResources.
    */
-  virtual void releaseResources() { _goalSet->releaseRead(); }
+  virtual void releaseResources() { _goalSet->releaseWrite(); }
 
   /*!
    @brief    The goal set associated with this goal selector.
@@ -68,20 +68,38 @@ GoalSet::~GoalSet() {
 
 bool GoalSet::addGoal(size_t id, Goal* goal) {
   bool valid = false;
-  _lock.lockRead();
+  _lock.lockWrite();
   if (_goals.find(id) == _goals.end()) {
     valid = true;
     goal->_goalSet = this;
     _goals[id] = goal;
+    goal->_availableIndex = _goalIDs.size();
     _goalIDs.push_back(id);
     _totalWeight += goal->_weight;
+    _index.clear();
   }
-  _lock.releaseRead();
+  _lock.releaseWrite();
   return valid;
 }
 
 /////////////////////////////////////////////////////////////////////
 
+void GoalSet::buildIndex() {
+  // The order of the available goals defines the slots; ties in distance then resolve to the same
+  // goal as a linear scan over the available goals would.
+  std::vector<Goal*> goals;
+  for (size_t i = 0; i < _goalIDs.size(); ++i) {
+    goals.push_back(_goals[_goalIDs[i]]);
+  }
+  std::map<size_t, Goal*>::const_iterator itr = _goals.begin();
+  for (; itr != _goals.end(); ++itr) {
+    if (!itr->second->hasCapacity()) goals.push_back(itr->second);
+  }
+  _index.build(goals);
+}
+
+/////////////////////////////////////////////////////////////////////
+
 Goal* GoalSet::getGoalByID(size_t id) {
   Goal* goal = 0x0;
   std::map<size_t, Goal*>::const_iterator itr = _goals.find(id);
@@ -125,6 +143,42 @@ Goal* GoalSet::getIthGoalConcurrent(size_t i) {
 
 /////////////////////////////////////////////////////////////////////
 
+Goal* GoalSet::getNearestGoal(const Math::Vector2& pt) {
+  if (_index.isBuilt()) return _index.getNearest(pt);
+  Goal* bestGoal = 0x0;
+  float bestDist = 0.f;
+  for (size_t i = 0; i < _goalIDs.size(); ++i) {
+    Goal* testGoal = getIthGoal(i);
+    if (testGoal == 0x0) continue;
+    const float testDist = absSq(testGoal->getCentroid() - pt);
+    if (bestGoal == 0x0 || testDist < bestDist) {
+      bestDist = testDist;
+      bestGoal = testGoal;
+    }
+  }
+  return bestGoal;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+Goal* GoalSet::getFarthestGoal(const Math::Vector2& pt) {
+  if (_index.isBuilt()) return _index.getFarthest(pt);
+  Goal* bestGoal = 0x0;
+  float bestDist = 0.f;
+  for (size_t i = 0; i < _goalIDs.size(); ++i) {
+    Goal* testGoal = getIthGoal(i);
+    if (testGoal == 0x0) continue;
+    const float testDist = absSq(testGoal->getCentroid() - pt);
+    if (bestGoal == 0x0 || testDist > bestDist) {
+      bestDist = testDist;
+      bestGoal = testGoal;
+    }
+  }
+  return bestGoal;
+}
+
+/////////////////////////////////////////////////////////////////////
+
 size_t GoalSet::sizeConcurrent() const {
   _lock.lockRead();
   size_t s = _goalIDs.size();
@@ -173,43 +227,45 @@ Goal* GoalSet::getRandomWeightedGoal() {
 
 /////////////////////////////////////////////////////////////////////
 
-void GoalSet::setGoalFull(const Goal* goal) const {
-  size_t i = 0;
-  std::map<size_t, Goal*>::const_iterator itr;
-  while (i < _goalIDs.size()) {
-    itr = _goals.find(_goalIDs[i]);
-    assert(itr != _goals.end() && "A goalID does not map to a goal");
-    const Goal* testGoal = itr->second;
-    if (testGoal == goal) {
-      _totalWeight -= goal->_weight;
-      _goalIDs.erase(_goalIDs.begin() + i);  // todo: should this just be itr?
-      break;
-    } else {
-      ++i;
-    }
-  }
-}
+void GoalSet::setGoalFull(const Goal* goal) const { updateAvailability(goal); }
 
 /////////////////////////////////////////////////////////////////////
 
 void GoalSet::setGoalAvailable(const Goal* goal) const {
-  const size_t GOAL_ID = goal->getID();
   _lock.lockWrite();
+  updateAvailability(goal);
+  _lock.releaseWrite();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void GoalSet::updateAvailability(const Goal* goal) const {
+  const size_t GOAL_ID = goal->getID();
   assert(_goals.find(GOAL_ID) != _goals.end() &&
-         "Trying to set a goal available that doesn't belong to the goal set");
-#ifdef _DEBUG
-  bool found = false;
-  for (size_t i = 0; i < _goalIDs.size(); ++i) {
-    if (_goalIDs[i] == GOAL_ID) {
-      found = true;
-      break;
+         "Trying to change the availability of a goal that doesn't belong to the goal set");
+  // Each goal knows its position in the list; an unavailable goal is swapped with the last one.
+  const size_t UNLISTED = -1;
+  const bool listed = goal->_availableIndex != UNLISTED;
+  const bool available = goal->hasCapacity();
+  if (listed == available) return;
+  if (available) {
+    goal->_availableIndex = _goalIDs.size();
+    _goalIDs.push_back(GOAL_ID);
+    _totalWeight += goal->_weight;
+  } else {
+    const size_t index = goal->_availableIndex;
+    assert(_goalIDs[index] == GOAL_ID && "A goal's position in the available goals is stale");
+    if (index + 1 < _goalIDs.size()) {
+      _goalIDs[index] = _goalIDs.back();
+      std::map<size_t, Goal*>::const_iterator moved = _goals.find(_goalIDs[index]);
+      assert(moved != _goals.end() && "A goalID does not map to a goal");
+      moved->second->_availableIndex = index;
     }
+    _goalIDs.pop_back();
+    goal->_availableIndex = UNLISTED;
+    _totalWeight -= goal->_weight;
   }
-  assert(!found && "Trying to reactivate a goal that was never marked unavailable");
-#endif
-  _goalIDs.push_back(GOAL_ID);
-  _totalWeight += goal->_weight;
-  _lock.releaseWrite();
+  if (_index.isBuilt()) _index.setAvailable(goal, available);
 }
 
 }  // namespace BFSM
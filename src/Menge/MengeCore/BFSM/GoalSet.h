@@ -24,6 +24,7 @@
 #ifndef __GOALSET_H__
 #define __GOALSET_H__
 
+#include "MengeCore/BFSM/GoalKDTree.h"
 #include "MengeCore/BFSM/fsmCommon.h"
 #include "MengeCore/Math/RandGenerator.h"
 #include "MengeCore/Runtime/ReadersWriterLock.h"
@@ -63,9 +64,20 @@ class MENGE_API GoalSet {
             set, the goal is added and true is returned. Otherwise, nothing is changed and false is
             returned. Once a goal is added to the GoalSet, the GoalSet takes responsibility for
             freeing the memory.
+
+   Adding a goal invalidates the spatial index (see buildIndex()).
    */
   bool addGoal(size_t id, Goal* goal);
 
+  /*!
+   @brief    Builds the spatial index over the goals' centroids used by getNearestGoal() and
+            getFarthestGoal().
+
+   This is not thread-safe; it is called once the goal set is complete (see buildFSM()). Until the
+   index is built (and after goals are added), the queries fall back to testing every goal.
+   */
+  void buildIndex();
+
   /*!
    @brief    Returns the goal with the given user-defined identifier.
 
@@ -82,7 +94,8 @@ class MENGE_API GoalSet {
    @brief    Returns the goal with the given user-defined identifier.
 
    This is the identifier given the behavior specification. This operation is thread-safe. But it
-   should not be called in the same thread that has already called GoalSet::lockRead.
+   should not be called in the same thread that has already called GoalSet::lockRead or
+   GoalSet::lockWrite.
 
    @param    id    The identifier of the desired goal.
    @returns  A pointer to the desired goal. If the goal doesn't exist, NULL is returned. Also, if the
@@ -108,7 +121,8 @@ class MENGE_API GoalSet {
             identifier).
             
    Merely the order in which the goals are ordered in the set. This operation is thread-safe. But it
-   should not be called in the same thread that has already called GoalSet::lockRead().
+   should not be called in the same thread that has already called GoalSet::lockRead() or
+   GoalSet::lockWrite().
 
    @param    i    The ith goal in the set -- order is undefined.
    @returns  A pointer to the desired goal. NULL is returned if the index exceeds the number of
@@ -116,6 +130,28 @@ class MENGE_API GoalSet {
    */
   Goal* getIthGoalConcurrent(size_t i);
 
+  /*!
+   @brief    Returns the *available* goal whose centroid is nearest to the given point.
+
+   This operation is not thread-safe. It should only be used in a context that is known to be
+   "safe" (e.g., while holding the goal set's lock; see lockRead()).
+
+   @param    pt    The query point.
+   @returns  A pointer to the nearest available goal. NULL is returned if no goal is available.
+   */
+  Goal* getNearestGoal(const Math::Vector2& pt);
+
+  /*!
+   @brief    Returns the *available* goal whose centroid is farthest from the given point.
+
+   This operation is not thread-safe. It should only be used in a context that is known to be
+   "safe" (e.g., while holding the goal set's lock; see lockRead()).
+
+   @param    pt    The query point.
+   @returns  A pointer to the farthest available goal. NULL is returned if no goal is available.
+   */
+  Goal* getFarthestGoal(const Math::Vector2& pt);
+
   /*!
    @brief    Reports the number of goals in the set.  *Not* thread safe.
 
@@ -154,12 +190,26 @@ class MENGE_API GoalSet {
    */
   void releaseRead() { _lock.releaseRead(); }
 
+  /*!
+   @brief    Locks the goal set for exclusive access.
+
+   Assigning an agent to a goal can fill the goal and change the set of available goals (see
+   Goal::tryAssign()); goals must be selected and assigned while holding this lock.
+   */
+  void lockWrite() { _lock.lockWrite(); }
+
+  /*!
+   @brief    Unlocks the goal set from exclusive access.
+   */
+  void releaseWrite() { _lock.releaseWrite(); }
+
   friend class Goal;
 
  protected:
   /*!
    @brief    Informs the goal set that the given goal has reached its capacity and should no longer
-            be considered.
+            be considered. The caller holds the goal set's write lock (see lockWrite() and
+            Goal::tryAssign()).
    */
   void setGoalFull(const Goal* goal) const;
 
@@ -169,6 +219,15 @@ class MENGE_API GoalSet {
    */
   void setGoalAvailable(const Goal* goal) const;
 
+  /*!
+   @brief    Lists the goal among the available goals if, and only if, it currently has capacity.
+
+   Goals change their population without a lock (see Goal::tryAssign() and Goal::free()); by the
+   time the goal set learns that a goal filled up (or freed up), it may already have changed back.
+   The goal set's write lock must be held.
+   */
+  void updateAvailability(const Goal* goal) const;
+
   /*!
    @brief    The underlying mapping from user-specified goal identifier to goal
    */
@@ -179,6 +238,11 @@ class MENGE_API GoalSet {
    */
   mutable std::vector<size_t> _goalIDs;
 
+  /*!
+   @brief    The spatial index over the goals' centroids; it tracks which goals are available.
+   */
+  mutable GoalKDTree _index;
+
   /*!
    @brief    The sum of all goal weights
    */
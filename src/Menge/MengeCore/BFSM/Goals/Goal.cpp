@@ -71,30 +71,30 @@ void Goal::setGeometry(Math::Geometry2D* geometry) {
 
 /////////////////////////////////////////////////////////////////////
 
-bool Goal::hasCapacity() const {
-  _lock.lockRead();
-  bool result = _population < _capacity;
-  _lock.releaseRead();
-  return result;
+bool Goal::hasCapacity() const { return _population.load() < _capacity; }
+
+/////////////////////////////////////////////////////////////////////
+
+bool Goal::tryAssign() {
+  size_t population = _population.load();
+  do {
+    if (population >= _capacity) return false;
+  } while (!_population.compare_exchange_weak(population, population + 1));
+  if (population + 1 == _capacity && _goalSet) _goalSet->setGoalFull(this);
+  return true;
 }
 
 /////////////////////////////////////////////////////////////////////
 
 void Goal::assign(const Agents::BaseAgent* agent) {
-  _lock.lockWrite();
-  ++_population;
-  if (_population > _capacity) throw GoalException();
-  if (_population >= _capacity && _goalSet) _goalSet->setGoalFull(this);
-  _lock.releaseWrite();
+  if (!tryAssign()) throw GoalException();
 }
 
 /////////////////////////////////////////////////////////////////////
 
 void Goal::free() {
-  _lock.lockWrite();
-  if (_population >= _capacity && _goalSet) _goalSet->setGoalAvailable(this);
-  --_population;
-  _lock.releaseWrite();
+  const size_t population = _population.fetch_sub(1);
+  if (population == _capacity && _goalSet) _goalSet->setGoalAvailable(this);
 }
 
 /////////////////////////////////////////////////////////////////////
@@ -29,7 +29,8 @@
 #include "MengeCore/Math/Geometry2D.h"
 #include "MengeCore/MengeException.h"
 #include "MengeCore/PluginEngine/Element.h"
-#include "MengeCore/Runtime/ReadersWriterLock.h"
+
+#include <atomic>
 
 // forward declaration
 class TiXmlElement;
@@ -98,6 +99,7 @@ class MENGE_API Goal : public Element {
         _capacity(MAX_CAPACITY),
         _id(-1),
         _goalSet(0x0),
+        _availableIndex(-1),
         _population(0),
         _geometry(0x0) {}
   // -1 is the biggest value for size_t
@@ -181,19 +183,37 @@ class MENGE_API Goal : public Element {
   /*!
    @brief    Reports if the goal still has capacity.
 
+   This doesn't lock; the answer may be out of date as soon as it is returned. Use tryAssign() to
+   claim capacity.
+
    @returns  True if the goal has remaining capacity, false otherwise.
    */
   bool hasCapacity() const;
 
   /*!
-   @brief    Inform the goal that it has been assigned.
+   @brief    Claims one unit of the goal's capacity, if there is any left.
+
+   The population is updated with an atomic compare-and-swap so concurrent assignments can never
+   exceed the capacity. If this assignment fills the goal, the goal's goal set is informed; so, for
+   a goal in a goal set, the caller must hold the goal set's write lock (see GoalSet::lockWrite()).
+
+   @returns  True if the goal was assigned, false if it was already full.
+   */
+  bool tryAssign();
+
+  /*!
+   @brief    Inform the goal that it has been assigned (see tryAssign()).
 
    @param    agent    The agent that has been assigned to this goal.
+   @throws    GoalException if the goal is already full.
    */
   void assign(const Agents::BaseAgent* agent);
 
   /*!
    @brief    Inform the goal that an assignment has been removed.
+
+   If the goal had been full, its goal set is informed; the caller must *not* hold the goal set's
+   lock.
    */
   void free();
 
@@ -312,21 +332,21 @@ class MENGE_API Goal : public Element {
    */
   GoalSet* _goalSet;
 
+  /*!
+   @brief    The position of this goal in its goal set's list of available goals (-1 if it isn't
+             listed); maintained by the goal set.
+   */
+  mutable size_t _availableIndex;
+
   /*!
    @brief    The current "population" of this goal.
 
-   In other words, it is the number of times "getGoalPoint" has been called on this goal.
+   In other words, it is the number of agents currently assigned to this goal.
    */
-  mutable size_t _population;
+  std::atomic<size_t> _population;
 
   /*! @brief  The underlying geometry for the goal. */
   Math::Geometry2D* _geometry;
-
-  /*!
-   @brief    The lock to maintain readers-writer access to the structure which control available
-            goals.
-   */
-  ReadersWriterLock _lock;
 };
 
 /*!
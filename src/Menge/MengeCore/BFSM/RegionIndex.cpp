@@ -0,0 +1,159 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#include "MengeCore/BFSM/RegionIndex.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Menge {
+
+namespace BFSM {
+
+using Math::Vector2;
+
+/////////////////////////////////////////////////////////////////////
+//                   Implementation of RegionIndex
+/////////////////////////////////////////////////////////////////////
+
+const size_t RegionIndex::NO_CELL = static_cast<size_t>(-1);
+
+namespace {
+// The amount by which region bounds are inflated: an absolute amount plus an amount proportional to
+// the magnitude of the coordinates.
+const float PADDING = 1e-3f;
+const float RELATIVE_PADDING = 1e-5f;
+// The target number of cells per region and the maximum number of cells along either axis.
+const float CELLS_PER_REGION = 4.f;
+const size_t MAX_CELLS = 1024;
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////
+
+RegionIndex::RegionIndex() : _origin(0.f, 0.f), _invCellSize(1.f), _width(0), _height(0) {}
+
+/////////////////////////////////////////////////////////////////////
+
+void RegionIndex::clear() {
+  _minPts.clear();
+  _maxPts.clear();
+  _cellStart.clear();
+  _cellRegions.clear();
+  _width = _height = 0;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+unsigned int RegionIndex::addRegion(const Vector2& minPt, const Vector2& maxPt) {
+  const float magnitude = std::max(std::max(std::fabs(minPt.x()), std::fabs(minPt.y())),
+                                  std::max(std::fabs(maxPt.x()), std::fabs(maxPt.y())));
+  const float pad = PADDING + RELATIVE_PADDING * magnitude;
+  _minPts.push_back(minPt - Vector2(pad, pad));
+  _maxPts.push_back(maxPt + Vector2(pad, pad));
+  return static_cast<unsigned int>(_minPts.size() - 1);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void RegionIndex::build() {
+  _cellStart.clear();
+  _cellRegions.clear();
+  _width = _height = 0;
+  if (_minPts.empty()) return;
+
+  Vector2 minPt = _minPts[0];
+  Vector2 maxPt = _maxPts[0];
+  for (size_t r = 1; r < _minPts.size(); ++r) {
+    minPt.set(std::min(minPt.x(), _minPts[r].x()), std::min(minPt.y(), _minPts[r].y()));
+    maxPt.set(std::max(maxPt.x(), _maxPts[r].x()), std::max(maxPt.y(), _maxPts[r].y()));
+  }
+  const Vector2 extent = maxPt - minPt;
+  float cellSize =
+      std::sqrt(extent.x() * extent.y() / (CELLS_PER_REGION * static_cast<float>(_minPts.size())));
+  const float maxExtent = std::max(extent.x(), extent.y());
+  cellSize = std::max(cellSize, maxExtent / static_cast<float>(MAX_CELLS));
+  _origin = minPt;
+  _invCellSize = 1.f / cellSize;
+  _width = std::min(MAX_CELLS, static_cast<size_t>(extent.x() * _invCellSize) + 1);
+  _height = std::min(MAX_CELLS, static_cast<size_t>(extent.y() * _invCellSize) + 1);
+
+  // Counting pass, followed by the filling pass; region ids are appended in increasing order.
+  _cellStart.assign(_width * _height + 1, 0);
+  for (int pass = 0; pass < 2; ++pass) {
+    std::vector<size_t> fill;
+    if (pass == 1) {
+      for (size_t c = 1; c < _cellStart.size(); ++c) _cellStart[c] += _cellStart[c - 1];
+      _cellRegions.resize(_cellStart.back());
+      fill.assign(_cellStart.begin(), _cellStart.end() - 1);
+    }
+    for (size_t r = 0; r < _minPts.size(); ++r) {
+      const size_t x0 = static_cast<size_t>((_minPts[r].x() - _origin.x()) * _invCellSize);
+      const size_t y0 = static_cast<size_t>((_minPts[r].y() - _origin.y()) * _invCellSize);
+      const size_t x1 = std::min(
+          _width - 1, static_cast<size_t>((_maxPts[r].x() - _origin.x()) * _invCellSize));
+      const size_t y1 = std::min(
+          _height - 1, static_cast<size_t>((_maxPts[r].y() - _origin.y()) * _invCellSize));
+      for (size_t y = y0; y <= y1; ++y) {
+        for (size_t x = x0; x <= x1; ++x) {
+          const size_t cell = y * _width + x;
+          if (pass == 0) {
+            ++_cellStart[cell + 1];
+          } else {
+            _cellRegions[fill[cell]++] = static_cast<unsigned int>(r);
+          }
+        }
+      }
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t RegionIndex::getCell(const Vector2& pt) const {
+  const float x = (pt.x() - _origin.x()) * _invCellSize;
+  const float y = (pt.y() - _origin.y()) * _invCellSize;
+  if (x < 0.f || y < 0.f) return NO_CELL;
+  const size_t cx = static_cast<size_t>(x);
+  const size_t cy = static_cast<size_t>(y);
+  if (cx >= _width || cy >= _height) return NO_CELL;
+  return cy * _width + cx;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool RegionIndex::mayContain(size_t cell, unsigned int region) const {
+  if (cell == NO_CELL) return false;
+  const unsigned int* first = &_cellRegions[0] + _cellStart[cell];
+  const unsigned int* last = &_cellRegions[0] + _cellStart[cell + 1];
+  return std::binary_search(first, last, region);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void RegionIndex::getRegions(size_t cell, const unsigned int*& begin,
+                             const unsigned int*& end) const {
+  if (cell == NO_CELL) {
+    begin = end = 0x0;
+  } else {
+    begin = &_cellRegions[0] + _cellStart[cell];
+    end = &_cellRegions[0] + _cellStart[cell + 1];
+  }
+}
+
+}  // namespace BFSM
+}  // namespace Menge
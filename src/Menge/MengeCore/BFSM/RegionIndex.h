@@ -0,0 +1,155 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+/*!
+ @file    RegionIndex.h
+ @brief    A uniform grid over the regions of spatial transition conditions.
+ */
+
+#ifndef __REGION_INDEX_H__
+#define __REGION_INDEX_H__
+
+#include "MengeCore/CoreConfig.h"
+#include "MengeCore/Math/Vector2.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace Menge {
+
+namespace BFSM {
+
+/*!
+ @brief    A uniform grid which maps each cell to the regions whose bounding boxes overlap it.
+
+ The region index allows a point to be rejected by many regions at once: the point's cell is looked
+ up once and only the regions listed for that cell can possibly contain the point. Regions are
+ represented by their axis-aligned bounding boxes, so a listed region may still not contain the
+ point. The bounding boxes are slightly inflated so that floating-point error in a shape's own
+ containment test never produces a false rejection.
+ */
+class MENGE_API RegionIndex {
+ public:
+  /*!
+   @brief    The cell of points which lie outside of all regions' bounding boxes.
+   */
+  static const size_t NO_CELL;
+
+  /*!
+   @brief    Constructor.
+   */
+  RegionIndex();
+
+  /*!
+   @brief    Removes all regions and the grid.
+   */
+  void clear();
+
+  /*!
+   @brief    Adds a region to the index; build() must be called before the index is queried.
+
+   @param    minPt    The minimum corner of the region's axis-aligned bounding box.
+   @param    maxPt    The maximum corner of the region's axis-aligned bounding box.
+   @returns  The identifier of the region (regions are numbered consecutively from zero).
+   */
+  unsigned int addRegion(const Math::Vector2& minPt, const Math::Vector2& maxPt);
+
+  /*!
+   @brief    Reports the number of regions in the index.
+   */
+  size_t getRegionCount() const { return _minPts.size(); }
+
+  /*!
+   @brief    Builds the grid from the added regions.
+
+   The cell size is chosen such that there are a few cells per region.
+   */
+  void build();
+
+  /*!
+   @brief    Reports the cell containing the given point.
+
+   @param    pt    The point.
+   @returns  The index of the cell containing `pt`, or NO_CELL if `pt` lies outside of all regions.
+   */
+  size_t getCell(const Math::Vector2& pt) const;
+
+  /*!
+   @brief    Reports if the given region may contain points in the given cell.
+
+   @param    cell      The cell index (as returned by getCell()).
+   @param    region    The region identifier (as returned by addRegion()).
+   @returns  False if no point in the cell can lie inside the region.
+   */
+  bool mayContain(size_t cell, unsigned int region) const;
+
+  /*!
+   @brief    Reports the regions which may contain points in the given cell.
+
+   @param    cell     The cell index (as returned by getCell()).
+   @param    begin    Set to the start of the cell's region list (sorted in increasing order).
+   @param    end      Set to the end of the cell's region list.
+   */
+  void getRegions(size_t cell, const unsigned int*& begin, const unsigned int*& end) const;
+
+ protected:
+  /*!
+   @brief    The minimum corners of the regions' (inflated) bounding boxes.
+   */
+  std::vector<Math::Vector2> _minPts;
+
+  /*!
+   @brief    The maximum corners of the regions' (inflated) bounding boxes.
+   */
+  std::vector<Math::Vector2> _maxPts;
+
+  /*!
+   @brief    The minimum corner of the grid.
+   */
+  Math::Vector2 _origin;
+
+  /*!
+   @brief    The reciprocal of the width (and height) of a cell.
+   */
+  float _invCellSize;
+
+  /*!
+   @brief    The number of cells along the x-axis.
+   */
+  size_t _width;
+
+  /*!
+   @brief    The number of cells along the y-axis.
+   */
+  size_t _height;
+
+  /*!
+   @brief    The regions overlapping cell i are _cellRegions[_cellStart[i]] through
+            _cellRegions[_cellStart[i + 1] - 1], in increasing order.
+   */
+  std::vector<size_t> _cellStart;
+
+  /*!
+   @brief    The region lists of all cells.
+   */
+  std::vector<unsigned int> _cellRegions;
+};
+}  // namespace BFSM
+}  // namespace Menge
+
+#endif  // __REGION_INDEX_H__
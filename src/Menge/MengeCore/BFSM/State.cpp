@@ -44,6 +44,10 @@ Any questions or comments should be sent to the authors {menge,geom}@cs.unc.edu
 
 #include <sstream>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace Menge {
 
 namespace BFSM {
@@ -64,10 +68,17 @@ State::State(const std::string& name)
       transitions_(),
       actions_(),
       _final(false),
+      _updateInterval(0),
       _goalSelector(0x0),
       _goals(),
-      _name(name) {
+      _name(name),
+      _tableIndex(0) {
   _id = COUNT++;
+  int threadCount = 1;
+#ifdef _OPENMP
+  threadCount = omp_get_max_threads();
+#endif
+  _membershipChanges.resize(threadCount);
 }
 
 /////////////////////////////////////////////////////////////////////
@@ -194,11 +205,13 @@ void State::enter(Agents::BaseAgent* agent) {
   for (size_t i = 0; i < velModifiers_.size(); ++i) {
     velModifiers_[i]->onEnter(agent);
   }
+  recordMembership(agent, true);
 }
 
 /////////////////////////////////////////////////////////////////////
 
 void State::leave(Agents::BaseAgent* agent) {
+  recordMembership(agent, false);
   _goalSelector->freeGoal(agent, _goals[agent->_id]);
 
   _goalLock.lockWrite();
@@ -220,6 +233,86 @@ void State::leave(Agents::BaseAgent* agent) {
 
 /////////////////////////////////////////////////////////////////////
 
+void State::enterBatch(const std::vector<Agents::BaseAgent*>& agents,
+                       std::vector<Agents::BaseAgent*>& entered) {
+  for (size_t i = 0; i < actions_.size(); ++i) {
+    actions_[i]->onEnterBatch(agents);
+  }
+
+  std::vector<const Agents::BaseAgent*> selecting(agents.begin(), agents.end());
+  std::vector<Goal*> goals;
+  const size_t assigned = _goalSelector->assignGoals(selecting, goals);
+
+  // As with enter(), an agent without a goal goes no further than the actions.
+  entered.clear();
+  entered.reserve(assigned);
+  _goalLock.lockWrite();
+  for (size_t i = 0; i < agents.size(); ++i) {
+    if (goals[i] == 0x0) continue;
+    _goals[agents[i]->_id] = goals[i];
+    entered.push_back(agents[i]);
+  }
+  _goalLock.releaseWrite();
+
+  _velComponent->onEnterBatch(entered);
+  // Serial, in the order the agents would enter one at a time: conditions and modifiers may draw
+  // from random distributions (e.g., a timer's duration).
+  for (size_t a = 0; a < entered.size(); ++a) {
+    for (size_t i = 0; i < transitions_.size(); ++i) {
+      transitions_[i]->onEnter(entered[a]);
+    }
+    for (size_t i = 0; i < velModifiers_.size(); ++i) {
+      velModifiers_[i]->onEnter(entered[a]);
+    }
+  }
+  for (size_t a = 0; a < entered.size(); ++a) {
+    recordMembership(entered[a], true);
+  }
+
+  if (assigned < agents.size()) {
+    logger << Logger::ERR_MSG << "State " << _name << " was unable to assign a goal to agents";
+    for (size_t i = 0; i < agents.size(); ++i) {
+      if (goals[i] == 0x0) logger << " " << agents[i]->_id;
+    }
+    logger << ".";
+    throw StateException();
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void State::leaveBatch(const std::vector<Agents::BaseAgent*>& agents) {
+  std::vector<Goal*> goals(agents.size(), 0x0);
+  _goalLock.lockWrite();
+  for (size_t i = 0; i < agents.size(); ++i) {
+    HASH_MAP<size_t, Goal*>::iterator itr = _goals.find(agents[i]->_id);
+    if (itr == _goals.end()) continue;
+    goals[i] = itr->second;
+    _goals.erase(itr);
+  }
+  _goalLock.releaseWrite();
+
+  for (size_t i = 0; i < agents.size(); ++i) {
+    recordMembership(agents[i], false);
+    if (goals[i] != 0x0) _goalSelector->freeGoal(agents[i], goals[i]);
+  }
+
+  for (size_t i = 0; i < actions_.size(); ++i) {
+    actions_[i]->onLeaveBatch(agents);
+  }
+  _velComponent->onExitBatch(agents);
+  for (size_t a = 0; a < agents.size(); ++a) {
+    for (size_t i = 0; i < transitions_.size(); ++i) {
+      transitions_[i]->onLeave(agents[a]);
+    }
+    for (size_t i = 0; i < velModifiers_.size(); ++i) {
+      velModifiers_[i]->onLeave(agents[a]);
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
 size_t State::getPopulation() const {
   // It is assumed that every agent actually in the state has a
   //  representation in _goals.
@@ -233,6 +326,50 @@ size_t State::getPopulation() const {
 
 /////////////////////////////////////////////////////////////////////
 
+const std::vector<Agents::BaseAgent*>& State::getMembers() {
+  mergeMembership();
+  return _members;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void State::recordMembership(Agents::BaseAgent* agent, bool entered) {
+  int thread = 0;
+#ifdef _OPENMP
+  // Assuming that the thread number is in [0, omp_get_max_threads() )
+  thread = omp_get_thread_num();
+#endif
+  MembershipChange change = {agent, entered};
+  _membershipChanges[thread].push_back(change);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void State::mergeMembership() {
+  // Each agent is evaluated by a single thread, so its changes are in order in one buffer.
+  for (size_t t = 0; t < _membershipChanges.size(); ++t) {
+    std::vector<MembershipChange>& changes = _membershipChanges[t];
+    for (size_t i = 0; i < changes.size(); ++i) {
+      Agents::BaseAgent* agent = changes[i].agent;
+      if (changes[i].entered) {
+        _memberIndex[agent->_id] = _members.size();
+        _members.push_back(agent);
+      } else {
+        HASH_MAP<size_t, size_t>::iterator itr = _memberIndex.find(agent->_id);
+        if (itr == _memberIndex.end()) continue;
+        Agents::BaseAgent* last = _members.back();
+        _members[itr->second] = last;
+        _memberIndex[last->_id] = itr->second;
+        _members.pop_back();
+        _memberIndex.erase(agent->_id);
+      }
+    }
+    changes.clear();
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
 void State::setGoalSelector(GoalSelector* selector) {
   if (_goalSelector != 0x0) {
     logger << Logger::ERR_MSG << "The state \"" << _name;
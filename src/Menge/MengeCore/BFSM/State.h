@@ -152,6 +152,19 @@ class State {
    */
   inline bool getFinal() const { return _final; }
 
+  /*!
+   @brief    Sets how often (in FSM steps) the agents in this state evaluate their transitions and
+            preferred velocity (see FSM::setUpdateInterval()).
+
+   @param    interval    The number of steps between updates; zero uses the FSM's interval.
+   */
+  inline void setUpdateInterval(size_t interval) { _updateInterval = interval; }
+
+  /*!
+   @brief    Reports the state's update interval; zero if the state uses the FSM's interval.
+   */
+  inline size_t getUpdateInterval() const { return _updateInterval; }
+
   /*!
    @brief    Test the transitions out of this state for the given agent.
 
@@ -178,6 +191,34 @@ class State {
    */
   virtual void leave(Agents::BaseAgent* agent);
 
+  /*!
+   @brief    Called when a batch of agents enters the state at once (e.g., when an event moves a
+            population of agents to this state).
+
+   The result is the same as calling enter() for each agent, but each element processes the whole
+   batch: the actions and the velocity component through their batch hooks
+   (Action::onEnterBatch() and VelComponent::onEnterBatch()), the goals are selected through
+   GoalSelector::assignGoals() with the selector's resources locked once, and then the transitions
+   and velocity modifiers are initialized for each agent, in order. It must not be called from
+   within a parallel region.
+
+   @param    agents     The agents who are entering the state.
+   @param    entered    Set to the agents who entered the state (in the order given); it is set
+                        even if an exception is thrown.
+   @throws   StateException if any of the agents couldn't be assigned a goal. The remaining agents
+            have entered the state.
+   */
+  virtual void enterBatch(const std::vector<Agents::BaseAgent*>& agents,
+                          std::vector<Agents::BaseAgent*>& entered);
+
+  /*!
+   @brief    Called when a batch of agents leaves the state at once; the batch counterpart of
+            leave(). See enterBatch().
+
+   @param    agents    The agents who left the state.
+   */
+  virtual void leaveBatch(const std::vector<Agents::BaseAgent*>& agents);
+
   /*!
    @brief    Add a transition to the state.
 
@@ -242,6 +283,26 @@ class State {
    */
   size_t getPopulation() const;
 
+  /*!
+   @brief    Returns the agents in this state.
+
+   The membership is maintained incrementally as agents enter and leave the state. Changes made
+   while the FSM is evaluated in parallel are buffered per thread and merged here, so this must not
+   be called while agents may be changing state (e.g., during FSM::doStep()'s agent loop). The
+   order of the members is unspecified.
+
+   @returns    The agents in this state.
+   */
+  const std::vector<Agents::BaseAgent*>& getMembers();
+
+  /*!
+   @brief    Merges the buffered membership changes into the state's members.
+
+   Called by the FSM after each parallel evaluation so that the buffers don't accumulate. The same
+   restrictions as for getMembers() apply.
+   */
+  void mergeMembership();
+
   /*!
    @brief    Sets the goal selector for the state
 
@@ -279,6 +340,8 @@ class State {
    */
   const Goal* getGoal(size_t goalId) { return _goals[goalId]; }
 
+  friend class TransitionTable;
+
  protected:
   /*!
    @brief    Test the transitions out of this state, tracking cycles.
@@ -293,6 +356,14 @@ class State {
    */
   State* testTransitions(Agents::BaseAgent* agent, std::set<State*>& visited);
 
+  /*!
+   @brief    Records the agent entering or leaving the state in the calling thread's change buffer.
+
+   @param    agent      The agent.
+   @param    entered    True if the agent entered the state, false if it left.
+   */
+  void recordMembership(Agents::BaseAgent* agent, bool entered);
+
   /*!
    @brief    The single velocity component associated with this state.
    */
@@ -322,6 +393,12 @@ class State {
    */
   bool _final;
 
+  /*!
+   @brief    The number of steps between updates of the agents in this state; zero uses the FSM's
+            interval.
+   */
+  size_t _updateInterval;
+
   /*!
    @brief    The goal selector for this state.
    */
@@ -342,10 +419,46 @@ class State {
    */
   size_t _id;
 
+  /*!
+   @brief    The index of the state in its FSM's compiled transition table (see TransitionTable).
+   */
+  size_t _tableIndex;
+
   /*!
    @brief    The lock for accessing the goals.
    */
   ReadersWriterLock _goalLock;
+
+  /*!
+   @brief    A change in the state's membership.
+   */
+  struct MembershipChange {
+    /*!
+     @brief    The agent which entered or left the state.
+     */
+    Agents::BaseAgent* agent;
+
+    /*!
+     @brief    True if the agent entered the state, false if it left.
+     */
+    bool entered;
+  };
+
+  /*!
+   @brief    The membership changes which have not yet been merged into _members -- one buffer per
+            thread.
+   */
+  std::vector<std::vector<MembershipChange> > _membershipChanges;
+
+  /*!
+   @brief    The agents in the state.
+   */
+  std::vector<Agents::BaseAgent*> _members;
+
+  /*!
+   @brief    A mapping from agent id to the agent's index in _members.
+   */
+  HASH_MAP<size_t, size_t> _memberIndex;
 };
 }  // namespace BFSM
 }  // namespace Menge
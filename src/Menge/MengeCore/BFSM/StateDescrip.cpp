@@ -54,7 +54,11 @@ namespace BFSM {
 /////////////////////////////////////////////////////////////////////
 
 StateDescrip::StateDescrip(const std::string& name, bool isFinal)
-    : _name(name), _isFinal(isFinal), _goalSelector(0x0), _velComponent(0x0) {}
+    : _name(name),
+      _isFinal(isFinal),
+      _updateInterval(0),
+      _goalSelector(0x0),
+      _velComponent(0x0) {}
 
 /////////////////////////////////////////////////////////////////////
 
@@ -116,6 +120,15 @@ bool parseState(TiXmlElement* node, const std::string& behaveFldr,
   }
 
   s = new StateDescrip(name, isFinal);
+  if (node->Attribute("update_interval", &i)) {
+    if (i < 0) {
+      logger << Logger::ERR_MSG << "The update interval of state " << name;
+      logger << " must be non-negative; found " << i << " on line " << node->Row() << ".";
+      delete s;
+      return false;
+    }
+    s->_updateInterval = static_cast<size_t>(i);
+  }
 
   for (TiXmlElement* gchild = node->FirstChildElement(); gchild;
        gchild = gchild->NextSiblingElement()) {
@@ -80,6 +80,12 @@ class StateDescrip {
    */
   bool _isFinal;
 
+  /*!
+   @brief    The number of steps between updates of the agents in the state; zero uses the FSM's
+            interval (see State::setUpdateInterval()).
+   */
+  size_t _updateInterval;
+
   /*!
    @brief    The description of the goal selector used for this state.
    */
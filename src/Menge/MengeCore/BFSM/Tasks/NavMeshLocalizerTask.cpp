@@ -38,8 +38,10 @@ Any questions or comments should be sent to the authors {menge,geom}@cs.unc.edu
 
 #include "MengeCore/BFSM/Tasks/NavMeshLocalizerTask.h"
 
+#include "MengeCore/Agents/BaseAgent.h"
 #include "MengeCore/Agents/SimulatorInterface.h"
 #include "MengeCore/BFSM/FSM.h"
+#include "MengeCore/Runtime/TraceRecorder.h"
 #include "MengeCore/resources/NavMeshLocalizer.h"
 
 #include <exception>
@@ -60,6 +62,7 @@ NavMeshLocalizerTask::NavMeshLocalizerTask(const std::string& navMeshName, bool
 /////////////////////////////////////////////////////////////////////
 
 void NavMeshLocalizerTask::doWork(const FSM* fsm) throw(TaskException) {
+  TraceScope span("NavMeshLocalizerTask", "task");
   const Agents::SimulatorInterface* sim = fsm->getSimulator();
   int agtCount = (int)sim->getNumAgents();
 
@@ -82,6 +85,27 @@ void NavMeshLocalizerTask::doWork(const FSM* fsm) throw(TaskException) {
     throw TaskFatalException();
   }
 }
+
+/////////////////////////////////////////////////////////////////////
+
+bool NavMeshLocalizerTask::getResources(TaskResources& resources) const {
+  resources.addRead(TaskResources::AGENTS);
+  resources.addWrite(_localizer.get());
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void NavMeshLocalizerTask::addAgent(const Agents::BaseAgent* agent) {
+  _localizer->updateLocation(agent);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void NavMeshLocalizerTask::removeAgent(const Agents::BaseAgent* agent) {
+  _localizer->removeAgent(agent->_id);
+}
+
 /////////////////////////////////////////////////////////////////////
 
 std::string NavMeshLocalizerTask::toString() const {
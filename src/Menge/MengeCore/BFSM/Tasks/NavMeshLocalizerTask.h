@@ -64,6 +64,33 @@ class MENGE_API NavMeshLocalizerTask : public Task {
    */
   virtual void doWork(const FSM* fsm) throw(TaskException);
 
+  /*!
+   @brief    The task reads the agents' positions and writes their locations in the localizer.
+
+   @param    resources    The resources to which the task adds its reads and writes.
+   @returns  True.
+   */
+  virtual bool getResources(TaskResources& resources) const;
+
+  /*!
+   @brief    The agents are located in parallel.
+   */
+  virtual bool isParallel() const { return true; }
+
+  /*!
+   @brief    Locates the new agent on the navigation mesh.
+
+   @param    agent    The agent added to the simulation.
+   */
+  virtual void addAgent(const Agents::BaseAgent* agent);
+
+  /*!
+   @brief    Removes the agent's location from the localizer.
+
+   @param    agent    The agent being removed from the simulation.
+   */
+  virtual void removeAgent(const Agents::BaseAgent* agent);
+
   /*!
    @brief    String representation of the task
 
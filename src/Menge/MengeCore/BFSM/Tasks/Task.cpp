@@ -44,6 +44,38 @@ namespace Menge {
 
 namespace BFSM {
 
+/////////////////////////////////////////////////////////////////////
+//          Implementation of TaskResources
+/////////////////////////////////////////////////////////////////////
+
+namespace {
+// The agents have no single object to represent them; this serves as their address.
+const char AGENTS_RESOURCE = 0;
+}  // namespace
+
+const void* const TaskResources::AGENTS = &AGENTS_RESOURCE;
+
+/////////////////////////////////////////////////////////////////////
+
+bool TaskResources::conflictsWith(const TaskResources& other) const {
+  for (size_t i = 0; i < _writes.size(); ++i) {
+    if (contains(other._reads, _writes[i]) || contains(other._writes, _writes[i])) return true;
+  }
+  for (size_t i = 0; i < other._writes.size(); ++i) {
+    if (contains(_reads, other._writes[i])) return true;
+  }
+  return false;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool TaskResources::contains(const std::vector<const void*>& resources, const void* resource) {
+  for (size_t i = 0; i < resources.size(); ++i) {
+    if (resources[i] == resource) return true;
+  }
+  return false;
+}
+
 /////////////////////////////////////////////////////////////////////
 //          Implementation of parsing function
 /////////////////////////////////////////////////////////////////////
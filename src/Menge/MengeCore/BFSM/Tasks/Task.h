@@ -29,6 +29,7 @@
 #include "MengeCore/PluginEngine/Element.h"
 
 #include <string>
+#include <vector>
 
 // forward declaration
 class TiXmlElement;
@@ -79,6 +80,55 @@ class TaskFatalException : public TaskException, public MengeFatalException {
       : MengeException(s), TaskException(), MengeFatalException() {}
 };
 
+/*!
+ @brief    The resources a task reads and writes while doing its work.
+
+ The FSM uses the resources declared by its tasks (see Task::getResources()) to run independent
+ tasks concurrently. A resource is identified by the address of the object which holds the data
+ (e.g., a navigation mesh localizer); the agents themselves are identified by AGENTS. Two tasks
+ conflict if either one writes a resource which the other one reads or writes.
+ */
+class MENGE_API TaskResources {
+ public:
+  /*!
+   @brief    The resource representing the state of the agents (position, velocity, properties,
+            etc.)
+   */
+  static const void* const AGENTS;
+
+  /*!
+   @brief    Declares that the task reads the given resource.
+   */
+  void addRead(const void* resource) { _reads.push_back(resource); }
+
+  /*!
+   @brief    Declares that the task writes the given resource.
+   */
+  void addWrite(const void* resource) { _writes.push_back(resource); }
+
+  /*!
+   @brief    Reports if tasks using these resources and the `other` resources must not run
+            concurrently.
+   */
+  bool conflictsWith(const TaskResources& other) const;
+
+ private:
+  /*!
+   @brief    Reports if `resource` is in `resources`.
+   */
+  static bool contains(const std::vector<const void*>& resources, const void* resource);
+
+  /*!
+   @brief    The resources which are read.
+   */
+  std::vector<const void*> _reads;
+
+  /*!
+   @brief    The resources which are written.
+   */
+  std::vector<const void*> _writes;
+};
+
 /*!
  @brief  Interface for basic FSM task.
 
@@ -104,6 +154,47 @@ class MENGE_API Task : public Element {
    */
   virtual void doWork(const FSM* fsm) throw(TaskException) = 0;
 
+  /*!
+   @brief    Declares the resources the task reads and writes in doWork().
+
+   The FSM runs tasks whose resources don't conflict concurrently. A task which doesn't declare its
+   resources (the default) runs alone: after every task added to the FSM before it and before every
+   task added after it.
+
+   @param    resources    The resources to which the task adds its reads and writes.
+   @returns  True if the task declared its resources.
+   */
+  virtual bool getResources(TaskResources& resources) const { return false; }
+
+  /*!
+   @brief    Reports if doWork() parallelizes its own work (e.g., over the agents).
+
+   Such tasks aren't run concurrently with other tasks so that they have every thread available.
+   The default implementation reports false.
+   */
+  virtual bool isParallel() const { return false; }
+
+  /*!
+   @brief    Informs the task that the given agent has been added to the running simulation.
+
+   This is called before the agent enters its initial state so that per-agent data the state relies
+   on (e.g., the agent's location on a navigation mesh) is available. The default implementation
+   does nothing.
+
+   @param    agent    The agent being added.
+   */
+  virtual void addAgent(const Agents::BaseAgent* agent) {}
+
+  /*!
+   @brief    Informs the task that the given agent is being removed from the simulation.
+
+   Tasks which maintain per-agent data should release it here; the agent's identifier may later be
+   reused by a newly spawned agent. The default implementation does nothing.
+
+   @param    agent    The agent being removed.
+   */
+  virtual void removeAgent(const Agents::BaseAgent* agent) {}
+
   /*!
    @brief    String representation of the task
 
@@ -0,0 +1,367 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#include "MengeCore/BFSM/TransitionTable.h"
+
+#include "MengeCore/Agents/BaseAgent.h"
+#include "MengeCore/BFSM/Goals/Goal.h"
+#include "MengeCore/BFSM/State.h"
+#include "MengeCore/BFSM/Transitions/CondAuto.h"
+#include "MengeCore/BFSM/Transitions/CondBoolean.h"
+#include "MengeCore/BFSM/Transitions/CondGoal.h"
+#include "MengeCore/BFSM/Transitions/CondSpace.h"
+#include "MengeCore/BFSM/Transitions/CondTimer.h"
+#include "MengeCore/BFSM/Transitions/Target.h"
+#include "MengeCore/BFSM/Transitions/Transition.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <typeinfo>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace Menge {
+
+namespace BFSM {
+
+using Math::Vector2;
+
+/////////////////////////////////////////////////////////////////////
+//                   Implementation of TransitionTable
+/////////////////////////////////////////////////////////////////////
+
+const size_t TransitionTable::NO_STATE = static_cast<size_t>(-1);
+
+/////////////////////////////////////////////////////////////////////
+
+const unsigned int TransitionTable::NO_REGION = static_cast<unsigned int>(-1);
+
+/////////////////////////////////////////////////////////////////////
+
+const size_t TransitionTable::NO_TRANSITION = static_cast<size_t>(-1);
+
+/////////////////////////////////////////////////////////////////////
+
+const size_t TransitionTable::UNKNOWN_CELL = static_cast<size_t>(-2);
+
+/////////////////////////////////////////////////////////////////////
+
+const size_t TransitionTable::DEFAULT_REGION_INDEX_THRESHOLD = 16;
+
+/////////////////////////////////////////////////////////////////////
+
+TransitionTable::TransitionTable()
+    : _compiled(false),
+      _regionIndexThreshold(DEFAULT_REGION_INDEX_THRESHOLD),
+      _useRegionIndex(false),
+      _visitedWords(0) {}
+
+/////////////////////////////////////////////////////////////////////
+
+void TransitionTable::compile(const std::vector<State*>& states) {
+  _states = states;
+  _firstTransition.clear();
+  _transitions.clear();
+  _conditions.clear();
+  _regionIndex.clear();
+  _firstRegion.clear();
+  _regionTransition.clear();
+  _firstUnindexed.clear();
+  _unindexed.clear();
+  for (size_t s = 0; s < _states.size(); ++s) {
+    _states[s]->_tableIndex = s;
+  }
+  for (size_t s = 0; s < _states.size(); ++s) {
+    _firstTransition.push_back(_transitions.size());
+    _firstRegion.push_back(static_cast<unsigned int>(_regionIndex.getRegionCount()));
+    _firstUnindexed.push_back(_unindexed.size());
+    const std::vector<Transition*>& transitions = _states[s]->transitions_;
+    for (size_t t = 0; t < transitions.size(); ++t) {
+      TransitionEntry entry;
+      entry.transition = transitions[t];
+      entry.condition = compileCondition(transitions[t]->_condition);
+      entry.target = NO_STATE;
+      // Only exactly SingleTarget is known to always return the same state.
+      const TransitionTarget* target = transitions[t]->_target;
+      if (typeid(*target) == typeid(SingleTarget)) {
+        const State* next = static_cast<const SingleTarget*>(target)->_next;
+        for (size_t i = 0; i < _states.size(); ++i) {
+          if (_states[i] == next) entry.target = i;
+        }
+      }
+      entry.region = requiredRegion(entry.condition);
+      _regionTransition.resize(_regionIndex.getRegionCount(), NO_TRANSITION);
+      if (entry.region == NO_REGION) {
+        _unindexed.push_back(_transitions.size());
+      } else {
+        _regionTransition[entry.region] = _transitions.size();
+      }
+      _transitions.push_back(entry);
+    }
+  }
+  _firstTransition.push_back(_transitions.size());
+  _firstRegion.push_back(static_cast<unsigned int>(_regionIndex.getRegionCount()));
+  _firstUnindexed.push_back(_unindexed.size());
+  _useRegionIndex =
+      _regionIndexThreshold > 0 && _regionIndex.getRegionCount() >= _regionIndexThreshold;
+  if (_useRegionIndex) _regionIndex.build();
+
+  int threadCount = 1;
+#ifdef _OPENMP
+  threadCount = omp_get_max_threads();
+#endif
+  const size_t BITS = sizeof(size_t) * 8;
+  _visitedWords = (_states.size() + BITS - 1) / BITS;
+  _visited.assign(threadCount * _visitedWords, 0);
+  _compiled = true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+State* TransitionTable::advance(Agents::BaseAgent* agent, State* state) {
+  assert(_compiled && "Evaluating an FSM's transitions before compiling them");
+  int threadNum = 0;
+#ifdef _OPENMP
+  // Assuming that threadNum \in [0, omp_get_max_threads() )
+  threadNum = omp_get_thread_num();
+#endif
+  size_t* visited = &_visited[0] + threadNum * _visitedWords;
+  memset(visited, 0, _visitedWords * sizeof(size_t));
+  const size_t BITS = sizeof(size_t) * 8;
+
+  State* result = 0x0;
+  // The agent doesn't move while it advances, so its cell is looked up at most once.
+  size_t cell = UNKNOWN_CELL;
+  while (true) {
+    const size_t s = state->_tableIndex;
+    const size_t bit = static_cast<size_t>(1) << (s % BITS);
+    if (visited[s / BITS] & bit) break;
+    visited[s / BITS] |= bit;
+
+    state->_goalLock.lockRead();
+    const Goal* goal = state->_goals[agent->_id];
+    state->_goalLock.releaseRead();
+
+    State* next = 0x0;
+    if (_useRegionIndex) {
+      next = testIndexedTransitions(s, agent, goal, cell);
+    } else {
+      for (size_t t = _firstTransition[s]; t < _firstTransition[s + 1]; ++t) {
+        next = testTransition(_transitions[t], agent, goal, cell);
+        if (next) break;
+      }
+    }
+    if (next == 0x0) break;
+    state->leave(agent);
+    next->enter(agent);
+    result = state = next;
+  }
+  return result;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+State* TransitionTable::testTransition(const TransitionEntry& entry, Agents::BaseAgent* agent,
+                                       const Goal* goal, size_t& cell) const {
+  if (!conditionMet(entry.condition, agent, goal, cell)) return 0x0;
+  return entry.target != NO_STATE ? _states[entry.target]
+                                  : entry.transition->_target->nextState(agent);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+State* TransitionTable::testIndexedTransitions(size_t s, Agents::BaseAgent* agent,
+                                               const Goal* goal, size_t& cell) const {
+  if (cell == UNKNOWN_CELL) cell = _regionIndex.getCell(agent->_pos);
+  // The candidates are the union of the transitions which don't require a region and those whose
+  // region overlaps the agent's cell. Both sequences are in transition order (region identifiers
+  // increase with the transition order), so they are merged to preserve the order of evaluation.
+  const unsigned int* region;
+  const unsigned int* regionEnd;
+  _regionIndex.getRegions(cell, region, regionEnd);
+  region = std::lower_bound(region, regionEnd, _firstRegion[s]);
+  const unsigned int lastRegion = _firstRegion[s + 1];
+  size_t u = _firstUnindexed[s];
+  const size_t uEnd = _firstUnindexed[s + 1];
+  while (true) {
+    while (region != regionEnd && *region < lastRegion &&
+           _regionTransition[*region] == NO_TRANSITION) {
+      ++region;
+    }
+    const size_t regionT =
+        region != regionEnd && *region < lastRegion ? _regionTransition[*region] : NO_TRANSITION;
+    const size_t unindexedT = u < uEnd ? _unindexed[u] : NO_TRANSITION;
+    size_t t;
+    if (unindexedT < regionT) {
+      t = unindexedT;
+      ++u;
+    } else if (regionT != NO_TRANSITION) {
+      t = regionT;
+      ++region;
+    } else {
+      break;
+    }
+    State* next = testTransition(_transitions[t], agent, goal, cell);
+    if (next) return next;
+  }
+  return 0x0;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+unsigned int TransitionTable::requiredRegion(unsigned int index) const {
+  const ConditionNode& node = _conditions[index];
+  switch (node.kind) {
+    case CIRCLE:
+    case AABB:
+    case OBB:
+      return static_cast<const SpaceCondition*>(node.condition)->_outsideActive ? NO_REGION
+                                                                               : node.region;
+    case AND: {
+      const unsigned int region = requiredRegion(node.operands[0]);
+      return region != NO_REGION ? region : requiredRegion(node.operands[1]);
+    }
+    default:
+      return NO_REGION;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+unsigned int TransitionTable::compileCondition(Condition* condition) {
+  const unsigned int index = static_cast<unsigned int>(_conditions.size());
+  ConditionNode node;
+  node.kind = GENERIC;
+  node.condition = condition;
+  node.operands[0] = node.operands[1] = 0;
+  node.region = 0;
+  // Sub-classes may override conditionMet(); only the exact types are evaluated directly.
+  const std::type_info& type = typeid(*condition);
+  if (type == typeid(AutoCondition)) {
+    node.kind = AUTO;
+  } else if (type == typeid(GoalCondition)) {
+    node.kind = GOAL;
+  } else if (type == typeid(TimerCondition)) {
+    node.kind = TIMER;
+  } else if (type == typeid(CircleCondition)) {
+    node.kind = CIRCLE;
+    const CircleCondition* circle = static_cast<const CircleCondition*>(condition);
+    const Vector2 r(circle->getRadius(), circle->getRadius());
+    node.region = _regionIndex.addRegion(circle->getCenter() - r, circle->getCenter() + r);
+  } else if (type == typeid(AABBCondition)) {
+    node.kind = AABB;
+    const AABBCondition* box = static_cast<const AABBCondition*>(condition);
+    node.region = _regionIndex.addRegion(box->getMinPoint(), box->getMaxPoint());
+  } else if (type == typeid(OBBCondition)) {
+    node.kind = OBB;
+    const OBBCondition* box = static_cast<const OBBCondition*>(condition);
+    const Vector2 corners[4] = {box->getPivot(),
+                                box->getPivot() + box->getXBasis() * box->getSize().x(),
+                                box->getPivot() + box->getYBasis() * box->getSize().y(),
+                                box->getPivot() + box->getXBasis() * box->getSize().x() +
+                                    box->getYBasis() * box->getSize().y()};
+    Vector2 minPt = corners[0];
+    Vector2 maxPt = corners[0];
+    for (int i = 1; i < 4; ++i) {
+      minPt.set(std::min(minPt.x(), corners[i].x()), std::min(minPt.y(), corners[i].y()));
+      maxPt.set(std::max(maxPt.x(), corners[i].x()), std::max(maxPt.y(), corners[i].y()));
+    }
+    node.region = _regionIndex.addRegion(minPt, maxPt);
+  } else if (type == typeid(AndCondition)) {
+    node.kind = AND;
+  } else if (type == typeid(OrCondition)) {
+    node.kind = OR;
+  } else if (type == typeid(NotCondition)) {
+    node.kind = NOT;
+  }
+  _conditions.push_back(node);
+
+  // Operands are compiled after their parent so the parent's index is stable.
+  if (node.kind == AND || node.kind == OR) {
+    Bool2Condition* op = static_cast<Bool2Condition*>(condition);
+    const unsigned int op1 = compileCondition(op->_op1);
+    const unsigned int op2 = compileCondition(op->_op2);
+    _conditions[index].operands[0] = op1;
+    _conditions[index].operands[1] = op2;
+  } else if (node.kind == NOT) {
+    const unsigned int op = compileCondition(static_cast<NotCondition*>(condition)->_op);
+    _conditions[index].operands[0] = op;
+  }
+  return index;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool TransitionTable::regionMayContain(const ConditionNode& node, const Agents::BaseAgent* agent,
+                                       size_t& cell) const {
+  if (!_useRegionIndex) return true;
+  if (cell == UNKNOWN_CELL) cell = _regionIndex.getCell(agent->_pos);
+  return _regionIndex.mayContain(cell, node.region);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool TransitionTable::conditionMet(unsigned int index, Agents::BaseAgent* agent,
+                                   const Goal* goal, size_t& cell) const {
+  const ConditionNode& node = _conditions[index];
+  switch (node.kind) {
+    case AUTO:
+      return true;
+    case GOAL:
+      return goal->squaredDistance(agent->_pos) <=
+             static_cast<const GoalCondition*>(node.condition)->_distSq;
+    case TIMER: {
+      TimerCondition* cond = static_cast<TimerCondition*>(node.condition);
+      return cond->TimerCondition::conditionMet(agent, goal);
+    }
+    case CIRCLE: {
+      const CircleCondition* cond = static_cast<const CircleCondition*>(node.condition);
+      const bool inside =
+          regionMayContain(node, agent, cell) && cond->CircleShape::containsPoint(agent->_pos);
+      return inside ^ cond->_outsideActive;
+    }
+    case AABB: {
+      const AABBCondition* cond = static_cast<const AABBCondition*>(node.condition);
+      const bool inside =
+          regionMayContain(node, agent, cell) && cond->AABBShape::containsPoint(agent->_pos);
+      return inside ^ cond->_outsideActive;
+    }
+    case OBB: {
+      const OBBCondition* cond = static_cast<const OBBCondition*>(node.condition);
+      const bool inside =
+          regionMayContain(node, agent, cell) && cond->OBBShape::containsPoint(agent->_pos);
+      return inside ^ cond->_outsideActive;
+    }
+    case AND:
+      return conditionMet(node.operands[0], agent, goal, cell) &&
+             conditionMet(node.operands[1], agent, goal, cell);
+    case OR:
+      return conditionMet(node.operands[0], agent, goal, cell) ||
+             conditionMet(node.operands[1], agent, goal, cell);
+    case NOT:
+      return !conditionMet(node.operands[0], agent, goal, cell);
+    default:
+      return node.condition->conditionMet(agent, goal);
+  }
+}
+
+}  // namespace BFSM
+}  // namespace Menge
@@ -0,0 +1,362 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+/*!
+ @file    TransitionTable.h
+ @brief    A flat, compiled form of an FSM's transitions for fast evaluation.
+ */
+
+#ifndef __TRANSITION_TABLE_H__
+#define __TRANSITION_TABLE_H__
+
+#include "MengeCore/BFSM/RegionIndex.h"
+#include "MengeCore/CoreConfig.h"
+
+#include <cstddef>
+#include <vector>
+
+namespace Menge {
+
+namespace Agents {
+class BaseAgent;
+}
+
+namespace BFSM {
+
+// forward declarations
+class Condition;
+class Goal;
+class State;
+class Transition;
+
+/*!
+ @brief    The transitions of an FSM compiled into flat arrays.
+
+ Evaluating a state's transitions through State::testTransitions() walks the transitions via
+ virtual calls and tracks the visited states in a std::set, allocating for every agent in every
+ step. The transition table is compiled from the FSM's states once and evaluates the same
+ transitions, in the same order and with the same semantics, without allocating:
+
+   - The transitions of all states are stored contiguously; each state's transitions occupy a
+     known range.
+   - Transitions with a single target have the target state resolved ahead of time.
+   - Conditions are stored as a flat array of nodes. The built-in conditions (auto, goal_reached,
+     timer, the spatial conditions and the boolean operators) are evaluated directly. Any other
+     condition (including sub-classes of the built-in conditions) is evaluated through its virtual
+     Condition::conditionMet().
+   - The states visited while following a chain of transitions are tracked in a per-thread bitset.
+   - If the FSM has enough spatial conditions (see setRegionIndexThreshold()), their regions are
+     placed in a RegionIndex. Each agent's grid cell is looked up (at most) once per advance() and a
+     region which doesn't overlap the agent's cell is known not to contain the agent without testing
+     its shape. Transitions which can only be active inside a region (e.g., an inside circle
+     condition, possibly combined with other conditions via "and") aren't visited at all unless
+     their region overlaps the agent's cell.
+
+ The table must be recompiled if states or transitions are added to the FSM.
+ */
+class MENGE_API TransitionTable {
+ public:
+  /*!
+   @brief    Constructor.
+   */
+  TransitionTable();
+
+  /*!
+   @brief    Compiles the transitions of the given states.
+
+   The index of each state in `states` becomes its index in the table.
+
+   @param    states    The states of the FSM.
+   */
+  void compile(const std::vector<State*>& states);
+
+  /*!
+   @brief    Marks the table as requiring recompilation.
+   */
+  void invalidate() { _compiled = false; }
+
+  /*!
+   @brief    Reports if the table has been compiled (and not invalidated since).
+   */
+  bool isCompiled() const { return _compiled; }
+
+  /*!
+   @brief    Sets the minimum number of spatial conditions for which the region index is used; it
+            takes effect the next time the table is compiled.
+
+   @param    threshold    The minimum number of spatial conditions; zero disables the index.
+   */
+  void setRegionIndexThreshold(size_t threshold) {
+    _regionIndexThreshold = threshold;
+    _compiled = false;
+  }
+
+  /*!
+   @brief    Reports if the compiled table uses the region index.
+   */
+  bool usesRegionIndex() const { return _useRegionIndex; }
+
+  /*!
+   @brief    Tests the transitions out of the agent's current state, following active transitions
+            until a state is reached whose transitions are all inactive or which has already been
+            visited.
+
+   This is equivalent to State::testTransitions(); the agent leaves and enters the states along the
+   way. It is safe to call in parallel for different agents.
+
+   @param    agent    The agent to advance.
+   @param    state    The agent's current state.
+   @returns  The agent's new state, or NULL if the agent remains in `state`.
+   */
+  State* advance(Agents::BaseAgent* agent, State* state);
+
+ protected:
+  /*!
+   @brief    The types of condition which are evaluated directly.
+   */
+  enum ConditionKind {
+    GENERIC,  ///< Evaluated via Condition::conditionMet().
+    AUTO,     ///< AutoCondition
+    GOAL,     ///< GoalCondition
+    TIMER,    ///< TimerCondition
+    CIRCLE,   ///< CircleCondition
+    AABB,     ///< AABBCondition
+    OBB,      ///< OBBCondition
+    AND,      ///< AndCondition
+    OR,       ///< OrCondition
+    NOT       ///< NotCondition
+  };
+
+  /*!
+   @brief    A compiled condition.
+   */
+  struct ConditionNode {
+    /*!
+     @brief    The kind of condition.
+     */
+    ConditionKind kind;
+
+    /*!
+     @brief    The condition.
+     */
+    Condition* condition;
+
+    /*!
+     @brief    The indices of the operand nodes (for the boolean operators).
+     */
+    unsigned int operands[2];
+
+    /*!
+     @brief    The condition's region in the region index (for the spatial conditions).
+     */
+    unsigned int region;
+  };
+
+  /*!
+   @brief    A compiled transition.
+   */
+  struct TransitionEntry {
+    /*!
+     @brief    The transition.
+     */
+    Transition* transition;
+
+    /*!
+     @brief    The index of the transition's root condition node.
+     */
+    unsigned int condition;
+
+    /*!
+     @brief    The index of the target state, or NO_STATE if the target must be queried.
+     */
+    size_t target;
+
+    /*!
+     @brief    The region the agent must be in for the condition to be met, or NO_REGION.
+     */
+    unsigned int region;
+  };
+
+  /*!
+   @brief    The value of TransitionEntry::target for targets which must be queried.
+   */
+  static const size_t NO_STATE;
+
+  /*!
+   @brief    The value of TransitionEntry::region for transitions which don't require a region.
+   */
+  static const unsigned int NO_REGION;
+
+  /*!
+   @brief    The transition index used for regions which aren't required by a transition.
+   */
+  static const size_t NO_TRANSITION;
+
+  /*!
+   @brief    Appends the nodes for the given condition (and its operands) to _conditions.
+
+   @param    condition    The condition to compile.
+   @returns  The index of the condition's node.
+   */
+  unsigned int compileCondition(Condition* condition);
+
+  /*!
+   @brief    Determines a region which the agent must be in for the given condition to be met.
+
+   @param    node    The index of the condition node.
+   @returns  The required region, or NO_REGION if the condition can be met outside of all regions.
+   */
+  unsigned int requiredRegion(unsigned int node) const;
+
+  /*!
+   @brief    Tests a single compiled transition.
+
+   @param    entry    The transition.
+   @param    agent    The agent to test the transition for.
+   @param    goal     The agent's goal.
+   @param    cell     The agent's cell in the region index (see conditionMet()).
+   @returns  The state the transition leads to, or NULL if the transition isn't active.
+   */
+  State* testTransition(const TransitionEntry& entry, Agents::BaseAgent* agent, const Goal* goal,
+                        size_t& cell) const;
+
+  /*!
+   @brief    Tests the transitions of the state with the given index using the region index.
+
+   @param    s        The state's index.
+   @param    agent    The agent to test the transitions for.
+   @param    goal     The agent's goal.
+   @param    cell     The agent's cell in the region index (see conditionMet()).
+   @returns  The state the first active transition leads to, or NULL if none is active.
+   */
+  State* testIndexedTransitions(size_t s, Agents::BaseAgent* agent, const Goal* goal,
+                                size_t& cell) const;
+
+  /*!
+   @brief    Evaluates a compiled condition.
+
+   @param    node     The index of the condition node.
+   @param    agent    The agent to test the condition for.
+   @param    goal     The agent's goal.
+   @param    cell     The agent's cell in the region index; it is looked up on demand if it is
+                      UNKNOWN_CELL.
+   @returns  True if the condition is met.
+   */
+  bool conditionMet(unsigned int node, Agents::BaseAgent* agent, const Goal* goal,
+                    size_t& cell) const;
+
+  /*!
+   @brief    Reports if the region of the given spatial condition node may contain the agent.
+
+   @param    node     The spatial condition node.
+   @param    agent    The agent.
+   @param    cell     The agent's cell in the region index; it is looked up if it is UNKNOWN_CELL.
+   @returns  False if the region index shows that the region can't contain the agent.
+   */
+  bool regionMayContain(const ConditionNode& node, const Agents::BaseAgent* agent,
+                        size_t& cell) const;
+
+  /*!
+   @brief    The value of an agent's region index cell before it has been looked up.
+   */
+  static const size_t UNKNOWN_CELL;
+
+  /*!
+   @brief    The default value of _regionIndexThreshold.
+   */
+  static const size_t DEFAULT_REGION_INDEX_THRESHOLD;
+
+  /*!
+   @brief    Reports if the table is compiled.
+   */
+  bool _compiled;
+
+  /*!
+   @brief    The states, in table order.
+   */
+  std::vector<State*> _states;
+
+  /*!
+   @brief    The transitions of state i are _transitions[_firstTransition[i]] through
+            _transitions[_firstTransition[i + 1] - 1].
+   */
+  std::vector<size_t> _firstTransition;
+
+  /*!
+   @brief    The transitions of all states.
+   */
+  std::vector<TransitionEntry> _transitions;
+
+  /*!
+   @brief    The condition nodes of all transitions.
+   */
+  std::vector<ConditionNode> _conditions;
+
+  /*!
+   @brief    The bounding boxes of the spatial conditions' regions.
+   */
+  RegionIndex _regionIndex;
+
+  /*!
+   @brief    The minimum number of spatial conditions for which the region index is used (zero
+            disables the index).
+   */
+  size_t _regionIndexThreshold;
+
+  /*!
+   @brief    Reports if the region index is used.
+   */
+  bool _useRegionIndex;
+
+  /*!
+   @brief    The regions of the spatial conditions of state i are numbered _firstRegion[i] through
+            _firstRegion[i + 1] - 1 (in the order of the state's transitions).
+   */
+  std::vector<unsigned int> _firstRegion;
+
+  /*!
+   @brief    For each region, the transition which requires it (see requiredRegion()), or
+            NO_TRANSITION.
+   */
+  std::vector<size_t> _regionTransition;
+
+  /*!
+   @brief    The transitions of state i which don't require a region are
+            _unindexed[_firstUnindexed[i]] through _unindexed[_firstUnindexed[i + 1] - 1].
+   */
+  std::vector<size_t> _firstUnindexed;
+
+  /*!
+   @brief    The indices of the transitions which don't require a region, in state order.
+   */
+  std::vector<size_t> _unindexed;
+
+  /*!
+   @brief    The number of words in each thread's visited-state bitset.
+   */
+  size_t _visitedWords;
+
+  /*!
+   @brief    The visited-state bitsets for all threads.
+   */
+  std::vector<size_t> _visited;
+};
+}  // namespace BFSM
+}  // namespace Menge
+
+#endif  // __TRANSITION_TABLE_H__
@@ -78,6 +78,7 @@ class MENGE_API Bool2Condition : public Condition {
   virtual void onLeave(Agents::BaseAgent* agent);
 
   friend class Bool2CondFactory;
+  friend class TransitionTable;
 
  protected:
   /*!
@@ -347,6 +348,7 @@ class MENGE_API NotCondition : public Condition {
   virtual Condition* copy();
 
   friend class NotCondFactory;
+  friend class TransitionTable;
 
  protected:
   /*!
@@ -77,6 +77,8 @@ class MENGE_API GoalCondition : public Condition {
    */
   void setMinDistance(float dist) { _distSq = dist * dist; }
 
+  friend class TransitionTable;
+
  protected:
   /*!
    @brief    Minimum distance of approach (squared for efficiency).
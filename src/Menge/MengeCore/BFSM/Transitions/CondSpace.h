@@ -74,6 +74,7 @@ class MENGE_API SpaceCondition : public Condition {
   virtual bool conditionMet(Agents::BaseAgent* agent, const Goal* goal);
 
   friend class SpaceCondFactory;
+  friend class TransitionTable;
 
  protected:
   /*!
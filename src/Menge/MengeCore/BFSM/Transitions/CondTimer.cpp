@@ -53,8 +53,8 @@ TimerCondition::TimerCondition() : _triggerTimes(), _durGen(0x0) {}
 
 ///////////////////////////////////////////////////////////////////////////
 
-TimerCondition::TimerCondition(const TimerCondition& cond) : Condition(cond) {
-  _triggerTimes.insert(cond._triggerTimes.begin(), cond._triggerTimes.end());
+TimerCondition::TimerCondition(const TimerCondition& cond)
+    : Condition(cond), _triggerTimes(cond._triggerTimes) {
   _durGen = cond._durGen->copy();
 }
 
@@ -67,28 +67,19 @@ TimerCondition::~TimerCondition() {
 ///////////////////////////////////////////////////////////////////////////
 
 void TimerCondition::onEnter(Agents::BaseAgent* agent) {
-  _lock.lockWrite();
   _triggerTimes[agent->_id] = Menge::SIM_TIME + _durGen->getValue();
-  _lock.releaseWrite();
 }
 
 ///////////////////////////////////////////////////////////////////////////
 
 void TimerCondition::onLeave(Agents::BaseAgent* agent) {
-  _lock.lockWrite();
-  std::map<size_t, float>::iterator itr = _triggerTimes.find(agent->_id);
-  assert(itr != _triggerTimes.end() && "Agent exiting a timer condition that never entered");
-  _triggerTimes.erase(itr);
-  _lock.releaseWrite();
+  _triggerTimes.clear(agent->_id);
 }
 
 ///////////////////////////////////////////////////////////////////////////
 
 bool TimerCondition::conditionMet(Agents::BaseAgent* agent, const Goal* goal) {
-  _lock.lockRead();
-  bool result = _triggerTimes[agent->_id] <= Menge::SIM_TIME;
-  _lock.releaseRead();
-  return result;
+  return _triggerTimes[agent->_id] <= Menge::SIM_TIME;
 }
 
 ///////////////////////////////////////////////////////////////////////////
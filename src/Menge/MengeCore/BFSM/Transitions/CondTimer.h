@@ -24,13 +24,11 @@
 #ifndef __COND_TIMER_H__
 #define __COND_TIMER_H__
 
+#include "MengeCore/BFSM/AgentSideTable.h"
 #include "MengeCore/BFSM/Transitions/Condition.h"
 #include "MengeCore/BFSM/Transitions/ConditionFactory.h"
 #include "MengeCore/BFSM/fsmCommon.h"
 #include "MengeCore/CoreConfig.h"
-#include "MengeCore/Runtime/ReadersWriterLock.h"
-
-#include <map>  //TODO: Replace this with a hash_map
 
 namespace Menge {
 
@@ -109,18 +107,15 @@ class MENGE_API TimerCondition : public Condition {
  protected:
   /*!
    @brief    The trigger time for agents currently effected by this transition.
+
+   Each agent's entry is only accessed by the thread evaluating that agent, so no lock is required.
    */
-  std::map<size_t, float> _triggerTimes;
+  AgentSideTable<float> _triggerTimes;
 
   /*!
    @brief    The generator for determining the per-agent duration.
    */
   FloatGenerator* _durGen;
-
-  /*!
-   @brief    Lock to protect _triggerTimes;
-   */
-  ReadersWriterLock _lock;
 };
 
 ///////////////////////////////////////////////////////////////////////////
@@ -186,6 +186,8 @@ class MENGE_API SingleTarget : public TransitionTarget {
    */
   virtual TransitionTarget* copy();
 
+  friend class TransitionTable;
+
  protected:
   /*!
    @brief    The name of the state to which this transition leads.
@@ -53,7 +53,7 @@ namespace BFSM {
 //                   Implementation of ReturnTarget
 ///////////////////////////////////////////////////////////////////////////
 
-ReturnTarget::ReturnTarget() : TransitionTarget(), _targets() {}
+ReturnTarget::ReturnTarget() : TransitionTarget(), _targets(0x0) {}
 
 ///////////////////////////////////////////////////////////////////////////
 
@@ -63,32 +63,21 @@ ReturnTarget::ReturnTarget(const ReturnTarget& tgt)
 ///////////////////////////////////////////////////////////////////////////
 
 void ReturnTarget::onEnter(Agents::BaseAgent* agent) {
-  _lock.lockWrite();
   assert(Menge::ACTIVE_FSM != 0x0 && "Undefined FSM pointer");
   _targets[agent->_id] = Menge::ACTIVE_FSM->getCurrentState(agent);
-  _lock.releaseWrite();
 }
 
 ///////////////////////////////////////////////////////////////////////////
 
 void ReturnTarget::onLeave(Agents::BaseAgent* agent) {
-  _lock.lockWrite();
-  assert(Menge::ACTIVE_FSM != 0x0 && "Undefined FSM pointer");
-  std::map<size_t, State*>::iterator itr = _targets.find(agent->_id);
-  if (itr != _targets.end()) {
-    _targets.erase(agent->_id);
-  }
-  _lock.releaseWrite();
+  _targets.clear(agent->_id);
 }
 
 ///////////////////////////////////////////////////////////////////////////
 
 State* ReturnTarget::nextState(Agents::BaseAgent* agent) {
-  _lock.lockRead();
-  std::map<size_t, State*>::iterator itr = _targets.find(agent->_id);
-  assert(itr != _targets.end() && "Using a return target for an agent with no return value");
-  State* next = itr->second;
-  _lock.releaseRead();
+  State* next = _targets[agent->_id];
+  assert(next != 0x0 && "Using a return target for an agent with no return value");
   return next;
 }
 
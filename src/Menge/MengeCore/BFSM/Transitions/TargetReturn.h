@@ -25,11 +25,11 @@
 #ifndef __TARGET_RETURN_H__
 #define __TARGET_RETURN_H__
 
+#include "MengeCore/BFSM/AgentSideTable.h"
 #include "MengeCore/BFSM/Transitions/Target.h"
 #include "MengeCore/BFSM/Transitions/TargetFactory.h"
 #include "MengeCore/BFSM/fsmCommon.h"
 #include "MengeCore/CoreConfig.h"
-#include "MengeCore/Runtime/ReadersWriterLock.h"
 
 #include <list>
 
@@ -119,14 +119,9 @@ class MENGE_API ReturnTarget : public TransitionTarget {
 
  protected:
   /*!
-   @brief    A mapping between an agent id and its return state.
+   @brief    The return state for each agent (null for agents which haven't entered the state).
    */
-  std::map<size_t, State*> _targets;
-
-  /*!
-   @brief    Lock to protect _targets;
-   */
-  ReadersWriterLock _lock;
+  AgentSideTable<State*> _targets;
 };
 
 ///////////////////////////////////////////////////////////////////////////
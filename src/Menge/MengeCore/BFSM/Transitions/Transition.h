@@ -118,6 +118,8 @@ class Transition {
    */
   Transition* copy();
 
+  friend class TransitionTable;
+
  protected:
   /*!
    @brief    The Condition instance for this transition.
@@ -71,6 +71,12 @@ void NavMeshVelComponent::onExit(Agents::BaseAgent* agent) { _localizer->clearPa
 
 /////////////////////////////////////////////////////////////////////
 
+void NavMeshVelComponent::onExitBatch(const std::vector<Agents::BaseAgent*>& agents) {
+  _localizer->clearPaths(agents);
+}
+
+/////////////////////////////////////////////////////////////////////
+
 void NavMeshVelComponent::setHeadingDeviation(float angle) { _headingDevCos = cos(angle); }
 
 /////////////////////////////////////////////////////////////////////
@@ -89,6 +95,11 @@ void NavMeshVelComponent::setPrefVelocity(const Agents::BaseAgent* agent, const
           "navigation mesh.  Bad NavMeshVelComponent!");
     }
     unsigned int agtNode = _localizer->getNode(agent);
+    if (agtNode == NavMeshLocation::NO_NODE) {
+      throw VelCompFatalException(
+          "Can't compute a path for an agent outside of the "
+          "navigation mesh.  Bad NavMeshVelComponent!");
+    }
     PortalRoute* route =
         _localizer->getPlanner()->getRoute(agtNode, goalNode, agent->_radius * 2.f);
     // compute the path
@@ -64,6 +64,14 @@ class MENGE_API NavMeshVelComponent : public VelComponent {
    */
   virtual void onExit(Agents::BaseAgent* agent);
 
+  /*!
+   @brief    Called when a batch of agents exits the state; the paths of all agents are cleared
+            under a single lock.
+
+   @param    agents    The agents exiting the state.
+   */
+  virtual void onExitBatch(const std::vector<Agents::BaseAgent*>& agents);
+
   /*!
    @brief    Sets the navigation mesh pointer.
 
@@ -94,6 +94,21 @@ void RoadMapVelComponent::onExit(Agents::BaseAgent* agent) {
 
 /////////////////////////////////////////////////////////////////////
 
+void RoadMapVelComponent::onExitBatch(const std::vector<Agents::BaseAgent*>& agents) {
+  // See onExit() for why the paths may not exist.
+  _lock.lockWrite();
+  for (size_t i = 0; i < agents.size(); ++i) {
+    PathMap::iterator itr = _paths.find(agents[i]->_id);
+    if (itr != _paths.end()) {
+      delete itr->second;
+      _paths.erase(itr);
+    }
+  }
+  _lock.releaseWrite();
+}
+
+/////////////////////////////////////////////////////////////////////
+
 void RoadMapVelComponent::setPrefVelocity(const Agents::BaseAgent* agent, const Goal* goal,
                                           Agents::PrefVelocity& pVel) const {
   _lock.lockRead();
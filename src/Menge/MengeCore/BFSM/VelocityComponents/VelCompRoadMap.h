@@ -109,6 +109,14 @@ class MENGE_API RoadMapVelComponent : public VelComponent {
    */
   virtual void onExit(Agents::BaseAgent* agent);
 
+  /*!
+   @brief    Called when a batch of agents leaves the state; the paths of all agents are released
+            under a single lock.
+
+   @param    agents    The agents who left the state.
+   */
+  virtual void onExitBatch(const std::vector<Agents::BaseAgent*>& agents);
+
   /*!
    @brief    Computes and sets the agent's preferred velocity.
 
@@ -39,9 +39,14 @@ Any questions or comments should be sent to the authors {menge,geom}@cs.unc.edu
 #include "MengeCore/BFSM/VelocityComponents/VelCompVF.h"
 
 #include "MengeCore/Agents/BaseAgent.h"
+#include "MengeCore/Agents/SpatialQueries/SpatialQuery.h"
 #include "MengeCore/BFSM/Goals/Goal.h"
+#include "MengeCore/Core.h"
+#include "MengeCore/Math/Geometry2D.h"
 #include "MengeCore/Runtime/Logger.h"
 #include "MengeCore/Runtime/os.h"
+#include "MengeCore/resources/EikonalField.h"
+#include "MengeCore/resources/NavMesh.h"
 
 #include <iomanip>
 #include <sstream>
@@ -129,5 +134,94 @@ bool VFVCFactory::setFromXML(VelComponent* vc, TiXmlElement* node,
   return true;
 }
 
+/////////////////////////////////////////////////////////////////////
+//                   Implementation of EikonalVCFactory
+/////////////////////////////////////////////////////////////////////
+
+EikonalVCFactory::EikonalVCFactory() : VelCompFactory() {
+  _navMeshID = _attrSet.addStringAttribute("nav_mesh", false /*required*/, "");
+  _cellSizeID = _attrSet.addFloatAttribute("cell_size", false /*required*/, 0.25f);
+  _clearanceID = _attrSet.addFloatAttribute("clearance", false /*required*/, 0.f);
+  _cacheFileID = _attrSet.addStringAttribute("cache_file", false /*required*/, "");
+  _useNearestID = _attrSet.addBoolAttribute("use_nearest", false /*required*/, false /*default*/);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool EikonalVCFactory::setFromXML(VelComponent* vc, TiXmlElement* node,
+                                  const std::string& behaveFldr) const {
+  VFVelComponent* vfvc = dynamic_cast<VFVelComponent*>(vc);
+  assert(vfvc != 0x0 &&
+         "Trying to set attributes of an eikonal field velocity "
+         "component on an incompatible object");
+
+  if (!VelCompFactory::setFromXML(vfvc, node, behaveFldr)) return false;
+
+  EikonalFieldBuilder builder(_attrSet.getFloat(_cellSizeID));
+  builder.setClearance(_attrSet.getFloat(_clearanceID));
+
+  // The goal set
+  for (TiXmlElement* child = node->FirstChildElement(); child;
+       child = child->NextSiblingElement()) {
+    if (child->ValueStr() == "Goal") {
+      Math::Geometry2D* goal = Math::createGeometry(child);
+      if (goal == 0x0) {
+        logger << Logger::ERR_MSG << "Invalid goal definition for the eikonal field velocity ";
+        logger << "component on line " << child->Row() << ".";
+        return false;
+      }
+      builder.addGoal(goal);
+    } else {
+      logger << Logger::WARN_MSG << "Unrecognized child tag of the eikonal field velocity ";
+      logger << "component on line " << child->Row() << ": " << child->ValueStr() << ".";
+    }
+  }
+  if (builder.getGoalCount() == 0) {
+    logger << Logger::ERR_MSG << "The eikonal field velocity component on line " << node->Row();
+    logger << " doesn't define any goals.";
+    return false;
+  }
+
+  // The walkable domain
+  NavMeshPtr nmPtr;
+  const std::string navMeshName = _attrSet.getString(_navMeshID);
+  if (navMeshName != "") {
+    std::string fName;
+    std::string path = os::path::join(2, behaveFldr.c_str(), navMeshName.c_str());
+    os::path::absPath(path, fName);
+    try {
+      nmPtr = loadNavMesh(fName);
+    } catch (ResourceException) {
+      logger << Logger::ERR_MSG << "Couldn't instantiate the navigation mesh referenced on line ";
+      logger << node->Row() << ".";
+      return false;
+    }
+    builder.setNavMesh(nmPtr.operator->());
+  }
+  if (SPATIAL_QUERY != 0x0) {
+    builder.addObstacles(SPATIAL_QUERY->getObstacles());
+  }
+
+  std::string cacheName;
+  const std::string cacheFile = _attrSet.getString(_cacheFileID);
+  if (cacheFile != "") {
+    std::string path = os::path::join(2, behaveFldr.c_str(), cacheFile.c_str());
+    os::path::absPath(path, cacheName);
+  }
+  VectorFieldPtr vfPtr;
+  try {
+    vfPtr = buildEikonalField(builder, cacheName);
+  } catch (ResourceException) {
+    logger << Logger::ERR_MSG
+           << "Couldn't compute the eikonal vector field for the velocity component on line "
+           << node->Row() << ".";
+    return false;
+  }
+  vfvc->setVectorField(vfPtr);
+  vfvc->setUseNearest(_attrSet.getBool(_useNearestID));
+
+  return true;
+}
+
 }  // namespace BFSM
 }  // namespace Menge
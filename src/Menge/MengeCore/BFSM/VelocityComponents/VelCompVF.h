@@ -208,6 +208,121 @@ class MENGE_API VFVCFactory : public VelCompFactory {
   size_t _useNearestID;
 };
 
+//////////////////////////////////////////////////////////////////////////////
+
+/*!
+ @brief    Factory for a VFVelComponent whose vector field is *computed* (rather than read from a
+          file) as the shortest paths to a set of goal regions.
+
+ The field is the solution of the eikonal equation over the walkable domain (see
+ EikonalFieldBuilder). It replaces per-agent path planning with a single precomputation and a
+ constant-time look up per agent; it is best suited to states in which all agents share the same
+ destination(s) (e.g., evacuation).
+
+ It is specified in XML as:
+
+ @code{xml}
+ <VelComponent type="eikonal_field" nav_mesh="floor.nav" cell_size="0.25" clearance="0.0"
+               cache_file="exits.vfb" use_nearest="0">
+   <Goal shape="aabb" min_x="-1" max_x="1" min_y="20" max_y="22" />
+   <Goal shape="circle" x="40" y="0" radius="1.5" />
+ </VelComponent>
+ @endcode
+
+   - `nav_mesh` (optional): a navigation mesh defining the walkable domain. If omitted, the domain
+     is the bounding region of the scene's obstacles and every cell not blocked by an obstacle is
+     walkable.
+   - `cell_size` (optional): the size of the grid cells (defaults to 0.25).
+   - `clearance` (optional): cells whose centers lie within this distance of a scene obstacle
+     are blocked. Zero (the default) uses half the cell diagonal.
+   - `cache_file` (optional): if given and the file exists, the field is loaded from it; otherwise
+     the field is computed and written to it (in the binary vector field format). Delete the file
+     to force the field to be recomputed.
+   - `use_nearest` (optional): the same as for the `vel_field` velocity component (defaults to 0,
+     i.e., bilinear interpolation).
+   - `Goal` (one or more): the goal regions, defined with the usual shape attributes (`point`,
+     `circle`, `aabb` or `obb`).
+
+ File paths are relative to the behavior file.
+ */
+class MENGE_API EikonalVCFactory : public VelCompFactory {
+ public:
+  /*!
+   @brief    Constructor.
+   */
+  EikonalVCFactory();
+
+  /*!
+   @brief    The name of the velocity component.
+
+   The velocity component's name must be unique among all registered
+   velocity components.  Each velocity component factory must override this function.
+
+   @returns  A string containing the unique velocity component name.
+   */
+  virtual const char* name() const { return "eikonal_field"; }
+
+  /*!
+   @brief    A description of the velocity component.
+
+   Each velocity component factory must override this function.
+
+   @returns  A string containing the velocity component description.
+   */
+  virtual const char* description() const {
+    return "Provides a preferred velocity from a vector field which is computed, at load time, "
+           "as the shortest paths to a set of goal regions through the walkable domain (defined "
+           "by a navigation mesh or the scene's obstacles).";
+  };
+
+ protected:
+  /*!
+  @brief    Create an instance of this class's velocity component.
+
+  @returns    A pointer to a newly instantiated VelComponent class.
+  */
+  VelComponent* instance() const { return new VFVelComponent(); }
+
+  /*!
+   @brief    Given a pointer to an VelComponent instance, sets the appropriate
+   fields from the provided XML node.
+
+   @param    vc          A pointer to the velocity component whose attributes are to be set.
+   @param    node        The XML node containing the velocity component attributes.
+   @param    behaveFldr  The path to the behavior file.  If the velocity component references
+                         resources in the file system, it should be defined relative to the behavior
+                         file location.  This is the folder containing that path.
+   @returns  A boolean reporting success (true) or failure (false).
+   */
+  virtual bool setFromXML(VelComponent* vc, TiXmlElement* node,
+                          const std::string& behaveFldr) const;
+
+  /*!
+   @brief    The identifier for the "nav_mesh" string attribute.
+   */
+  size_t _navMeshID;
+
+  /*!
+   @brief    The identifier for the "cell_size" float attribute.
+   */
+  size_t _cellSizeID;
+
+  /*!
+   @brief    The identifier for the "clearance" float attribute.
+   */
+  size_t _clearanceID;
+
+  /*!
+   @brief    The identifier for the "cache_file" string attribute.
+   */
+  size_t _cacheFileID;
+
+  /*!
+   @brief    The identifier for the "use_nearest" bool attribute.
+   */
+  size_t _useNearestID;
+};
+
 }  // namespace BFSM
 }  // namespace Menge
 
@@ -57,6 +57,23 @@ namespace BFSM {
       return new VelCompContext();
     }
 #endif
+
+/////////////////////////////////////////////////////////////////////
+
+void VelComponent::onEnterBatch(const std::vector<Agents::BaseAgent*>& agents) {
+  for (size_t i = 0; i < agents.size(); ++i) {
+    onEnter(agents[i]);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void VelComponent::onExitBatch(const std::vector<Agents::BaseAgent*>& agents) {
+  for (size_t i = 0; i < agents.size(); ++i) {
+    onExit(agents[i]);
+  }
+}
+
 /////////////////////////////////////////////////////////////////////
 //          Implementation of parsing function
 /////////////////////////////////////////////////////////////////////
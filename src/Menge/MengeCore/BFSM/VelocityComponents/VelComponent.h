@@ -117,6 +117,29 @@ class MENGE_API VelComponent : public Element {
    */
   virtual void onExit(Agents::BaseAgent* agent) {}
 
+  /*!
+   @brief    Called when a batch of agents enters the state at once; it must be equivalent to
+            calling onEnter() for each agent.
+
+   The default implementation calls onEnter() for each agent, in order, so that any values the
+   component draws (e.g., from a random distribution) don't depend on the number of threads.
+   Sub-classes can override this to initialize the whole batch more efficiently (e.g., in parallel,
+   if their onEnter() is known to be thread-safe).
+
+   @param    agents    The agents who entered the state.
+   */
+  virtual void onEnterBatch(const std::vector<Agents::BaseAgent*>& agents);
+
+  /*!
+   @brief    Called when a batch of agents leaves the state at once; it must be equivalent to
+            calling onExit() for each agent.
+
+   As with onEnterBatch(), the default implementation calls onExit() for each agent, in order.
+
+   @param    agents    The agents who left the state.
+   */
+  virtual void onExitBatch(const std::vector<Agents::BaseAgent*>& agents);
+
   /*!
    @brief    Computes and sets the agent's preferred velocity.
 
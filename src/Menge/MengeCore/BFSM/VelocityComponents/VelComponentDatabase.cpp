@@ -61,6 +61,7 @@ void ElementDB<BFSM::VelCompFactory, BFSM::VelComponent>::addBuiltins() {
   addFactory(new BFSM::ZeroVCFactory());
   addFactory(new BFSM::GoalVCFactory());
   addFactory(new BFSM::VFVCFactory());
+  addFactory(new BFSM::EikonalVCFactory());
   addFactory(new BFSM::RoadMapVCFactory());
   addFactory(new BFSM::NavMeshVCFactory());
 }
@@ -53,6 +53,7 @@ Any questions or comments should be sent to the authors {menge,geom}@cs.unc.edu
 #include "MengeCore/Agents/SpatialQueries/SpatialQuery.h"
 #include "MengeCore/BFSM/FSM.h"
 #include "MengeCore/BFSM/GoalSelectors/GoalSelector.h"
+#include "MengeCore/BFSM/GoalSet.h"
 #include "MengeCore/BFSM/GoalSelectors/GoalSelectorIdentity.h"
 #include "MengeCore/BFSM/GoalSelectors/GoalSelectorShared.h"
 #include "MengeCore/BFSM/State.h"
@@ -79,6 +80,7 @@ FSM* buildFSM(FSMDescrip& fsmDescrip, Agents::SimulatorInterface* sim, bool VERB
   bool valid = true;
   const size_t AGT_COUNT = sim->getNumAgents();
   FSM* fsm = new FSM(sim);
+  fsm->setUpdateInterval(fsmDescrip._updateInterval);
 
   // Build the fsm
 
@@ -92,6 +94,10 @@ FSM* buildFSM(FSMDescrip& fsmDescrip, Agents::SimulatorInterface* sim, bool VERB
   fsm->_goalSets.clear();
   fsm->_goalSets.insert(fsmDescrip._goalSets.begin(), fsmDescrip._goalSets.end());
   fsmDescrip._goalSets.clear();
+  std::map<size_t, GoalSet*>::iterator gsItr = fsm->_goalSets.begin();
+  for (; gsItr != fsm->_goalSets.end(); ++gsItr) {
+    gsItr->second->buildIndex();
+  }
 
   //  1. Create states
   //    a. Add velocity components and actions
@@ -267,6 +273,11 @@ FSM* buildFSM(FSMDescrip& fsmDescrip, Agents::SimulatorInterface* sim, bool VERB
   if (VERBOSE) logger << Logger::INFO_MSG << "Initializing agents:\n";
   Agents::SimulatorState* initState = sim->getInitialState();
 
+  // Consecutive agents starting in the same state enter it as a batch; the agents still enter their
+  // states in agent order, so goals are assigned in the same order as entering one at a time.
+  std::vector<Agents::BaseAgent*> entering;
+  std::vector<Agents::BaseAgent*> entered;
+  State* enteringState = 0x0;
   for (size_t a = 0; a < AGT_COUNT; ++a) {
     Agents::BaseAgent* agt = sim->getAgent(a);
     // update current state to class-appropriate value
@@ -288,7 +299,17 @@ FSM* buildFSM(FSMDescrip& fsmDescrip, Agents::SimulatorInterface* sim, bool VERB
       logger << cState->getName() << ".";
     }
     fsm->setCurrentState(agt, stateID);
-    cState->enter(agt);
+    if (cState != enteringState && !entering.empty()) {
+      enteringState->enterBatch(entering, entered);
+      entering.clear();
+    }
+    enteringState = cState;
+    entering.push_back(agt);
+  }
+  if (!entering.empty()) enteringState->enterBatch(entering, entered);
+
+  for (size_t a = 0; a < AGT_COUNT; ++a) {
+    Agents::BaseAgent* agt = sim->getAgent(a);
     // TODO: Restore support for defining inital velocity state: zero or preferred
     agt->_vel.set(Vector2(0.f, 0.f));
 
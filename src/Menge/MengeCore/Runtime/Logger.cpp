@@ -43,10 +43,322 @@ Any questions or comments should be sent to the authors {menge,geom}@cs.unc.edu
 #ifndef _WIN32
 #include <cstddef>
 #endif
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace Menge {
 
+/////////////////////////////////////////////////////////////////////
+//          Implementation of LogQueue
+/////////////////////////////////////////////////////////////////////
+
+/*!
+ @brief    The asynchronous machinery of the Logger.
+
+ Each thread composes its current message in its own slot. A message is handed to the consumer (the
+ background thread, or a thread calling Logger::flush()) by pushing it onto a lock-free stack when
+ the thread starts its next message; the consumer also collects messages that have been left in the
+ slots. The consumer takes the whole stack at once and restores the order.
+ */
+class LogQueue {
+ public:
+  /*!
+   @brief    The kinds of fragments.
+   */
+  enum FragmentKind {
+    MESSAGE,  ///< The start of a new message.
+    TEXT,     ///< Text continuing the thread's current message.
+    LINE      ///< A divider.
+  };
+
+  /*!
+   @brief    A message (or a piece of one) posted by a single thread.
+   */
+  struct Fragment {
+    Fragment* next;          ///< The next fragment in the stack.
+    std::thread::id thread;  ///< The posting thread.
+    FragmentKind kind;       ///< The kind of fragment.
+    Logger::LogType type;    ///< The message type (MESSAGE only).
+    std::string text;        ///< The text.
+  };
+
+  /*!
+   @brief    The buffer in which a thread composes its current message.
+   */
+  struct ThreadSlot {
+    std::atomic<Fragment*> message;  ///< The message being composed (NULL if none).
+    std::atomic<Fragment*> error;    ///< The error being composed (NULL if none).
+    std::thread::id thread;          ///< The thread which owns the slot.
+  };
+
+  /*!
+   @brief    The consumer's record of the last message from a thread.
+   */
+  struct ThreadState {
+    ThreadState() : type(Logger::INFO_MSG), awaitingText(false), dropped(false) {}
+    Logger::LogType type;  ///< The type of the message.
+    bool awaitingText;     ///< True if the message has started but has no text yet.
+    bool dropped;          ///< True if the message was dropped as a repetition.
+  };
+
+  /*!
+   @brief    The record of a family of similar messages.
+   */
+  struct Repeat {
+    std::chrono::steady_clock::time_point start;  ///< The start of the current window.
+    size_t count;                                 ///< The messages seen in the window.
+    size_t suppressed;                            ///< The messages dropped in the window.
+    Logger::LogType type;                         ///< The type of the messages.
+    std::string sample;                           ///< The first message of the window.
+  };
+
+  LogQueue()
+      : generation(++GENERATIONS),
+        head(0x0),
+        started(false),
+        stopping(false),
+        closed(false),
+        owner(),
+        hasOwner(false),
+        maxRepeats(10),
+        window(1.f) {}
+
+  ~LogQueue() {
+    collect(true);
+    Fragment* f = takeAll();
+    while (f != 0x0) {
+      Fragment* next = f->next;
+      delete f;
+      f = next;
+    }
+    for (size_t i = 0; i < slots.size(); ++i) delete slots[i];
+  }
+
+  /*!
+   @brief    Returns the calling thread's slot.
+   */
+  ThreadSlot* slot();
+
+  /*!
+   @brief    Pushes a fragment onto the stack; safe to call from any thread.
+   */
+  void push(Fragment* f) {
+    f->next = head.load(std::memory_order_relaxed);
+    while (!head.compare_exchange_weak(f->next, f, std::memory_order_release,
+                                       std::memory_order_relaxed)) {
+    }
+  }
+
+  /*!
+   @brief    Pushes the messages left in every thread's slot.
+
+   Errors are only pushed when they are complete (see endError()), so that each one is written and
+   rate limited as a whole.
+
+   @param    errors    If true, unfinished errors are pushed as well.
+   */
+  void collect(bool errors = false) {
+    std::lock_guard<std::mutex> lock(slotLock);
+    for (size_t i = 0; i < slots.size(); ++i) {
+      Fragment* f = slots[i]->message.exchange(0x0, std::memory_order_acquire);
+      if (f != 0x0) push(f);
+      if (errors) {
+        f = slots[i]->error.exchange(0x0, std::memory_order_acquire);
+        if (f != 0x0) push(f);
+      }
+    }
+  }
+
+  /*!
+   @brief    Pushes the error the thread has been composing, if any.
+
+   @param    s    The calling thread's slot.
+   @returns  True if an error was pushed.
+   */
+  bool endError(ThreadSlot* s) {
+    Fragment* f = s->error.exchange(0x0, std::memory_order_acquire);
+    if (f == 0x0) return false;
+    push(f);
+    return true;
+  }
+
+  /*!
+   @brief    Takes every fragment posted so far, in the order they were posted.
+   */
+  Fragment* takeAll() {
+    Fragment* f = head.exchange(0x0, std::memory_order_acquire);
+    Fragment* ordered = 0x0;
+    while (f != 0x0) {
+      Fragment* next = f->next;
+      f->next = ordered;
+      ordered = f;
+      f = next;
+    }
+    return ordered;
+  }
+
+  /*!
+   @brief    Distinguishes this queue from any other (even one later allocated at the same
+              address); used to validate each thread's cached slot.
+   */
+  const unsigned long long generation;
+
+  /*!
+   @brief    The top of the lock-free stack of posted fragments.
+   */
+  std::atomic<Fragment*> head;
+
+  /*!
+   @brief    The slots of every thread which has logged a message.
+   */
+  std::vector<ThreadSlot*> slots;
+
+  /*!
+   @brief    Guards the list of slots.
+   */
+  std::mutex slotLock;
+
+  /*!
+   @brief    Indicates that the background thread has been started.
+   */
+  std::atomic<bool> started;
+
+  /*!
+   @brief    Tells the background thread to finish.
+   */
+  bool stopping;
+
+  /*!
+   @brief    Indicates the logger has been closed; subsequent messages are written synchronously.
+   */
+  std::atomic<bool> closed;
+
+  /*!
+   @brief    The background thread.
+   */
+  std::thread flushThread;
+
+  /*!
+   @brief    Serializes starting and stopping the background thread.
+   */
+  std::mutex threadLock;
+
+  /*!
+   @brief    Wakes the background thread when stopping.
+   */
+  std::condition_variable wake;
+
+  /*!
+   @brief    Guards the output and all of the consumer state below.
+   */
+  std::mutex outputLock;
+
+  /*!
+   @brief    The thread whose message is in the open row (if hasOwner is true).
+   */
+  std::thread::id owner;
+
+  /*!
+   @brief    Indicates that text from `owner` can be appended to the open row.
+   */
+  bool hasOwner;
+
+  /*!
+   @brief    The last message from each thread.
+   */
+  std::map<std::thread::id, ThreadState> threads;
+
+  /*!
+   @brief    The families of recent warnings and errors, keyed by type and text without digits.
+   */
+  std::map<std::string, Repeat> repeats;
+
+  /*!
+   @brief    The number of similar messages written per window (zero for no limit).
+   */
+  size_t maxRepeats;
+
+  /*!
+   @brief    The length of the rate-limiting window, in seconds.
+   */
+  float window;
+
+  /*!
+   @brief    The number of queues created so far.
+   */
+  static std::atomic<unsigned long long> GENERATIONS;
+};
+
+std::atomic<unsigned long long> LogQueue::GENERATIONS(0);
+
+namespace {
+// The interval at which the background thread drains the queue.
+const std::chrono::milliseconds FLUSH_INTERVAL(10);
+
+// Formats values the way they would be written to a stream (without the cost of constructing one
+// for every value).
+std::string format(unsigned long long value) {
+  char buffer[24];
+  sprintf(buffer, "%llu", value);
+  return buffer;
+}
+
+std::string format(long long value) {
+  char buffer[24];
+  sprintf(buffer, "%lld", value);
+  return buffer;
+}
+
+std::string format(double value) {
+  // The default precision of a stream is six significant digits.
+  char buffer[32];
+  sprintf(buffer, "%g", value);
+  return buffer;
+}
+
+// The calling thread's slot in the most recently used queue.
+struct SlotCache {
+  unsigned long long generation;
+  LogQueue::ThreadSlot* slot;
+};
+
+#if defined(_MSC_VER) && _MSC_VER < 1900
+__declspec(thread) SlotCache THREAD_SLOT = {0, 0x0};
+#else
+thread_local SlotCache THREAD_SLOT = {0, 0x0};
+#endif
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////
+
+LogQueue::ThreadSlot* LogQueue::slot() {
+  if (THREAD_SLOT.generation == generation) return THREAD_SLOT.slot;
+  const std::thread::id id = std::this_thread::get_id();
+  std::lock_guard<std::mutex> lock(slotLock);
+  ThreadSlot* s = 0x0;
+  // Thread ids are reused; a new thread can take over the slot of one which has finished.
+  for (size_t i = 0; i < slots.size() && s == 0x0; ++i) {
+    if (slots[i]->thread == id) s = slots[i];
+  }
+  if (s == 0x0) {
+    s = new ThreadSlot();
+    s->message.store(0x0);
+    s->error.store(0x0);
+    s->thread = id;
+    slots.push_back(s);
+  }
+  THREAD_SLOT.generation = generation;
+  THREAD_SLOT.slot = s;
+  return s;
+}
+
 /////////////////////////////////////////////////////////////////////
 //          Implementation of Logger
 /////////////////////////////////////////////////////////////////////
@@ -55,7 +367,7 @@ Logger logger;
 
 /////////////////////////////////////////////////////////////////////
 
-Logger::Logger() : _validFile(false), _file(), _streamType(UNDEF_LOG) {
+Logger::Logger() : _validFile(false), _file(), _streamType(UNDEF_LOG), _queue(new LogQueue()) {
   // test for the existence of the style sheet
   if (!os::path::exists("log.css")) {
     std::ofstream cssFile;
@@ -124,38 +436,88 @@ Logger::Logger() : _validFile(false), _file(), _streamType(UNDEF_LOG) {
 
 /////////////////////////////////////////////////////////////////////
 
-Logger::~Logger() { close(); }
+Logger::~Logger() {
+  close();
+  delete _queue;
+}
 
 /////////////////////////////////////////////////////////////////////
 
 void Logger::close() {
+  {
+    std::lock_guard<std::mutex> lock(_queue->threadLock);
+    if (_queue->started) {
+      {
+        std::lock_guard<std::mutex> outLock(_queue->outputLock);
+        _queue->stopping = true;
+      }
+      _queue->wake.notify_one();
+      _queue->flushThread.join();
+      _queue->stopping = false;
+      _queue->started = false;
+    }
+    _queue->closed = true;
+  }
+  std::lock_guard<std::mutex> lock(_queue->outputLock);
+  _queue->collect(true);
+  drain();
+  reportRepeats(true);
   if (_validFile) {
     writeTail();
     _file.close();
     _validFile = false;
+  } else {
+    closeRow();
+    std::cout.flush();
   }
+  _streamType = UNDEF_LOG;
+  _queue->hasOwner = false;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void Logger::flush() {
+  std::lock_guard<std::mutex> lock(_queue->outputLock);
+  drain();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void Logger::setRateLimit(size_t maxRepeats, float window) {
+  std::lock_guard<std::mutex> lock(_queue->outputLock);
+  _queue->maxRepeats = maxRepeats;
+  _queue->window = window;
 }
 
 /////////////////////////////////////////////////////////////////////
 
 void Logger::line() {
-  if (_validFile) {
-    if (_streamType != UNDEF_LOG) {
-      _file << "</td>\n\t</tr>\n";
-    }
-    _file << "\t<tr>\n\t\t<td class=\"divider\"/>\n\t</tr>\n";
+  LogQueue::ThreadSlot* slot = _queue->slot();
+  const bool error = _queue->endError(slot);
+  LogQueue::Fragment* f = slot->message.exchange(0x0, std::memory_order_acquire);
+  if (f != 0x0) _queue->push(f);
+  f = new LogQueue::Fragment();
+  f->thread = slot->thread;
+  f->kind = LogQueue::LINE;
+  f->type = UNDEF_LOG;
+  _queue->push(f);
+  if (error) {
+    flush();
   } else {
-    if (_streamType != Logger::UNDEF_LOG) {
-      std::cout << "\n";
-    }
-    std::cout << "============================\n";
+    startFlushing();
   }
-  _streamType = UNDEF_LOG;
 }
 
 /////////////////////////////////////////////////////////////////////
 
 void Logger::setFile(const std::string& fileName) {
+  std::lock_guard<std::mutex> lock(_queue->outputLock);
+  // Everything logged before the file was specified goes to the console.
+  drain();
+  closeRow();
+  _streamType = UNDEF_LOG;
+  _queue->hasOwner = false;
+  _queue->closed = false;
   _file.open(fileName.c_str(), std::ios::out);
   _validFile = _file.is_open();
   if (_validFile) {
@@ -168,6 +530,246 @@ void Logger::setFile(const std::string& fileName) {
 
 /////////////////////////////////////////////////////////////////////
 
+void Logger::post(const char* text) {
+  LogQueue::ThreadSlot* slot = _queue->slot();
+  // An error is composed apart from other messages; the consumer doesn't collect it until it ends.
+  LogQueue::Fragment* f = slot->error.exchange(0x0, std::memory_order_acquire);
+  if (f != 0x0) {
+    f->text += text;
+    slot->error.store(f, std::memory_order_release);
+    return;
+  }
+  // Taking the message out of the slot keeps the consumer from collecting it while it changes.
+  f = slot->message.exchange(0x0, std::memory_order_acquire);
+  if (f == 0x0) {
+    // The message was collected (or never started); the text continues it.
+    f = new LogQueue::Fragment();
+    f->thread = slot->thread;
+    f->kind = LogQueue::TEXT;
+    f->type = UNDEF_LOG;
+  }
+  f->text += text;
+  slot->message.store(f, std::memory_order_release);
+  startFlushing();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void Logger::post(LogType type) {
+  LogQueue::ThreadSlot* slot = _queue->slot();
+  // Errors are written as soon as they end: they are most needed when the process is about to
+  // die, before the background thread would get to them.
+  if (_queue->endError(slot)) flush();
+  LogQueue::Fragment* f = new LogQueue::Fragment();
+  f->thread = slot->thread;
+  f->kind = LogQueue::MESSAGE;
+  f->type = type == UNDEF_LOG ? INFO_MSG : type;
+  LogQueue::Fragment* done = slot->message.exchange(f->type == ERR_MSG ? 0x0 : f,
+                                                    std::memory_order_acq_rel);
+  if (done != 0x0) _queue->push(done);
+  if (f->type == ERR_MSG) slot->error.store(f, std::memory_order_release);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void Logger::startFlushing() {
+  if (_queue->started.load(std::memory_order_acquire)) return;
+  if (_queue->closed) {
+    // There is no background thread after close(); write immediately.
+    flush();
+    return;
+  }
+  std::lock_guard<std::mutex> lock(_queue->threadLock);
+  if (!_queue->started && !_queue->closed) {
+    _queue->flushThread = std::thread(&Logger::flushLoop, this);
+    _queue->started = true;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void Logger::flushLoop() {
+  std::unique_lock<std::mutex> lock(_queue->outputLock);
+  while (!_queue->stopping) {
+    _queue->wake.wait_for(lock, FLUSH_INTERVAL);
+    drain();
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void Logger::drain() {
+  _queue->collect();
+  LogQueue::Fragment* f = _queue->takeAll();
+  const bool wrote = f != 0x0;
+  while (f != 0x0) {
+    LogQueue::ThreadState& state = _queue->threads[f->thread];
+    const bool isOwner = _queue->hasOwner && _queue->owner == f->thread;
+    bool newMessage = false;
+    switch (f->kind) {
+      case LogQueue::MESSAGE:
+        if (isOwner) _queue->hasOwner = false;
+        state = LogQueue::ThreadState();
+        state.type = f->type;
+        state.awaitingText = true;
+        newMessage = !f->text.empty();
+        break;
+      case LogQueue::TEXT:
+        newMessage = state.awaitingText;
+        if (!newMessage && !state.dropped) {
+          // The rest of a message which was collected while it was being composed.
+          if (!isOwner) openRow(state.type);
+          writeText(f->text);
+          _queue->owner = f->thread;
+          _queue->hasOwner = true;
+        }
+        break;
+      case LogQueue::LINE:
+        closeRow();
+        if (_validFile) {
+          _file << "\t<tr>\n\t\t<td class=\"divider\"/>\n\t</tr>\n";
+        } else {
+          std::cout << "============================\n";
+        }
+        _queue->hasOwner = false;
+        break;
+    }
+    if (newMessage) {
+      state.awaitingText = false;
+      if (admit(state.type, f->text)) {
+        openRow(state.type);
+        writeText(f->text);
+        _queue->owner = f->thread;
+        _queue->hasOwner = true;
+      } else {
+        state.dropped = true;
+      }
+    }
+    LogQueue::Fragment* next = f->next;
+    delete f;
+    f = next;
+  }
+  reportRepeats(false);
+  if (wrote) {
+    if (_validFile) {
+      _file.flush();
+    } else {
+      std::cout.flush();
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void Logger::openRow(LogType type) {
+  closeRow();
+  if (_validFile) {
+    _file << "\t<tr>\n\t\t<td class=\"";
+    switch (type) {
+      case Logger::UNDEF_LOG:
+      case Logger::INFO_MSG:
+        _file << "inf";
+        break;
+      case Logger::WARN_MSG:
+        _file << "war";
+        break;
+      case Logger::ERR_MSG:
+        _file << "err";
+        break;
+    }
+    _file << "\">";
+  } else {
+    switch (type) {
+      case Logger::UNDEF_LOG:
+        std::cout << "?  ";
+        break;
+      case Logger::INFO_MSG:
+        std::cout << "-  ";
+        break;
+      case Logger::WARN_MSG:
+        std::cout << "!  ";
+        break;
+      case Logger::ERR_MSG:
+        std::cout << "X  ";
+        break;
+    }
+  }
+  _streamType = type;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void Logger::closeRow() {
+  if (_streamType != UNDEF_LOG) {
+    if (_validFile) {
+      _file << "</td>\n\t</tr>\n";
+    } else {
+      std::cout << "\n";
+    }
+  }
+  _streamType = UNDEF_LOG;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void Logger::writeText(const std::string& text) {
+  std::string msgStr(text);
+  processText(msgStr);
+  if (_validFile) {
+    _file << msgStr;
+  } else {
+    std::cout << msgStr;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool Logger::admit(LogType type, const std::string& text) {
+  if (_queue->maxRepeats == 0 || type < WARN_MSG) return true;
+  // Messages which only differ in their numbers (agent ids, positions, etc.) are repetitions.
+  std::string key(1, static_cast<char>('0' + type));
+  for (size_t i = 0; i < text.size(); ++i) {
+    if (text[i] < '0' || text[i] > '9') key += text[i];
+  }
+  const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  LogQueue::Repeat& rep = _queue->repeats[key];
+  if (rep.count == 0) {
+    rep.start = now;
+    rep.suppressed = 0;
+    rep.type = type;
+    rep.sample = text.substr(0, 120);
+  }
+  if (++rep.count <= _queue->maxRepeats) return true;
+  ++rep.suppressed;
+  return false;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void Logger::reportRepeats(bool all) {
+  if (_queue->repeats.empty()) return;
+  const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  const std::chrono::duration<float> window(_queue->window);
+  std::map<std::string, LogQueue::Repeat>::iterator itr = _queue->repeats.begin();
+  while (itr != _queue->repeats.end()) {
+    const LogQueue::Repeat& rep = itr->second;
+    if (all || now - rep.start > window) {
+      if (rep.suppressed > 0) {
+        openRow(rep.type);
+        writeText("Suppressed " + format(static_cast<unsigned long long>(rep.suppressed)) +
+                  " similar message(s) in " + format(static_cast<double>(_queue->window)) +
+                  " s: " + rep.sample);
+        _queue->hasOwner = false;
+      }
+      _queue->repeats.erase(itr++);
+    } else {
+      ++itr;
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
 void Logger::writeHeader() {
   _file << "<html>\n";
   _file << "<head>\n";
@@ -188,9 +790,7 @@ void Logger::writeHeader() {
 /////////////////////////////////////////////////////////////////////
 
 void Logger::writeTail() {
-  if (_streamType != UNDEF_LOG) {
-    _file << "</td>\n\t</tr>\n";
-  }
+  closeRow();
   _file << "</table>\n";
   _file << "</div>\n";
   _file << "</div>\n";
@@ -233,141 +833,63 @@ void Logger::processText(std::string& input) {
 /////////////////////////////////////////////////////////////////////
 
 Logger& operator<<(Logger& logger, const std::string& msg) {
-  std::string msgStr(msg);
-  logger.processText(msgStr);
-  if (logger._validFile) {
-    logger._file << msgStr;
-  } else {
-    std::cout << msgStr;
-  }
+  logger.post(msg.c_str());
   return logger;
 }
 
 /////////////////////////////////////////////////////////////////////
 
 Logger& operator<<(Logger& logger, const char* msg) {
-  std::string msgStr(msg);
-  logger.processText(msgStr);
-  if (logger._validFile) {
-    logger._file << msgStr;
-  } else {
-    std::cout << msgStr;
-  }
+  logger.post(msg);
   return logger;
 }
 
 /////////////////////////////////////////////////////////////////////
 
 Logger& operator<<(Logger& logger, long unsigned int value) {
-  if (logger._validFile) {
-    logger._file << value;
-  } else {
-    std::cout << value;
-  }
+  logger.post(format(static_cast<unsigned long long>(value)).c_str());
   return logger;
 }
 #ifdef _WIN32
 /////////////////////////////////////////////////////////////////////
 
 Logger& operator<<(Logger& logger, size_t value) {
-  if (logger._validFile) {
-    logger._file << value;
-  } else {
-    std::cout << value;
-  }
+  logger.post(format(static_cast<unsigned long long>(value)).c_str());
   return logger;
 }
 #endif  // _WIN32
         /////////////////////////////////////////////////////////////////////
 #if !defined _MSC_VER || defined _M_X64
 Logger& operator<<(Logger& logger, unsigned int value) {
-  if (logger._validFile) {
-    logger._file << value;
-  } else {
-    std::cout << value;
-  }
+  logger.post(format(static_cast<unsigned long long>(value)).c_str());
   return logger;
 }
 #endif
 /////////////////////////////////////////////////////////////////////
 
 Logger& operator<<(Logger& logger, int value) {
-  if (logger._validFile) {
-    logger._file << value;
-  } else {
-    std::cout << value;
-  }
+  logger.post(format(static_cast<long long>(value)).c_str());
   return logger;
 }
 
 /////////////////////////////////////////////////////////////////////
 
 Logger& operator<<(Logger& logger, float value) {
-  if (logger._validFile) {
-    logger._file << value;
-  } else {
-    std::cout << value;
-  }
+  logger.post(format(static_cast<double>(value)).c_str());
   return logger;
 }
 
 /////////////////////////////////////////////////////////////////////
 
 Logger& operator<<(Logger& logger, double value) {
-  if (logger._validFile) {
-    logger._file << value;
-  } else {
-    std::cout << value;
-  }
+  logger.post(format(value).c_str());
   return logger;
 }
 
 /////////////////////////////////////////////////////////////////////
 
 Logger& operator<<(Logger& logger, Logger::LogType type) {
-  if (logger._validFile) {
-    if (logger._streamType != Logger::UNDEF_LOG) {
-      logger._file << "</td>\n\t</tr>\n";
-    } else {
-      type = Logger::INFO_MSG;
-    }
-    logger._file << "\t<tr>\n\t\t<td class=\"";
-    switch (type) {
-      case Logger::UNDEF_LOG:
-      case Logger::INFO_MSG:
-        logger._file << "inf";
-        break;
-      case Logger::WARN_MSG:
-        logger._file << "war";
-        break;
-      case Logger::ERR_MSG:
-        logger._file << "err";
-        break;
-    }
-    logger._file << "\">";
-
-  } else {
-    if (logger._streamType != Logger::UNDEF_LOG) {
-      std::cout << "\n";
-    } else {
-      type = Logger::INFO_MSG;
-    }
-    switch (type) {
-      case Logger::UNDEF_LOG:
-        std::cout << "?  ";
-        break;
-      case Logger::INFO_MSG:
-        std::cout << "-  ";
-        break;
-      case Logger::WARN_MSG:
-        std::cout << "!  ";
-        break;
-      case Logger::ERR_MSG:
-        std::cout << "X  ";
-        break;
-    }
-  }
-  logger._streamType = type;
+  logger.post(type);
   return logger;
 }
 
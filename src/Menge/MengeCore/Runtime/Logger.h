@@ -30,12 +30,47 @@
 #include <fstream>
 #include <string>
 
+/*!
+ @brief    The compile-time severity floor of the MENGE_LOG macro.
+
+ Messages logged through MENGE_LOG whose type is less than the floor are removed from the build
+ entirely (see Logger::LogType for the values; e.g., 2 keeps only warnings and errors and 4 removes
+ all of them). Messages streamed directly to the logger are unaffected.
+ */
+#ifndef MENGE_LOG_FLOOR
+#define MENGE_LOG_FLOOR 0
+#endif  // MENGE_LOG_FLOOR
+
+/*!
+ @brief    Starts a message of the given type (e.g., `MENGE_LOG(WARN_MSG) << "text";`).
+
+ The whole statement compiles away if the type is below MENGE_LOG_FLOOR, so it is the preferred way
+ to log from performance-critical code. The message must be complete in that one statement.
+ */
+#define MENGE_LOG(type)                                   \
+  if (Menge::Logger::type < MENGE_LOG_FLOOR) {            \
+  } else                                                  \
+    Menge::logger << Menge::Logger::type
+
 namespace Menge {
 
+class LogQueue;
+
 /////////////////////////////////////////////////////////////////////
 
 /*!
  @brief    An html logger - writes messages to a formatted html file.
+
+ Logging is asynchronous and safe to use from multiple threads (including inside OpenMP loops).
+ Each thread formats its messages into its own buffer; complete messages are handed to a background
+ thread through a lock-free queue and written from there. Concurrent messages are never interleaved
+ and threads never wait on the output stream, except for errors (ERR_MSG): each error is written
+ and flushed as soon as it ends (when the thread starts its next message or draws a line, or the
+ log is closed) so that it isn't lost if the process dies. Call flush() to write everything logged
+ so far.
+
+ Repeated warnings and errors are rate limited: messages which only differ in their numbers are
+ considered repetitions; beyond a fixed number per time window they are dropped and summarized.
  */
 class Logger {
  public:
@@ -64,6 +99,20 @@ class Logger {
    */
   MENGE_API void close();
 
+  /*!
+   @brief    Writes every message logged so far (by any thread) before returning.
+   */
+  MENGE_API void flush();
+
+  /*!
+   @brief    Configures the rate limiting of repeated warnings and errors.
+
+   @param    maxRepeats    The number of similar messages written per window; zero disables rate
+                          limiting.
+   @param    window        The length of the window, in seconds.
+   */
+  MENGE_API void setRateLimit(size_t maxRepeats, float window);
+
   /*!
    @brief    Writes a solid line to the logger.
    */
@@ -78,6 +127,20 @@ class Logger {
    */
   MENGE_API void setFile(const std::string& fileName);
 
+  /*!
+   @brief    Posts a piece of a message to the queue; used by the streaming operators.
+
+   @param    text    The text to append to the calling thread's current message.
+   */
+  MENGE_API void post(const char* text);
+
+  /*!
+   @brief    Starts a new message of the given type for the calling thread.
+
+   @param    type    The type of the message.
+   */
+  MENGE_API void post(LogType type);
+
   /*!
    @brief    Writes strings to the logger based on current status.
 
@@ -185,6 +248,48 @@ class Logger {
    */
   void processText(std::string& input);
 
+  /*!
+   @brief    Writes all queued messages; the caller must hold the output lock.
+   */
+  void drain();
+
+  /*!
+   @brief    Starts a new row (or console line) of the given type.
+   */
+  void openRow(LogType type);
+
+  /*!
+   @brief    Ends the current row (if any).
+   */
+  void closeRow();
+
+  /*!
+   @brief    Writes text into the current row.
+   */
+  void writeText(const std::string& text);
+
+  /*!
+   @brief    Writes the summaries of suppressed repetitions.
+
+   @param    all    If true, every summary is written; otherwise only those whose window expired.
+   */
+  void reportRepeats(bool all);
+
+  /*!
+   @brief    Reports if a new message should be written, or dropped as a repetition.
+   */
+  bool admit(LogType type, const std::string& text);
+
+  /*!
+   @brief    Starts the background thread, if it isn't running.
+   */
+  void startFlushing();
+
+  /*!
+   @brief    The body of the background thread.
+   */
+  void flushLoop();
+
   /*!
    @brief    Indicates if the output file is valid.
    */
@@ -196,9 +301,14 @@ class Logger {
   std::ofstream _file;
 
   /*!
-   @brief    The current message type
+   @brief    The type of the row currently being written (UNDEF_LOG if no row is open).
    */
   LogType _streamType;
+
+  /*!
+   @brief    The message queue and the state of the background thread.
+   */
+  LogQueue* _queue;
 };
 
 /*!
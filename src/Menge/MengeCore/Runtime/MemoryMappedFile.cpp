@@ -0,0 +1,114 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#include "MengeCore/Runtime/MemoryMappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // _WIN32
+
+namespace Menge {
+
+/////////////////////////////////////////////////////////////////////
+//                   Implementation of MemoryMappedFile
+/////////////////////////////////////////////////////////////////////
+
+MemoryMappedFile::MemoryMappedFile()
+    : _data(0x0),
+      _size(0)
+#ifdef _WIN32
+      ,
+      _file(INVALID_HANDLE_VALUE),
+      _mapping(0x0)
+#endif  // _WIN32
+{
+}
+
+/////////////////////////////////////////////////////////////////////
+
+MemoryMappedFile::~MemoryMappedFile() { close(); }
+
+/////////////////////////////////////////////////////////////////////
+
+bool MemoryMappedFile::open(const std::string& fileName) {
+  close();
+#ifdef _WIN32
+  HANDLE file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, 0x0, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, 0x0);
+  if (file == INVALID_HANDLE_VALUE) return false;
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+    CloseHandle(file);
+    return false;
+  }
+  HANDLE mapping = CreateFileMappingA(file, 0x0, PAGE_READONLY, 0, 0, 0x0);
+  if (mapping == 0x0) {
+    CloseHandle(file);
+    return false;
+  }
+  void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  if (view == 0x0) {
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return false;
+  }
+  _file = file;
+  _mapping = mapping;
+  _data = static_cast<const char*>(view);
+  _size = static_cast<size_t>(fileSize.QuadPart);
+#else
+  int fd = ::open(fileName.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    ::close(fd);
+    return false;
+  }
+  void* view = mmap(0x0, static_cast<size_t>(st.st_size), PROT_READ, MAP_SHARED, fd, 0);
+  // The mapping holds its own reference to the file; the descriptor is no longer needed.
+  ::close(fd);
+  if (view == MAP_FAILED) return false;
+  _data = static_cast<const char*>(view);
+  _size = static_cast<size_t>(st.st_size);
+#endif  // _WIN32
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void MemoryMappedFile::close() {
+  if (_data == 0x0) return;
+#ifdef _WIN32
+  UnmapViewOfFile(_data);
+  CloseHandle(_mapping);
+  CloseHandle(_file);
+  _mapping = 0x0;
+  _file = INVALID_HANDLE_VALUE;
+#else
+  munmap(const_cast<char*>(_data), _size);
+#endif  // _WIN32
+  _data = 0x0;
+  _size = 0;
+}
+
+}  // namespace Menge
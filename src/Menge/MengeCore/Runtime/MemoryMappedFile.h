@@ -0,0 +1,114 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+/*!
+ @file    MemoryMappedFile.h
+ @brief   A read-only, memory-mapped view of a file on disk.
+ */
+
+#ifndef __MEMORY_MAPPED_FILE_H__
+#define __MEMORY_MAPPED_FILE_H__
+
+#include "MengeCore/CoreConfig.h"
+
+#include <cstddef>
+#include <string>
+
+namespace Menge {
+
+/*!
+ @brief    Maps the full contents of a file into the address space of the process (read-only).
+
+ The operating system pages the file in on demand, so "opening" even a very large file is nearly
+ instantaneous and multiple processes mapping the same file share the same physical pages. The
+ mapping is released when the instance is closed or destroyed; any pointers previously acquired via
+ data() become invalid at that point.
+ */
+class MENGE_API MemoryMappedFile {
+ public:
+  /*!
+   @brief    Constructor.
+   */
+  MemoryMappedFile();
+
+  /*!
+   @brief    Destructor -- unmaps the file if it is still mapped.
+   */
+  ~MemoryMappedFile();
+
+  /*!
+   @brief    Maps the indicated file into memory.
+
+   If the instance already has a file mapped, it is closed first.
+
+   @param    fileName    The path to the file to map.
+   @returns  True if the file was successfully mapped, false otherwise. An empty file cannot be
+            mapped.
+   */
+  bool open(const std::string& fileName);
+
+  /*!
+   @brief    Unmaps the file (if mapped).
+   */
+  void close();
+
+  /*!
+   @brief    Reports if a file is currently mapped.
+   */
+  bool isOpen() const { return _data != 0x0; }
+
+  /*!
+   @brief    Returns a pointer to the first byte of the mapped file (or NULL if nothing is mapped).
+   */
+  const char* data() const { return _data; }
+
+  /*!
+   @brief    Reports the size of the mapped file, in bytes.
+   */
+  size_t size() const { return _size; }
+
+ private:
+  // Not copyable; the mapping has a unique owner.
+  MemoryMappedFile(const MemoryMappedFile&);
+  MemoryMappedFile& operator=(const MemoryMappedFile&);
+
+  /*!
+   @brief    The first byte of the mapped region.
+   */
+  const char* _data;
+
+  /*!
+   @brief    The size of the mapped region, in bytes.
+   */
+  size_t _size;
+
+#ifdef _WIN32
+  /*!
+   @brief    The handle to the open file.
+   */
+  void* _file;
+
+  /*!
+   @brief    The handle to the file-mapping object.
+   */
+  void* _mapping;
+#endif  // _WIN32
+};
+}  // namespace Menge
+
+#endif  // __MEMORY_MAPPED_FILE_H__
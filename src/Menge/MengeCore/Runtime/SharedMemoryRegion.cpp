@@ -0,0 +1,163 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#include "MengeCore/Runtime/SharedMemoryRegion.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // _WIN32
+
+#include <cstring>
+
+namespace Menge {
+
+namespace {
+// Names the region in the platform's namespace for shared memory objects.
+std::string platformName(const std::string& name) {
+#ifdef _WIN32
+  return "Local\\" + name;
+#else
+  return name.size() > 0 && name[0] == '/' ? name : "/" + name;
+#endif  // _WIN32
+}
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////
+//                   Implementation of SharedMemoryRegion
+/////////////////////////////////////////////////////////////////////
+
+SharedMemoryRegion::SharedMemoryRegion()
+    : _data(0x0),
+      _size(0),
+      _owner(false)
+#ifdef _WIN32
+      ,
+      _mapping(0x0)
+#endif  // _WIN32
+{
+}
+
+/////////////////////////////////////////////////////////////////////
+
+SharedMemoryRegion::~SharedMemoryRegion() { close(); }
+
+/////////////////////////////////////////////////////////////////////
+
+bool SharedMemoryRegion::create(const std::string& name, size_t size) {
+  close();
+  if (size == 0) return false;
+  const std::string sysName = platformName(name);
+#ifdef _WIN32
+  const unsigned long long size64 = size;
+  HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, 0x0, PAGE_READWRITE,
+                                      static_cast<DWORD>(size64 >> 32),
+                                      static_cast<DWORD>(size64 & 0xFFFFFFFF), sysName.c_str());
+  if (mapping == 0x0) return false;
+  void* view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size);
+  if (view == 0x0) {
+    CloseHandle(mapping);
+    return false;
+  }
+  _mapping = mapping;
+  // A mapping with this name may already have existed; make sure the contents start out zeroed.
+  memset(view, 0, size);
+#else
+  shm_unlink(sysName.c_str());
+  int fd = shm_open(sysName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0) return false;
+  if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    ::close(fd);
+    shm_unlink(sysName.c_str());
+    return false;
+  }
+  void* view = mmap(0x0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (view == MAP_FAILED) {
+    shm_unlink(sysName.c_str());
+    return false;
+  }
+#endif  // _WIN32
+  _data = static_cast<char*>(view);
+  _size = size;
+  _name = sysName;
+  _owner = true;
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool SharedMemoryRegion::open(const std::string& name, bool writable) {
+  close();
+  const std::string sysName = platformName(name);
+#ifdef _WIN32
+  HANDLE mapping =
+      OpenFileMappingA(writable ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, FALSE, sysName.c_str());
+  if (mapping == 0x0) return false;
+  void* view = MapViewOfFile(mapping, writable ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, 0);
+  if (view == 0x0) {
+    CloseHandle(mapping);
+    return false;
+  }
+  MEMORY_BASIC_INFORMATION info;
+  VirtualQuery(view, &info, sizeof(info));
+  _mapping = mapping;
+  _size = info.RegionSize;
+#else
+  int fd = shm_open(sysName.c_str(), writable ? O_RDWR : O_RDONLY, 0);
+  if (fd < 0) return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    ::close(fd);
+    return false;
+  }
+  void* view = mmap(0x0, static_cast<size_t>(st.st_size),
+                    writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (view == MAP_FAILED) return false;
+  _size = static_cast<size_t>(st.st_size);
+#endif  // _WIN32
+  _data = static_cast<char*>(view);
+  _name = sysName;
+  _owner = false;
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void SharedMemoryRegion::close() {
+  if (_data == 0x0) return;
+#ifdef _WIN32
+  UnmapViewOfFile(_data);
+  CloseHandle(_mapping);
+  _mapping = 0x0;
+#else
+  munmap(_data, _size);
+  if (_owner) shm_unlink(_name.c_str());
+#endif  // _WIN32
+  _data = 0x0;
+  _size = 0;
+  _owner = false;
+  _name = "";
+}
+
+}  // namespace Menge
@@ -0,0 +1,128 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+/*!
+ @file    SharedMemoryRegion.h
+ @brief   A named region of memory shared between processes.
+ */
+
+#ifndef __SHARED_MEMORY_REGION_H__
+#define __SHARED_MEMORY_REGION_H__
+
+#include "MengeCore/CoreConfig.h"
+
+#include <cstddef>
+#include <string>
+
+namespace Menge {
+
+/*!
+ @brief    A named block of memory which can be mapped by multiple processes.
+
+ One process creates the region (and owns it); others open it by name. On POSIX systems the region
+ is a shared memory object (see `shm_open`); the owner removes the name when it closes the region,
+ but processes which still have it mapped keep their mapping. On Windows it is a named file mapping
+ backed by the paging file, which disappears when the last process closes it.
+ */
+class MENGE_API SharedMemoryRegion {
+ public:
+  /*!
+   @brief    Constructor.
+   */
+  SharedMemoryRegion();
+
+  /*!
+   @brief    Destructor -- unmaps the region (and removes its name, if this instance created it).
+   */
+  ~SharedMemoryRegion();
+
+  /*!
+   @brief    Creates a new, zero-initialized region with the given name and maps it read-write.
+
+   Any existing region with the same name is replaced.
+
+   @param    name    The name of the region (a leading '/' is added on POSIX systems if missing).
+   @param    size    The size of the region, in bytes.
+   @returns  True if the region was created and mapped.
+   */
+  bool create(const std::string& name, size_t size);
+
+  /*!
+   @brief    Maps an existing region.
+
+   @param    name        The name of the region.
+   @param    writable    If true, the region is mapped read-write, otherwise read-only.
+   @returns  True if the region was found and mapped.
+   */
+  bool open(const std::string& name, bool writable = false);
+
+  /*!
+   @brief    Unmaps the region (if mapped).
+   */
+  void close();
+
+  /*!
+   @brief    Reports if a region is currently mapped.
+   */
+  bool isOpen() const { return _data != 0x0; }
+
+  /*!
+   @brief    Returns a pointer to the first byte of the region (or NULL if nothing is mapped).
+   */
+  char* data() const { return _data; }
+
+  /*!
+   @brief    Reports the size of the region, in bytes.
+   */
+  size_t size() const { return _size; }
+
+ private:
+  // Not copyable; the mapping has a unique owner.
+  SharedMemoryRegion(const SharedMemoryRegion&);
+  SharedMemoryRegion& operator=(const SharedMemoryRegion&);
+
+  /*!
+   @brief    The first byte of the mapped region.
+   */
+  char* _data;
+
+  /*!
+   @brief    The size of the mapped region, in bytes.
+   */
+  size_t _size;
+
+  /*!
+   @brief    The platform-specific name of the region.
+   */
+  std::string _name;
+
+  /*!
+   @brief    Indicates that this instance created the region.
+   */
+  bool _owner;
+
+#ifdef _WIN32
+  /*!
+   @brief    The handle to the file-mapping object.
+   */
+  void* _mapping;
+#endif  // _WIN32
+};
+
+}  // namespace Menge
+#endif  // __SHARED_MEMORY_REGION_H__
@@ -39,9 +39,11 @@ Any questions or comments should be sent to the authors {menge,geom}@cs.unc.edu
 #include "MengeCore/Runtime/SimulatorDBEntry.h"
 
 #include "MengeCore/Agents/AgentInitializer.h"
+#include "MengeCore/Agents/BaseAgent.h"
 #include "MengeCore/Agents/SimulatorInterface.h"
 #include "MengeCore/BFSM/FSM.h"
 #include "MengeCore/BFSM/FSMDescrip.h"
+#include "MengeCore/Core.h"
 #include "MengeCore/MengeException.h"
 #include "MengeCore/Runtime/Logger.h"
 
@@ -74,6 +76,9 @@ Agents::SimulatorInterface* SimulatorDBEntry::initSimulator(const std::string& s
 BFSM::FSM* SimulatorDBEntry::initFSM(const std::string& behaveFile, Agents::SimulatorInterface* sim,
                                      bool VERBOSE) {
   logger.line();
+  // Some behavior elements consume scene data (e.g., obstacles) while they are parsed.
+  SIMULATOR = sim;
+  SPATIAL_QUERY = sim->getSpatialQuery();
   BFSM::FSMDescrip fsmDescrip;
 
   if (!fsmDescrip.loadFromXML(behaveFile, VERBOSE)) {
@@ -95,17 +100,27 @@ bool SimulatorDBEntry::finalize(Agents::SimulatorInterface* sim, BFSM::FSM* fsm)
   sim->setBFSM(fsm);
   // older versions of OpenMP require signed for loop counters
   int agtCount = (int)sim->getNumAgents();
-#pragma omp parallel for
+  // Exceptions can't leave the parallel region; they are counted and reported afterwards.
+  int exceptionCount = 0;
+#pragma omp parallel for reduction(+ : exceptionCount)
   for (int a = 0; a < agtCount; ++a) {
     Agents::BaseAgent* agt = sim->getAgent(a);
-    fsm->computePrefVelocity(agt);
+    try {
+      fsm->computePrefVelocity(agt);
+    } catch (Menge::MengeException& e) {
+      logger << Logger::ERR_MSG << "Unable to compute the initial preferred velocity of agent "
+             << agt->_id << ".\n\t" << e.what();
+      ++exceptionCount;
+    }
+  }
+  if (exceptionCount > 0) {
+    return false;
   }
   try {
     sim->finalize();
   } catch (Menge::MengeException& e) {
     logger << Logger::ERR_MSG << "Problem in finalizing the simulator.\n";
     logger << "\t" << e.what();
-    delete fsm;
     return false;
   }
   try {
@@ -113,7 +128,6 @@ bool SimulatorDBEntry::finalize(Agents::SimulatorInterface* sim, BFSM::FSM* fsm)
   } catch (Menge::MengeFatalException& e) {
     logger << Logger::ERR_MSG << "Fatal error finalizing the finite state machine!\n";
     logger << "\t" << e.what();
-    delete fsm;
     return false;
   } catch (Menge::MengeException& e) {
     logger << Logger::WARN_MSG
@@ -142,8 +156,10 @@ Agents::SimulatorInterface* SimulatorDBEntry::getSimulator(
     return 0x0;
   }
   if (!finalize(_sim, _fsm)) {
+    // The simulator owns the FSM.
     delete _sim;
-    delete _fsm;
+    _sim = 0x0;
+    _fsm = 0x0;
     return 0x0;
   }
 
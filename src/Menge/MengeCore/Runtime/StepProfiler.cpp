@@ -0,0 +1,297 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#include "MengeCore/Runtime/StepProfiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace Menge {
+
+/////////////////////////////////////////////////////////////////////
+//                   Implementation of StepProfiler
+/////////////////////////////////////////////////////////////////////
+
+StepProfiler PROFILER;
+
+static_assert(StepProfiler::PHASE_COUNT <= TraceRecorder::MAX_PHASES,
+              "The trace recorder can't track every phase");
+
+/////////////////////////////////////////////////////////////////////
+
+const char* StepProfiler::phaseName(Phase phase) {
+  switch (phase) {
+    case EVENTS:
+      return "events";
+    case FSM_TRANSITIONS:
+      return "fsm_transitions";
+    case PREF_VELOCITY:
+      return "pref_velocity";
+    case SPATIAL_REBUILD:
+      return "spatial_rebuild";
+    case NEIGHBOR_QUERY:
+      return "neighbor_query";
+    case NEW_VELOCITY:
+      return "new_velocity";
+    case UPDATE:
+      return "update";
+    case TASKS:
+      return "tasks";
+    case OUTPUT:
+      return "output";
+    default:
+      return "unknown";
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+const char* StepProfiler::regionName(Phase first, Phase second) {
+  if (second == PHASE_COUNT) return phaseName(first);
+  // Built once; the names must outlive any trace which refers to them.
+  static std::string names[PHASE_COUNT][PHASE_COUNT];
+  static bool built = false;
+  if (!built) {
+    for (int i = 0; i < PHASE_COUNT; ++i) {
+      for (int j = 0; j < PHASE_COUNT; ++j) {
+        names[i][j] = std::string(phaseName(static_cast<Phase>(i))) + "+" +
+                      phaseName(static_cast<Phase>(j));
+      }
+    }
+    built = true;
+  }
+  return names[first][second].c_str();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+StepProfiler::StepProfiler() : _enabled(false) { reset(); }
+
+/////////////////////////////////////////////////////////////////////
+
+void StepProfiler::enable() {
+  int threadCount = 1;
+#ifdef _OPENMP
+  threadCount = omp_get_max_threads();
+#endif
+  _threads.resize(std::max(1, threadCount));
+  reset();
+  _enabled = true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void StepProfiler::reset() {
+  _stepCount = 0;
+  _stepTotal = _stepMax = 0.0;
+  _stepMin = 0.0;
+  for (int p = 0; p < PHASE_COUNT; ++p) _phaseWall[p] = 0.0;
+  for (size_t t = 0; t < _threads.size(); ++t) memset(&_threads[t], 0, sizeof(ThreadTimes));
+  _taskNames.clear();
+  _taskWall.clear();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void StepProfiler::beginStep() {
+  if (_enabled) _stepStart = std::chrono::steady_clock::now();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void StepProfiler::endStep() {
+  if (!_enabled) return;
+  const double elapsed =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - _stepStart).count();
+  _stepMin = _stepCount == 0 ? elapsed : std::min(_stepMin, elapsed);
+  _stepMax = std::max(_stepMax, elapsed);
+  _stepTotal += elapsed;
+  ++_stepCount;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void StepProfiler::addPhaseTime(Phase phase, double seconds) { _phaseWall[phase] += seconds; }
+
+/////////////////////////////////////////////////////////////////////
+
+void StepProfiler::addThreadTime(Phase phase, double seconds) {
+  size_t thread = 0;
+#ifdef _OPENMP
+  thread = static_cast<size_t>(omp_get_thread_num());
+#endif
+  if (thread < _threads.size()) _threads[thread].busy[phase] += seconds;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void StepProfiler::beginRegion() {
+  for (size_t t = 0; t < _threads.size(); ++t) {
+    memcpy(_threads[t].regionStart, _threads[t].busy, sizeof(_threads[t].busy));
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void StepProfiler::endRegion(Phase first, Phase second, double seconds) {
+  double firstBusy = 0.0;
+  double secondBusy = 0.0;
+  for (size_t t = 0; t < _threads.size(); ++t) {
+    ThreadTimes& times = _threads[t];
+    double busy = 0.0;
+    for (int p = 0; p < PHASE_COUNT; ++p) busy += times.busy[p] - times.regionStart[p];
+    times.idle += std::max(0.0, seconds - busy);
+    firstBusy += times.busy[first] - times.regionStart[first];
+    if (second != PHASE_COUNT) secondBusy += times.busy[second] - times.regionStart[second];
+  }
+  if (second == PHASE_COUNT || firstBusy + secondBusy <= 0.0) {
+    _phaseWall[first] += seconds;
+  } else {
+    const double share = firstBusy / (firstBusy + secondBusy);
+    _phaseWall[first] += seconds * share;
+    _phaseWall[second] += seconds * (1.0 - share);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void StepProfiler::addTaskTime(const std::string& name, double seconds) {
+  // There are a handful of tasks; a linear search is cheaper than a map.
+  for (size_t i = 0; i < _taskNames.size(); ++i) {
+    if (_taskNames[i] == name) {
+      _taskWall[i] += seconds;
+      return;
+    }
+  }
+  _taskNames.push_back(name);
+  _taskWall.push_back(seconds);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+double StepProfiler::getTaskTime(const std::string& name) const {
+  for (size_t i = 0; i < _taskNames.size(); ++i) {
+    if (_taskNames[i] == name) return _taskWall[i];
+  }
+  return 0.0;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+double StepProfiler::getThreadBusyTime(size_t thread, Phase phase) const {
+  return thread < _threads.size() ? _threads[thread].busy[phase] : 0.0;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+double StepProfiler::getThreadIdleTime(size_t thread) const {
+  return thread < _threads.size() ? _threads[thread].idle : 0.0;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool StepProfiler::write(const std::string& fileName) const {
+  const std::string ext = ".json";
+  if (fileName.size() >= ext.size() &&
+      fileName.compare(fileName.size() - ext.size(), ext.size(), ext) == 0) {
+    return writeJSON(fileName);
+  }
+  return writeCSV(fileName);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool StepProfiler::writeCSV(const std::string& fileName) const {
+  std::ofstream out(fileName.c_str());
+  if (!out.is_open()) return false;
+  const double perStep = _stepCount > 0 ? 1000.0 / _stepCount : 0.0;
+  // One table: step totals, one row per phase, one row per thread and one row per task.
+  out << "section,name,wall_ms,wall_ms_per_step,busy_ms,idle_ms\n";
+  out << "step,all," << _stepTotal * 1000.0 << "," << _stepTotal * perStep << ",,\n";
+  out << "step,min," << _stepMin * 1000.0 << ",,,\n";
+  out << "step,max," << _stepMax * 1000.0 << ",,,\n";
+  for (int p = 0; p < PHASE_COUNT; ++p) {
+    double busy = 0.0;
+    for (size_t t = 0; t < _threads.size(); ++t) busy += _threads[t].busy[p];
+    out << "phase," << phaseName(static_cast<Phase>(p)) << "," << _phaseWall[p] * 1000.0 << ","
+        << _phaseWall[p] * perStep << "," << busy * 1000.0 << ",\n";
+  }
+  for (size_t t = 0; t < _threads.size(); ++t) {
+    double busy = 0.0;
+    for (int p = 0; p < PHASE_COUNT; ++p) busy += _threads[t].busy[p];
+    out << "thread," << t << ",,," << busy * 1000.0 << "," << _threads[t].idle * 1000.0 << "\n";
+  }
+  for (size_t i = 0; i < _taskNames.size(); ++i) {
+    out << "task," << _taskNames[i] << "," << _taskWall[i] * 1000.0 << ","
+        << _taskWall[i] * perStep << ",,\n";
+  }
+  return out.good();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool StepProfiler::writeJSON(const std::string& fileName) const {
+  std::ofstream out(fileName.c_str());
+  if (!out.is_open()) return false;
+  const double perStep = _stepCount > 0 ? 1000.0 / _stepCount : 0.0;
+  out << "{\n";
+  out << "  \"steps\": " << _stepCount << ",\n";
+  out << "  \"step_ms\": {\"total\": " << _stepTotal * 1000.0 << ", \"mean\": "
+      << _stepTotal * perStep << ", \"min\": " << _stepMin * 1000.0
+      << ", \"max\": " << _stepMax * 1000.0 << "},\n";
+  out << "  \"phases\": [\n";
+  for (int p = 0; p < PHASE_COUNT; ++p) {
+    double busy = 0.0;
+    for (size_t t = 0; t < _threads.size(); ++t) busy += _threads[t].busy[p];
+    out << "    {\"name\": \"" << phaseName(static_cast<Phase>(p))
+        << "\", \"wall_ms\": " << _phaseWall[p] * 1000.0
+        << ", \"wall_ms_per_step\": " << _phaseWall[p] * perStep
+        << ", \"busy_ms\": " << busy * 1000.0 << "}" << (p + 1 < PHASE_COUNT ? "," : "") << "\n";
+  }
+  out << "  ],\n";
+  out << "  \"threads\": [\n";
+  for (size_t t = 0; t < _threads.size(); ++t) {
+    out << "    {\"thread\": " << t << ", \"busy_ms\": {";
+    double busy = 0.0;
+    for (int p = 0; p < PHASE_COUNT; ++p) {
+      busy += _threads[t].busy[p];
+      out << (p > 0 ? ", " : "") << "\"" << phaseName(static_cast<Phase>(p))
+          << "\": " << _threads[t].busy[p] * 1000.0;
+    }
+    out << "}, \"total_busy_ms\": " << busy * 1000.0
+        << ", \"idle_ms\": " << _threads[t].idle * 1000.0 << "}"
+        << (t + 1 < _threads.size() ? "," : "") << "\n";
+  }
+  out << "  ],\n";
+  out << "  \"tasks\": [\n";
+  for (size_t i = 0; i < _taskNames.size(); ++i) {
+    out << "    {\"name\": \"" << _taskNames[i] << "\", \"wall_ms\": " << _taskWall[i] * 1000.0
+        << ", \"wall_ms_per_step\": " << _taskWall[i] * perStep << "}"
+        << (i + 1 < _taskNames.size() ? "," : "") << "\n";
+  }
+  out << "  ]\n";
+  out << "}\n";
+  return out.good();
+}
+
+}  // namespace Menge
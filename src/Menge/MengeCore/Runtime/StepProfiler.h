@@ -0,0 +1,395 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+/*!
+ @file    StepProfiler.h
+ @brief   Timing of the phases of a simulation step.
+ */
+
+#ifndef __STEP_PROFILER_H__
+#define __STEP_PROFILER_H__
+
+#include "MengeCore/CoreConfig.h"
+#include "MengeCore/Runtime/TraceRecorder.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace Menge {
+
+/*!
+ @brief    Accumulates the time spent in each phase of SimulatorInterface::step().
+
+ Serial phases are timed with a ProfileScope. Phases which run in parallel over the agents are timed
+ per agent, on the thread which does the work, with a ProfileLap; the enclosing parallel loop is
+ timed with a ProfileRegion. The wall time of a region is split between its phases in proportion to
+ the threads' busy time in each. A thread's idle time is the time it spent in a region without
+ working (e.g., waiting at the loop's closing barrier).
+
+ The same timers feed the TraceRecorder: while a step is being traced, every ProfileScope is
+ recorded as a span and every ProfileRegion as one span per worker thread.
+
+ When the profiler and the trace recorder are disabled (the default), each timer reduces to testing
+ two flags.
+ */
+class MENGE_API StepProfiler {
+ public:
+  /*!
+   @brief    The phases of a simulation step.
+   */
+  enum Phase {
+    EVENTS,           ///< Evaluation of the event system.
+    FSM_TRANSITIONS,  ///< Advancing the agents through the behavior FSM.
+    PREF_VELOCITY,    ///< Computing the agents' preferred velocities.
+    SPATIAL_REBUILD,  ///< Updating the spatial query structure.
+    NEIGHBOR_QUERY,   ///< Computing the agents' neighbors.
+    NEW_VELOCITY,     ///< Computing the agents' new velocities (the pedestrian model).
+    UPDATE,           ///< Integrating the agents' new velocities.
+    TASKS,            ///< The behavior FSM's tasks.
+    OUTPUT,           ///< Trajectory output (scb file and shared memory).
+    PHASE_COUNT       ///< The number of phases.
+  };
+
+  /*!
+   @brief    Returns the name of the given phase (as used in the summaries).
+   */
+  static const char* phaseName(Phase phase);
+
+  /*!
+   @brief    Returns the name of a parallel region covering the given phases (e.g.,
+            "neighbor_query+new_velocity").
+
+   @param    first     The region's first phase.
+   @param    second    The region's second phase (PHASE_COUNT if the region has one phase).
+   */
+  static const char* regionName(Phase first, Phase second);
+
+  /*!
+   @brief    Constructor.
+   */
+  StepProfiler();
+
+  /*!
+   @brief    Starts profiling; any previous measurements are discarded.
+   */
+  void enable();
+
+  /*!
+   @brief    Stops profiling; the measurements are retained.
+   */
+  void disable() { _enabled = false; }
+
+  /*!
+   @brief    Reports if the profiler is enabled.
+   */
+  bool isEnabled() const { return _enabled; }
+
+  /*!
+   @brief    Discards all measurements.
+   */
+  void reset();
+
+  /*!
+   @brief    Marks the start of a simulation step.
+   */
+  void beginStep();
+
+  /*!
+   @brief    Marks the end of a simulation step.
+   */
+  void endStep();
+
+  /*!
+   @brief    Adds wall time to a phase; called on the simulation thread.
+
+   @param    phase      The phase.
+   @param    seconds    The elapsed time.
+   */
+  void addPhaseTime(Phase phase, double seconds);
+
+  /*!
+   @brief    Adds busy time to a phase for the calling thread; safe to call inside a parallel loop.
+
+   @param    phase      The phase.
+   @param    seconds    The elapsed time.
+   */
+  void addThreadTime(Phase phase, double seconds);
+
+  /*!
+   @brief    Marks the start of a parallel region; called on the simulation thread.
+   */
+  void beginRegion();
+
+  /*!
+   @brief    Marks the end of a parallel region; called on the simulation thread.
+
+   @param    first      The first phase in the region.
+   @param    second     The second phase in the region (PHASE_COUNT if the region has one phase).
+   @param    seconds    The wall time of the region.
+   */
+  void endRegion(Phase first, Phase second, double seconds);
+
+  /*!
+   @brief    Adds time spent in one of the behavior FSM's tasks; called on the simulation thread.
+
+   Tasks may run concurrently, so the times of the tasks in a step can sum to more than the wall
+   time of the TASKS phase.
+
+   @param    name       The name of the task (see BFSM::Task::toString()).
+   @param    seconds    The elapsed time.
+   */
+  void addTaskTime(const std::string& name, double seconds);
+
+  /*!
+   @brief    Reports the number of steps profiled.
+   */
+  size_t getStepCount() const { return _stepCount; }
+
+  /*!
+   @brief    Reports the total wall time attributed to the given phase, in seconds.
+   */
+  double getPhaseTime(Phase phase) const { return _phaseWall[phase]; }
+
+  /*!
+   @brief    Reports the number of threads for which busy and idle time are recorded.
+   */
+  size_t getThreadCount() const { return _threads.size(); }
+
+  /*!
+   @brief    Reports the total busy time of the given thread in the given phase, in seconds.
+   */
+  double getThreadBusyTime(size_t thread, Phase phase) const;
+
+  /*!
+   @brief    Reports the total idle time of the given thread in parallel regions, in seconds.
+   */
+  double getThreadIdleTime(size_t thread) const;
+
+  /*!
+   @brief    Reports the number of tasks for which time has been recorded.
+   */
+  size_t getTaskCount() const { return _taskNames.size(); }
+
+  /*!
+   @brief    Reports the name of the i-th task for which time has been recorded.
+   */
+  const std::string& getTaskName(size_t i) const { return _taskNames[i]; }
+
+  /*!
+   @brief    Reports the total time spent in the named task, in seconds.
+   */
+  double getTaskTime(const std::string& name) const;
+
+  /*!
+   @brief    Writes the summary; the format is JSON if the name ends in ".json", CSV otherwise.
+
+   @param    fileName    The path to the file to write.
+   @returns  True if the file was written.
+   */
+  bool write(const std::string& fileName) const;
+
+  /*!
+   @brief    Writes the summary as comma-separated values.
+   */
+  bool writeCSV(const std::string& fileName) const;
+
+  /*!
+   @brief    Writes the summary as JSON.
+   */
+  bool writeJSON(const std::string& fileName) const;
+
+ private:
+  /*!
+   @brief    The measurements of a single thread; padded to avoid false sharing.
+   */
+  struct ThreadTimes {
+    double busy[PHASE_COUNT];         ///< The busy time in each phase.
+    double idle;                      ///< The idle time in parallel regions.
+    double regionStart[PHASE_COUNT];  ///< The busy times at the start of the current region.
+    char padding[64];                 ///< Keeps neighboring threads off this cache line.
+  };
+
+  /*!
+   @brief    Indicates that measurements are being taken.
+   */
+  bool _enabled;
+
+  /*!
+   @brief    The number of steps profiled.
+   */
+  size_t _stepCount;
+
+  /*!
+   @brief    The start of the current step.
+   */
+  std::chrono::steady_clock::time_point _stepStart;
+
+  /*!
+   @brief    The total, shortest and longest step times.
+   */
+  double _stepTotal, _stepMin, _stepMax;
+
+  /*!
+   @brief    The wall time attributed to each phase.
+   */
+  double _phaseWall[PHASE_COUNT];
+
+  /*!
+   @brief    The measurements of each thread.
+   */
+  std::vector<ThreadTimes> _threads;
+
+  /*!
+   @brief    The names of the tasks timed, in the order in which they were first timed.
+   */
+  std::vector<std::string> _taskNames;
+
+  /*!
+   @brief    The time spent in each of the tasks in _taskNames.
+   */
+  std::vector<double> _taskWall;
+};
+
+/*!
+ @brief    The profiler used by the simulation.
+ */
+extern MENGE_API StepProfiler PROFILER;
+
+/*!
+ @brief    Times a serial phase for the lifetime of the scope.
+ */
+class ProfileScope {
+ public:
+  /*!
+   @brief    Constructor; starts timing the given phase (if profiling or tracing).
+   */
+  explicit ProfileScope(StepProfiler::Phase phase)
+      : _phase(phase), _profile(PROFILER.isEnabled()), _trace(TRACER.isRecording()) {
+    if (_profile || _trace) _start = std::chrono::steady_clock::now();
+  }
+
+  /*!
+   @brief    Destructor; adds the elapsed time to the phase.
+   */
+  ~ProfileScope() {
+    if (_profile || _trace) {
+      const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+      const std::chrono::duration<double> elapsed = end - _start;
+      if (_profile) PROFILER.addPhaseTime(_phase, elapsed.count());
+      if (_trace) TRACER.addSpan(StepProfiler::phaseName(_phase), "step", _start, end);
+    }
+  }
+
+ private:
+  StepProfiler::Phase _phase;
+  bool _profile;
+  bool _trace;
+  std::chrono::steady_clock::time_point _start;
+};
+
+/*!
+ @brief    Times a parallel loop covering one or two phases for the lifetime of the scope.
+ */
+class ProfileRegion {
+ public:
+  /*!
+   @brief    Constructor; starts timing the region (if profiling or tracing).
+
+   @param    first     The first phase timed (with ProfileLap) inside the region.
+   @param    second    The second phase timed inside the region, if any.
+   */
+  explicit ProfileRegion(StepProfiler::Phase first,
+                         StepProfiler::Phase second = StepProfiler::PHASE_COUNT)
+      : _first(first),
+        _second(second),
+        _profile(PROFILER.isEnabled()),
+        _trace(TRACER.isRecording()) {
+    if (_profile) {
+      PROFILER.beginRegion();
+      _start = std::chrono::steady_clock::now();
+    }
+    if (_trace) TRACER.beginRegion();
+  }
+
+  /*!
+   @brief    Destructor; distributes the region's time among its phases.
+   */
+  ~ProfileRegion() {
+    if (_profile) {
+      const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - _start;
+      PROFILER.endRegion(_first, _second, elapsed.count());
+    }
+    if (_trace) {
+      const bool pair = _second != StepProfiler::PHASE_COUNT;
+      TRACER.endRegion(StepProfiler::regionName(_first, _second), _first,
+                       StepProfiler::phaseName(_first),
+                       pair ? static_cast<size_t>(_second) : TraceRecorder::MAX_PHASES,
+                       pair ? StepProfiler::phaseName(_second) : 0x0);
+    }
+  }
+
+ private:
+  StepProfiler::Phase _first, _second;
+  bool _profile;
+  bool _trace;
+  std::chrono::steady_clock::time_point _start;
+};
+
+/*!
+ @brief    Times consecutive pieces of work on one thread, e.g., the phases of one agent's update in
+           a parallel loop.
+
+ @code
+ ProfileLap lap;
+ advance(agent);
+ lap.lap(StepProfiler::FSM_TRANSITIONS);
+ computePrefVelocity(agent);
+ lap.lap(StepProfiler::PREF_VELOCITY);
+ @endcode
+ */
+class ProfileLap {
+ public:
+  /*!
+   @brief    Constructor; starts the first lap (if profiling or tracing).
+   */
+  ProfileLap() : _profile(PROFILER.isEnabled()), _trace(TRACER.isRecording()) {
+    if (_profile || _trace) _start = std::chrono::steady_clock::now();
+  }
+
+  /*!
+   @brief    Adds the time since the previous lap to the given phase and starts the next lap.
+   */
+  void lap(StepProfiler::Phase phase) {
+    if (_profile || _trace) {
+      const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+      const std::chrono::duration<double> elapsed = now - _start;
+      if (_profile) PROFILER.addThreadTime(phase, elapsed.count());
+      if (_trace) TRACER.addWork(phase, _start, now);
+      _start = now;
+    }
+  }
+
+ private:
+  bool _profile;
+  bool _trace;
+  std::chrono::steady_clock::time_point _start;
+};
+
+}  // namespace Menge
+#endif  // __STEP_PROFILER_H__
@@ -0,0 +1,234 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#include "MengeCore/Runtime/TraceRecorder.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace Menge {
+
+/////////////////////////////////////////////////////////////////////
+//                   Implementation of TraceRecorder
+/////////////////////////////////////////////////////////////////////
+
+TraceRecorder TRACER;
+
+/////////////////////////////////////////////////////////////////////
+
+TraceRecorder::TraceRecorder()
+    : _enabled(false), _recording(false), _stepInterval(1), _minDuration(0.0), _stepCount(0) {}
+
+/////////////////////////////////////////////////////////////////////
+
+void TraceRecorder::enable(size_t capacity, size_t stepInterval, double minDuration) {
+  int maxThreads = 1;
+#ifdef _OPENMP
+  maxThreads = omp_get_max_threads();
+#endif
+  const size_t threadCount = static_cast<size_t>(std::max(1, maxThreads));
+  _threads.clear();
+  _threads.resize(threadCount);
+  for (size_t t = 0; t < threadCount; ++t) {
+    _threads[t].events.reserve(std::max<size_t>(1, capacity / threadCount));
+    _threads[t].dropped = 0;
+    _threads[t].regionActive = false;
+  }
+  _stepInterval = std::max<size_t>(1, stepInterval);
+  _minDuration = minDuration;
+  _stepCount = 0;
+  _recording = false;
+  _origin = std::chrono::steady_clock::now();
+  _enabled = true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void TraceRecorder::disable() {
+  _enabled = false;
+  _recording = false;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void TraceRecorder::beginStep() {
+  if (!_enabled) return;
+  _recording = _stepCount % _stepInterval == 0;
+  ++_stepCount;
+  if (_recording) _stepStart = std::chrono::steady_clock::now();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void TraceRecorder::endStep() {
+  if (!_recording) return;
+  addSpan("step", "step", _stepStart, std::chrono::steady_clock::now(), "step",
+          static_cast<double>(_stepCount - 1));
+  _recording = false;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void TraceRecorder::addSpan(const char* name, const char* category,
+                            std::chrono::steady_clock::time_point start,
+                            std::chrono::steady_clock::time_point end, const char* argName,
+                            double arg) {
+  Event event;
+  event.name = name;
+  event.category = category;
+  event.start = toMicroseconds(start);
+  event.duration = toMicroseconds(end) - event.start;
+  event.argNames[0] = argName;
+  event.argNames[1] = 0x0;
+  event.args[0] = arg;
+  event.args[1] = 0.0;
+  push(event);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void TraceRecorder::beginRegion() {
+  for (size_t t = 0; t < _threads.size(); ++t) {
+    ThreadBuffer& buffer = _threads[t];
+    buffer.regionActive = false;
+    std::fill(buffer.regionBusy, buffer.regionBusy + MAX_PHASES, 0.0);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void TraceRecorder::addWork(size_t phase, std::chrono::steady_clock::time_point start,
+                            std::chrono::steady_clock::time_point end) {
+  size_t thread = 0;
+#ifdef _OPENMP
+  thread = static_cast<size_t>(omp_get_thread_num());
+#endif
+  if (thread >= _threads.size()) return;
+  ThreadBuffer& buffer = _threads[thread];
+  if (!buffer.regionActive) {
+    buffer.regionActive = true;
+    buffer.regionStart = start;
+  }
+  buffer.regionEnd = end;
+  buffer.regionBusy[phase] += std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void TraceRecorder::endRegion(const char* name, size_t first, const char* firstName, size_t second,
+                              const char* secondName) {
+  for (size_t t = 0; t < _threads.size(); ++t) {
+    ThreadBuffer& buffer = _threads[t];
+    if (!buffer.regionActive) continue;
+    Event event;
+    event.name = name;
+    event.category = "step";
+    event.start = toMicroseconds(buffer.regionStart);
+    event.duration = toMicroseconds(buffer.regionEnd) - event.start;
+    event.argNames[0] = firstName;
+    event.args[0] = buffer.regionBusy[first] / 1000.0;
+    event.argNames[1] = second < MAX_PHASES ? secondName : 0x0;
+    event.args[1] = second < MAX_PHASES ? buffer.regionBusy[second] / 1000.0 : 0.0;
+    // The region has ended; the worker threads are idle, so this thread may append their spans.
+    if (buffer.events.size() < buffer.events.capacity()) {
+      buffer.events.push_back(event);
+    } else {
+      ++buffer.dropped;
+    }
+    buffer.regionActive = false;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t TraceRecorder::getEventCount() const {
+  size_t count = 0;
+  for (size_t t = 0; t < _threads.size(); ++t) count += _threads[t].events.size();
+  return count;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t TraceRecorder::getDroppedCount() const {
+  size_t count = 0;
+  for (size_t t = 0; t < _threads.size(); ++t) count += _threads[t].dropped;
+  return count;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool TraceRecorder::write(const std::string& fileName) const {
+  std::ofstream out(fileName.c_str());
+  if (!out.is_open()) return false;
+  out << std::fixed << std::setprecision(3);
+  out << "{\"traceEvents\": [\n";
+  out << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, "
+         "\"args\": {\"name\": \"Menge\"}}";
+  for (size_t t = 0; t < _threads.size(); ++t) {
+    out << ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << t
+        << ", \"args\": {\"name\": \"thread " << t << "\"}}";
+  }
+  for (size_t t = 0; t < _threads.size(); ++t) {
+    const std::vector<Event>& events = _threads[t].events;
+    for (size_t e = 0; e < events.size(); ++e) {
+      const Event& event = events[e];
+      out << ",\n{\"name\": \"" << event.name << "\", \"cat\": \"" << event.category
+          << "\", \"ph\": \"X\", \"ts\": " << event.start << ", \"dur\": " << event.duration
+          << ", \"pid\": 1, \"tid\": " << t;
+      if (event.argNames[0] != 0x0) {
+        out << ", \"args\": {\"" << event.argNames[0] << "\": " << event.args[0];
+        if (event.argNames[1] != 0x0) out << ", \"" << event.argNames[1] << "\": " << event.args[1];
+        out << "}";
+      }
+      out << "}";
+    }
+  }
+  out << "\n],\n\"displayTimeUnit\": \"ms\",\n";
+  out << "\"otherData\": {\"dropped_events\": " << getDroppedCount() << "}}\n";
+  return out.good();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void TraceRecorder::push(const Event& event) {
+  size_t thread = 0;
+#ifdef _OPENMP
+  thread = static_cast<size_t>(omp_get_thread_num());
+#endif
+  if (thread >= _threads.size()) return;
+  ThreadBuffer& buffer = _threads[thread];
+  // The buffer never grows beyond the capacity reserved in enable().
+  if (buffer.events.size() < buffer.events.capacity()) {
+    buffer.events.push_back(event);
+  } else {
+    ++buffer.dropped;
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+double TraceRecorder::toMicroseconds(std::chrono::steady_clock::time_point time) const {
+  return std::chrono::duration<double, std::micro>(time - _origin).count();
+}
+
+}  // namespace Menge
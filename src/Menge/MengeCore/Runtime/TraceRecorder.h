@@ -0,0 +1,304 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+/*!
+ @file    TraceRecorder.h
+ @brief   Recording of simulation spans as Chrome trace events.
+ */
+
+#ifndef __TRACE_RECORDER_H__
+#define __TRACE_RECORDER_H__
+
+#include "MengeCore/CoreConfig.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace Menge {
+
+/*!
+ @brief    Records timed spans of the simulation, per thread, and writes them in the Chrome
+           trace-event format (viewable in Perfetto or chrome://tracing).
+
+ The phases of each sampled simulation step are recorded by the StepProfiler helpers: serial phases
+ as spans on the simulation thread and parallel phases as one span per worker thread (covering the
+ thread's first to last unit of work, annotated with its busy time in each phase). Expensive
+ operations (e.g., path searches and FSM tasks) are recorded with a TraceScope.
+
+ Memory is bounded: each thread's events are stored in a buffer allocated when recording is
+ enabled. Once a buffer is full, further events on that thread are counted but discarded. Only one
+ step in every `stepInterval` steps is recorded, and TraceScope spans shorter than a minimum
+ duration are discarded.
+ */
+class MENGE_API TraceRecorder {
+ public:
+  /*!
+   @brief    The default number of events held across all threads.
+   */
+  static const size_t DEFAULT_CAPACITY = 1 << 18;
+
+  /*!
+   @brief    The maximum number of distinct phases in a parallel region.
+   */
+  static const size_t MAX_PHASES = 16;
+
+  /*!
+   @brief    Constructor.
+   */
+  TraceRecorder();
+
+  /*!
+   @brief    Starts recording; any previously recorded events are discarded.
+
+   @param    capacity        The maximum number of events held (across all threads).
+   @param    stepInterval    Only one in every stepInterval steps is recorded.
+   @param    minDuration     TraceScope spans shorter than this (in microseconds) are discarded.
+   */
+  void enable(size_t capacity = DEFAULT_CAPACITY, size_t stepInterval = 1,
+              double minDuration = 0.0);
+
+  /*!
+   @brief    Stops recording; the recorded events are retained.
+   */
+  void disable();
+
+  /*!
+   @brief    Reports if the recorder is enabled.
+   */
+  bool isEnabled() const { return _enabled; }
+
+  /*!
+   @brief    Reports if events of the current step are being recorded.
+   */
+  bool isRecording() const { return _recording; }
+
+  /*!
+   @brief    Reports the minimum duration of TraceScope spans, in microseconds.
+   */
+  double getMinDuration() const { return _minDuration; }
+
+  /*!
+   @brief    Marks the start of a simulation step; decides whether the step is sampled.
+   */
+  void beginStep();
+
+  /*!
+   @brief    Marks the end of a simulation step.
+   */
+  void endStep();
+
+  /*!
+   @brief    Records a span on the calling thread.
+
+   @param    name        The span's name; must outlive the recorder (e.g., a string literal).
+   @param    category    The span's category; must outlive the recorder.
+   @param    start       The start of the span.
+   @param    end         The end of the span.
+   @param    argName     The name of an optional numerical argument (NULL for none).
+   @param    arg         The argument's value.
+   */
+  void addSpan(const char* name, const char* category, std::chrono::steady_clock::time_point start,
+               std::chrono::steady_clock::time_point end, const char* argName = 0x0,
+               double arg = 0.0);
+
+  /*!
+   @brief    Marks the start of a parallel region; called on the simulation thread.
+   */
+  void beginRegion();
+
+  /*!
+   @brief    Records a unit of work done by the calling thread in the current parallel region.
+
+   @param    phase    The index of the phase (less than MAX_PHASES).
+   @param    start    The start of the work.
+   @param    end      The end of the work.
+   */
+  void addWork(size_t phase, std::chrono::steady_clock::time_point start,
+               std::chrono::steady_clock::time_point end);
+
+  /*!
+   @brief    Marks the end of a parallel region; records a span for every thread which did work.
+
+   @param    name           The name of the spans.
+   @param    first          The index of the region's first phase.
+   @param    firstName      The name of the first phase.
+   @param    second         The index of the second phase (MAX_PHASES if there is none).
+   @param    secondName     The name of the second phase (NULL if there is none).
+   */
+  void endRegion(const char* name, size_t first, const char* firstName, size_t second,
+                 const char* secondName);
+
+  /*!
+   @brief    Reports the number of events recorded.
+   */
+  size_t getEventCount() const;
+
+  /*!
+   @brief    Reports the number of events discarded because a buffer was full.
+   */
+  size_t getDroppedCount() const;
+
+  /*!
+   @brief    Writes the recorded events as Chrome trace-event JSON.
+
+   @param    fileName    The path to the file to write.
+   @returns  True if the file was written.
+   */
+  bool write(const std::string& fileName) const;
+
+ private:
+  /*!
+   @brief    A recorded span.
+   */
+  struct Event {
+    const char* name;         ///< The span's name.
+    const char* category;     ///< The span's category.
+    double start;             ///< The start time (microseconds since recording started).
+    double duration;          ///< The duration (microseconds).
+    const char* argNames[2];  ///< The names of the span's arguments (NULL if unused).
+    double args[2];           ///< The values of the span's arguments.
+  };
+
+  /*!
+   @brief    The events of a single thread; padded to avoid false sharing.
+   */
+  struct ThreadBuffer {
+    /*! @brief  The recorded events. */
+    std::vector<Event> events;
+    /*! @brief  The number of discarded events. */
+    size_t dropped;
+    /*! @brief  The start of the thread's first unit of work in the current region. */
+    std::chrono::steady_clock::time_point regionStart;
+    /*! @brief  The end of the thread's last unit of work in the current region. */
+    std::chrono::steady_clock::time_point regionEnd;
+    /*! @brief  The thread's busy time in each phase of the current region (microseconds). */
+    double regionBusy[MAX_PHASES];
+    /*! @brief  Reports if the thread did any work in the current region. */
+    bool regionActive;
+    /*! @brief  Keeps neighboring threads off this cache line. */
+    char padding[64];
+  };
+
+  /*!
+   @brief    Appends an event to the calling thread's buffer.
+   */
+  void push(const Event& event);
+
+  /*!
+   @brief    Converts a time point to microseconds since recording started.
+   */
+  double toMicroseconds(std::chrono::steady_clock::time_point time) const;
+
+  /*!
+   @brief    Indicates that the recorder is enabled.
+   */
+  bool _enabled;
+
+  /*!
+   @brief    Indicates that the current step is being recorded.
+   */
+  bool _recording;
+
+  /*!
+   @brief    One in this many steps is recorded.
+   */
+  size_t _stepInterval;
+
+  /*!
+   @brief    The minimum duration of TraceScope spans (microseconds).
+   */
+  double _minDuration;
+
+  /*!
+   @brief    The number of steps seen since recording started.
+   */
+  size_t _stepCount;
+
+  /*!
+   @brief    The time recording started; event times are relative to it.
+   */
+  std::chrono::steady_clock::time_point _origin;
+
+  /*!
+   @brief    The start of the current step.
+   */
+  std::chrono::steady_clock::time_point _stepStart;
+
+  /*!
+   @brief    The event buffers of each thread.
+   */
+  std::vector<ThreadBuffer> _threads;
+};
+
+/*!
+ @brief    The trace recorder used by the simulation.
+ */
+extern MENGE_API TraceRecorder TRACER;
+
+/*!
+ @brief    Records a span for the lifetime of the scope, if the current step is being recorded and
+           the span is at least TraceRecorder::getMinDuration() long.
+
+ @code
+ TraceScope span("navmesh_astar", "path");
+ @endcode
+ */
+class TraceScope {
+ public:
+  /*!
+   @brief    Constructor.
+
+   @param    name        The span's name; must outlive the recorder (e.g., a string literal).
+   @param    category    The span's category; must outlive the recorder.
+   @param    argName     The name of an optional numerical argument (NULL for none).
+   @param    arg         The argument's value.
+   */
+  TraceScope(const char* name, const char* category, const char* argName = 0x0, double arg = 0.0)
+      : _name(name),
+        _category(category),
+        _argName(argName),
+        _arg(arg),
+        _enabled(TRACER.isRecording()) {
+    if (_enabled) _start = std::chrono::steady_clock::now();
+  }
+
+  /*!
+   @brief    Destructor; records the span.
+   */
+  ~TraceScope() {
+    if (_enabled) {
+      const std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+      const std::chrono::duration<double, std::micro> elapsed = end - _start;
+      if (elapsed.count() >= TRACER.getMinDuration()) {
+        TRACER.addSpan(_name, _category, _start, end, _argName, _arg);
+      }
+    }
+  }
+
+ private:
+  const char* _name;
+  const char* _category;
+  const char* _argName;
+  double _arg;
+  bool _enabled;
+  std::chrono::steady_clock::time_point _start;
+};
+
+}  // namespace Menge
+#endif  // __TRACE_RECORDER_H__
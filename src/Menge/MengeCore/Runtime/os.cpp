@@ -175,9 +175,9 @@ std::string fileSizeStr(FILE_SIZE size) {
 
 bool remove(const std::string& path) {
 #ifdef _MSC_VER
-  return 0 == DeleteFile(path.c_str());
+  return 0 != DeleteFile(path.c_str());
 #else
-  return (0 == remove(path.c_str()));
+  return (0 == ::remove(path.c_str()));
 #endif
 }
 
@@ -227,25 +227,27 @@ bool makedirs(const std::string& path) {
 #else
 
 bool mkdir(const std::string& path) {
-  return ::mkdir(path.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+  if (::mkdir(path.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH) == 0) return true;
+  // As with Windows, an existing directory counts as success.
+  return errno == EEXIST && path::isdir(path);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////
 
 bool makedirs(const std::string& path) {
-  size_t err;
-  std::string fullpath;
-  path::absPath(path, fullpath);
-  size_t pos = 0;
-  bool ret_val = true;
-
-  while ((ret_val == true || err == EEXIST) && pos != std::string::npos) {
-    pos = fullpath.find(path::pathSep(), pos + 1);
-    ret_val = mkdir(fullpath.substr(0, pos));
-    err = errno;
+  // path::absPath() can't be used; it only resolves paths it can create as a file.
+  if (path::exists(path)) {
+    return path::isdir(path);
   }
 
-  return !ret_val;
+  size_t pos = path.find('/', 1);
+  while (pos != std::string::npos) {
+    if (!mkdir(path.substr(0, pos))) {
+      return false;
+    }
+    pos = path.find('/', pos + 1);
+  }
+  return mkdir(path);
 }
 
 #endif
@@ -1,6 +1,10 @@
 #include "MengeCore/menge_c_api.h"
 
 #include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "MengeCore/Agents/BaseAgent.h"
 #include "MengeCore/Agents/Events/EventSystem.h"
@@ -18,6 +22,111 @@
 
 Menge::Agents::SimulatorInterface* _simulator = 0x0;
 
+namespace {
+using Menge::Agents::BaseAgent;
+
+/////////////////////////////////////////////////////////////////////
+
+// Advances the simulator on a persistent background thread (so OpenMP's thread pool is reused from
+// one step to the next).
+class AsyncStepper {
+ public:
+  AsyncStepper() : _busy(false), _result(true), _quit(false) {}
+
+  ~AsyncStepper() {
+    if (_thread.joinable()) {
+      {
+        std::lock_guard<std::mutex> guard(_lock);
+        _quit = true;
+      }
+      _signal.notify_all();
+      _thread.join();
+    }
+  }
+
+  // Starts a step; returns false if one is already in progress.
+  bool begin() {
+    std::lock_guard<std::mutex> guard(_lock);
+    if (_busy) return false;
+    if (!_thread.joinable()) _thread = std::thread(&AsyncStepper::run, this);
+    _busy = true;
+    _signal.notify_all();
+    return true;
+  }
+
+  // Waits for the step in progress (if any); returns the result of the last step.
+  bool end() {
+    std::unique_lock<std::mutex> guard(_lock);
+    _signal.wait(guard, [this] { return !_busy; });
+    return _result;
+  }
+
+ private:
+  void run() {
+    std::unique_lock<std::mutex> guard(_lock);
+    while (true) {
+      _signal.wait(guard, [this] { return _busy || _quit; });
+      if (_quit) break;
+      guard.unlock();
+      const bool result = _simulator->step();
+      guard.lock();
+      _result = result;
+      _busy = false;
+      _signal.notify_all();
+    }
+  }
+
+  std::thread _thread;
+  std::mutex _lock;
+  std::condition_variable _signal;
+  bool _busy;
+  bool _result;
+  bool _quit;
+};
+
+AsyncStepper _stepper;
+
+/////////////////////////////////////////////////////////////////////
+
+// The state of all agents at one point in time (packed arrays).
+struct AgentSnapshot {
+  float time;
+  size_t count;
+  std::vector<float> positions;
+  std::vector<float> velocities;
+  std::vector<float> orients;
+  std::vector<size_t> states;
+  std::vector<int> classes;
+};
+
+AgentSnapshot _snapshots[2];
+int _currentSnapshot = -1;
+
+/////////////////////////////////////////////////////////////////////
+
+// Returns the address of the ith record of a strided array.
+template <typename T>
+inline T* record(T* first, size_t stride, size_t i) {
+  return reinterpret_cast<T*>(reinterpret_cast<char*>(first) + stride * i);
+}
+
+// Applies the operation, in parallel, to each agent in [start, start + count) (clipped to the
+// simulator's agents). The operation receives the agent and its offset from start.
+template <typename Op>
+size_t forAgentRange(size_t start, size_t count, Op op) {
+  assert(_simulator != 0x0);
+  const size_t total = _simulator->getNumAgents();
+  if (start >= total) return 0;
+  if (count > total - start) count = total - start;
+  const int COUNT = static_cast<int>(count);
+#pragma omp parallel for
+  for (int i = 0; i < COUNT; ++i) {
+    op(_simulator->getAgent(start + i), static_cast<size_t>(i));
+  }
+  return count;
+}
+}  // namespace
+
 /////////////////////////////////////////////////////////////////////
 //          API implementation
 /////////////////////////////////////////////////////////////////////
@@ -32,6 +141,8 @@ using std::find;
 bool InitSimulator(const char* behaveFile, const char* sceneFile, const char* model,
                    const char* pluginPath) {
   const bool VERBOSE = false;
+  _stepper.end();
+  _currentSnapshot = -1;
   if (_simulator != 0x0) delete _simulator;
   Menge::SimulatorDB simDB;
   // TODO: Plugin engine is *not* public.  I can't get plugins.
@@ -58,6 +169,7 @@ bool InitSimulator(const char* behaveFile, const char* sceneFile, const char* mo
 
 void SetTimeStep(float timeStep) {
   assert(_simulator != 0x0);
+  _stepper.end();
   _simulator->setTimeStep(timeStep);
 }
 
@@ -65,6 +177,7 @@ void SetTimeStep(float timeStep) {
 
 bool DoStep() {
   assert(_simulator != 0x0);
+  _stepper.end();
   return _simulator->step();
 }
 
@@ -187,6 +300,132 @@ float GetAgentRadius(size_t i) {
 
 /////////////////////////////////////////////////////////////////////
 
+size_t GetAgentPositions(size_t start, size_t count, float* positions, size_t stride) {
+  if (stride == 0) stride = 3 * sizeof(float);
+  return forAgentRange(start, count, [=](const BaseAgent* agt, size_t i) {
+    float* p = record(positions, stride, i);
+    p[0] = agt->_pos._x;
+    p[1] = _simulator->getElevation(agt);
+    p[2] = agt->_pos._y;
+  });
+}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t GetAgentVelocities(size_t start, size_t count, float* velocities, size_t stride) {
+  if (stride == 0) stride = 3 * sizeof(float);
+  return forAgentRange(start, count, [=](const BaseAgent* agt, size_t i) {
+    float* v = record(velocities, stride, i);
+    v[0] = agt->_vel._x;
+    v[1] = 0;
+    v[2] = agt->_vel._y;
+  });
+}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t GetAgentOrients(size_t start, size_t count, float* orients, size_t stride) {
+  if (stride == 0) stride = 2 * sizeof(float);
+  return forAgentRange(start, count, [=](const BaseAgent* agt, size_t i) {
+    float* o = record(orients, stride, i);
+    o[0] = agt->_orient._x;
+    o[1] = agt->_orient._y;
+  });
+}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t GetAgentStates(size_t start, size_t count, size_t* state_ids, size_t stride) {
+  if (stride == 0) stride = sizeof(size_t);
+  const Menge::BFSM::FSM* bfsm = _simulator->getBFSM();
+  return forAgentRange(start, count, [=](const BaseAgent* agt, size_t i) {
+    *record(state_ids, stride, i) = bfsm->getAgentStateID(agt->_id);
+  });
+}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t GetAgentClasses(size_t start, size_t count, int* classes, size_t stride) {
+  if (stride == 0) stride = sizeof(int);
+  return forAgentRange(start, count, [=](const BaseAgent* agt, size_t i) {
+    *record(classes, stride, i) = static_cast<int>(agt->_class);
+  });
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool BeginStep() {
+  assert(_simulator != 0x0);
+  _stepper.end();
+  // Alternate buffers so the previous snapshot stays valid while this one is read.
+  _currentSnapshot = _currentSnapshot == 0 ? 1 : 0;
+  AgentSnapshot& snapshot = _snapshots[_currentSnapshot];
+  const size_t count = _simulator->getNumAgents();
+  snapshot.time = _simulator->getGlobalTime();
+  snapshot.count = count;
+  snapshot.positions.resize(3 * count + 1);  // +1 so data() is never null.
+  snapshot.velocities.resize(3 * count + 1);
+  snapshot.orients.resize(2 * count + 1);
+  snapshot.states.resize(count + 1);
+  snapshot.classes.resize(count + 1);
+  GetAgentPositions(0, count, snapshot.positions.data(), 0);
+  GetAgentVelocities(0, count, snapshot.velocities.data(), 0);
+  GetAgentOrients(0, count, snapshot.orients.data(), 0);
+  GetAgentStates(0, count, snapshot.states.data(), 0);
+  GetAgentClasses(0, count, snapshot.classes.data(), 0);
+  if (!_simulator->isRunning()) return false;
+  return _stepper.begin();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+bool EndStep() {
+  assert(_simulator != 0x0);
+  return _stepper.end();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+size_t GetSnapshotAgentCount() {
+  return _currentSnapshot < 0 ? 0 : _snapshots[_currentSnapshot].count;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+float GetSnapshotTime() { return _currentSnapshot < 0 ? 0.f : _snapshots[_currentSnapshot].time; }
+
+/////////////////////////////////////////////////////////////////////
+
+const float* GetSnapshotPositions() {
+  return _currentSnapshot < 0 ? nullptr : _snapshots[_currentSnapshot].positions.data();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+const float* GetSnapshotVelocities() {
+  return _currentSnapshot < 0 ? nullptr : _snapshots[_currentSnapshot].velocities.data();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+const float* GetSnapshotOrients() {
+  return _currentSnapshot < 0 ? nullptr : _snapshots[_currentSnapshot].orients.data();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+const size_t* GetSnapshotStates() {
+  return _currentSnapshot < 0 ? nullptr : _snapshots[_currentSnapshot].states.data();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+const int* GetSnapshotClasses() {
+  return _currentSnapshot < 0 ? nullptr : _snapshots[_currentSnapshot].classes.data();
+}
+
+/////////////////////////////////////////////////////////////////////
+
 std::vector<std::string> triggers;
 bool triggersValid = false;
 
@@ -164,6 +164,141 @@ MENGE_API float GetAgentRadius(size_t i);
 
 //@}
 
+/*! @name   Bulk agent functions
+ @brief   Functions for querying the state of a range of agents with a single call.
+
+ Each function fills a caller-provided array with the values for agents `start` through
+ `start + count - 1` (the range is clipped to the number of agents in the simulation). Each agent's
+ values are written to a record in the array; `stride` is the distance, in bytes, between
+ consecutive records. A stride of zero means the records are tightly packed. This allows the
+ values to be written directly into interleaved buffers (e.g., an array of structs).
+
+ The work is parallelized internally. Each function returns the number of agents written.
+ */
+//@{
+
+/*!
+ @brief   Reports the 3D positions of a range of agents (x, elevation, z).
+ @param       start       The index of the first agent.
+ @param       count       The number of agents.
+ @param[out]  positions   The first record; each record receives three floats.
+ @param       stride      The distance (in bytes) between records (zero for packed records).
+ @returns     The number of agents written.
+ */
+MENGE_API size_t GetAgentPositions(size_t start, size_t count, float* positions, size_t stride);
+
+/*!
+ @brief   Reports the 3D velocities of a range of agents (x, 0, z).
+ @param       start       The index of the first agent.
+ @param       count       The number of agents.
+ @param[out]  velocities  The first record; each record receives three floats.
+ @param       stride      The distance (in bytes) between records (zero for packed records).
+ @returns     The number of agents written.
+ */
+MENGE_API size_t GetAgentVelocities(size_t start, size_t count, float* velocities, size_t stride);
+
+/*!
+ @brief   Reports the 2D orientations of a range of agents.
+ @param       start       The index of the first agent.
+ @param       count       The number of agents.
+ @param[out]  orients     The first record; each record receives two floats.
+ @param       stride      The distance (in bytes) between records (zero for packed records).
+ @returns     The number of agents written.
+ */
+MENGE_API size_t GetAgentOrients(size_t start, size_t count, float* orients, size_t stride);
+
+/*!
+ @brief   Reports the ids of the states a range of agents are currently in.
+ @param       start       The index of the first agent.
+ @param       count       The number of agents.
+ @param[out]  state_ids   The first record; each record receives one size_t.
+ @param       stride      The distance (in bytes) between records (zero for packed records).
+ @returns     The number of agents written.
+ */
+MENGE_API size_t GetAgentStates(size_t start, size_t count, size_t* state_ids, size_t stride);
+
+/*!
+ @brief   Reports the classes of a range of agents.
+ @param       start       The index of the first agent.
+ @param       count       The number of agents.
+ @param[out]  classes     The first record; each record receives one int.
+ @param       stride      The distance (in bytes) between records (zero for packed records).
+ @returns     The number of agents written.
+ */
+MENGE_API size_t GetAgentClasses(size_t start, size_t count, int* classes, size_t stride);
+
+//@}
+
+/*! @name   Asynchronous stepping
+ @brief   Functions for reading the state of frame N while frame N+1 is computed.
+
+ BeginStep() captures a snapshot of the current state of all agents. It then starts computing the
+ next time step on a background thread and returns immediately. While the step is in progress, the
+ caller may read the snapshot through the GetSnapshot functions, which return packed arrays.
+ EndStep() waits for the step to complete.
+
+ Snapshots are double buffered: the arrays of a snapshot remain valid until the second following
+ call to BeginStep(). Between BeginStep() and EndStep(), *only* the snapshot functions may be
+ called (InitSimulator(), SetTimeStep() and DoStep() wait for the step to finish first).
+ */
+//@{
+
+/*!
+ @brief   Snapshots the current state of the agents and starts advancing the simulator one time
+          step on a background thread.
+ @returns True if the step was started. False if a step is already in progress or the simulation
+          has ended.
+ */
+MENGE_API bool BeginStep();
+
+/*!
+ @brief   Waits for the step started by BeginStep() to complete.
+ @returns True if the simulation can keep running.
+ */
+MENGE_API bool EndStep();
+
+/*!
+ @brief   Reports the number of agents in the most recent snapshot.
+ */
+MENGE_API size_t GetSnapshotAgentCount();
+
+/*!
+ @brief   Reports the simulation time of the most recent snapshot.
+ */
+MENGE_API float GetSnapshotTime();
+
+/*!
+ @brief   The positions of the most recent snapshot (three floats per agent: x, elevation, z).
+ @returns A pointer to the positions, or null if no snapshot has been taken.
+ */
+MENGE_API const float* GetSnapshotPositions();
+
+/*!
+ @brief   The velocities of the most recent snapshot (three floats per agent: x, 0, z).
+ @returns A pointer to the velocities, or null if no snapshot has been taken.
+ */
+MENGE_API const float* GetSnapshotVelocities();
+
+/*!
+ @brief   The orientations of the most recent snapshot (two floats per agent).
+ @returns A pointer to the orientations, or null if no snapshot has been taken.
+ */
+MENGE_API const float* GetSnapshotOrients();
+
+/*!
+ @brief   The state ids of the most recent snapshot (one per agent).
+ @returns A pointer to the state ids, or null if no snapshot has been taken.
+ */
+MENGE_API const size_t* GetSnapshotStates();
+
+/*!
+ @brief   The classes of the most recent snapshot (one per agent).
+ @returns A pointer to the classes, or null if no snapshot has been taken.
+ */
+MENGE_API const int* GetSnapshotClasses();
+
+//@}
+
 /*! @name   External triggers.
  @brief   The interface for working with external triggers.
 
@@ -0,0 +1,357 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+#include "MengeCore/resources/EikonalField.h"
+
+#include "MengeCore/Agents/Obstacle.h"
+#include "MengeCore/Math/Geometry2D.h"
+#include "MengeCore/Runtime/Logger.h"
+#include "MengeCore/Runtime/os.h"
+#include "MengeCore/resources/NavMesh.h"
+#include "MengeCore/resources/NavMeshNode.h"
+#include "MengeCore/resources/ResourceManager.h"
+
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <sstream>
+#include <utility>
+
+namespace Menge {
+
+using Math::Vector2;
+
+namespace {
+// The traversal cost of a blocked cell, relative to a walkable cell.
+const double BLOCKED_COST = 1e6;
+
+// An axis-aligned bounding box of a polygon or segment.
+struct Bounds {
+  float minX, minY, maxX, maxY;
+};
+
+// The walkability classification of each grid cell.
+enum CellType { BLOCKED = 0, WALKABLE = 1, GOAL = 2 };
+}  // namespace
+
+/////////////////////////////////////////////////////////////////////
+//                   Implementation of EikonalFieldBuilder
+/////////////////////////////////////////////////////////////////////
+
+EikonalFieldBuilder::EikonalFieldBuilder(float cellSize)
+    : _cellSize(cellSize), _clearance(-1.f), _navMesh(0x0) {}
+
+/////////////////////////////////////////////////////////////////////
+
+EikonalFieldBuilder::~EikonalFieldBuilder() {
+  for (size_t i = 0; i < _goals.size(); ++i) {
+    delete _goals[i];
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void EikonalFieldBuilder::addObstacle(const Vector2& p0, const Vector2& p1) {
+  _obstacles.push_back(p0);
+  _obstacles.push_back(p1);
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void EikonalFieldBuilder::addObstacles(const std::vector<Agents::Obstacle*>& obstacles) {
+  for (size_t i = 0; i < obstacles.size(); ++i) {
+    addObstacle(obstacles[i]->getP0(), obstacles[i]->getP1());
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void EikonalFieldBuilder::addGoal(Math::Geometry2D* goal) { _goals.push_back(goal); }
+
+/////////////////////////////////////////////////////////////////////
+
+VectorField* EikonalFieldBuilder::build(const std::string& name) const {
+  if (_goals.empty()) {
+    logger << Logger::ERR_MSG << "Can't compute an eikonal vector field without goals.\n";
+    return 0x0;
+  }
+  if (_navMesh == 0x0 && _obstacles.empty()) {
+    logger << Logger::ERR_MSG << "Can't compute an eikonal vector field without a domain; ";
+    logger << "provide a navigation mesh or obstacles.\n";
+    return 0x0;
+  }
+  if (_cellSize <= 0.f) {
+    logger << Logger::ERR_MSG << "Eikonal vector field requires a positive cell size.\n";
+    return 0x0;
+  }
+
+  // Per-polygon bounding boxes (navigation mesh) -- these also define the domain.
+  Bounds domain = {1e30f, 1e30f, -1e30f, -1e30f};
+  std::vector<Bounds> polyBounds;
+  if (_navMesh != 0x0) {
+    const Vector2* vertices = _navMesh->getVertices();
+    const size_t NODE_COUNT = _navMesh->getNodeCount();
+    polyBounds.resize(NODE_COUNT);
+    for (size_t n = 0; n < NODE_COUNT; ++n) {
+      const NavMeshNode& node = _navMesh->getNode((unsigned int)n);
+      Bounds& b = polyBounds[n];
+      b.minX = b.minY = 1e30f;
+      b.maxX = b.maxY = -1e30f;
+      for (size_t v = 0; v < node.getVertexCount(); ++v) {
+        const Vector2& p = vertices[node.getVertexID(v)];
+        if (p.x() < b.minX) b.minX = p.x();
+        if (p.x() > b.maxX) b.maxX = p.x();
+        if (p.y() < b.minY) b.minY = p.y();
+        if (p.y() > b.maxY) b.maxY = p.y();
+      }
+      if (b.minX < domain.minX) domain.minX = b.minX;
+      if (b.minY < domain.minY) domain.minY = b.minY;
+      if (b.maxX > domain.maxX) domain.maxX = b.maxX;
+      if (b.maxY > domain.maxY) domain.maxY = b.maxY;
+    }
+  } else {
+    for (size_t i = 0; i < _obstacles.size(); ++i) {
+      const Vector2& p = _obstacles[i];
+      if (p.x() < domain.minX) domain.minX = p.x();
+      if (p.x() > domain.maxX) domain.maxX = p.x();
+      if (p.y() < domain.minY) domain.minY = p.y();
+      if (p.y() > domain.maxY) domain.maxY = p.y();
+    }
+  }
+  for (size_t g = 0; g < _goals.size(); ++g) {
+    const Vector2 c = _goals[g]->getCentroid();
+    if (c.x() < domain.minX) domain.minX = c.x();
+    if (c.x() > domain.maxX) domain.maxX = c.x();
+    if (c.y() < domain.minY) domain.minY = c.y();
+    if (c.y() > domain.maxY) domain.maxY = c.y();
+  }
+
+  // Pad the domain by a cell so the boundary is surrounded by a ring of cells.
+  const float H = _cellSize;
+  const Vector2 minPt(domain.minX - H, domain.minY - H);
+  const int COLS = (int)std::ceil((domain.maxX - domain.minX) / H) + 2;
+  const int ROWS = (int)std::ceil((domain.maxY - domain.minY) / H) + 2;
+  const double CELL_COUNT = (double)ROWS * (double)COLS;
+  if (CELL_COUNT > (double)std::numeric_limits<int>::max()) {
+    logger << Logger::ERR_MSG << "The eikonal vector field would have too many cells (";
+    logger << (float)CELL_COUNT << "); increase the cell size.\n";
+    return 0x0;
+  }
+  const int N = ROWS * COLS;
+
+  // 1. Classify the cells.
+  std::vector<unsigned char> cellType(N, _navMesh == 0x0 ? WALKABLE : BLOCKED);
+  if (_navMesh != 0x0) {
+    const int NODE_COUNT = (int)polyBounds.size();
+#pragma omp parallel for
+    for (int r = 0; r < ROWS; ++r) {
+      const float y = minPt.y() + (r + 0.5f) * H;
+      for (int n = 0; n < NODE_COUNT; ++n) {
+        const Bounds& b = polyBounds[n];
+        if (y < b.minY || y > b.maxY) continue;
+        int c0 = (int)std::floor((b.minX - minPt.x()) / H - 0.5f);
+        int c1 = (int)std::ceil((b.maxX - minPt.x()) / H - 0.5f);
+        if (c0 < 0) c0 = 0;
+        if (c1 >= COLS) c1 = COLS - 1;
+        const NavMeshNode& node = _navMesh->getNode((unsigned int)n);
+        for (int c = c0; c <= c1; ++c) {
+          unsigned char& cell = cellType[r * COLS + c];
+          if (cell == BLOCKED && node.containsPoint(Vector2(minPt.x() + (c + 0.5f) * H, y))) {
+            cell = WALKABLE;
+          }
+        }
+      }
+    }
+  }
+  if (!_obstacles.empty()) {
+    const float CLEARANCE = _clearance > 0.f ? _clearance : 0.7072f * H;
+    const float CLEAR_SQ = CLEARANCE * CLEARANCE;
+    const int SEG_COUNT = (int)_obstacles.size() / 2;
+#pragma omp parallel for
+    for (int r = 0; r < ROWS; ++r) {
+      const float y = minPt.y() + (r + 0.5f) * H;
+      for (int s = 0; s < SEG_COUNT; ++s) {
+        const Vector2& p0 = _obstacles[2 * s];
+        const Vector2& p1 = _obstacles[2 * s + 1];
+        const float minY = (p0.y() < p1.y() ? p0.y() : p1.y()) - CLEARANCE;
+        const float maxY = (p0.y() > p1.y() ? p0.y() : p1.y()) + CLEARANCE;
+        if (y < minY || y > maxY) continue;
+        const float minX = (p0.x() < p1.x() ? p0.x() : p1.x()) - CLEARANCE;
+        const float maxX = (p0.x() > p1.x() ? p0.x() : p1.x()) + CLEARANCE;
+        int c0 = (int)std::floor((minX - minPt.x()) / H - 0.5f);
+        int c1 = (int)std::ceil((maxX - minPt.x()) / H - 0.5f);
+        if (c0 < 0) c0 = 0;
+        if (c1 >= COLS) c1 = COLS - 1;
+        for (int c = c0; c <= c1; ++c) {
+          const Vector2 q(minPt.x() + (c + 0.5f) * H, y);
+          float distSq = absSq(q - p0);
+          if (p0 != p1) distSq = Agents::distSqPointLineSegment(p0, p1, q);
+          if (distSq <= CLEAR_SQ) cellType[r * COLS + c] = BLOCKED;
+        }
+      }
+    }
+  }
+  // Goal cells: every cell whose center is in a goal and the cell containing each goal's centroid.
+  const int GOAL_COUNT = (int)_goals.size();
+#pragma omp parallel for
+  for (int r = 0; r < ROWS; ++r) {
+    const float y = minPt.y() + (r + 0.5f) * H;
+    for (int c = 0; c < COLS; ++c) {
+      const Vector2 q(minPt.x() + (c + 0.5f) * H, y);
+      for (int g = 0; g < GOAL_COUNT; ++g) {
+        if (_goals[g]->containsPoint(q)) {
+          cellType[r * COLS + c] = GOAL;
+          break;
+        }
+      }
+    }
+  }
+  for (int g = 0; g < GOAL_COUNT; ++g) {
+    const Vector2 offset = (_goals[g]->getCentroid() - minPt) / H;
+    cellType[(int)offset.y() * COLS + (int)offset.x()] = GOAL;
+  }
+
+  // 2. Fast marching.
+  const double INF = std::numeric_limits<double>::infinity();
+  std::vector<double> T(N, INF);
+  std::vector<unsigned char> frozen(N, 0);
+  typedef std::pair<double, int> HeapEntry;
+  std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry> > front;
+  for (int i = 0; i < N; ++i) {
+    if (cellType[i] == GOAL) {
+      T[i] = 0.0;
+      front.push(HeapEntry(0.0, i));
+    }
+  }
+  while (!front.empty()) {
+    const HeapEntry top = front.top();
+    front.pop();
+    const int i = top.second;
+    // Stale entries are left in the heap when a cell's value improves; skip them.
+    if (frozen[i] || top.first > T[i]) continue;
+    frozen[i] = 1;
+    const int r = i / COLS;
+    const int c = i % COLS;
+    const int neighbors[4] = {c > 0 ? i - 1 : -1, c < COLS - 1 ? i + 1 : -1,
+                              r > 0 ? i - COLS : -1, r < ROWS - 1 ? i + COLS : -1};
+    for (int k = 0; k < 4; ++k) {
+      const int j = neighbors[k];
+      if (j < 0 || frozen[j]) continue;
+      const int rj = j / COLS;
+      const int cj = j % COLS;
+      // The smallest known value along each axis.
+      double a = INF;
+      if (cj > 0 && frozen[j - 1]) a = T[j - 1];
+      if (cj < COLS - 1 && frozen[j + 1] && T[j + 1] < a) a = T[j + 1];
+      double b = INF;
+      if (rj > 0 && frozen[j - COLS]) b = T[j - COLS];
+      if (rj < ROWS - 1 && frozen[j + COLS] && T[j + COLS] < b) b = T[j + COLS];
+      if (a > b) std::swap(a, b);
+      const double f = cellType[j] == BLOCKED ? H * BLOCKED_COST : H;
+      double t;
+      if (b == INF || b - a >= f) {
+        t = a + f;
+      } else {
+        t = 0.5 * (a + b + std::sqrt(2.0 * f * f - (a - b) * (a - b)));
+      }
+      if (t < T[j]) {
+        T[j] = t;
+        front.push(HeapEntry(t, j));
+      }
+    }
+  }
+
+  // 3. Extract the (negative) gradient directions.
+  VectorField* field = new VectorField(name, minPt, ROWS, COLS, H);
+  const double UNREACHABLE = H * BLOCKED_COST;
+  int unreachable = 0;
+#pragma omp parallel for reduction(+ : unreachable)
+  for (int r = 0; r < ROWS; ++r) {
+    for (int c = 0; c < COLS; ++c) {
+      const int i = r * COLS + c;
+      if (cellType[i] == GOAL) continue;
+      const bool walkable = cellType[i] == WALKABLE;
+      if (walkable && T[i] >= UNREACHABLE) {
+        ++unreachable;
+        continue;
+      }
+      // Walkable cells only follow walkable neighbors (or goals).
+      double left = INF, right = INF, down = INF, up = INF;
+      if (c > 0 && (!walkable || cellType[i - 1] != BLOCKED)) left = T[i - 1];
+      if (c < COLS - 1 && (!walkable || cellType[i + 1] != BLOCKED)) right = T[i + 1];
+      if (r > 0 && (!walkable || cellType[i - COLS] != BLOCKED)) down = T[i - COLS];
+      if (r < ROWS - 1 && (!walkable || cellType[i + COLS] != BLOCKED)) up = T[i + COLS];
+      double dx = 0.0, dy = 0.0;
+      if (left < right) {
+        if (left < T[i]) dx = -(T[i] - left);
+      } else if (right < T[i]) {
+        dx = T[i] - right;
+      }
+      if (down < up) {
+        if (down < T[i]) dy = -(T[i] - down);
+      } else if (up < T[i]) {
+        dy = T[i] - up;
+      }
+      const double len = std::sqrt(dx * dx + dy * dy);
+      if (len > 0.0) {
+        field->setFieldValue(r, c, Vector2((float)(dx / len), (float)(dy / len)));
+      }
+    }
+  }
+  if (unreachable > 0) {
+    logger << Logger::WARN_MSG << "The eikonal vector field " << name << " has " << unreachable;
+    logger << " walkable cells which cannot reach any goal; their vectors are zero.\n";
+  }
+  return field;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+VectorFieldPtr buildEikonalField(const EikonalFieldBuilder& builder,
+                                 const std::string& cacheFile) throw(ResourceException) {
+  if (cacheFile != "" && os::path::exists(cacheFile)) {
+    logger << Logger::INFO_MSG << "Using cached eikonal vector field: " << cacheFile << "\n";
+    return loadVectorField(cacheFile);
+  }
+
+  std::string name = cacheFile;
+  if (name == "") {
+    // In-memory fields need a unique resource name.
+    static int fieldCount = 0;
+    std::stringstream ss;
+    ss << "eikonal_field_" << fieldCount++;
+    name = ss.str();
+  }
+  VectorField* field = builder.build(name);
+  if (field == 0x0) {
+    throw ResourceException();
+  }
+  if (cacheFile != "") {
+    const bool written = field->writeBinary(cacheFile, false /* halfPrecision */);
+    field->destroy();
+    if (!written) throw ResourceException();
+    return loadVectorField(cacheFile);
+  }
+  if (!ResourceManager::addResource(field)) {
+    field->destroy();
+    throw ResourceException();
+  }
+  return VectorFieldPtr(field);
+}
+}  // namespace Menge
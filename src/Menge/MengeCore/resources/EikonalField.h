@@ -0,0 +1,183 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+/*!
+ @file    EikonalField.h
+ @brief   Generation of vector fields from the solution of the eikonal equation (i.e., shortest
+          travel distance to a goal set) over a walkable domain.
+ */
+
+#ifndef __EIKONAL_FIELD_H__
+#define __EIKONAL_FIELD_H__
+
+#include "MengeCore/CoreConfig.h"
+#include "MengeCore/Math/Vector2.h"
+#include "MengeCore/resources/Resource.h"
+#include "MengeCore/resources/VectorField.h"
+
+#include <string>
+#include <vector>
+
+namespace Menge {
+
+// forward declarations
+class NavMesh;
+namespace Agents {
+class Obstacle;
+}
+namespace Math {
+class Geometry2D;
+}
+
+/*!
+ @brief    Computes a VectorField whose vectors point along the shortest path (through the walkable
+          domain) to the nearest goal in a goal set.
+
+ The domain is discretized into a uniform grid. The walkable cells are defined by a navigation mesh
+ (a cell is walkable if its center lies inside one of the mesh's polygons) and/or a set of
+ obstacle line segments (a cell is blocked if its center lies within the clearance distance of an
+ obstacle). If there is no navigation mesh, every cell not blocked by an obstacle is walkable.
+
+ The travel-distance field is computed with the fast marching method (a first-order, upwind
+ solution of |grad T| = 1) seeded at all cells covered by the goals. Blocked cells are given a very
+ large traversal cost, rather than being excluded; so the resulting vectors in the (few) blocked
+ cells an agent may stray into lead back out into the walkable domain. Walkable cells only take
+ their direction from walkable neighbors, so paths never cut through obstacles.
+
+ The resulting field contains unit vectors (zero in the goal cells and in any walkable cell which
+ cannot reach a goal) and can be used directly with the VFVelComponent. Rasterizing the domain and
+ extracting the vectors are performed in parallel; the marching front itself is inherently
+ sequential.
+ */
+class MENGE_API EikonalFieldBuilder {
+ public:
+  /*!
+   @brief    Constructor.
+
+   @param    cellSize    The size of each square grid cell.
+   */
+  explicit EikonalFieldBuilder(float cellSize);
+
+  /*!
+   @brief    Destructor.
+   */
+  ~EikonalFieldBuilder();
+
+  /*!
+   @brief    Defines the walkable domain by the polygons of the given navigation mesh. The mesh must
+            persist until build() is called.
+
+   @param    navMesh    The navigation mesh.
+   */
+  void setNavMesh(const NavMesh* navMesh) { _navMesh = navMesh; }
+
+  /*!
+   @brief    Adds a single obstacle line segment.
+
+   @param    p0    The first end point of the segment.
+   @param    p1    The second end point of the segment.
+   */
+  void addObstacle(const Math::Vector2& p0, const Math::Vector2& p1);
+
+  /*!
+   @brief    Adds the given simulation obstacles.
+
+   @param    obstacles    The obstacles.
+   */
+  void addObstacles(const std::vector<Agents::Obstacle*>& obstacles);
+
+  /*!
+   @brief    Sets the clearance distance for obstacles: cells whose centers lie within this
+            distance of an obstacle are blocked. Non-positive values select the default: half the
+            diagonal of a cell (the smallest value that guarantees obstacles are "water tight").
+
+   @param    clearance    The clearance distance.
+   */
+  void setClearance(float clearance) { _clearance = clearance; }
+
+  /*!
+   @brief    Adds a goal region to the goal set. The builder takes ownership of the geometry.
+
+   @param    goal    The goal region.
+   */
+  void addGoal(Math::Geometry2D* goal);
+
+  /*!
+   @brief    Reports the number of goal regions in the goal set.
+   */
+  size_t getGoalCount() const { return _goals.size(); }
+
+  /*!
+   @brief    Computes the vector field.
+
+   @param    name    The name of the resulting vector field resource.
+   @returns  A new, unmanaged VectorField (the caller is responsible for it), or NULL if the field
+            could not be computed (e.g., there are no goals or no domain).
+   */
+  VectorField* build(const std::string& name) const;
+
+ protected:
+  /*!
+   @brief    The size of each grid cell.
+   */
+  float _cellSize;
+
+  /*!
+   @brief    The obstacle clearance distance (see setClearance).
+   */
+  float _clearance;
+
+  /*!
+   @brief    The optional navigation mesh defining the walkable domain.
+   */
+  const NavMesh* _navMesh;
+
+  /*!
+   @brief    The obstacle segments, stored as pairs of consecutive end points.
+   */
+  std::vector<Math::Vector2> _obstacles;
+
+  /*!
+   @brief    The goal set.
+   */
+  std::vector<Math::Geometry2D*> _goals;
+
+ private:
+  // Not copyable; it owns its goal geometries.
+  EikonalFieldBuilder(const EikonalFieldBuilder&);
+  EikonalFieldBuilder& operator=(const EikonalFieldBuilder&);
+};
+
+/*!
+ @brief    Acquires the vector field produced by the given builder, optionally caching it on disk.
+
+ If a cache file is named and it exists, the field is simply loaded from it (the builder is not
+ executed -- delete the cache file to force the field to be recomputed). If it doesn't exist, the
+ field is computed and written to the cache file in the binary vector field format. Without a
+ cache file, the field is computed and held only in memory.
+
+ @param    builder      The builder defining the field.
+ @param    cacheFile    The path to the cache file; the empty string disables caching.
+ @returns  The VectorFieldPtr containing the data.
+ @throws   A ResourceException if the field could not be computed or cached.
+ */
+MENGE_API VectorFieldPtr buildEikonalField(const EikonalFieldBuilder& builder,
+                                           const std::string& cacheFile) throw(ResourceException);
+}  // namespace Menge
+
+#endif  // __EIKONAL_FIELD_H__
@@ -45,6 +45,7 @@ Any questions or comments should be sent to the authors {menge,geom}@cs.unc.edu
 #include "MengeCore/resources/GraphEdge.h"
 #include "MengeCore/resources/MinHeap.h"
 #include "MengeCore/resources/RoadMapPath.h"
+#include "MengeCore/Runtime/TraceRecorder.h"
 
 #include <fstream>
 #include <iostream>
@@ -250,6 +251,7 @@ size_t Graph::getClosestVertex(const Vector2& point, float radius, Clearance cle
 //////////////////////////////////////////////////////////////////////////////////////
 
 RoadMapPath* Graph::getPath(size_t startID, size_t endID) {
+  TraceScope span("roadmap_astar", "path", "start_vertex", static_cast<double>(startID));
   const size_t N = _vCount;
 #ifdef _OPENMP
   // Assuming that threadNum \in [0, omp_get_max_threads() )
@@ -96,6 +96,17 @@ class MENGE_API Graph : public Resource {
    */
   RoadMapPath* getPath(const Agents::BaseAgent* agent, const BFSM::Goal* goal);
 
+  /*!
+   @brief    Computes the shortest path from start to end vertices.
+
+   This function instantiates a new path, but the caller is responsible for deleting it.
+
+   @param    startID   The index of the start vertex.
+   @param    endID     The index of the end vertex.
+   @returns  A pointer to a new RoadMapPath.
+   */
+  RoadMapPath* getPath(size_t startID, size_t endID);
+
   /*!
    @brief    Return the number of vertices in the graph.
 
@@ -135,17 +146,6 @@ class MENGE_API Graph : public Resource {
    */
   size_t getClosestVertex(const Vector2& point, float radius, Clearance clearance);
 
-  /*!
-   @brief    Computes the shortest path from start to end vertices.
-
-   This function instantiates a new path, but the caller is responsible for deleting it.
-
-   @param    startID   The index of the start vertex.
-   @param    endID     The index of the end vertex.
-   @returns  A pointer to a new RoadMapPath.
-   */
-  RoadMapPath* getPath(size_t startID, size_t endID);
-
   /*!
    @brief    Compute's "h" for the A* algorithm.
    
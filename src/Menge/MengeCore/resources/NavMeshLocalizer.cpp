@@ -135,6 +135,17 @@ void NavMeshLocalizer::clearPath(size_t agentID) {
 
 /////////////////////////////////////////////////////////////////////
 
+void NavMeshLocalizer::clearPaths(const std::vector<Agents::BaseAgent*>& agents) {
+  _locLock.lockRead();
+  for (size_t i = 0; i < agents.size(); ++i) {
+    HASH_MAP<size_t, NavMeshLocation>::iterator itr = _locations.find(agents[i]->_id);
+    if (itr != _locations.end()) itr->second.clearPath();
+  }
+  _locLock.releaseRead();
+}
+
+/////////////////////////////////////////////////////////////////////
+
 unsigned int NavMeshLocalizer::getNode(const Agents::BaseAgent* agent) const {
   unsigned int node = NavMeshLocation::NO_NODE;
   _locLock.lockRead();
@@ -195,6 +206,24 @@ void NavMeshLocalizer::setNode(size_t agentID, unsigned int nodeID) {
 
 /////////////////////////////////////////////////////////////////////
 
+void NavMeshLocalizer::removeAgent(size_t agentID) {
+  unsigned int node = NavMeshLocation::NO_NODE;
+  _locLock.lockWrite();
+  HASH_MAP<size_t, NavMeshLocation>::iterator itr = _locations.find(agentID);
+  if (itr != _locations.end()) {
+    node = itr->second.getNode();
+    itr->second.setNode(NavMeshLocation::NO_NODE);  // frees the path
+    _locations.erase(itr);
+  }
+  _locLock.releaseWrite();
+  // Agents off the mesh are recorded in the extra, final occupant set.
+  const unsigned int OFF_MESH = static_cast<unsigned int>(_navMesh->getNodeCount());
+  if (node != NavMeshLocation::NO_NODE) _nodeOccupants[node].erase(agentID);
+  _nodeOccupants[OFF_MESH].erase(agentID);
+}
+
+/////////////////////////////////////////////////////////////////////
+
 unsigned int NavMeshLocalizer::updateLocation(const Agents::BaseAgent* agent, bool force) const {
   const size_t ID = agent->_id;
   // NOTE: This will create a default location instance if the agent didn't already
@@ -239,14 +268,13 @@ unsigned int NavMeshLocalizer::updateLocation(const Agents::BaseAgent* agent, bo
         if (fromItr != _nodeOccupants[oldLoc].end()) {
           _nodeOccupants[oldLoc].erase(fromItr);
         } else if (oldLoc != NavMeshLocation::NO_NODE) {
-          logger << Logger::ERR_MSG << "Trying to remove agent " << ID;
-          logger << " from node " << oldLoc;
-          logger << " but it has not been assigned to that node.";
+          MENGE_LOG(ERR_MSG) << "Trying to remove agent " << ID << " from node " << oldLoc
+                             << " but it has not been assigned to that node.";
           const size_t NCOUNT = _navMesh->getNodeCount();
           for (size_t i = 0; i < NCOUNT; ++i) {
             fromItr = _nodeOccupants[i].find(ID);
             if (fromItr != _nodeOccupants[i].end()) {
-              logger << "\n\tFound the agent in node: " << i << ".";
+              MENGE_LOG(ERR_MSG) << "\tFound agent " << ID << " in node: " << i << ".";
               _nodeOccupants[i].erase(fromItr);
               break;
             }
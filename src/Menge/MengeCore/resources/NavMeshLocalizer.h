@@ -33,6 +33,7 @@
 
 #include <map>
 #include <set>
+#include <vector>
 
 namespace Menge {
 
@@ -243,6 +244,13 @@ class MENGE_API NavMeshLocalizer : public Resource {
    */
   void clearPath(size_t agentID);
 
+  /*!
+   @brief    Clears the paths of the given agents, acquiring the location lock once.
+
+   @param    agents    The agents whose paths are to be cleared.
+   */
+  void clearPaths(const std::vector<Agents::BaseAgent*>& agents);
+
   /*!
    @brief    Sets the location of the agent to be anode
 
@@ -251,6 +259,14 @@ class MENGE_API NavMeshLocalizer : public Resource {
    */
   void setNode(size_t agentID, unsigned int nodeID);
 
+  /*!
+   @brief    Forgets the agent; its location (and path) is discarded and it is removed from the
+            node occupants.
+
+   @param    agentID    The index of the agent to remove.
+   */
+  void removeAgent(size_t agentID);
+
   /*!
    @brief    Sets the tracking status of the localizer to all agents.
 
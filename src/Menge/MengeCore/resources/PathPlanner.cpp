@@ -42,7 +42,9 @@ Any questions or comments should be sent to the authors {menge,geom}@cs.unc.edu
 #include "MengeCore/resources/NavMesh.h"
 #include "MengeCore/resources/NavMeshNode.h"
 #include "MengeCore/resources/Route.h"
+#include "MengeCore/Runtime/TraceRecorder.h"
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <sstream>
@@ -92,6 +94,11 @@ PathPlanner::PathPlanner(NavMeshPtr ptr)
     : _navMesh(ptr), DATA_SIZE(0), STATE_SIZE(0), _HEAP(0x0), _DATA(0x0), _STATE(0x0) {
   size_t nCount = _navMesh->getNodeCount();
   initHeapMemory(nCount);
+  for (unsigned int e = 0; e < _navMesh->getEdgeCount(); ++e) {
+    _edgeWidths.push_back(_navMesh->getEdge(e).getWidth());
+  }
+  std::sort(_edgeWidths.begin(), _edgeWidths.end());
+  _edgeWidths.erase(std::unique(_edgeWidths.begin(), _edgeWidths.end()), _edgeWidths.end());
 }
 
 /////////////////////////////////////////////////////////////////////
@@ -129,7 +136,82 @@ PortalRoute* PathPlanner::getRoute(unsigned int startID, unsigned int endID, flo
 
 /////////////////////////////////////////////////////////////////////
 
+const float* PathPlanner::getPathLengths(unsigned int endID, float minWidth) {
+  // An edge is passable if its width is at least minWidth; the smallest such width admits exactly
+  // the same edges.
+  std::vector<float>::const_iterator wItr =
+      std::lower_bound(_edgeWidths.begin(), _edgeWidths.end(), minWidth);
+  if (wItr != _edgeWidths.end()) minWidth = *wItr;
+  const std::pair<unsigned int, float> key(endID, minWidth);
+  const float* lengths = 0x0;
+  _pathLengthLock.lockRead();
+  std::map<std::pair<unsigned int, float>, std::vector<float> >::const_iterator itr =
+      _pathLengths.find(key);
+  if (itr != _pathLengths.end()) lengths = &itr->second[0];
+  _pathLengthLock.releaseRead();
+  if (lengths != 0x0) return lengths;
+
+  // Several threads may compute the same table; the first one cached is used by all of them.
+  std::vector<float> computed;
+  computePathLengths(endID, minWidth, computed);
+  _pathLengthLock.lockWrite();
+  std::vector<float>& cached = _pathLengths[key];
+  if (cached.empty()) cached.swap(computed);
+  lengths = &cached[0];
+  _pathLengthLock.releaseWrite();
+  return lengths;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+void PathPlanner::computePathLengths(unsigned int endID, float minWidth,
+                                     std::vector<float>& lengths) {
+  TraceScope span("navmesh_dijkstra", "path", "end_node", endID);
+  const size_t N = _navMesh->getNodeCount();
+#ifdef _OPENMP
+  const unsigned int threadNum = omp_get_thread_num();
+  AStarMinHeap heap(_HEAP + threadNum * N, _DATA + threadNum * DATA_SIZE,
+                    _STATE + threadNum * STATE_SIZE, _PATH + threadNum * N, N);
+#else
+  AStarMinHeap heap(_HEAP, _DATA, _STATE, _PATH, N);
+#endif
+
+  // A* without a heuristic; the edges are symmetric so searching from the end node yields the
+  // lengths of the paths *to* the end node.
+  lengths.assign(N, -1.f);
+  heap.g(endID, 0);
+  heap.h(endID, 0);
+  heap.f(endID, 0);
+  heap.push(endID);
+  while (!heap.empty()) {
+    unsigned int x = heap.pop();
+    lengths[x] = heap.g(x);
+
+    NavMeshNode& node = _navMesh->_nodes[x];
+    for (size_t e = 0; e < node._edgeCount; ++e) {
+      NavMeshEdge* edge = node._edges[e];
+      unsigned int y = edge->getOtherByID(x)->_id;
+      if (heap.isVisited(y)) continue;
+      float distance = edge->getNodeDistance(minWidth);
+      if (distance < 0.f) continue;
+      float tempG = heap.g(x) + distance;
+      if (!heap.isInHeap(y)) heap.h(y, 0.f);
+      if (tempG < heap.g(y)) {
+        heap.setReachedFrom(y, x);
+        heap.g(y, tempG);
+        heap.f(y, tempG);
+      }
+      if (!heap.isInHeap(y)) {
+        heap.push(y);
+      }
+    }
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+
 PortalRoute* PathPlanner::computeRoute(unsigned int startID, unsigned int endID, float minWidth) {
+  TraceScope span("navmesh_astar", "path", "start_node", startID);
   const size_t N = _navMesh->getNodeCount();
 #ifdef _OPENMP
   // Assuming that threadNum \in [0, omp_get_max_threads() )
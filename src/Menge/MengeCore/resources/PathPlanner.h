@@ -30,6 +30,8 @@
 
 #include <list>
 #include <map>
+#include <utility>
+#include <vector>
 
 namespace Menge {
 
@@ -137,6 +139,21 @@ class MENGE_API PathPlanner {
    */
   PortalRoute* getRoute(unsigned int startID, unsigned int endID, float minWidth);
 
+  /*!
+   @brief    Returns the lengths of the shortest paths from every node to the specified node.
+
+   The lengths are measured the same way as PortalRoute::getLength(). They are computed with a
+   single Dijkstra search from the end node the first time they are requested and cached thereafter.
+   Widths which admit the same set of edges share a table, so the number of tables per node is
+   bounded by the number of distinct edge widths in the mesh.
+
+   @param    endID      The index of the navigation mesh node at which the paths end.
+   @param    minWidth  The minimum passable width required for the paths.
+   @returns  An array of path lengths indexed by navigation mesh node. Nodes from which the end node
+            can't be reached have a negative length.
+   */
+  const float* getPathLengths(unsigned int endID, float minWidth);
+
  protected:
   /*!
    @brief    Computes a route (and adds it to the cache) between start and end with the minimum
@@ -178,6 +195,15 @@ class MENGE_API PathPlanner {
    */
   PortalRoute* cacheRoute(unsigned int startID, unsigned int endID, PortalRoute* route);
 
+  /*!
+   @brief    Computes the lengths of the shortest paths from every node to the end node.
+
+   @param    endID      The index of the navigation mesh node at which the paths end.
+   @param    minWidth  The minimum passable width required for the paths.
+   @param    lengths    The path length for each node; unreachable nodes have a negative length.
+   */
+  void computePathLengths(unsigned int endID, float minWidth, std::vector<float>& lengths);
+
   /*!
    @brief    A mapping from RouteKeys (a size_t) to to a list of routes.
 
@@ -191,6 +217,22 @@ class MENGE_API PathPlanner {
    */
   ReadersWriterLock _routeLock;
 
+  /*!
+   @brief    The cached path lengths to an end node (see getPathLengths()), keyed by end node and
+            minimum width.
+   */
+  std::map<std::pair<unsigned int, float>, std::vector<float> > _pathLengths;
+
+  /*!
+   @brief    The distinct widths of the navigation mesh's edges in increasing order.
+   */
+  std::vector<float> _edgeWidths;
+
+  /*!
+   @brief    Lock for securing _pathLengths.
+   */
+  ReadersWriterLock _pathLengthLock;
+
   /*!
    @brief    The navigation mesh for planning on.
    */
@@ -246,6 +246,11 @@ class ResourcePtr {
    */
   Rsrc* operator->() const { return _data; }
 
+  /*!
+   @brief    Returns a pointer to the underlying data (NULL if there is none).
+   */
+  Rsrc* get() const { return _data; }
+
   /*!
    @brief    Reports if to Resource pointers (of the same type) refer to the same data.
 
@@ -74,6 +74,19 @@ Resource* ResourceManager::getResource(const std::string& fileName,
 
 /////////////////////////////////////////////////////////////////////
 
+bool ResourceManager::addResource(Resource* rsrc) {
+  const std::string key = rsrc->_fileName + CAT_SYMBOL + rsrc->getLabel();
+  if (_resources.find(key) != _resources.end()) {
+    logger << Logger::ERR_MSG << "Trying to add a resource that already exists: ";
+    logger << rsrc->_fileName << "\n";
+    return false;
+  }
+  _resources[key] = rsrc;
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
 void ResourceManager::cleanup() {
   ResourceMap::iterator itr = _resources.begin();
   while (itr != _resources.end()) {
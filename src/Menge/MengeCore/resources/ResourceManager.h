@@ -60,6 +60,19 @@ class MENGE_API ResourceManager {
   static Resource* getResource(const std::string& fileName, Resource* (*reader)(const std::string&),
                                const std::string& suffix);
 
+  /*!
+   @brief    Adds a resource that was created in memory (rather than read from a file) to the
+            manager.
+
+   The resource is registered under its name and label, exactly as if it had been read by
+   getResource(); from then on, it is managed (and released) like any other resource.
+
+   @param    rsrc    A pointer to the resource to add.
+   @returns  True if the resource was added, false if a resource with the same name and label is
+            already managed (in which case, the caller retains ownership of rsrc).
+   */
+  static bool addResource(Resource* rsrc);
+
   /*!
    @brief    Passes through the resources and removes all unreferenced resources.
    */
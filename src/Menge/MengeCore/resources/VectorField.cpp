@@ -38,9 +38,12 @@ Any questions or comments should be sent to the authors {menge,geom}@cs.unc.edu
 
 #include "MengeCore/resources/VectorField.h"
 
+#include "MengeCore/Runtime/MemoryMappedFile.h"
 #include "MengeCore/resources/ResourceManager.h"
 
 #include <cassert>
+#include <cmath>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 
@@ -48,6 +51,199 @@ namespace Menge {
 
 using Math::Vector2;
 
+namespace {
+/////////////////////////////////////////////////////////////////////
+//                   Binary format and cell access
+/////////////////////////////////////////////////////////////////////
+
+// The magic string at the start of every binary vector field file.
+const char BINARY_MAGIC[4] = {'M', 'V', 'F', 'B'};
+// The current version of the binary vector field format.
+const unsigned int BINARY_VERSION = 1;
+// The size of the binary header; the cell data starts at this offset.
+const size_t BINARY_HEADER_SIZE = 64;
+
+// The binary file header. See VectorField::writeBinary for the layout.
+struct BinaryHeader {
+  char magic[4];
+  unsigned int version;
+  unsigned int componentBits;
+  int rowCount;
+  int colCount;
+  float cellSize;
+  float minX;
+  float minY;
+  unsigned int reserved[8];
+};
+
+// Converts an IEEE 754 half-precision value to a single-precision float.
+inline float halfToFloat(unsigned short h) {
+  const unsigned int sign = (h & 0x8000u) << 16;
+  unsigned int exponent = (h >> 10) & 0x1F;
+  unsigned int mantissa = h & 0x3FF;
+  unsigned int bits;
+  if (exponent == 0) {
+    if (mantissa == 0) {
+      bits = sign;
+    } else {
+      // Subnormal; renormalize.
+      exponent = 127 - 15 + 1;
+      while ((mantissa & 0x400) == 0) {
+        mantissa <<= 1;
+        --exponent;
+      }
+      mantissa &= 0x3FF;
+      bits = sign | (exponent << 23) | (mantissa << 13);
+    }
+  } else if (exponent == 0x1F) {
+    bits = sign | 0x7F800000u | (mantissa << 13);
+  } else {
+    bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+  }
+  float f;
+  memcpy(&f, &bits, sizeof(float));
+  return f;
+}
+
+// Converts a single-precision float to an IEEE 754 half-precision value (round to nearest even).
+inline unsigned short floatToHalf(float f) {
+  unsigned int bits;
+  memcpy(&bits, &f, sizeof(float));
+  const unsigned short sign = static_cast<unsigned short>((bits >> 16) & 0x8000);
+  const unsigned int absBits = bits & 0x7FFFFFFF;
+  if (absBits >= 0x7F800000) {
+    // Inf or NaN.
+    return sign | 0x7C00 | (absBits > 0x7F800000 ? 0x200 : 0);
+  }
+  if (absBits >= 0x477FF000) {
+    // Overflows to infinity.
+    return sign | 0x7C00;
+  }
+  if (absBits < 0x38800000) {
+    // Subnormal half (or zero).
+    if (absBits < 0x33000000) return sign;
+    const unsigned int shift = 126 - (absBits >> 23);
+    const unsigned int mantissa = (absBits & 0x7FFFFF) | 0x800000;
+    unsigned int half = mantissa >> (shift + 1);
+    const unsigned int rem = mantissa & ((1u << (shift + 1)) - 1);
+    const unsigned int halfway = 1u << shift;
+    if (rem > halfway || (rem == halfway && (half & 1))) ++half;
+    return sign | static_cast<unsigned short>(half);
+  }
+  unsigned int half = ((absBits >> 13) - ((127 - 15) << 10));
+  const unsigned int rem = absBits & 0x1FFF;
+  if (rem > 0x1000 || (rem == 0x1000 && (half & 1))) ++half;
+  return sign | static_cast<unsigned short>(half);
+}
+
+// Reads the two components of the cell with the given linear index.
+inline void readCell(const float* data, int index, float& x, float& y) {
+  x = data[2 * index];
+  y = data[2 * index + 1];
+}
+
+inline void readCell(const unsigned short* data, int index, float& x, float& y) {
+  x = halfToFloat(data[2 * index]);
+  y = halfToFloat(data[2 * index + 1]);
+}
+
+// The geometric definition of the grid needed to sample it.
+struct GridSpec {
+  float minX;
+  float minY;
+  float invCellSize;
+  int rowCount;
+  int colCount;
+};
+
+// The grid of the given field.
+GridSpec gridOf(const VectorField& field) {
+  const Vector2 minPoint = field.getMinimumPoint();
+  GridSpec grid;
+  grid.minX = minPoint.x();
+  grid.minY = minPoint.y();
+  grid.invCellSize = 1.f / field.getCellSize();
+  grid.rowCount = field.getRowCount();
+  grid.colCount = field.getColCount();
+  return grid;
+}
+
+// Clamps the integer value to the range [0, limit - 1].
+inline int clampIndex(int i, int limit) { return i < 0 ? 0 : (i >= limit ? limit - 1 : i); }
+
+// Samples the value of the cell containing (px, py) -- positions off the grid are clamped to the
+// nearest cell.
+template <typename T>
+inline void sampleNearest(const T* data, const GridSpec& grid, float px, float py, float& vx,
+                          float& vy) {
+  // Clamp in floating point before the conversion so distant points can't overflow an int.
+  float u = (px - grid.minX) * grid.invCellSize;
+  float v = (py - grid.minY) * grid.invCellSize;
+  u = u < 0.f ? 0.f : (u > grid.colCount ? (float)grid.colCount : u);
+  v = v < 0.f ? 0.f : (v > grid.rowCount ? (float)grid.rowCount : v);
+  const int c = clampIndex((int)u, grid.colCount);
+  const int r = clampIndex((int)v, grid.rowCount);
+  readCell(data, r * grid.colCount + c, vx, vy);
+}
+
+// Bilinearly interpolates the cell values around (px, py). Beyond the outer ring of cell centers,
+// the field is held constant along the axis that has left the grid.
+template <typename T>
+inline void sampleBilinear(const T* data, const GridSpec& grid, float px, float py, float& vx,
+                           float& vy) {
+  // Continuous coordinates relative to the cell *centers*.
+  float u = (px - grid.minX) * grid.invCellSize - 0.5f;
+  float v = (py - grid.minY) * grid.invCellSize - 0.5f;
+  u = u < -1.f ? -1.f : (u > grid.colCount ? (float)grid.colCount : u);
+  v = v < -1.f ? -1.f : (v > grid.rowCount ? (float)grid.rowCount : v);
+  const float fu = std::floor(u);
+  const float fv = std::floor(v);
+  const float wx = u - fu;
+  const float wy = v - fv;
+  const int c = (int)fu;
+  const int r = (int)fv;
+  const int c0 = clampIndex(c, grid.colCount);
+  const int c1 = clampIndex(c + 1, grid.colCount);
+  const int r0 = clampIndex(r, grid.rowCount) * grid.colCount;
+  const int r1 = clampIndex(r + 1, grid.rowCount) * grid.colCount;
+
+  float x00, y00, x01, y01, x10, y10, x11, y11;
+  readCell(data, r0 + c0, x00, y00);
+  readCell(data, r0 + c1, x01, y01);
+  readCell(data, r1 + c0, x10, y10);
+  readCell(data, r1 + c1, x11, y11);
+  const float bx = x00 + (x01 - x00) * wx;
+  const float by = y00 + (y01 - y00) * wx;
+  const float tx = x10 + (x11 - x10) * wx;
+  const float ty = y10 + (y11 - y10) * wx;
+  vx = bx + (tx - bx) * wy;
+  vy = by + (ty - by) * wy;
+}
+
+// Samples a batch of positions.
+template <typename T>
+void sampleBatch(const T* data, const GridSpec& grid, const Vector2* positions, Vector2* values,
+                 int count, bool interpolate) {
+  // Small batches aren't worth the cost of spinning up the thread team.
+  const int PARALLEL_MIN = 4096;
+  if (interpolate) {
+#pragma omp parallel for if (count >= PARALLEL_MIN)
+    for (int i = 0; i < count; ++i) {
+      float x, y;
+      sampleBilinear(data, grid, positions[i].x(), positions[i].y(), x, y);
+      values[i].set(x, y);
+    }
+  } else {
+#pragma omp parallel for if (count >= PARALLEL_MIN)
+    for (int i = 0; i < count; ++i) {
+      float x, y;
+      sampleNearest(data, grid, positions[i].x(), positions[i].y(), x, y);
+      values[i].set(x, y);
+    }
+  }
+}
+}  // namespace
+
 /////////////////////////////////////////////////////////////////////
 //                   Implementation of VectorField
 /////////////////////////////////////////////////////////////////////
@@ -56,10 +252,30 @@ const std::string VectorField::LABEL("vecfield");
 
 /////////////////////////////////////////////////////////////////////
 
-VectorField::VectorField(const std::string& fileName) : Resource(fileName) {
+VectorField::VectorField(const std::string& fileName)
+    : Resource(fileName),
+      _data(0x0),
+      _halfPrecision(false),
+      _ownedData(0x0),
+      _mappedFile(0x0) {
   _resolution[0] = _resolution[1] = 0;
   _cellSize = 0.f;
-  _data = 0x0;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+VectorField::VectorField(const std::string& name, const Vector2& minPoint, int rowCount,
+                         int colCount, float cellSize)
+    : Resource(name),
+      _minPoint(minPoint),
+      _cellSize(cellSize),
+      _data(0x0),
+      _halfPrecision(false),
+      _ownedData(0x0),
+      _mappedFile(0x0) {
+  _resolution[0] = rowCount;
+  _resolution[1] = colCount;
+  initDataArray();
 }
 
 /////////////////////////////////////////////////////////////////////
@@ -83,29 +299,30 @@ void VectorField::setDimensions(float width, float height) {
 
 void VectorField::initDataArray() {
   freeDataArray();
-  const int ROW_COUNT = _resolution[0];
-  const int COL_COUNT = _resolution[1];
-  _data = new Vector2*[ROW_COUNT];
-  for (int r = 0; r < ROW_COUNT; ++r) {
-    _data[r] = new Vector2[COL_COUNT];
-  }
+  const size_t CELL_COUNT = static_cast<size_t>(_resolution[0]) * _resolution[1];
+  _ownedData = new float[2 * CELL_COUNT];
+  memset(_ownedData, 0, 2 * CELL_COUNT * sizeof(float));
+  _data = _ownedData;
+  _halfPrecision = false;
 }
 
 /////////////////////////////////////////////////////////////////////
 
 void VectorField::freeDataArray() {
-  if (_data) {
-    for (int r = 0; r < _resolution[0]; ++r) {
-      delete[] _data[r];
-    }
-    delete _data;
-    _data = 0x0;
+  if (_ownedData) {
+    delete[] _ownedData;
+    _ownedData = 0x0;
+  }
+  if (_mappedFile) {
+    delete _mappedFile;
+    _mappedFile = 0x0;
   }
+  _data = 0x0;
 }
 
 /////////////////////////////////////////////////////////////////////
 
-void VectorField::getCell(const Vector2& pos, int& r, int& c) {
+void VectorField::getCell(const Vector2& pos, int& r, int& c) const {
   assert(_data != 0x0 && "Requesting a field value without having field data");
   Vector2 offset = pos - _minPoint;
   offset /= _cellSize;
@@ -127,114 +344,209 @@ void VectorField::getCell(const Vector2& pos, int& r, int& c) {
 Vector2 VectorField::getFieldValue(int row, int col) const {
   assert(row >= 0 && row < _resolution[0] && "Invalid row index");
   assert(col >= 0 && col < _resolution[1] && "Invalid column index");
-  return _data[row][col];
+  float x, y;
+  if (_halfPrecision) {
+    readCell(static_cast<const unsigned short*>(_data), row * _resolution[1] + col, x, y);
+  } else {
+    readCell(static_cast<const float*>(_data), row * _resolution[1] + col, x, y);
+  }
+  return Vector2(x, y);
 }
 
 /////////////////////////////////////////////////////////////////////
 
-Vector2 VectorField::getFieldValue(const Vector2& pos) {
+Vector2 VectorField::getFieldValue(const Vector2& pos) const {
   assert(_data != 0x0 && "Requesting a field value without having field data");
-  int row, col;
-  getCell(pos, row, col);
+  // A single look-up is sampled directly; it is usually made from inside a parallel loop.
+  const GridSpec grid = gridOf(*this);
+  float x, y;
+  if (_halfPrecision) {
+    sampleNearest(static_cast<const unsigned short*>(_data), grid, pos.x(), pos.y(), x, y);
+  } else {
+    sampleNearest(static_cast<const float*>(_data), grid, pos.x(), pos.y(), x, y);
+  }
+  return Vector2(x, y);
+}
+
+/////////////////////////////////////////////////////////////////////
 
-  return _data[row][col];
+Vector2 VectorField::getFieldValueInterp(const Vector2& pos) const {
+  assert(_data != 0x0 && "Requesting a field value without having field data");
+  const GridSpec grid = gridOf(*this);
+  float x, y;
+  if (_halfPrecision) {
+    sampleBilinear(static_cast<const unsigned short*>(_data), grid, pos.x(), pos.y(), x, y);
+  } else {
+    sampleBilinear(static_cast<const float*>(_data), grid, pos.x(), pos.y(), x, y);
+  }
+  return Vector2(x, y);
 }
 
 /////////////////////////////////////////////////////////////////////
 
-Vector2 VectorField::getFieldValueInterp(const Vector2& pos) {
-  // NOTE: this doesn't use anything smart when it comes to performing
-  //  the bilinear interpolation.  The x and y components of the vector
-  //  are interpolated independently
+void VectorField::getFieldValues(const Vector2* positions, Vector2* values, size_t count,
+                                 bool interpolate) const {
   assert(_data != 0x0 && "Requesting a field value without having field data");
-  int rowIndex, colIndex;
-  getCell(pos, rowIndex, colIndex);
+  const GridSpec grid = gridOf(*this);
+  if (_halfPrecision) {
+    sampleBatch(static_cast<const unsigned short*>(_data), grid, positions, values, (int)count,
+                interpolate);
+  } else {
+    sampleBatch(static_cast<const float*>(_data), grid, positions, values, (int)count,
+                interpolate);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
 
-  // Compute center of target cell
-  Vector2 center = Vector2(colIndex + 0.5f, rowIndex + 0.5f) * _cellSize + _minPoint;
-  Vector2 weight = (pos - center) / _cellSize;
-  const float WX = weight.x();
-  const float WY = weight.y();
+void VectorField::setFieldValue(int row, int col, const Vector2& value) {
+  assert(_ownedData != 0x0 && "Only in-memory, full-precision fields can be modified");
+  assert(row >= 0 && row < _resolution[0] && "Invalid row index");
+  assert(col >= 0 && col < _resolution[1] && "Invalid column index");
+  const int index = row * _resolution[1] + col;
+  _ownedData[2 * index] = value.x();
+  _ownedData[2 * index + 1] = value.y();
+}
 
-  Vector2 value = _data[rowIndex][colIndex];
+/////////////////////////////////////////////////////////////////////
 
-  // if I'm in the center its simple
-  const int ROW_COUNT = _resolution[0];
+bool VectorField::writeBinary(const std::string& fileName, bool halfPrecision) const {
+  std::ofstream f(fileName.c_str(), std::ios::out | std::ios::binary);
+  if (!f.is_open()) {
+    logger << Logger::ERR_MSG << "Error opening the binary VectorField file for writing: ";
+    logger << fileName << "\n";
+    return false;
+  }
+  BinaryHeader header;
+  memset(&header, 0, sizeof(BinaryHeader));
+  memcpy(header.magic, BINARY_MAGIC, 4);
+  header.version = BINARY_VERSION;
+  header.componentBits = halfPrecision ? 16 : 32;
+  header.rowCount = _resolution[0];
+  header.colCount = _resolution[1];
+  header.cellSize = _cellSize;
+  header.minX = _minPoint.x();
+  header.minY = _minPoint.y();
+  f.write((const char*)&header, sizeof(BinaryHeader));
+
+  // Write a row at a time (rather than a value at a time).
   const int COL_COUNT = _resolution[1];
-  if (WX >= 0.f && colIndex < COL_COUNT - 1) {
-    // interpolate with cells to the right
-    value = _data[rowIndex][colIndex] * (1 - WX) + _data[rowIndex][colIndex + 1] * WX;
-    if (WY >= 0.f && rowIndex < ROW_COUNT - 1) {
-      Vector2 val2 =
-          _data[rowIndex + 1][colIndex] * (1 - WX) + _data[rowIndex + 1][colIndex + 1] * WX;
-      value *= (1 - WY);
-      value += val2 * WY;
-    } else if (WY < 0 && rowIndex > 0) {
-      Vector2 val2 =
-          _data[rowIndex - 1][colIndex] * (1 - WX) + _data[rowIndex - 1][colIndex + 1] * WX;
-      value *= (1 + WY);
-      value -= val2 * WY;
-    }
-  } else if (WX < 0.f && colIndex > 0) {
-    // interpolate with cells to the right
-    value = _data[rowIndex][colIndex] * (1 + WX) - _data[rowIndex][colIndex - 1] * WX;
-    if (WY >= 0.f && rowIndex < ROW_COUNT - 1) {
-      Vector2 val2 =
-          _data[rowIndex + 1][colIndex] * (1 + WX) - _data[rowIndex + 1][colIndex - 1] * WX;
-      value *= (1 - WY);
-      value += val2 * WY;
-    } else if (WY < 0 && rowIndex > 0) {
-      Vector2 val2 =
-          _data[rowIndex - 1][colIndex] * (1 + WX) - _data[rowIndex - 1][colIndex - 1] * WX;
-      value *= (1 + WY);
-      value -= val2 * WY;
+  float* floatRow = new float[2 * COL_COUNT];
+  unsigned short* halfRow = new unsigned short[2 * COL_COUNT];
+  for (int r = 0; r < _resolution[0]; ++r) {
+    for (int c = 0; c < COL_COUNT; ++c) {
+      Vector2 v = getFieldValue(r, c);
+      floatRow[2 * c] = v.x();
+      floatRow[2 * c + 1] = v.y();
     }
-  } else {
-    if (WY >= 0.f && rowIndex < ROW_COUNT - 1) {
-      value = _data[rowIndex][colIndex] * (1 - WY) + _data[rowIndex + 1][colIndex] * WY;
-    } else if (WY < 0 && rowIndex > 0) {
-      value = _data[rowIndex][colIndex] * (1 + WY) - _data[rowIndex - 1][colIndex] * WY;
+    if (halfPrecision) {
+      for (int i = 0; i < 2 * COL_COUNT; ++i) halfRow[i] = floatToHalf(floatRow[i]);
+      f.write((const char*)halfRow, 2 * COL_COUNT * sizeof(unsigned short));
+    } else {
+      f.write((const char*)floatRow, 2 * COL_COUNT * sizeof(float));
     }
   }
+  delete[] floatRow;
+  delete[] halfRow;
+  const bool valid = f.good();
+  f.close();
+  if (!valid) {
+    logger << Logger::ERR_MSG << "Error writing the binary VectorField file: " << fileName << "\n";
+  }
+  return valid;
+}
+
+/////////////////////////////////////////////////////////////////////
 
-  return value;
+bool VectorField::loadBinary(const std::string& fileName) {
+  MemoryMappedFile* file = new MemoryMappedFile();
+  if (!file->open(fileName) || file->size() < BINARY_HEADER_SIZE) {
+    delete file;
+    return false;
+  }
+  BinaryHeader header;
+  memcpy(&header, file->data(), sizeof(BinaryHeader));
+  if (memcmp(header.magic, BINARY_MAGIC, 4) != 0) {
+    delete file;
+    return false;
+  }
+  if (header.version != BINARY_VERSION) {
+    logger << Logger::ERR_MSG << "Unsupported binary VectorField version (" << header.version;
+    logger << ") in file: " << fileName << "\n";
+    delete file;
+    return false;
+  }
+  if (header.componentBits != 16 && header.componentBits != 32) {
+    logger << Logger::ERR_MSG << "Invalid component size (" << header.componentBits;
+    logger << " bits) in binary VectorField file: " << fileName << "\n";
+    delete file;
+    return false;
+  }
+  const size_t CELL_COUNT = static_cast<size_t>(header.rowCount) * header.colCount;
+  const size_t DATA_SIZE = CELL_COUNT * 2 * (header.componentBits / 8);
+  if (header.rowCount <= 0 || header.colCount <= 0 || header.cellSize <= 0.f ||
+      file->size() < BINARY_HEADER_SIZE + DATA_SIZE) {
+    logger << Logger::ERR_MSG << "Format error in the binary VectorField file: " << fileName;
+    logger << "\n\tThe header is invalid or the file is truncated.\n";
+    delete file;
+    return false;
+  }
+  freeDataArray();
+  _resolution[0] = header.rowCount;
+  _resolution[1] = header.colCount;
+  _cellSize = header.cellSize;
+  _minPoint.set(header.minX, header.minY);
+  _halfPrecision = header.componentBits == 16;
+  _mappedFile = file;
+  _data = file->data() + BINARY_HEADER_SIZE;
+  return true;
 }
 
 /////////////////////////////////////////////////////////////////////
 
-Resource* VectorField::load(const std::string& fileName) {
+bool VectorField::loadAscii(const std::string& fileName) {
   std::ifstream f;
   f.open(fileName.c_str(), std::ios::in);
   if (!f.is_open()) {
     logger << Logger::ERR_MSG << "Error opening the VectorField file definition: ";
     logger << fileName << "\n";
-    return 0x0;
+    return false;
   }
 
-  VectorField* field = new VectorField(fileName);
-  f >> field->_resolution[0] >> field->_resolution[1];
-  f >> field->_cellSize;
+  f >> _resolution[0] >> _resolution[1];
+  f >> _cellSize;
   float x, y;
   f >> x >> y;
-  field->_minPoint = Vector2(x, y);
-  field->initDataArray();
-  for (int r = 0; r < field->_resolution[0]; ++r) {
-    for (int c = 0; c < field->_resolution[1]; ++c) {
+  _minPoint = Vector2(x, y);
+  initDataArray();
+  float* cell = _ownedData;
+  for (int r = 0; r < _resolution[0]; ++r) {
+    for (int c = 0; c < _resolution[1]; ++c) {
       if (f >> x >> y) {
-        field->_data[r][c] = Vector2(x, y);
+        *cell++ = x;
+        *cell++ = y;
       } else {
         logger << Logger::ERR_MSG;
         logger << "Format error in the VectorField file definition: " << fileName;
         logger << "\n\tTried to read a vector at position: (" << r << ", " << c;
         logger << "), but no data existed\n";
-        field->destroy();
         f.close();
-        return 0x0;
+        return false;
       }
     }
   }
   f.close();
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
 
+Resource* VectorField::load(const std::string& fileName) {
+  VectorField* field = new VectorField(fileName);
+  if (!field->loadBinary(fileName) && !field->loadAscii(fileName)) {
+    field->destroy();
+    return 0x0;
+  }
   return field;
 }
 
@@ -257,6 +569,7 @@ Logger& operator<<(Logger& out, const VectorField& vf) {
   out << "\tMinimum point:  " << vf._minPoint << "\n";
   out << "\tCell size:      " << vf._cellSize << "\n";
   out << "\t(width,height): " << vf.getSize() << "\n";
+  out << "\tPrecision:      " << (vf._halfPrecision ? "half" : "full") << "\n";
   return out;
 }
 
@@ -276,4 +589,16 @@ VectorFieldPtr loadVectorField(const std::string& fileName) throw(ResourceExcept
   }
   return VectorFieldPtr(vf);
 }
+
+/////////////////////////////////////////////////////////////////////
+
+bool convertVectorField(const std::string& inFileName, const std::string& outFileName,
+                        bool halfPrecision) {
+  Resource* rsrc = VectorField::load(inFileName);
+  if (rsrc == 0x0) return false;
+  VectorField* vf = static_cast<VectorField*>(rsrc);
+  const bool valid = vf->writeBinary(outFileName, halfPrecision);
+  rsrc->destroy();
+  return valid;
+}
 }  // namespace Menge
@@ -32,11 +32,26 @@
 
 namespace Menge {
 
+// forward declaration
+class MemoryMappedFile;
+
 /*!
  @brief    A simple 2D vector field.
 
  The field is defined by the location of its bottom, left-hand corner, the size of the space the
  grid should cover and the size of each, square cell.
+
+ The cell values are stored in a single, contiguous, row-major buffer. A field can be read from two
+ file formats:
+
+   - The original ASCII format: `rowCount colCount cellSize minX minY` followed by
+     `rowCount * colCount` pairs of vector components.
+   - A binary format (see VectorField::writeBinary) consisting of a 64-byte header followed by the
+     raw cell data. Binary fields are memory mapped (rather than parsed), so even very large fields
+     are available immediately and pages are only read from disk as they are sampled. The cell
+     data can be stored at full (32-bit) or half (16-bit) precision.
+
+ The format is detected from the file contents; the file extension is irrelevant.
  */
 class MENGE_API VectorField : public Resource {
  public:
@@ -47,6 +62,20 @@ class MENGE_API VectorField : public Resource {
    */
   VectorField(const std::string& fileName);
 
+  /*!
+   @brief    Constructs an in-memory field with the given grid; all cell values are zero.
+
+   The cell values can subsequently be set with setFieldValue.
+
+   @param    name        The name of the field (used to identify the resource).
+   @param    minPoint    The minimum extent of the field.
+   @param    rowCount    The number of rows in the grid.
+   @param    colCount    The number of columns in the grid.
+   @param    cellSize    The size of each square cell.
+   */
+  VectorField(const std::string& name, const Math::Vector2& minPoint, int rowCount, int colCount,
+              float cellSize);
+
  protected:
   /*!
    @brief    Destructor.
@@ -68,7 +97,7 @@ class MENGE_API VectorField : public Resource {
    @param    c      A reference to the column index -- this is to be set by the function.
    */
   // TODO: Determine what happens if pos is off the grid
-  void getCell(const Math::Vector2& pos, int& r, int& c);
+  void getCell(const Math::Vector2& pos, int& r, int& c) const;
 
   /*!
    @brief    Returns the value of the field for the given CELL address
@@ -91,7 +120,7 @@ class MENGE_API VectorField : public Resource {
    @param    pos    The position to read the field's vector value.
    @returns  The vector value of the cell center closest to pos.
    */
-  Math::Vector2 getFieldValue(const Math::Vector2& pos);
+  Math::Vector2 getFieldValue(const Math::Vector2& pos) const;
 
   /*!
    @brief    Returns the value of the field for the given position.
@@ -103,7 +132,66 @@ class MENGE_API VectorField : public Resource {
    @param    pos    The position to read the field's vector value.
    @returns  The vector value of the cell center closest to pos.
    */
-  Math::Vector2 getFieldValueInterp(const Math::Vector2& pos);
+  Math::Vector2 getFieldValueInterp(const Math::Vector2& pos) const;
+
+  /*!
+   @brief    Samples the field at many positions in a single call.
+
+   Produces exactly the same values as calling getFieldValue(const Math::Vector2&) (or
+   getFieldValueInterp) for each position, but the look-ups are performed in a tight loop over the
+   contiguous cell buffer (parallelized with OpenMP for large batches).
+
+   @param    positions     An array of `count` query positions.
+   @param    values        An array of `count` vectors to be populated with the field values.
+   @param    count         The number of positions to sample.
+   @param    interpolate   If true, values are bilinearly interpolated, otherwise the nearest cell
+                          is used.
+   */
+  void getFieldValues(const Math::Vector2* positions, Math::Vector2* values, size_t count,
+                      bool interpolate) const;
+
+  /*!
+   @brief    Sets the value of the field for the given CELL address.
+
+   Only valid for fields whose data is held in memory at full precision (i.e., not memory-mapped
+   from a binary file). The row and column values are only validated in debug mode.
+
+   @param    row    The index of the row.
+   @param    col    The index of the column.
+   @param    value  The vector value to store in the cell.
+   */
+  void setFieldValue(int row, int col, const Math::Vector2& value);
+
+  /*!
+   @brief    Writes the field to the given file in the binary format.
+
+   The binary format is:
+
+   | Bytes   | Type        | Value                                                   |
+   | ------- | ----------- | ------------------------------------------------------- |
+   | 0-3     | char[4]     | The magic string `MVFB`                                 |
+   | 4-7     | uint32      | Format version (currently 1)                            |
+   | 8-11    | uint32      | Bits per vector component: 32 (float) or 16 (half)      |
+   | 12-15   | int32       | Row count                                               |
+   | 16-19   | int32       | Column count                                            |
+   | 20-23   | float       | Cell size                                               |
+   | 24-31   | float[2]    | Minimum point (x, y)                                    |
+   | 32-63   | -           | Reserved (zero)                                         |
+   | 64-...  | float/half  | Row-major cell data, (x, y) per cell                    |
+
+   All values are little endian.
+
+   @param    fileName        The path to the file to write.
+   @param    halfPrecision   If true, vector components are written as IEEE 754 half-precision
+                            values, otherwise as single-precision floats.
+   @returns  True if the file was successfully written.
+   */
+  bool writeBinary(const std::string& fileName, bool halfPrecision) const;
+
+  /*!
+   @brief    Reports if the cell data is stored at half precision.
+   */
+  bool isHalfPrecision() const { return _halfPrecision; }
 
   /*!
    @brief    Parses a vector field definition and returns a pointer to it.
@@ -191,9 +279,26 @@ class MENGE_API VectorField : public Resource {
   float _cellSize;
 
   /*!
-   @brief    The 2D array of vector data for each cell.
+   @brief    The contiguous, row-major cell data: two components per cell, each either a float or
+            a half (see _halfPrecision). It either points into _ownedData or into the memory-mapped
+            file.
+   */
+  const void* _data;
+
+  /*!
+   @brief    Reports if each component in _data is a 16-bit half (true) or a 32-bit float (false).
+   */
+  bool _halfPrecision;
+
+  /*!
+   @brief    The heap-allocated cell data (if the field is not memory mapped).
+   */
+  float* _ownedData;
+
+  /*!
+   @brief    The memory-mapped binary file backing _data (if any).
    */
-  Math::Vector2** _data;
+  MemoryMappedFile* _mappedFile;
 
   /*!
    @brief    Computes the appropriate resolution of the grid.
@@ -216,6 +321,22 @@ class MENGE_API VectorField : public Resource {
    @brief    frees the data array.
    */
   void freeDataArray();
+
+  /*!
+   @brief    Attempts to load the field from a file in the binary format.
+
+   @param    fileName    The path to the binary file.
+   @returns  True if the field was mapped, false if the file is not a valid binary field.
+   */
+  bool loadBinary(const std::string& fileName);
+
+  /*!
+   @brief    Attempts to load the field from a file in the ASCII format.
+
+   @param    fileName    The path to the ASCII file.
+   @returns  True if the field was read, false if the file is not a valid ASCII field.
+   */
+  bool loadAscii(const std::string& fileName);
 };
 
 /*!
@@ -231,6 +352,17 @@ typedef ResourcePtr<VectorField> VectorFieldPtr;
  @throws    A ResourceException if the data is unable to be instantiated.
  */
 VectorFieldPtr loadVectorField(const std::string& fileName) throw(ResourceException);
+
+/*!
+ @brief    Converts a vector field file (in either format) into the binary format.
+
+ @param    inFileName      The path to the vector field to convert.
+ @param    outFileName     The path to the binary file to write.
+ @param    halfPrecision   If true, the output stores half-precision vector components.
+ @returns  True if the conversion was successful.
+ */
+MENGE_API bool convertVectorField(const std::string& inFileName, const std::string& outFileName,
+                                  bool halfPrecision);
 }  // namespace Menge
 
 #endif  // __VECTOR_FIELD_H__
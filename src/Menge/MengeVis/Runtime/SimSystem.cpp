@@ -69,7 +69,12 @@ using SceneGraph::SystemStopException;
 ////////////////////////////////////////////////////////////////////////////
 
 SimSystem::SimSystem(SimulatorInterface* sim)
-    : SceneGraph::System(), _sim(sim), _lastUpdate(0.f), _isRunning(true) {}
+    : SceneGraph::System(),
+      _sim(sim),
+      _visAgents(0x0),
+      _visAgentCount(0),
+      _lastUpdate(0.f),
+      _isRunning(true) {}
 
 ////////////////////////////////////////////////////////////////////////////
 
@@ -81,7 +86,7 @@ SimSystem::~SimSystem() {
 
 bool SimSystem::updateScene(float time) {
   if (_sim->step()) {
-    updateAgentPosition(static_cast<int>(_sim->getNumAgents()));
+    updateAgentPosition(static_cast<int>(_visAgentCount));
     return true;
   }
   throw SystemStopException();
@@ -120,8 +125,9 @@ void SimSystem::addObstacleToScene(GLScene* scene) {
 ////////////////////////////////////////////////////////////////////////////
 
 void SimSystem::addAgentsToScene(GLScene* scene) {
-  _visAgents = new VisAgent*[_sim->getNumAgents()];
-  for (size_t a = 0; a < _sim->getNumAgents(); ++a) {
+  _visAgentCount = _sim->getNumAgents();
+  _visAgents = new VisAgent*[_visAgentCount];
+  for (size_t a = 0; a < _visAgentCount; ++a) {
     BaseAgent* agt = _sim->getAgent(a);
     VisAgent* baseNode = VisAgentDB::getInstance(agt);
     VisAgent* agtNode = baseNode->moveToClone();
@@ -154,7 +160,7 @@ void SimSystem::updateAgentPosition(int agtCount) {
 
 ////////////////////////////////////////////////////////////////////////////
 
-size_t SimSystem::getAgentCount() const { return _sim->getNumAgents(); }
+size_t SimSystem::getAgentCount() const { return _visAgentCount; }
 
 ////////////////////////////////////////////////////////////////////////////
 }  // namespace Runtime
@@ -148,6 +148,9 @@ class MENGEVIS_API SimSystem : public SceneGraph::System {
   /*!
    @brief   Reports the number of agents.
 
+   The visual agents are created when the scene is populated; agents spawned later by agent sources
+   are not drawn.
+
    @returns The number of VisAgents updated by the system.
    */
   size_t getAgentCount() const;
@@ -163,6 +166,11 @@ class MENGEVIS_API SimSystem : public SceneGraph::System {
    */
   VisAgent** _visAgents;
 
+  /*!
+   @brief   The number of visualization agents.
+   */
+  size_t _visAgentCount;
+
   /*!
    @brief   The global time of last system update.
    */
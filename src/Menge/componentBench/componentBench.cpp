@@ -0,0 +1,723 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+/*!
+ @file    componentBench.cpp
+ @brief   Measures the hot simulation components in isolation on synthetic data.
+
+ Each component is exercised with randomly generated inputs over a sweep of problem sizes: the
+ agent kd-tree (build and k-nearest queries over agent count, density and K), the obstacle kd-tree
+ (build and linkIsTraversible() over obstacle count), the navigation mesh localizer (incremental and
+ blind updates over mesh size), navigation mesh A* (PathPlanner::computeRoute()), roadmap A*
+ (Graph::getPath()), the funnel algorithm (FunnelPlanner::computeCrossing()) and the ORCA and PedVO
+ linear programs (over the number of constraints).
+
+ Every measurement reports the mean time per operation. For consecutive sizes of the same
+ measurement, the table also reports the empirical scaling exponent:
+ log(t1 / t0) / log(n1 / n0). A query which scales logarithmically has an exponent near zero and a
+ linear-time operation has an exponent near one; the size at which the exponent jumps is where the
+ algorithm stops scaling (typically when the data no longer fits in cache).
+
+ Navigation meshes and roadmaps are regular grids of one-meter cells written to temporary files in
+ the working directory (and removed afterwards).
+ */
+
+#include "MengeCore/Agents/ObstacleSets/ListObstacleSet.h"
+#include "MengeCore/Agents/ObstacleSets/ObstacleVertexList.h"
+#include "MengeCore/Agents/SpatialQueries/AgentKDTree.h"
+#include "MengeCore/Agents/SpatialQueries/ObstacleKDTree.h"
+#include "MengeCore/BFSM/Goals/GoalPoint.h"
+#include "MengeCore/Math/Line.h"
+#include "MengeCore/Orca/ORCAAgent.h"
+#include "MengeCore/PedVO/PedVOAgent.h"
+#include "MengeCore/Runtime/Logger.h"
+#include "MengeCore/Runtime/os.h"
+#include "MengeCore/resources/Funnel.h"
+#include "MengeCore/resources/Graph.h"
+#include "MengeCore/resources/NavMesh.h"
+#include "MengeCore/resources/NavMeshLocalizer.h"
+#include "MengeCore/resources/PathPlanner.h"
+#include "MengeCore/resources/PortalPath.h"
+#include "MengeCore/resources/RoadMapPath.h"
+#include "MengeCore/resources/Route.h"
+#include "thirdParty/tclap/CmdLine.h"
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace Menge;
+using Menge::Agents::AgentKDTree;
+using Menge::Agents::BaseAgent;
+using Menge::Agents::ObstacleKDTree;
+using Menge::Math::Line;
+using Menge::Math::Vector2;
+
+namespace {
+typedef std::chrono::steady_clock Clock;
+
+// The names of the components, in the order they are run.
+const char* COMPONENTS = "agent_kdtree,obstacle_kdtree,localizer,navmesh_astar,roadmap_astar,"
+                         "funnel,orca_lp,pedvo_lp";
+
+// The radius of the synthetic agents.
+const float AGENT_RADIUS = 0.19f;
+
+// The number of agents tracked by the localizer benchmark.
+const size_t LOCALIZER_AGENTS = 1000;
+
+// The number of pre-generated inputs which the timed loops cycle through.
+const size_t INPUT_COUNT = 1024;
+
+// A single measurement.
+struct Measurement {
+  std::string component;
+  std::string operation;
+  std::string sizeName;
+  double size;
+  std::string config;
+  // Additional information about the inputs (not used to match sizes).
+  std::string note;
+  double nsPerOp;
+  size_t ops;
+  // The scaling exponent relative to the previous size (NaN for the first size).
+  double exponent;
+};
+
+// The parameters of the sweeps.
+struct Settings {
+  std::vector<int> agents;
+  std::vector<double> densities;
+  std::vector<int> neighbors;
+  std::vector<int> obstacles;
+  std::vector<int> grids;
+  double minSeconds;
+};
+
+std::vector<std::string> splitList(const std::string& list) {
+  std::vector<std::string> items;
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    if (item != "") items.push_back(item);
+  }
+  return items;
+}
+
+template <typename T>
+std::vector<T> splitValues(const std::string& list) {
+  std::vector<T> values;
+  std::vector<std::string> items = splitList(list);
+  for (size_t i = 0; i < items.size(); ++i) {
+    std::stringstream stream(items[i]);
+    T value;
+    if (stream >> value && value > 0) values.push_back(value);
+  }
+  return values;
+}
+
+// Calls op (which performs `batch` operations) until minSeconds have elapsed; returns the mean
+// time per operation in nanoseconds.
+template <typename Op>
+double timeOps(Op op, size_t batch, double minSeconds, size_t& opCount) {
+  opCount = 0;
+  const Clock::time_point start = Clock::now();
+  double elapsed = 0.0;
+  do {
+    op();
+    opCount += batch;
+    elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+  } while (elapsed < minSeconds);
+  return elapsed * 1e9 / opCount;
+}
+
+// Records and prints a measurement; the scaling exponent is computed against the previous
+// measurement of the same operation and configuration.
+void record(std::vector<Measurement>& results, const std::string& component,
+            const std::string& operation, const std::string& sizeName, double size,
+            const std::string& config, double nsPerOp, size_t ops, const std::string& note = "") {
+  Measurement m = {component, operation, sizeName, size, config, note, nsPerOp, ops, std::nan("")};
+  for (size_t i = results.size(); i > 0; --i) {
+    const Measurement& prev = results[i - 1];
+    if (prev.component == component && prev.operation == operation && prev.config == config) {
+      if (prev.size > 0.0 && size > prev.size && prev.nsPerOp > 0.0) {
+        m.exponent = std::log(nsPerOp / prev.nsPerOp) / std::log(size / prev.size);
+      }
+      break;
+    }
+  }
+  results.push_back(m);
+  std::ostringstream sizeText;
+  sizeText << sizeName << "=" << size;
+  std::cout << std::left << std::setw(16) << component << std::setw(8) << operation
+            << std::setw(16) << sizeText.str() << std::setw(22) << config << std::right
+            << std::fixed << std::setprecision(1) << std::setw(14) << nsPerOp << " ns/op";
+  if (!std::isnan(m.exponent)) {
+    std::cout << std::setprecision(2) << std::setw(10) << m.exponent;
+  } else if (note != "") {
+    std::cout << std::setw(10) << "";
+  }
+  if (note != "") std::cout << "  " << note;
+  std::cout << "\n" << std::flush;
+}
+
+bool writeResults(const std::string& fileName, const std::vector<Measurement>& results) {
+  std::ofstream out(fileName.c_str());
+  if (!out.is_open()) return false;
+  out << "component,operation,size_name,size,config,note,ns_per_op,operations,exponent\n";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Measurement& m = results[i];
+    out << m.component << "," << m.operation << "," << m.sizeName << "," << m.size << ","
+        << m.config << "," << m.note << "," << m.nsPerOp << "," << m.ops << ",";
+    if (!std::isnan(m.exponent)) out << m.exponent;
+    out << "\n";
+  }
+  return out.good();
+}
+
+// Places the agents uniformly in a square whose size gives the requested density.
+void scatterAgents(std::vector<ORCA::Agent>& agents, double density, std::mt19937& rng) {
+  const float side = static_cast<float>(std::sqrt(agents.size() / density));
+  std::uniform_real_distribution<float> coord(0.f, side);
+  for (size_t i = 0; i < agents.size(); ++i) {
+    agents[i]._id = i;
+    agents[i]._radius = AGENT_RADIUS;
+    agents[i]._pos.set(coord(rng), coord(rng));
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+//          Synthetic navigation meshes and roadmaps
+/////////////////////////////////////////////////////////////////////
+
+// Writes a navigation mesh of size x size square, one-meter cells. Returns the file name.
+std::string writeGridMesh(int size) {
+  std::ostringstream name;
+  name << "componentBench_grid" << size << ".nav";
+  std::ofstream out(name.str().c_str());
+  const int V = size + 1;
+  out << V * V << "\n";
+  for (int j = 0; j < V; ++j) {
+    for (int i = 0; i < V; ++i) out << i << " " << j << "\n";
+  }
+  // An edge's first node lies on the right of the edge's direction (from its first vertex).
+  std::vector<std::vector<int> > nodeEdges(size * size);
+  std::ostringstream edges;
+  int edgeCount = 0;
+  for (int j = 0; j < size; ++j) {
+    for (int i = 1; i < size; ++i) {
+      // Vertical edge between cells (i - 1, j) and (i, j).
+      const int right = j * size + i;
+      const int left = right - 1;
+      edges << (j * V + i) << " " << ((j + 1) * V + i) << " " << right << " " << left << "\n";
+      nodeEdges[right].push_back(edgeCount);
+      nodeEdges[left].push_back(edgeCount++);
+    }
+  }
+  for (int j = 1; j < size; ++j) {
+    for (int i = 0; i < size; ++i) {
+      // Horizontal edge between cells (i, j - 1) and (i, j).
+      const int above = j * size + i;
+      const int below = above - size;
+      edges << (j * V + i) << " " << (j * V + i + 1) << " " << below << " " << above << "\n";
+      nodeEdges[below].push_back(edgeCount);
+      nodeEdges[above].push_back(edgeCount++);
+    }
+  }
+  out << edgeCount << "\n" << edges.str() << "0\ngrid\n" << size * size << "\n";
+  for (int j = 0; j < size; ++j) {
+    for (int i = 0; i < size; ++i) {
+      const std::vector<int>& nodeEdge = nodeEdges[j * size + i];
+      out << (i + 0.5f) << " " << (j + 0.5f) << "\n";
+      out << "4 " << (j * V + i) << " " << (j * V + i + 1) << " " << ((j + 1) * V + i + 1) << " "
+          << ((j + 1) * V + i) << "\n0 0 0\n";
+      out << nodeEdge.size();
+      for (size_t e = 0; e < nodeEdge.size(); ++e) out << " " << nodeEdge[e];
+      out << "\n0\n";
+    }
+  }
+  return name.str();
+}
+
+// Writes a roadmap of size x size vertices on a one-meter lattice, connected to their four
+// neighbors. Returns the file name.
+std::string writeGridRoadmap(int size) {
+  std::ostringstream name;
+  name << "componentBench_grid" << size << ".txt";
+  std::ofstream out(name.str().c_str());
+  out << size * size << "\n";
+  for (int j = 0; j < size; ++j) {
+    for (int i = 0; i < size; ++i) {
+      const int degree = (i > 0) + (i < size - 1) + (j > 0) + (j < size - 1);
+      out << degree << " " << i << " " << j << "\n";
+    }
+  }
+  out << 2 * size * (size - 1) << "\n";
+  for (int j = 0; j < size; ++j) {
+    for (int i = 0; i < size; ++i) {
+      const int v = j * size + i;
+      if (i < size - 1) out << v << " " << v + 1 << "\n";
+      if (j < size - 1) out << v << " " << v + size << "\n";
+    }
+  }
+  return name.str();
+}
+
+// Exposes the route computation itself; PathPlanner::getRoute() would answer from its cache.
+class BenchPlanner : public PathPlanner {
+ public:
+  explicit BenchPlanner(NavMeshPtr mesh) : PathPlanner(mesh) {}
+  using PathPlanner::computeRoute;
+};
+
+/////////////////////////////////////////////////////////////////////
+//          The components
+/////////////////////////////////////////////////////////////////////
+
+void benchAgentTree(const Settings& settings, std::vector<Measurement>& results) {
+  std::mt19937 rng(1);
+  for (size_t d = 0; d < settings.densities.size(); ++d) {
+    const double density = settings.densities[d];
+    std::ostringstream densityText;
+    densityText << "density=" << density;
+    for (size_t a = 0; a < settings.agents.size(); ++a) {
+      std::vector<ORCA::Agent> agents(settings.agents[a]);
+      scatterAgents(agents, density, rng);
+      std::vector<BaseAgent*> pointers(agents.size());
+      for (size_t i = 0; i < agents.size(); ++i) pointers[i] = &agents[i];
+
+      AgentKDTree tree;
+      size_t ops;
+      double ns = timeOps([&]() { tree.setAgents(pointers); }, 1, settings.minSeconds, ops);
+      record(results, "agent_kdtree", "build", "agents", agents.size(), densityText.str(), ns,
+             ops);
+
+      for (size_t k = 0; k < settings.neighbors.size(); ++k) {
+        // The agents query for their own neighbors, as they do in the simulation.
+        std::uniform_int_distribution<size_t> pick(0, agents.size() - 1);
+        std::vector<BaseAgent*> queries(INPUT_COUNT);
+        for (size_t i = 0; i < INPUT_COUNT; ++i) queries[i] = pointers[pick(rng)];
+        for (size_t i = 0; i < agents.size(); ++i) {
+          agents[i]._maxNeighbors = settings.neighbors[k];
+          // The default neighbor distance of the ORCA-style models.
+          agents[i]._neighborDist = 5.f;
+        }
+        ns = timeOps(
+            [&]() {
+              for (size_t i = 0; i < INPUT_COUNT; ++i) {
+                queries[i]->startQuery();
+                tree.agentQuery(queries[i]);
+              }
+            },
+            INPUT_COUNT, settings.minSeconds, ops);
+        std::ostringstream config;
+        config << densityText.str() << " k=" << settings.neighbors[k];
+        record(results, "agent_kdtree", "query", "agents", agents.size(), config.str(), ns, ops);
+      }
+    }
+  }
+}
+
+void benchObstacleTree(const Settings& settings, std::vector<Measurement>& results) {
+  std::mt19937 rng(2);
+  for (size_t o = 0; o < settings.obstacles.size(); ++o) {
+    // One-meter boxes, one per 16 square meters.
+    const int boxCount = settings.obstacles[o];
+    const float side = 4.f * std::sqrt(static_cast<float>(boxCount));
+    std::uniform_real_distribution<float> coord(0.f, side);
+    Agents::ListObstacleSet* obstacleSet = new Agents::ListObstacleSet();
+    for (int b = 0; b < boxCount; ++b) {
+      const Vector2 corner(coord(rng), coord(rng));
+      Agents::ObstacleVertexList box;
+      box.closed = true;
+      box.vertices.push_back(corner);
+      box.vertices.push_back(corner + Vector2(1.f, 0.f));
+      box.vertices.push_back(corner + Vector2(1.f, 1.f));
+      box.vertices.push_back(corner + Vector2(0.f, 1.f));
+      obstacleSet->addObstacle(box);
+    }
+    std::vector<Agents::Obstacle*> obstacles(obstacleSet->obstacleCount());
+    for (size_t i = 0; i < obstacles.size(); ++i) obstacles[i] = obstacleSet->getObstacle(i);
+
+    ObstacleKDTree tree;
+    size_t ops;
+    double ns = timeOps([&]() { tree.buildTree(obstacles); }, 1, settings.minSeconds, ops);
+    record(results, "obstacle_kdtree", "build", "segments", obstacles.size(), "", ns, ops);
+
+    // Links up to five meters long.
+    std::uniform_real_distribution<float> offset(-5.f, 5.f);
+    std::vector<Vector2> ends(2 * INPUT_COUNT);
+    for (size_t i = 0; i < INPUT_COUNT; ++i) {
+      ends[2 * i].set(coord(rng), coord(rng));
+      ends[2 * i + 1] = ends[2 * i] + Vector2(offset(rng), offset(rng));
+    }
+    size_t clear = 0;
+    ns = timeOps(
+        [&]() {
+          for (size_t i = 0; i < INPUT_COUNT; ++i) {
+            clear += tree.linkIsTraversible(ends[2 * i], ends[2 * i + 1], AGENT_RADIUS);
+          }
+        },
+        INPUT_COUNT, settings.minSeconds, ops);
+    std::ostringstream note;
+    note << std::setprecision(2) << (100.0 * clear / ops) << "% clear";
+    record(results, "obstacle_kdtree", "link", "segments", obstacles.size(), "", ns, ops,
+           note.str());
+    obstacleSet->destroy();
+  }
+}
+
+void benchLocalizer(const Settings& settings, std::vector<Measurement>& results) {
+  std::mt19937 rng(3);
+  for (size_t g = 0; g < settings.grids.size(); ++g) {
+    const int size = settings.grids[g];
+    const std::string fileName = writeGridMesh(size);
+    NavMeshLocalizerPtr localizer = loadNavMeshLocalizer(fileName, false);
+    os::remove(fileName);
+
+    // Positions are kept off the cell boundaries.
+    std::uniform_real_distribution<float> coord(0.01f, size - 0.01f);
+    std::vector<ORCA::Agent> agents(LOCALIZER_AGENTS);
+    for (size_t i = 0; i < agents.size(); ++i) {
+      agents[i]._id = i;
+      agents[i]._pos.set(coord(rng), coord(rng));
+      localizer->updateLocation(&agents[i], true);
+    }
+    const double nodes = static_cast<double>(size) * size;
+
+    // Small steps: the agent usually remains in its cell or moves into a neighbor.
+    std::uniform_real_distribution<float> step(-0.3f, 0.3f);
+    std::vector<Vector2> steps(INPUT_COUNT);
+    for (size_t i = 0; i < INPUT_COUNT; ++i) steps[i].set(step(rng), step(rng));
+    const float lo = 0.01f;
+    const float hi = size - 0.01f;
+    size_t next = 0;
+    size_t ops;
+    double ns = timeOps(
+        [&]() {
+          for (size_t i = 0; i < INPUT_COUNT; ++i) {
+            ORCA::Agent& agent = agents[next];
+            next = (next + 1) % agents.size();
+            Vector2 p = agent._pos + steps[i];
+            p.set(std::min(hi, std::max(lo, p.x())), std::min(hi, std::max(lo, p.y())));
+            agent._pos = p;
+            localizer->updateLocation(&agent, true);
+          }
+        },
+        INPUT_COUNT, settings.minSeconds, ops);
+    record(results, "localizer", "walk", "nodes", nodes, "", ns, ops);
+
+    // Arbitrary jumps: the agent must be found with a search of the whole mesh.
+    std::vector<Vector2> jumps(INPUT_COUNT);
+    for (size_t i = 0; i < INPUT_COUNT; ++i) jumps[i].set(coord(rng), coord(rng));
+    ns = timeOps(
+        [&]() {
+          for (size_t i = 0; i < INPUT_COUNT; ++i) {
+            ORCA::Agent& agent = agents[next];
+            next = (next + 1) % agents.size();
+            agent._pos = jumps[i];
+            localizer->updateLocation(&agent, true);
+          }
+        },
+        INPUT_COUNT, settings.minSeconds, ops);
+    record(results, "localizer", "jump", "nodes", nodes, "", ns, ops);
+  }
+}
+
+void benchNavMeshPlanner(const Settings& settings, std::vector<Measurement>& results) {
+  std::mt19937 rng(4);
+  for (size_t g = 0; g < settings.grids.size(); ++g) {
+    const int size = settings.grids[g];
+    const std::string fileName = writeGridMesh(size);
+    NavMeshPtr mesh = loadNavMesh(fileName);
+    os::remove(fileName);
+    BenchPlanner planner(mesh);
+    const unsigned int nodes = static_cast<unsigned int>(mesh->getNodeCount());
+    std::uniform_int_distribution<unsigned int> pick(0, nodes - 1);
+    std::vector<unsigned int> pairs(2 * INPUT_COUNT);
+    for (size_t i = 0; i < pairs.size(); ++i) pairs[i] = pick(rng);
+    size_t next = 0;
+    size_t ops;
+    const double ns = timeOps(
+        [&]() {
+          planner.computeRoute(pairs[2 * next], pairs[2 * next + 1], 2.f * AGENT_RADIUS);
+          next = (next + 1) % INPUT_COUNT;
+        },
+        1, settings.minSeconds, ops);
+    record(results, "navmesh_astar", "route", "nodes", nodes, "", ns, ops);
+  }
+}
+
+void benchRoadmap(const Settings& settings, std::vector<Measurement>& results) {
+  std::mt19937 rng(5);
+  for (size_t g = 0; g < settings.grids.size(); ++g) {
+    const int size = settings.grids[g];
+    const std::string fileName = writeGridRoadmap(size);
+    GraphPtr graph = loadGraph(fileName);
+    os::remove(fileName);
+    const size_t vertices = graph->getVertexCount();
+    std::uniform_int_distribution<size_t> pick(0, vertices - 1);
+    std::vector<size_t> pairs(2 * INPUT_COUNT);
+    for (size_t i = 0; i < pairs.size(); ++i) pairs[i] = pick(rng);
+    size_t next = 0;
+    size_t ops;
+    const double ns = timeOps(
+        [&]() {
+          delete graph->getPath(pairs[2 * next], pairs[2 * next + 1]);
+          next = (next + 1) % INPUT_COUNT;
+        },
+        1, settings.minSeconds, ops);
+    record(results, "roadmap_astar", "path", "vertices", static_cast<double>(vertices), "", ns,
+           ops);
+  }
+}
+
+void benchFunnel(const Settings& settings, std::vector<Measurement>& results) {
+  std::mt19937 rng(6);
+  const size_t PATH_COUNT = 64;
+  for (size_t g = 0; g < settings.grids.size(); ++g) {
+    const int size = settings.grids[g];
+    const std::string fileName = writeGridMesh(size);
+    NavMeshPtr mesh = loadNavMesh(fileName);
+    os::remove(fileName);
+    BenchPlanner planner(mesh);
+    const unsigned int nodes = static_cast<unsigned int>(mesh->getNodeCount());
+    std::uniform_int_distribution<unsigned int> pick(0, nodes - 1);
+
+    // Routes between random cells; the planner owns the routes.
+    std::vector<BFSM::PointGoal*> goals;
+    std::vector<PortalPath*> paths;
+    std::vector<Vector2> starts;
+    double portals = 0.0;
+    while (paths.size() < PATH_COUNT) {
+      const unsigned int start = pick(rng);
+      const unsigned int end = pick(rng);
+      PortalRoute* route = planner.computeRoute(start, end, 2.f * AGENT_RADIUS);
+      if (route->getPortalCount() == 0) continue;
+      goals.push_back(new BFSM::PointGoal(mesh->getNode(end).getCenter()));
+      starts.push_back(mesh->getNode(start).getCenter());
+      paths.push_back(new PortalPath(starts.back(), goals.back(), route, AGENT_RADIUS));
+      portals += route->getPortalCount();
+    }
+    size_t next = 0;
+    size_t ops;
+    const double ns = timeOps(
+        [&]() {
+          // A planner is only used once (as in PortalPath::computeCrossing()).
+          FunnelPlanner funnel;
+          funnel.computeCrossing(AGENT_RADIUS, starts[next], paths[next]);
+          next = (next + 1) % PATH_COUNT;
+        },
+        1, settings.minSeconds, ops);
+    std::ostringstream note;
+    note << std::setprecision(3) << portals / PATH_COUNT << " portals per path";
+    record(results, "funnel", "cross", "nodes", nodes, "", ns, ops, note.str());
+    for (size_t i = 0; i < paths.size(); ++i) {
+      delete paths[i];
+      goals[i]->destroy();
+    }
+  }
+}
+
+// Creates sets of constraints whose boundaries lie at a random distance (in [minOffset, 1.5]) from
+// the origin. The origin satisfies every constraint with a positive offset.
+std::vector<std::vector<Line> > makeConstraints(size_t lineCount, float minOffset,
+                                                std::mt19937& rng) {
+  std::uniform_real_distribution<float> angle(0.f, 6.2831853f);
+  std::uniform_real_distribution<float> offset(minOffset, 1.5f);
+  std::vector<std::vector<Line> > sets(INPUT_COUNT, std::vector<Line>(lineCount));
+  for (size_t s = 0; s < sets.size(); ++s) {
+    for (size_t i = 0; i < lineCount; ++i) {
+      const float theta = angle(rng);
+      const Vector2 normal(std::cos(theta), std::sin(theta));
+      sets[s][i]._point = offset(rng) * normal;
+      sets[s][i]._direction.set(-normal.y(), normal.x());
+    }
+  }
+  return sets;
+}
+
+// Times the linear programs of one pedestrian model. Lp2 and Lp3 are callables with the signatures
+// of the model's linearProgram2() and linearProgram3() (less any model-specific parameters).
+template <typename Lp2, typename Lp3>
+void benchLinearPrograms(const std::string& component, Lp2 lp2, Lp3 lp3, const Settings& settings,
+                         std::vector<Measurement>& results) {
+  std::mt19937 rng(7);
+  const float maxSpeed = 1.5f;
+  std::uniform_real_distribution<float> angle(0.f, 6.2831853f);
+  std::vector<Vector2> preferred(INPUT_COUNT);
+  for (size_t i = 0; i < INPUT_COUNT; ++i) {
+    const float theta = angle(rng);
+    preferred[i].set(maxSpeed * std::cos(theta), maxSpeed * std::sin(theta));
+  }
+  for (size_t k = 0; k < settings.neighbors.size(); ++k) {
+    const size_t lineCount = static_cast<size_t>(settings.neighbors[k]);
+    // Feasible sets are solved by the 2D program alone.
+    const std::vector<std::vector<Line> > feasible = makeConstraints(lineCount, 0.05f, rng);
+    Vector2 result;
+    size_t ops;
+    double ns = timeOps(
+        [&]() {
+          for (size_t i = 0; i < INPUT_COUNT; ++i) {
+            lp2(feasible[i], maxSpeed, preferred[i], result);
+          }
+        },
+        INPUT_COUNT, settings.minSeconds, ops);
+    record(results, component, "lp2", "lines", static_cast<double>(lineCount), "", ns, ops);
+
+    // Infeasible sets fall back to the 3D program from the line on which the 2D program failed.
+    std::vector<std::vector<Line> > infeasible;
+    std::vector<size_t> failures;
+    for (int attempt = 0; attempt < 16 && infeasible.size() < INPUT_COUNT; ++attempt) {
+      const std::vector<std::vector<Line> > sets = makeConstraints(lineCount, -0.5f, rng);
+      for (size_t i = 0; i < sets.size() && infeasible.size() < INPUT_COUNT; ++i) {
+        const size_t fail = lp2(sets[i], maxSpeed, preferred[i], result);
+        if (fail < lineCount) {
+          infeasible.push_back(sets[i]);
+          failures.push_back(fail);
+        }
+      }
+    }
+    if (infeasible.empty()) continue;
+    ns = timeOps(
+        [&]() {
+          for (size_t i = 0; i < infeasible.size(); ++i) {
+            lp3(infeasible[i], failures[i], maxSpeed, result);
+          }
+        },
+        infeasible.size(), settings.minSeconds, ops);
+    record(results, component, "lp3", "lines", static_cast<double>(lineCount), "", ns, ops);
+  }
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  std::string componentList = COMPONENTS;
+  std::string agentList = "1000,10000,100000";
+  std::string densityList = "0.5,2";
+  std::string neighborList = "5,10,20,40";
+  std::string obstacleList = "100,300,1000";
+  std::string gridList = "10,30,100,300";
+  double minSeconds = 0.2;
+  std::string outFile = "";
+  try {
+    TCLAP::CmdLine cmd("Measures the simulation components in isolation. ", ' ', "0.1");
+    TCLAP::ValueArg<std::string> componentArg(
+        "c", "components", std::string("Comma-separated components to measure: ") + COMPONENTS,
+        false, componentList, "string", cmd);
+    TCLAP::ValueArg<std::string> agentArg("a", "agents", "Comma-separated agent counts.", false,
+                                          agentList, "string", cmd);
+    TCLAP::ValueArg<std::string> densityArg(
+        "d", "densities", "Comma-separated agent densities (agents per square meter).", false,
+        densityList, "string", cmd);
+    TCLAP::ValueArg<std::string> neighborArg(
+        "k", "neighbors",
+        "Comma-separated neighbor counts (K for the kd-tree, constraints for the linear programs).",
+        false, neighborList, "string", cmd);
+    TCLAP::ValueArg<std::string> obstacleArg("b", "obstacles",
+                                             "Comma-separated counts of box obstacles.", false,
+                                             obstacleList, "string", cmd);
+    TCLAP::ValueArg<std::string> gridArg(
+        "g", "grids", "Comma-separated side lengths of the grid meshes and roadmaps.", false,
+        gridList, "string", cmd);
+    TCLAP::ValueArg<double> timeArg("", "minTime", "The minimum duration of each measurement (s).",
+                                    false, minSeconds, "float", cmd);
+    TCLAP::ValueArg<std::string> outArg("o", "out", "A CSV file the measurements are written to.",
+                                        false, outFile, "string", cmd);
+    cmd.parse(argc, argv);
+    componentList = componentArg.getValue();
+    agentList = agentArg.getValue();
+    densityList = densityArg.getValue();
+    neighborList = neighborArg.getValue();
+    obstacleList = obstacleArg.getValue();
+    gridList = gridArg.getValue();
+    minSeconds = timeArg.getValue();
+    outFile = outArg.getValue();
+  } catch (TCLAP::ArgException& e) {
+    std::cerr << "Error parsing command-line arguments: " << e.error() << " for arg " << e.argId()
+              << "\n";
+    return 1;
+  }
+
+  Settings settings;
+  settings.agents = splitValues<int>(agentList);
+  settings.densities = splitValues<double>(densityList);
+  settings.neighbors = splitValues<int>(neighborList);
+  settings.obstacles = splitValues<int>(obstacleList);
+  settings.grids = splitValues<int>(gridList);
+  settings.minSeconds = minSeconds;
+
+  logger.setFile("componentBench_log.html");
+  std::vector<Measurement> results;
+  const std::vector<std::string> components = splitList(componentList);
+  for (size_t c = 0; c < components.size(); ++c) {
+    const std::string& name = components[c];
+    if (name == "agent_kdtree") {
+      benchAgentTree(settings, results);
+    } else if (name == "obstacle_kdtree") {
+      benchObstacleTree(settings, results);
+    } else if (name == "localizer") {
+      benchLocalizer(settings, results);
+    } else if (name == "navmesh_astar") {
+      benchNavMeshPlanner(settings, results);
+    } else if (name == "roadmap_astar") {
+      benchRoadmap(settings, results);
+    } else if (name == "funnel") {
+      benchFunnel(settings, results);
+    } else if (name == "orca_lp") {
+      benchLinearPrograms(
+          "orca_lp",
+          [](const std::vector<Line>& lines, float speed, const Vector2& pref, Vector2& result) {
+            return ORCA::linearProgram2(lines, speed, pref, false, result);
+          },
+          [](const std::vector<Line>& lines, size_t fail, float speed, Vector2& result) {
+            ORCA::linearProgram3(lines, 0, fail, speed, result);
+          },
+          settings, results);
+    } else if (name == "pedvo_lp") {
+      const float turnBias = 1.f;
+      benchLinearPrograms(
+          "pedvo_lp",
+          [=](const std::vector<Line>& lines, float speed, const Vector2& pref, Vector2& result) {
+            return PedVO::linearProgram2(lines, speed, pref, false, turnBias, result);
+          },
+          [=](const std::vector<Line>& lines, size_t fail, float speed, Vector2& result) {
+            PedVO::linearProgram3(lines, 0, fail, speed, turnBias, result);
+          },
+          settings, results);
+    } else {
+      std::cerr << "Unknown component: " << name << "\n";
+      return 1;
+    }
+  }
+
+  if (outFile != "") {
+    if (!writeResults(outFile, results)) {
+      std::cerr << "Unable to write the measurements: " << outFile << "\n";
+      return 1;
+    }
+    std::cout << "Measurements written to " << outFile << "\n";
+  }
+  return 0;
+}
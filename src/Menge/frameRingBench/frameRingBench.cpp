@@ -0,0 +1,222 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+/*!
+ @file    frameRingBench.cpp
+ @brief   Measures the latency with which other processes see frames published to a FrameRing.
+
+ A synthetic simulator publishes frames at a fixed rate; a number of reader processes poll the ring
+ and record, for each frame they read, the time between its publication and the moment the reader
+ held a validated copy of it. Each reader reports the latency percentiles and how many frames it
+ missed (overwritten before it could read them) or found torn.
+ */
+
+#include "MengeCore/Agents/FrameRing.h"
+#include "MengeCore/Orca/ORCAInitializer.h"
+#include "MengeCore/Orca/ORCASimulator.h"
+#include "MengeCore/Runtime/Logger.h"
+#include "thirdParty/tclap/CmdLine.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif  // _WIN32
+
+using namespace Menge;
+using Menge::Agents::FrameRingAgent;
+using Menge::Agents::FrameRingReader;
+using Menge::Agents::FrameView;
+
+namespace {
+unsigned long long nowNanoseconds() {
+  return static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                             std::chrono::steady_clock::now().time_since_epoch())
+                                             .count());
+}
+
+// Reads frames until the final frame is seen (or the writer stops publishing); prints a summary.
+int runReader(const std::string& name, int readerID, unsigned long long frameCount) {
+  FrameRingReader reader;
+  const std::chrono::steady_clock::time_point deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (!reader.open(name)) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      std::cerr << "Reader " << readerID << ": unable to open \"" << name << "\"\n";
+      return 1;
+    }
+    std::this_thread::yield();
+  }
+
+  std::vector<double> latencies;
+  latencies.reserve(static_cast<size_t>(frameCount));
+  std::vector<FrameRingAgent> agents;
+  unsigned long long next = 1;
+  size_t missed = 0;
+  size_t torn = 0;
+  std::chrono::steady_clock::time_point lastProgress = std::chrono::steady_clock::now();
+  while (next <= frameCount) {
+    const unsigned long long latest = reader.getLatestSequence();
+    if (latest < next) {
+      if (std::chrono::steady_clock::now() - lastProgress > std::chrono::seconds(5)) break;
+      std::this_thread::yield();
+      continue;
+    }
+    // Frames older than the ring have already been overwritten.
+    if (latest - next >= reader.getSlotCount()) {
+      missed += static_cast<size_t>(latest - next - reader.getSlotCount() + 1);
+      next = latest - reader.getSlotCount() + 1;
+    }
+    FrameView view;
+    if (reader.acquire(next, view)) {
+      agents.assign(view.agents, view.agents + view.agentCount);
+      if (reader.validate(view)) {
+        latencies.push_back((nowNanoseconds() - view.publishTime) * 1e-3);
+      } else {
+        ++torn;
+      }
+    } else {
+      ++missed;
+    }
+    ++next;
+    lastProgress = std::chrono::steady_clock::now();
+  }
+
+  std::ostringstream out;
+  out << "Reader " << readerID << ": " << latencies.size() << " frames read, " << missed
+      << " missed, " << torn << " torn";
+  if (!latencies.empty()) {
+    std::sort(latencies.begin(), latencies.end());
+    const double pcts[] = {0.5, 0.9, 0.99, 1.0};
+    const char* names[] = {"p50", "p90", "p99", "max"};
+    out << "; latency (us)";
+    for (int i = 0; i < 4; ++i) {
+      const size_t idx =
+          std::min(latencies.size() - 1, static_cast<size_t>(pcts[i] * latencies.size()));
+      out << " " << names[i] << "=" << latencies[idx];
+    }
+  }
+  out << "\n";
+  std::cout << out.str() << std::flush;
+  return 0;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+#ifdef _WIN32
+  std::cerr << "frameRingBench measures latency across processes with fork() and is only "
+               "available on POSIX systems.\n";
+  return 1;
+#else
+  int agentCount = 10000;
+  int frameCount = 1000;
+  int readerCount = 2;
+  int slotCount = 8;
+  float rate = 100.f;
+  std::string name = "mengeFrameRingBench";
+  try {
+    TCLAP::CmdLine cmd("Shared-memory frame ring latency benchmark.", ' ', "1.0");
+    TCLAP::ValueArg<int> agentArg("a", "agents", "The number of agents (default 10000)", false,
+                                  agentCount, "int", cmd);
+    TCLAP::ValueArg<int> frameArg("f", "frames", "The number of frames to publish (default 1000)",
+                                  false, frameCount, "int", cmd);
+    TCLAP::ValueArg<int> readerArg("k", "readers", "The number of reader processes (default 2)",
+                                   false, readerCount, "int", cmd);
+    TCLAP::ValueArg<int> slotArg("", "slots", "The number of slots in the ring (default 8)", false,
+                                 slotCount, "int", cmd);
+    TCLAP::ValueArg<float> rateArg("r", "rate",
+                                   "Frames published per second; zero publishes as fast as "
+                                   "possible (default 100)",
+                                   false, rate, "float", cmd);
+    TCLAP::ValueArg<std::string> nameArg("n", "name", "The name of the shared region", false, name,
+                                         "string", cmd);
+    cmd.parse(argc, argv);
+    agentCount = agentArg.getValue();
+    frameCount = frameArg.getValue();
+    readerCount = readerArg.getValue();
+    slotCount = slotArg.getValue();
+    rate = rateArg.getValue();
+    name = nameArg.getValue();
+  } catch (TCLAP::ArgException& e) {
+    std::cerr << "Error parsing command-line arguments: " << e.error() << " for arg " << e.argId()
+              << std::endl;
+    return 1;
+  }
+  if (agentCount <= 0 || frameCount <= 0 || readerCount < 0 || slotCount <= 0) {
+    std::cerr << "The agent, frame and slot counts must be positive.\n";
+    return 1;
+  }
+
+  ORCA::Simulator sim;
+  ORCA::AgentInitializer init;
+  for (int i = 0; i < agentCount; ++i) sim.addAgent(Math::Vector2(0.f, 0.f), &init);
+  Agents::FrameRingWriter writer;
+  if (!writer.open(name, agentCount, slotCount)) {
+    std::cerr << "Unable to create the shared region \"" << name << "\"\n";
+    return 1;
+  }
+
+  // Anything still buffered would be written again by each child.
+  std::cout << std::flush;
+  std::vector<pid_t> readers;
+  for (int r = 0; r < readerCount; ++r) {
+    pid_t pid = fork();
+    if (pid == 0) _exit(runReader(name, r, frameCount));
+    if (pid > 0) readers.push_back(pid);
+  }
+  // Give the readers a moment to map the region.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  std::vector<double> publishTimes;
+  publishTimes.reserve(frameCount);
+  std::chrono::steady_clock::time_point next = std::chrono::steady_clock::now();
+  const std::chrono::nanoseconds period(rate > 0.f ? static_cast<long long>(1e9 / rate) : 0);
+  for (int f = 0; f < frameCount; ++f) {
+    for (int i = 0; i < agentCount; ++i) {
+      Agents::BaseAgent* agt = sim.getAgent(i);
+      const float t = f * 0.1f + i;
+      agt->_pos = Math::Vector2(std::cos(t), std::sin(t));
+      agt->_vel = Math::Vector2(-std::sin(t), std::cos(t));
+    }
+    const unsigned long long start = nowNanoseconds();
+    writer.publish(&sim, 0x0);
+    publishTimes.push_back((nowNanoseconds() - start) * 1e-3);
+    if (period.count() > 0) {
+      next += period;
+      std::this_thread::sleep_until(next);
+    }
+  }
+
+  for (size_t r = 0; r < readers.size(); ++r) waitpid(readers[r], 0x0, 0);
+
+  std::sort(publishTimes.begin(), publishTimes.end());
+  std::cout << "Writer: " << frameCount << " frames of " << agentCount
+            << " agents; publish (us) p50=" << publishTimes[publishTimes.size() / 2]
+            << " max=" << publishTimes.back() << "\n";
+  return 0;
+#endif  // _WIN32
+}
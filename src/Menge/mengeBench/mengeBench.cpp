@@ -0,0 +1,499 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+/*!
+ @file    mengeBench.cpp
+ @brief   Measures the throughput of complete simulations of the core example scenarios.
+
+ Every combination of scene, pedestrian model, population scale and thread count is simulated for a
+ fixed number of steps. For each run, the benchmark reports the steps and agent-steps per second of
+ wall time and the peak resident memory. The results are written as JSON and can be compared
+ against a previously saved baseline; runs which are slower than the baseline by more than a
+ tolerance are reported as regressions (and the benchmark exits with a non-zero status).
+
+ Each run is performed by a separate invocation of this executable (with --single). Simulation
+ resources (e.g., navigation meshes and roadmaps) are cached for the lifetime of the process and
+ hold per-simulation state, so simulations can't safely follow each other in one process; a fresh
+ process also gives each run its own peak memory.
+
+ Populations are scaled by writing a copy of the scene next to the original in which every
+ `rect_grid` generator is extended (its counts are multiplied). Other generators are unchanged.
+ */
+
+#include "MengeCore/Agents/SimulatorInterface.h"
+#include "MengeCore/PluginEngine/CorePluginEngine.h"
+#include "MengeCore/ProjectSpec.h"
+#include "MengeCore/Runtime/Logger.h"
+#include "MengeCore/Runtime/SimulatorDB.h"
+#include "MengeCore/Runtime/os.h"
+#include "thirdParty/tclap/CmdLine.h"
+#include "tinyxml/tinyxml.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif  // _OPENMP
+
+#ifdef _WIN32
+#include <windows.h>
+// windows.h must precede psapi.h
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif  // _WIN32
+
+using namespace Menge;
+using Menge::PluginEngine::CorePluginEngine;
+
+namespace {
+// The scenes benchmarked by default (project files in examples/core).
+const char* DEFAULT_SCENES = "4square,bottleneck,stadium,maze-navmesh,office,soccer";
+
+// The result of a single benchmark run.
+struct BenchResult {
+  std::string scene;
+  std::string model;
+  int scale;
+  int threads;
+  size_t agents;
+  size_t steps;
+  double seconds;
+  double stepsPerSec;
+  double agentStepsPerSec;
+  long long peakRssKB;
+
+  // The key by which runs are matched against the baseline.
+  std::string key() const {
+    std::ostringstream s;
+    s << scene << "/" << model << "/x" << scale << "/t" << threads;
+    return s.str();
+  }
+};
+
+std::vector<std::string> splitList(const std::string& list) {
+  std::vector<std::string> items;
+  std::stringstream stream(list);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    if (item != "") items.push_back(item);
+  }
+  return items;
+}
+
+std::vector<int> splitInts(const std::string& list) {
+  std::vector<int> values;
+  std::vector<std::string> items = splitList(list);
+  for (size_t i = 0; i < items.size(); ++i) {
+    const int value = atoi(items[i].c_str());
+    if (value > 0) values.push_back(value);
+  }
+  return values;
+}
+
+// Reports the peak resident memory of this process, in kilobytes.
+long long peakMemoryKB() {
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS counters;
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+    return static_cast<long long>(counters.PeakWorkingSetSize / 1024);
+  }
+  return -1;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+#ifdef __APPLE__
+  return static_cast<long long>(usage.ru_maxrss / 1024);
+#else
+  return static_cast<long long>(usage.ru_maxrss);
+#endif  // __APPLE__
+#endif  // _WIN32
+}
+
+// Writes a copy of the scene with every rect_grid generator scaled by (roughly) the given factor.
+// Returns the path to the copy (or the original path if no scaling is required).
+std::string scaleScene(const std::string& sceneFile, int scale, bool& written) {
+  written = false;
+  if (scale == 1) return sceneFile;
+  TiXmlDocument doc(sceneFile);
+  if (!doc.LoadFile()) {
+    std::cerr << "Unable to read the scene: " << sceneFile << "\n";
+    return "";
+  }
+  // Grow both dimensions of the grid so its shape is roughly preserved.
+  const int xScale = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(scale))));
+  const int yScale = std::max(1, static_cast<int>(std::floor(scale / (double)xScale + 0.5)));
+  std::vector<TiXmlElement*> pending(1, doc.RootElement());
+  while (!pending.empty()) {
+    TiXmlElement* node = pending.back();
+    pending.pop_back();
+    if (node == 0x0) continue;
+    const char* type = node->Attribute("type");
+    if (node->ValueStr() == "Generator" && type != 0x0 && std::string(type) == "rect_grid") {
+      int count;
+      if (node->QueryIntAttribute("count_x", &count) == TIXML_SUCCESS) {
+        node->SetAttribute("count_x", count * xScale);
+      }
+      if (node->QueryIntAttribute("count_y", &count) == TIXML_SUCCESS) {
+        node->SetAttribute("count_y", count * yScale);
+      }
+    }
+    for (TiXmlElement* child = node->FirstChildElement(); child != 0x0;
+         child = child->NextSiblingElement()) {
+      pending.push_back(child);
+    }
+  }
+  std::ostringstream name;
+  name << sceneFile << ".bench" << scale << ".xml";
+  if (!doc.SaveFile(name.str())) {
+    std::cerr << "Unable to write the scaled scene: " << name.str() << "\n";
+    return "";
+  }
+  written = true;
+  return name.str();
+}
+
+// Runs a single configuration in this process; returns false if the simulator couldn't be built.
+bool runBenchmark(SimulatorDB& simDB, const ProjectSpec& spec, const std::string& scene,
+                  const std::string& model, int scale, int threads, size_t steps,
+                  BenchResult& result) {
+  SimulatorDBEntry* entry = simDB.getDBEntry(model);
+  if (entry == 0x0) return false;
+  bool scaled = false;
+  const std::string sceneFile = scaleScene(spec.getScene(), scale, scaled);
+  if (sceneFile == "") return false;
+#ifdef _OPENMP
+  omp_set_num_threads(threads);
+#endif  // _OPENMP
+
+  size_t agentCount = 0;
+  float timeStep = spec.getTimeStep();
+  // The duration is effectively unlimited; the run is bounded by the step count.
+  Agents::SimulatorInterface* sim = 0x0;
+  try {
+    sim = entry->getSimulator(agentCount, timeStep, spec.getSubSteps(), 1e6f, spec.getBehavior(),
+                              sceneFile, "", "", false);
+  } catch (...) {
+    if (scaled) os::remove(sceneFile);
+    throw;
+  }
+  if (scaled) os::remove(sceneFile);
+  if (sim == 0x0) return false;
+
+  const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  size_t s = 0;
+  while (s < steps) {
+    ++s;
+    if (!sim->step()) break;
+  }
+  const double seconds =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  result.scene = scene;
+  result.model = model;
+  result.scale = scale;
+  result.threads = threads;
+  result.agents = sim->getNumAgents();
+  result.steps = s;
+  result.seconds = seconds;
+  result.stepsPerSec = seconds > 0.0 ? s / seconds : 0.0;
+  result.agentStepsPerSec = result.stepsPerSec * result.agents;
+  result.peakRssKB = peakMemoryKB();
+  delete sim;
+  return true;
+}
+
+// Formats a result as a single-line JSON object.
+std::string formatResult(const BenchResult& r) {
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(3);
+  out << "{\"scene\": \"" << r.scene << "\", \"model\": \"" << r.model << "\", \"scale\": "
+      << r.scale << ", \"threads\": " << r.threads << ", \"agents\": " << r.agents
+      << ", \"steps\": " << r.steps << ", \"seconds\": " << r.seconds
+      << ", \"steps_per_sec\": " << r.stepsPerSec
+      << ", \"agent_steps_per_sec\": " << r.agentStepsPerSec
+      << ", \"peak_rss_kb\": " << r.peakRssKB << "}";
+  return out.str();
+}
+
+// Extracts the value following "key": on the line (without quotes for strings).
+std::string fieldValue(const std::string& line, const std::string& key) {
+  const std::string tag = "\"" + key + "\": ";
+  size_t pos = line.find(tag);
+  if (pos == std::string::npos) return "";
+  pos += tag.size();
+  if (line[pos] == '"') {
+    const size_t end = line.find('"', pos + 1);
+    return line.substr(pos + 1, end - pos - 1);
+  }
+  const size_t end = line.find_first_of(",}", pos);
+  return line.substr(pos, end - pos);
+}
+
+// Parses a line written by formatResult(); returns false if the line holds no result.
+bool parseResult(const std::string& line, BenchResult& r) {
+  if (line.find("\"scene\"") == std::string::npos) return false;
+  r.scene = fieldValue(line, "scene");
+  r.model = fieldValue(line, "model");
+  r.scale = atoi(fieldValue(line, "scale").c_str());
+  r.threads = atoi(fieldValue(line, "threads").c_str());
+  r.agents = static_cast<size_t>(atoll(fieldValue(line, "agents").c_str()));
+  r.steps = static_cast<size_t>(atoll(fieldValue(line, "steps").c_str()));
+  r.seconds = atof(fieldValue(line, "seconds").c_str());
+  r.stepsPerSec = atof(fieldValue(line, "steps_per_sec").c_str());
+  r.agentStepsPerSec = atof(fieldValue(line, "agent_steps_per_sec").c_str());
+  r.peakRssKB = atoll(fieldValue(line, "peak_rss_kb").c_str());
+  return true;
+}
+
+bool writeResults(const std::string& fileName, const std::vector<BenchResult>& results,
+                  size_t steps) {
+  std::ofstream out(fileName.c_str());
+  if (!out.is_open()) return false;
+  out << "{\n  \"steps\": " << steps << ",\n  \"runs\": [\n";
+  // One run per line; readResults() depends on it.
+  for (size_t i = 0; i < results.size(); ++i) {
+    out << "    " << formatResult(results[i]) << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  out << "  ]\n}\n";
+  return out.good();
+}
+
+// Reads the runs in a file written by writeResults() (or by a --single run).
+bool readResults(const std::string& fileName, std::vector<BenchResult>& results) {
+  std::ifstream in(fileName.c_str());
+  if (!in.is_open()) return false;
+  std::string line;
+  BenchResult r;
+  while (std::getline(in, line)) {
+    if (parseResult(line, r)) results.push_back(r);
+  }
+  return true;
+}
+
+std::string quote(const std::string& text) { return "\"" + text + "\""; }
+
+// Runs a single configuration in a child process; returns false if it failed.
+bool runChild(const std::string& exe, const std::string& common, const std::string& scene,
+              const std::string& model, int scale, int threads, const std::string& resultFile,
+              BenchResult& result) {
+  std::ostringstream cmd;
+  cmd << quote(exe) << " --single" << common << " -s " << scene << " -m " << model << " -x "
+      << scale << " -t " << threads << " -o " << quote(resultFile);
+  std::string command = cmd.str();
+#ifdef _WIN32
+  // cmd.exe strips the outer quotes of a command which starts with a quoted path.
+  command = quote(command);
+#endif  // _WIN32
+  os::remove(resultFile);
+  if (std::system(command.c_str()) != 0) return false;
+  std::vector<BenchResult> results;
+  if (!readResults(resultFile, results) || results.empty()) return false;
+  os::remove(resultFile);
+  result = results[0];
+  return true;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  std::string exe;
+  std::string root;
+  {
+    std::string tail;
+    os::path::absPath(argv[0], exe);
+    os::path::split(exe, root, tail);
+  }
+  std::string examples = os::path::join(3, root.c_str(), "..", "examples/core");
+  std::string plugins = os::path::join(2, root.c_str(), "plugins");
+  std::string sceneList = DEFAULT_SCENES;
+  std::string modelList = "";
+  std::string scaleList = "1,4";
+  std::string threadList = "";
+  int stepCount = 200;
+  std::string outFile = "mengeBench.json";
+  std::string baselineFile = "";
+  float tolerance = 0.1f;
+  bool single = false;
+  try {
+    TCLAP::CmdLine cmd("Measures the throughput of the core example scenarios. ", ' ', "0.1");
+    TCLAP::ValueArg<std::string> examplesArg(
+        "e", "examples", "The directory containing the example project files.", false, examples,
+        "string", cmd);
+    TCLAP::ValueArg<std::string> pluginArg("p", "plugins", "The directory of the model plugins.",
+                                           false, plugins, "string", cmd);
+    TCLAP::ValueArg<std::string> sceneArg("s", "scenes",
+                                          "Comma-separated names of the project files to run.",
+                                          false, sceneList, "string", cmd);
+    TCLAP::ValueArg<std::string> modelArg(
+        "m", "models", "Comma-separated pedestrian models (default: every model found).", false,
+        modelList, "string", cmd);
+    TCLAP::ValueArg<std::string> scaleArg(
+        "x", "scales", "Comma-separated population scales applied to the scenes' generators.",
+        false, scaleList, "string", cmd);
+    TCLAP::ValueArg<std::string> threadArg(
+        "t", "threads", "Comma-separated thread counts (default: 1 and the maximum).", false,
+        threadList, "string", cmd);
+    TCLAP::ValueArg<int> stepArg("n", "steps", "The number of steps in each run.", false,
+                                 stepCount, "int", cmd);
+    TCLAP::ValueArg<std::string> outArg("o", "out", "The JSON file the results are written to.",
+                                        false, outFile, "string", cmd);
+    TCLAP::ValueArg<std::string> baselineArg(
+        "b", "baseline", "Results of a previous run to compare against.", false, baselineFile,
+        "string", cmd);
+    TCLAP::ValueArg<float> toleranceArg(
+        "", "tolerance", "The fraction by which a run may be slower than the baseline.", false,
+        tolerance, "float", cmd);
+    TCLAP::SwitchArg singleArg("", "single",
+                               "Run only the first scene, model, scale and thread count in this "
+                               "process (used internally for every run).",
+                               cmd, false);
+    cmd.parse(argc, argv);
+    examples = examplesArg.getValue();
+    plugins = pluginArg.getValue();
+    sceneList = sceneArg.getValue();
+    modelList = modelArg.getValue();
+    scaleList = scaleArg.getValue();
+    threadList = threadArg.getValue();
+    stepCount = stepArg.getValue();
+    outFile = outArg.getValue();
+    baselineFile = baselineArg.getValue();
+    tolerance = toleranceArg.getValue();
+    single = singleArg.getValue();
+  } catch (TCLAP::ArgException& e) {
+    std::cerr << "Error parsing command-line arguments: " << e.error() << " for arg " << e.argId()
+              << "\n";
+    return 1;
+  }
+
+  logger.setFile("mengeBench_log.html");
+  SimulatorDB simDB;
+  CorePluginEngine engine(&simDB);
+  engine.loadPlugins(plugins);
+
+  std::vector<std::string> models = splitList(modelList);
+  if (models.empty()) {
+    for (size_t i = 0; i < simDB.modelCount(); ++i) {
+      models.push_back(simDB.name(static_cast<int>(i)));
+    }
+  }
+  std::vector<int> threads = splitInts(threadList);
+  if (threads.empty()) {
+    threads.push_back(1);
+#ifdef _OPENMP
+    if (omp_get_max_threads() > 1) threads.push_back(omp_get_max_threads());
+#endif  // _OPENMP
+  }
+  const std::vector<std::string> scenes = splitList(sceneList);
+  const std::vector<int> scales = splitInts(scaleList);
+  if (scenes.empty() || models.empty() || scales.empty()) {
+    std::cerr << "Nothing to run.\n";
+    return 1;
+  }
+
+  if (single) {
+    ProjectSpec spec;
+    const std::string projectName = scenes[0] + ".xml";
+    BenchResult result;
+    if (!spec.loadFromXML(os::path::join(2, examples.c_str(), projectName.c_str()))) return 1;
+    try {
+      if (!runBenchmark(simDB, spec, scenes[0], models[0], scales[0], threads[0],
+                        static_cast<size_t>(stepCount), result)) {
+        return 1;
+      }
+    } catch (std::exception& e) {
+      // E.g., a scaled population which the scene's behavior can't accommodate.
+      std::cerr << "The simulation of " << scenes[0] << " failed (see mengeBench_log.html). "
+                << e.what() << "\n";
+      return 1;
+    }
+    std::ofstream out(outFile.c_str());
+    out << formatResult(result) << "\n";
+    return out.good() ? 0 : 1;
+  }
+
+  std::ostringstream common;
+  common << " -e " << quote(examples) << " -p " << quote(plugins) << " -n " << stepCount;
+  const std::string resultFile = outFile + ".run";
+  std::vector<BenchResult> results;
+  std::cout << std::fixed << std::setprecision(1);
+  for (size_t s = 0; s < scenes.size(); ++s) {
+    for (size_t m = 0; m < models.size(); ++m) {
+      for (size_t x = 0; x < scales.size(); ++x) {
+        for (size_t t = 0; t < threads.size(); ++t) {
+          BenchResult result;
+          if (!runChild(exe, common.str(), scenes[s], models[m], scales[x], threads[t],
+                        resultFile, result)) {
+            std::cerr << "Skipping " << scenes[s] << " with " << models[m] << " (x" << scales[x]
+                      << "): the simulation failed\n";
+            break;
+          }
+          std::cout << std::left << std::setw(40) << result.key() << std::right << std::setw(8)
+                    << result.agents << " agents " << std::setw(10) << result.stepsPerSec
+                    << " steps/s " << std::setw(12) << result.agentStepsPerSec
+                    << " agent-steps/s " << std::setw(10) << result.peakRssKB << " KB\n"
+                    << std::flush;
+          results.push_back(result);
+        }
+      }
+    }
+  }
+
+  if (!writeResults(outFile, results, static_cast<size_t>(stepCount))) {
+    std::cerr << "Unable to write the results: " << outFile << "\n";
+    return 1;
+  }
+  std::cout << "Results written to " << outFile << "\n";
+
+  if (baselineFile == "") return 0;
+  std::vector<BenchResult> baselineRuns;
+  if (!readResults(baselineFile, baselineRuns)) {
+    std::cerr << "Unable to read the baseline: " << baselineFile << "\n";
+    return 1;
+  }
+  std::map<std::string, double> baseline;
+  for (size_t i = 0; i < baselineRuns.size(); ++i) {
+    baseline[baselineRuns[i].key()] = baselineRuns[i].agentStepsPerSec;
+  }
+  size_t regressions = 0;
+  std::cout << "\nComparison with " << baselineFile << " (agent-steps/s):\n";
+  for (size_t i = 0; i < results.size(); ++i) {
+    std::map<std::string, double>::const_iterator itr = baseline.find(results[i].key());
+    if (itr == baseline.end() || itr->second <= 0.0) continue;
+    const double ratio = results[i].agentStepsPerSec / itr->second;
+    const bool regressed = ratio < 1.0 - tolerance;
+    if (regressed) ++regressions;
+    std::cout << std::left << std::setw(40) << results[i].key() << std::right << std::setw(12)
+              << itr->second << " -> " << std::setw(12) << results[i].agentStepsPerSec << "  "
+              << std::setprecision(2) << ratio << "x" << std::setprecision(1)
+              << (regressed ? "  REGRESSION" : "") << "\n";
+  }
+  std::cout << regressions << " regression(s)\n";
+  return regressions > 0 ? 2 : 0;
+}
@@ -42,7 +42,10 @@ Any questions or comments should be sent to the authors {menge,geom}@cs.unc.edu
 #include "MengeCore/ProjectSpec.h"
 #include "MengeCore/Runtime/Logger.h"
 #include "MengeCore/Runtime/SimulatorDB.h"
+#include "MengeCore/Runtime/StepProfiler.h"
+#include "MengeCore/Runtime/TraceRecorder.h"
 #include "MengeCore/Runtime/os.h"
+#include "MengeCore/resources/VectorField.h"
 
 #include "MengeVis/PluginEngine/VisPluginEngine.h"
 #include "MengeVis/Runtime/AgentContext/BaseAgentContext.h"
@@ -81,6 +84,18 @@ size_t SUB_STEPS = 0;
 float SIM_DURATION = 800.f;
 // Controls whether the simulation is verbose or not
 bool VERBOSE = false;
+// The name of the shared-memory region frames are published to (none if empty)
+std::string SHARED_OUTPUT;
+// The number of frames held by the shared-memory ring buffer
+size_t SHARED_SLOTS = 8;
+// The path to the step profile summary (no profiling if empty)
+std::string PROFILE_OUTPUT;
+// The path to the Chrome trace-event file (no tracing if empty)
+std::string TRACE_OUTPUT;
+// Only one in this many steps is traced
+size_t TRACE_INTERVAL = 1;
+// Path searches and tasks shorter than this (in microseconds) are not traced
+double TRACE_MIN_SPAN = 0.0;
 // The location of the executable - for basic executable resources
 std::string ROOT;
 
@@ -136,7 +151,7 @@ bool parseCommandParameters(int argc, char* argv[], ProjectSpec* spec, const Sim
                                            false, "", "string", cmd);
     TCLAP::ValueArg<std::string> versionArg("", "scbVersion",
                                             "Version of scb file to write "
-                                            "(1.0, 2.0, 2.1, 2.2, 2.3, or 2.4 -- 2.1 is the "
+                                            "(1.0, 2.0, 2.1, 2.2, 2.3, 2.4, or 3.0 -- 2.1 is the "
                                             "default",
                                             false, "", "string", cmd);
     TCLAP::ValueArg<float> durationArg("d", "duration",
@@ -183,9 +198,64 @@ bool parseCommandParameters(int argc, char* argv[], ProjectSpec* spec, const Sim
                                              "current directory.  (Will create the directory "
                                              "if it doesn't already exist.)",
                                              false, "", "string", cmd);
+    TCLAP::ValueArg<std::string> vfConvertArg("", "vfConvert",
+                                              "Converts the given vector field file to the "
+                                              "binary (memory-mappable) vector field format. "
+                                              "Requires --vfOut. If specified, no simulation is "
+                                              "run.",
+                                              false, "", "string", cmd);
+    TCLAP::ValueArg<std::string> vfOutArg("", "vfOut",
+                                          "The path to the binary vector field file written by "
+                                          "--vfConvert.",
+                                          false, "", "string", cmd);
+    TCLAP::ValueArg<std::string> shmArg("", "shm",
+                                        "Publish every frame to the named shared-memory ring "
+                                        "buffer so other processes can read the simulation while "
+                                        "it runs.",
+                                        false, "", "string", cmd);
+    TCLAP::ValueArg<int> shmSlotsArg("", "shmSlots",
+                                     "The number of frames held by the shared-memory ring "
+                                     "buffer (see --shm). Defaults to 8.",
+                                     false, -1, "int", cmd);
+    TCLAP::ValueArg<std::string> profileArg("", "profile",
+                                            "Time the phases of every simulation step and write a "
+                                            "summary to the given file (JSON if the name ends in "
+                                            ".json, CSV otherwise).",
+                                            false, "", "string", cmd);
+    TCLAP::ValueArg<std::string> traceArg("", "trace",
+                                          "Record the phases of the simulation steps, path "
+                                          "searches and FSM tasks of every thread and write them "
+                                          "to the given file as Chrome trace-event JSON (open it "
+                                          "in Perfetto or chrome://tracing).",
+                                          false, "", "string", cmd);
+    TCLAP::ValueArg<int> traceEveryArg("", "traceEvery",
+                                       "Only trace one in every N simulation steps (see --trace). "
+                                       "Defaults to 1.",
+                                       false, 1, "int", cmd);
+    TCLAP::ValueArg<float> traceMinArg("", "traceMinUs",
+                                       "Omit path searches and FSM tasks which take less than "
+                                       "this many microseconds from the trace (see --trace). "
+                                       "Defaults to 0.",
+                                       false, 0.f, "float", cmd);
+    TCLAP::SwitchArg vfHalfArg("", "vfHalf",
+                               "Store the vector field written by --vfConvert at half "
+                               "precision.",
+                               cmd, false);
 
     cmd.parse(argc, argv);
 
+    if (vfConvertArg.getValue() != "") {
+      if (vfOutArg.getValue() == "") {
+        std::cerr << "--vfConvert requires an output file (--vfOut)\n";
+      } else if (convertVectorField(vfConvertArg.getValue(), vfOutArg.getValue(),
+                                    vfHalfArg.getValue())) {
+        std::cout << "Wrote binary vector field: " << vfOutArg.getValue() << "\n";
+      } else {
+        std::cerr << "Unable to convert the vector field. See the log for details.\n";
+      }
+      return false;
+    }
+
     if (listModelsFullArg.getValue()) {
       std::cout << "\n" << simDB.longDescriptions() << "\n";
       return false;
@@ -253,6 +323,15 @@ bool parseCommandParameters(int argc, char* argv[], ProjectSpec* spec, const Sim
       spec->setDumpPath(temp);
     }
 
+    SHARED_OUTPUT = shmArg.getValue();
+    if (shmSlotsArg.getValue() > 0) SHARED_SLOTS = static_cast<size_t>(shmSlotsArg.getValue());
+    PROFILE_OUTPUT = profileArg.getValue();
+    TRACE_OUTPUT = traceArg.getValue();
+    if (traceEveryArg.getValue() > 0) {
+      TRACE_INTERVAL = static_cast<size_t>(traceEveryArg.getValue());
+    }
+    TRACE_MIN_SPAN = traceMinArg.getValue();
+
   } catch (TCLAP::ArgException& e) {
     std::cerr << "Error parsing command-line arguments: " << e.error() << " for arg " << e.argId()
               << std::endl;
@@ -315,6 +394,15 @@ int simMain(SimulatorDBEntry* dbEntry, const std::string& behaveFile, const std:
     return 1;
   }
 
+  if (SHARED_OUTPUT != "" && !sim->setSharedOutput(SHARED_OUTPUT, SHARED_SLOTS)) {
+    std::cerr << "Unable to publish frames to shared memory: " << SHARED_OUTPUT << "\n";
+  }
+
+  if (PROFILE_OUTPUT != "") PROFILER.enable();
+  if (TRACE_OUTPUT != "") {
+    TRACER.enable(TraceRecorder::DEFAULT_CAPACITY, TRACE_INTERVAL, TRACE_MIN_SPAN);
+  }
+
   std::cout << "Starting...\n";
 
   if (visualize) {
@@ -385,6 +473,23 @@ int simMain(SimulatorDBEntry* dbEntry, const std::string& behaveFile, const std:
   std::cout << "Simulation time: " << dbEntry->simDuration() << "\n";
   logger << Logger::INFO_MSG << "Simulation time: " << dbEntry->simDuration() << "\n";
 
+  if (PROFILE_OUTPUT != "") {
+    if (PROFILER.write(PROFILE_OUTPUT)) {
+      std::cout << "Step profile (" << PROFILER.getStepCount() << " steps): " << PROFILE_OUTPUT
+                << "\n";
+    } else {
+      std::cerr << "Unable to write the step profile: " << PROFILE_OUTPUT << "\n";
+    }
+  }
+  if (TRACE_OUTPUT != "") {
+    if (TRACER.write(TRACE_OUTPUT)) {
+      std::cout << "Trace (" << TRACER.getEventCount() << " events, " << TRACER.getDroppedCount()
+                << " dropped): " << TRACE_OUTPUT << "\n";
+    } else {
+      std::cerr << "Unable to write the trace: " << TRACE_OUTPUT << "\n";
+    }
+  }
+
   return 0;
 }
 
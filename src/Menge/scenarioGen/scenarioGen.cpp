@@ -0,0 +1,728 @@
+/*
+ Menge Crowd Simulation Framework
+
+ Copyright and trademark 2012-17 University of North Carolina at Chapel Hill
+
+ Licensed under the Apache License, Version 2.0 (the "License");
+ you may not use this file except in compliance with the License.
+ You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+ or
+    LICENSE.txt in the root of the Menge repository.
+
+ Any questions or comments should be sent to the authors menge@cs.unc.edu
+
+ <http://gamma.cs.unc.edu/Menge/>
+*/
+
+/*!
+ @file    scenarioGen.cpp
+ @brief   Procedurally generates large simulation scenarios for scaling tests.
+
+ A scenario is a project file with its scene, behavior, view and navigation mesh, written in the
+ same layout as the examples (`<out>/<name>.xml` and `<out>/<name>/...`). Everything is derived
+ deterministically from the command-line parameters and the seed; the pseudo-random numbers are
+ drawn directly from a Mersenne twister (rather than the standard distributions, whose output
+ differs between standard libraries) so a seed produces the same scenario on every platform.
+
+ The environment is a grid of square cells, each of which is either free or blocked:
+
+   - `open`:  a single open plaza.
+   - `grid`:  city blocks separated by streets.
+   - `maze`:  a perfect maze with corridors one cell wide.
+   - `venue`: a stadium; a blocked pitch surrounded by stands (rows of seats broken by aisles)
+              inside a concourse.
+
+ The environment is sized so that the requested number of agents fits at the requested density.
+ The navigation mesh is the grid with runs of identical columns and rows merged into single
+ nodes; its boundary provides the obstacles (via the `nav_mesh` obstacle set). Agents are placed on
+ a jittered lattice in the free space and navigate with the navigation mesh to goals chosen by one
+ of the patterns:
+
+   - `exits`:    every agent walks to the nearest of four exits (one near the middle of each side).
+   - `crossing`: agents in the western half walk to the eastern edge and vice versa.
+   - `random`:   agents walk between randomly placed goals indefinitely.
+ */
+
+#include "MengeCore/Runtime/os.h"
+#include "thirdParty/tclap/CmdLine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace Menge;
+
+namespace {
+// The radius of the generated agents.
+const float AGENT_RADIUS = 0.19f;
+
+// Agents are placed at least this far from the obstacles.
+const float WALL_CLEARANCE = 0.3f;
+
+// A portable source of pseudo-random numbers.
+class Random {
+ public:
+  explicit Random(unsigned int seed) : _engine(seed) {}
+
+  // A value uniformly distributed in [0, 1).
+  double uniform() { return (_engine() >> 5) * (1.0 / 134217728.0); }
+
+  // A value uniformly distributed in [0, n).
+  size_t index(size_t n) { return static_cast<size_t>(uniform() * n); }
+
+  template <typename T>
+  void shuffle(std::vector<T>& values) {
+    for (size_t i = values.size(); i > 1; --i) std::swap(values[i - 1], values[index(i)]);
+  }
+
+ private:
+  std::mt19937 _engine;
+};
+
+// The parameters of a scenario.
+struct Settings {
+  std::string layout;
+  std::string pattern;
+  size_t agents;
+  double density;
+  double cellSize;
+  size_t goalCount;
+  unsigned int seed;
+};
+
+// An axis-aligned box, in world coordinates.
+struct Box {
+  double minX, minY, maxX, maxY;
+};
+
+// The environment: a grid of free and blocked cells, centered on the origin.
+class CellGrid {
+ public:
+  CellGrid(int width, int height, double cellSize)
+      : _width(width), _height(height), _cellSize(cellSize), _blocked(width * height, 0) {}
+
+  int width() const { return _width; }
+  int height() const { return _height; }
+  double cellSize() const { return _cellSize; }
+
+  bool blocked(int i, int j) const {
+    return i < 0 || j < 0 || i >= _width || j >= _height || _blocked[j * _width + i] != 0;
+  }
+  void setBlocked(int i, int j, bool blocked) { _blocked[j * _width + i] = blocked ? 1 : 0; }
+
+  double x(double i) const { return (i - 0.5 * _width) * _cellSize; }
+  double y(double j) const { return (j - 0.5 * _height) * _cellSize; }
+  int column(double x) const { return static_cast<int>(std::floor(x / _cellSize + 0.5 * _width)); }
+  int row(double y) const { return static_cast<int>(std::floor(y / _cellSize + 0.5 * _height)); }
+
+  Box cellBox(int i, int j) const { return Box{x(i), y(j), x(i + 1), y(j + 1)}; }
+
+  // Reports if a disk of the given radius centered at (px, py) lies entirely in free cells.
+  bool clear(double px, double py, double radius) const {
+    const int i0 = column(px - radius);
+    const int i1 = column(px + radius);
+    const int j0 = row(py - radius);
+    const int j1 = row(py + radius);
+    for (int j = j0; j <= j1; ++j) {
+      for (int i = i0; i <= i1; ++i) {
+        if (blocked(i, j)) return false;
+      }
+    }
+    return true;
+  }
+
+  // Finds the free cell closest to the given point.
+  bool nearestFree(double px, double py, int& ci, int& cj) const {
+    double best = -1.0;
+    for (int j = 0; j < _height; ++j) {
+      for (int i = 0; i < _width; ++i) {
+        if (blocked(i, j)) continue;
+        const double dx = x(i + 0.5) - px;
+        const double dy = y(j + 0.5) - py;
+        const double d = dx * dx + dy * dy;
+        if (best < 0.0 || d < best) {
+          best = d;
+          ci = i;
+          cj = j;
+        }
+      }
+    }
+    return best >= 0.0;
+  }
+
+ private:
+  int _width;
+  int _height;
+  double _cellSize;
+  std::vector<char> _blocked;
+};
+
+/////////////////////////////////////////////////////////////////////
+//          Layouts
+/////////////////////////////////////////////////////////////////////
+
+// City blocks (BLOCK x BLOCK cells) separated by streets STREET cells wide.
+const int BLOCK = 6;
+const int STREET = 3;
+
+CellGrid makeGrid(int blocks) {
+  const int size = blocks * (BLOCK + STREET) + STREET;
+  CellGrid grid(size, size, 0.0);
+  for (int j = 0; j < size; ++j) {
+    for (int i = 0; i < size; ++i) {
+      const bool inBlock = i % (BLOCK + STREET) >= STREET && j % (BLOCK + STREET) >= STREET;
+      grid.setBlocked(i, j, inBlock);
+    }
+  }
+  return grid;
+}
+
+// A perfect maze over rooms x rooms rooms (carved with a randomized depth-first search).
+CellGrid makeMaze(int rooms, Random& random) {
+  const int size = 2 * rooms + 1;
+  CellGrid grid(size, size, 0.0);
+  for (int j = 0; j < size; ++j) {
+    for (int i = 0; i < size; ++i) grid.setBlocked(i, j, true);
+  }
+  std::vector<char> visited(rooms * rooms, 0);
+  std::vector<int> stack(1, 0);
+  visited[0] = 1;
+  grid.setBlocked(1, 1, false);
+  const int DI[] = {1, -1, 0, 0};
+  const int DJ[] = {0, 0, 1, -1};
+  while (!stack.empty()) {
+    const int room = stack.back();
+    const int ri = room % rooms;
+    const int rj = room / rooms;
+    int options[4];
+    int optionCount = 0;
+    for (int d = 0; d < 4; ++d) {
+      const int ni = ri + DI[d];
+      const int nj = rj + DJ[d];
+      if (ni >= 0 && nj >= 0 && ni < rooms && nj < rooms && !visited[nj * rooms + ni]) {
+        options[optionCount++] = d;
+      }
+    }
+    if (optionCount == 0) {
+      stack.pop_back();
+      continue;
+    }
+    const int d = options[random.index(optionCount)];
+    const int ni = ri + DI[d];
+    const int nj = rj + DJ[d];
+    grid.setBlocked(2 * ri + 1 + DI[d], 2 * rj + 1 + DJ[d], false);
+    grid.setBlocked(2 * ni + 1, 2 * nj + 1, false);
+    visited[nj * rooms + ni] = 1;
+    stack.push_back(nj * rooms + ni);
+  }
+  return grid;
+}
+
+// A stadium: a concourse around stands which surround the pitch.
+CellGrid makeVenue(int size) {
+  const int CONCOURSE = 3;
+  CellGrid grid(size, size, 0.0);
+  const int pitch0 = static_cast<int>(size * 0.35);
+  const int pitch1 = size - pitch0;
+  for (int j = 0; j < size; ++j) {
+    for (int i = 0; i < size; ++i) {
+      // Distance (in cells) inward from the concourse, and the position along the stand.
+      const int edge = std::min(std::min(i, j), std::min(size - 1 - i, size - 1 - j));
+      bool blocked = false;
+      if (i >= pitch0 && i < pitch1 && j >= pitch0 && j < pitch1) {
+        blocked = true;
+      } else if (edge >= CONCOURSE && edge < pitch0 - 1) {
+        // Rows of seats (every other ring) broken by an aisle every eighth cell.
+        const bool horizontal = std::min(j, size - 1 - j) == edge;
+        const int along = horizontal ? i : j;
+        blocked = (edge - CONCOURSE) % 2 == 1 && along % 8 != 0;
+      }
+      grid.setBlocked(i, j, blocked);
+    }
+  }
+  return grid;
+}
+
+// The fraction of the area which is usually free (used for the initial size estimate).
+double freeFraction(const std::string& layout) {
+  if (layout == "grid") return 0.5;
+  if (layout == "maze") return 0.45;
+  if (layout == "venue") return 0.45;
+  return 1.0;
+}
+
+CellGrid makeLayout(const Settings& settings, double side, Random& random) {
+  const int cells = std::max(4, static_cast<int>(std::ceil(side / settings.cellSize)));
+  CellGrid grid(1, 1, 0.0);
+  if (settings.layout == "grid") {
+    grid = makeGrid(std::max(1, (cells - STREET) / (BLOCK + STREET)));
+  } else if (settings.layout == "maze") {
+    grid = makeMaze(std::max(2, cells / 2), random);
+  } else if (settings.layout == "venue") {
+    grid = makeVenue(std::max(24, cells));
+  } else {
+    grid = CellGrid(cells, cells, 0.0);
+  }
+  CellGrid sized(grid.width(), grid.height(), settings.cellSize);
+  for (int j = 0; j < grid.height(); ++j) {
+    for (int i = 0; i < grid.width(); ++i) sized.setBlocked(i, j, grid.blocked(i, j));
+  }
+  return sized;
+}
+
+/////////////////////////////////////////////////////////////////////
+//          Agents
+/////////////////////////////////////////////////////////////////////
+
+// Places agents on a jittered lattice whose spacing gives the requested density.
+std::vector<double> placeAgents(const CellGrid& grid, double density, Random& random) {
+  const double spacing = 1.0 / std::sqrt(density);
+  const double jitter = 0.25 * spacing;
+  const double x0 = grid.x(0);
+  const double y0 = grid.y(0);
+  const int nx = static_cast<int>(grid.width() * grid.cellSize() / spacing);
+  const int ny = static_cast<int>(grid.height() * grid.cellSize() / spacing);
+  std::vector<double> positions;
+  for (int b = 0; b < ny; ++b) {
+    for (int a = 0; a < nx; ++a) {
+      const double px = x0 + (a + 0.5) * spacing + (2.0 * random.uniform() - 1.0) * jitter;
+      const double py = y0 + (b + 0.5) * spacing + (2.0 * random.uniform() - 1.0) * jitter;
+      if (grid.clear(px, py, WALL_CLEARANCE)) {
+        positions.push_back(px);
+        positions.push_back(py);
+      }
+    }
+  }
+  return positions;
+}
+
+/////////////////////////////////////////////////////////////////////
+//          Navigation mesh
+/////////////////////////////////////////////////////////////////////
+
+// Merges runs of identical lines of cells; returns the boundaries of the runs (in cells).
+std::vector<int> mergeRuns(const CellGrid& grid, bool columns) {
+  const int count = columns ? grid.width() : grid.height();
+  const int length = columns ? grid.height() : grid.width();
+  std::vector<int> bounds(1, 0);
+  for (int k = 1; k < count; ++k) {
+    bool same = true;
+    for (int m = 0; m < length && same; ++m) {
+      same = columns ? grid.blocked(k, m) == grid.blocked(k - 1, m)
+                     : grid.blocked(m, k) == grid.blocked(m, k - 1);
+    }
+    if (!same) bounds.push_back(k);
+  }
+  bounds.push_back(count);
+  return bounds;
+}
+
+// An obstacle segment between mesh vertices, with the free space on its right.
+struct Segment {
+  int v0, v1, node;
+};
+
+// Writes the navigation mesh; returns false if it couldn't be written.
+bool writeNavMesh(const std::string& fileName, const CellGrid& grid, size_t& nodeCount) {
+  const std::vector<int> xs = mergeRuns(grid, true);
+  const std::vector<int> ys = mergeRuns(grid, false);
+  const int bx = static_cast<int>(xs.size()) - 1;
+  const int by = static_cast<int>(ys.size()) - 1;
+  // Vertex (a, b) lies on the boundary between runs; node (a, b) is the merged block.
+  std::vector<int> nodeIDs(bx * by, -1);
+  int nodes = 0;
+  for (int b = 0; b < by; ++b) {
+    for (int a = 0; a < bx; ++a) {
+      if (!grid.blocked(xs[a], ys[b])) nodeIDs[b * bx + a] = nodes++;
+    }
+  }
+  nodeCount = nodes;
+  const int V = bx + 1;
+  std::vector<std::vector<int> > nodeEdges(nodes);
+  std::vector<std::vector<int> > nodeObstacles(nodes);
+  std::ostringstream edges;
+  int edgeCount = 0;
+  std::vector<Segment> segments;
+  for (int b = 0; b < by; ++b) {
+    for (int a = 0; a < bx; ++a) {
+      const int n = nodeIDs[b * bx + a];
+      if (n < 0) continue;
+      const int bl = b * V + a;
+      const int br = bl + 1;
+      const int tl = bl + V;
+      const int tr = tl + 1;
+      // Edges to the east and north neighbors; obstacles on every side which faces blocked space.
+      const int east = a + 1 < bx ? nodeIDs[b * bx + a + 1] : -1;
+      const int north = b + 1 < by ? nodeIDs[(b + 1) * bx + a] : -1;
+      const int west = a > 0 ? nodeIDs[b * bx + a - 1] : -1;
+      const int south = b > 0 ? nodeIDs[(b - 1) * bx + a] : -1;
+      if (east >= 0) {
+        edges << br << " " << tr << " " << n << " " << east << "\n";
+        nodeEdges[n].push_back(edgeCount);
+        nodeEdges[east].push_back(edgeCount++);
+      }
+      if (north >= 0) {
+        edges << tl << " " << tr << " " << n << " " << north << "\n";
+        nodeEdges[n].push_back(edgeCount);
+        nodeEdges[north].push_back(edgeCount++);
+      }
+      if (south < 0) segments.push_back(Segment{br, bl, n});
+      if (north < 0) segments.push_back(Segment{tl, tr, n});
+      if (west < 0) segments.push_back(Segment{bl, tl, n});
+      if (east < 0) segments.push_back(Segment{tr, br, n});
+    }
+  }
+
+  // Chain the obstacles into closed loops. Where two loops touch at a vertex (diagonally adjacent
+  // free blocks), the loop continues around the same node.
+  std::vector<std::vector<int> > startingAt(V * (by + 1));
+  for (size_t s = 0; s < segments.size(); ++s) startingAt[segments[s].v0].push_back(int(s));
+  std::vector<int> next(segments.size(), -1);
+  for (size_t s = 0; s < segments.size(); ++s) {
+    const std::vector<int>& candidates = startingAt[segments[s].v1];
+    for (size_t c = 0; c < candidates.size(); ++c) {
+      if (next[s] < 0 || segments[candidates[c]].node == segments[s].node) next[s] = candidates[c];
+    }
+    nodeObstacles[segments[s].node].push_back(int(s));
+  }
+
+  std::ofstream out(fileName.c_str());
+  if (!out.is_open()) return false;
+  out << std::setprecision(10);
+  out << V * (by + 1) << "\n";
+  for (int b = 0; b <= by; ++b) {
+    for (int a = 0; a <= bx; ++a) out << grid.x(xs[a]) << " " << grid.y(ys[b]) << "\n";
+  }
+  out << edgeCount << "\n" << edges.str();
+  out << segments.size() << "\n";
+  for (size_t s = 0; s < segments.size(); ++s) {
+    out << segments[s].v0 << " " << segments[s].v1 << " " << segments[s].node << " " << next[s]
+        << "\n";
+  }
+  out << "synthetic\n" << nodes << "\n";
+  for (int b = 0; b < by; ++b) {
+    for (int a = 0; a < bx; ++a) {
+      const int n = nodeIDs[b * bx + a];
+      if (n < 0) continue;
+      const int bl = b * V + a;
+      out << 0.5 * (grid.x(xs[a]) + grid.x(xs[a + 1])) << " "
+          << 0.5 * (grid.y(ys[b]) + grid.y(ys[b + 1])) << "\n";
+      out << "4 " << bl << " " << bl + 1 << " " << bl + V + 1 << " " << bl + V << "\n0 0 0\n";
+      out << nodeEdges[n].size();
+      for (size_t e = 0; e < nodeEdges[n].size(); ++e) out << " " << nodeEdges[n][e];
+      out << "\n" << nodeObstacles[n].size();
+      for (size_t o = 0; o < nodeObstacles[n].size(); ++o) out << " " << nodeObstacles[n][o];
+      out << "\n";
+    }
+  }
+  return out.good();
+}
+
+/////////////////////////////////////////////////////////////////////
+//          Specification files
+/////////////////////////////////////////////////////////////////////
+
+void writeBox(std::ostream& out, const char* element, int id, const Box& box) {
+  out << "\t\t<" << element << " type=\"AABB\" id=\"" << id << "\" min_x=\"" << box.minX
+      << "\" min_y=\"" << box.minY << "\" max_x=\"" << box.maxX << "\" max_y=\"" << box.maxY
+      << "\" />\n";
+}
+
+// The runs of free cells in the westernmost (or easternmost) column which has free cells.
+std::vector<Box> edgeGoals(const CellGrid& grid, bool east) {
+  std::vector<Box> goals;
+  for (int c = 0; c < grid.width() && goals.empty(); ++c) {
+    const int i = east ? grid.width() - 1 - c : c;
+    for (int j = 0; j < grid.height(); ++j) {
+      if (grid.blocked(i, j)) continue;
+      const int j0 = j;
+      while (j + 1 < grid.height() && !grid.blocked(i, j + 1)) ++j;
+      goals.push_back(Box{grid.x(i), grid.y(j0), grid.x(i + 1), grid.y(j + 1)});
+    }
+  }
+  return goals;
+}
+
+// The goal sets of the scenario; for the crossing pattern, set 0 is in the west and set 1 in the
+// east.
+std::vector<std::vector<Box> > makeGoals(const CellGrid& grid, const Settings& settings,
+                                         Random& random) {
+  std::vector<std::vector<Box> > goalSets(1);
+  std::vector<Box>& goals = goalSets[0];
+  if (settings.pattern == "crossing") {
+    goals = edgeGoals(grid, false);
+    goalSets.push_back(edgeGoals(grid, true));
+  } else if (settings.pattern == "random") {
+    std::vector<int> free;
+    for (int j = 0; j < grid.height(); ++j) {
+      for (int i = 0; i < grid.width(); ++i) {
+        if (!grid.blocked(i, j)) free.push_back(j * grid.width() + i);
+      }
+    }
+    random.shuffle(free);
+    for (size_t g = 0; g < settings.goalCount && g < free.size(); ++g) {
+      goals.push_back(grid.cellBox(free[g] % grid.width(), free[g] / grid.width()));
+    }
+  } else {
+    const double halfW = 0.5 * grid.width() * grid.cellSize();
+    const double halfH = 0.5 * grid.height() * grid.cellSize();
+    const double targets[4][2] = {{-halfW, 0.0}, {halfW, 0.0}, {0.0, -halfH}, {0.0, halfH}};
+    for (int t = 0; t < 4; ++t) {
+      int i = 0, j = 0;
+      if (grid.nearestFree(targets[t][0], targets[t][1], i, j)) goals.push_back(grid.cellBox(i, j));
+    }
+  }
+  return goalSets;
+}
+
+bool writeBehavior(const std::string& fileName, const std::string& navMesh,
+                   const std::vector<std::vector<Box> >& goalSets, const Settings& settings) {
+  std::ofstream out(fileName.c_str());
+  if (!out.is_open()) return false;
+  out << "<?xml version=\"1.0\"?>\n\n<BFSM>\n";
+  for (size_t s = 0; s < goalSets.size(); ++s) {
+    out << "\t<GoalSet id=\"" << s << "\">\n";
+    for (size_t g = 0; g < goalSets[s].size(); ++g) writeBox(out, "Goal", int(g), goalSets[s][g]);
+    out << "\t</GoalSet>\n";
+  }
+  out << "\n";
+  const std::string velocity =
+      "\t\t<VelComponent type=\"nav_mesh\" file_name=\"" + navMesh + "\" />\n";
+  if (settings.pattern == "crossing") {
+    const char* names[] = {"West", "East"};
+    for (int g = 0; g < 2; ++g) {
+      out << "\t<State name=\"" << names[g] << "\" final=\"0\" >\n"
+          << "\t\t<GoalSelector type=\"nearest\" goal_set=\"" << g << "\" />\n"
+          << velocity << "\t</State>\n";
+    }
+  } else {
+    const char* selector = settings.pattern == "random" ? "random" : "nearest";
+    out << "\t<State name=\"Walk\" final=\"0\" >\n"
+        << "\t\t<GoalSelector type=\"" << selector << "\" goal_set=\"0\" />\n"
+        << velocity << "\t</State>\n";
+  }
+  if (settings.pattern != "random") {
+    out << "\t<State name=\"Stop\" final=\"1\" >\n"
+        << "\t\t<GoalSelector type=\"identity\" />\n"
+        << "\t\t<VelComponent type=\"zero\" />\n\t</State>\n\n";
+  }
+  const char* condition = "\t\t<Condition type=\"goal_reached\" distance=\"0.5\" />\n";
+  if (settings.pattern == "crossing") {
+    out << "\t<Transition from=\"West,East\" to=\"Stop\" >\n" << condition << "\t</Transition>\n";
+  } else if (settings.pattern == "random") {
+    // Reaching a goal selects the next one.
+    out << "\n\t<Transition from=\"Walk\" to=\"Walk\" >\n" << condition << "\t</Transition>\n";
+  } else {
+    out << "\t<Transition from=\"Walk\" to=\"Stop\" >\n" << condition << "\t</Transition>\n";
+  }
+  out << "</BFSM>\n";
+  return out.good();
+}
+
+void writeGroup(std::ostream& out, const std::string& state, const std::vector<double>& positions,
+                const std::vector<size_t>& members) {
+  out << "\t<AgentGroup>\n"
+      << "\t\t<ProfileSelector type=\"const\" name=\"pedestrian\" />\n"
+      << "\t\t<StateSelector type=\"const\" name=\"" << state << "\" />\n"
+      << "\t\t<Generator type=\"explicit\" >\n";
+  for (size_t m = 0; m < members.size(); ++m) {
+    const size_t a = members[m];
+    out << "\t\t\t<Agent p_x=\"" << positions[2 * a] << "\" p_y=\"" << positions[2 * a + 1]
+        << "\" />\n";
+  }
+  out << "\t\t</Generator>\n\t</AgentGroup>\n";
+}
+
+bool writeScene(const std::string& fileName, const std::string& navMesh,
+                const std::vector<double>& positions, const Settings& settings,
+                const std::string& description) {
+  std::ofstream out(fileName.c_str());
+  if (!out.is_open()) return false;
+  out << std::fixed << std::setprecision(3);
+  out << "<?xml version=\"1.0\"?>\n<!-- " << description << " -->\n"
+      << "<Experiment version=\"2.0\">\n"
+      << "\t<SpatialQuery type=\"kd-tree\" test_visibility=\"false\" />\n"
+      << "\t<Common time_step=\"0.1\" />\n\n"
+      << "\t<AgentProfile name=\"pedestrian\" >\n"
+      << "\t\t<Common max_angle_vel=\"360\" max_neighbors=\"10\" obstacleSet=\"1\" "
+         "neighbor_dist=\"5\" r=\""
+      << AGENT_RADIUS << "\" class=\"1\" pref_speed=\"1.04\" max_speed=\"2\" max_accel=\"5\" />\n"
+      << "\t\t<PedVO factor=\"1.57\" buffer=\"0.9\" tau=\"3\" tauObst=\"0.1\" "
+         "turningBias=\"1.0\" />\n"
+      << "\t\t<ORCA tau=\"3.0\" tauObst=\"0.15\" />\n"
+      << "\t</AgentProfile>\n\n";
+  const size_t count = positions.size() / 2;
+  if (settings.pattern == "crossing") {
+    std::vector<size_t> west, east;
+    for (size_t a = 0; a < count; ++a) (positions[2 * a] < 0.0 ? west : east).push_back(a);
+    // The agents in the west walk to the east.
+    writeGroup(out, "East", positions, west);
+    writeGroup(out, "West", positions, east);
+  } else {
+    std::vector<size_t> all(count);
+    for (size_t a = 0; a < count; ++a) all[a] = a;
+    writeGroup(out, "Walk", positions, all);
+  }
+  out << "\n\t<ObstacleSet type=\"nav_mesh\" file_name=\"" << navMesh << "\" class=\"1\" />\n"
+      << "</Experiment>\n";
+  return out.good();
+}
+
+bool writeView(const std::string& fileName, const CellGrid& grid) {
+  std::ofstream out(fileName.c_str());
+  if (!out.is_open()) return false;
+  const double extent = std::max(grid.width(), grid.height()) * grid.cellSize();
+  out << "<?xml version=\"1.0\"?>\n\n<View width=\"640\" height=\"480\" z_up=\"1\" >\n"
+      << "\t<Camera xpos=\"0\" ypos=\"-0.01\" zpos=\"" << extent << "\" xtgt=\"0\" ytgt=\"0\" "
+      << "ztgt=\"0\" far=\"" << 4.0 * extent << "\" near=\"0.01\" fov=\"0\" orthoScale=\""
+      << extent / 40.0 << "\" />\n"
+      << "\t<Light x=\"1\" y=\"0\" z=\"-1\" type=\"directional\" space=\"camera\" diffR=\"1\" "
+         "diffG=\"0.8\" diffB=\"0.8\" />\n"
+      << "\t<Light x=\"0\" y=\"0\" z=\"1\" type=\"directional\" space=\"world\" diffR=\"0.8\" "
+         "diffG=\"0.8\" diffB=\"0.8\" />\n"
+      << "</View>\n";
+  return out.good();
+}
+
+bool writeProject(const std::string& fileName, const std::string& name, const std::string& model) {
+  std::ofstream out(fileName.c_str());
+  if (!out.is_open()) return false;
+  out << "<?xml version=\"1.0\"?>\n\n<Project\n"
+      << "\tscene=\"" << name << "/" << name << "S.xml\"\n"
+      << "\tbehavior=\"" << name << "/" << name << "B.xml\"\n"
+      << "\tview=\"" << name << "/" << name << "V.xml\"\n"
+      << "\tmodel=\"" << model << "\"\n/>\n";
+  return out.good();
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  Settings settings;
+  std::string outDir = ".";
+  std::string name = "synthetic";
+  std::string model = "orca";
+  try {
+    TCLAP::CmdLine cmd("Generates large, synthetic simulation scenarios. ", ' ', "0.1");
+    TCLAP::ValueArg<std::string> outArg("o", "out", "The directory the project is written to.",
+                                        false, outDir, "string", cmd);
+    TCLAP::ValueArg<std::string> nameArg("n", "name", "The name of the project.", false, name,
+                                         "string", cmd);
+    TCLAP::ValueArg<std::string> layoutArg("l", "layout", "The layout: open, grid, maze or venue.",
+                                           false, "grid", "string", cmd);
+    TCLAP::ValueArg<std::string> patternArg(
+        "g", "goals", "The goal pattern: exits, crossing or random.", false, "exits", "string",
+        cmd);
+    TCLAP::ValueArg<size_t> agentArg("a", "agents", "The number of agents.", false, 10000, "int",
+                                     cmd);
+    TCLAP::ValueArg<double> densityArg("d", "density",
+                                       "The initial density of the agents (agents per m^2).",
+                                       false, 1.0, "float", cmd);
+    TCLAP::ValueArg<double> cellArg("c", "cell", "The size of the layout's cells (m).", false, 2.0,
+                                    "float", cmd);
+    TCLAP::ValueArg<size_t> goalCountArg("", "goalCount",
+                                         "The number of goals for the random pattern.", false, 16,
+                                         "int", cmd);
+    TCLAP::ValueArg<unsigned int> seedArg("s", "seed", "The random seed.", false, 1, "int", cmd);
+    TCLAP::ValueArg<std::string> modelArg("m", "model", "The pedestrian model of the project.",
+                                          false, model, "string", cmd);
+    cmd.parse(argc, argv);
+    outDir = outArg.getValue();
+    name = nameArg.getValue();
+    model = modelArg.getValue();
+    settings.layout = layoutArg.getValue();
+    settings.pattern = patternArg.getValue();
+    settings.agents = agentArg.getValue();
+    settings.density = densityArg.getValue();
+    settings.cellSize = cellArg.getValue();
+    settings.goalCount = goalCountArg.getValue();
+    settings.seed = seedArg.getValue();
+  } catch (TCLAP::ArgException& e) {
+    std::cerr << "Error parsing command-line arguments: " << e.error() << " for arg " << e.argId()
+              << "\n";
+    return 1;
+  }
+  const std::string layouts = ",open,grid,maze,venue,";
+  const std::string patterns = ",exits,crossing,random,";
+  if (layouts.find("," + settings.layout + ",") == std::string::npos ||
+      patterns.find("," + settings.pattern + ",") == std::string::npos) {
+    std::cerr << "Unknown layout or goal pattern.\n";
+    return 1;
+  }
+  if (settings.agents == 0 || settings.density <= 0.0 || settings.density > 6.0 ||
+      settings.cellSize < 2.0 * WALL_CLEARANCE + 0.1) {
+    std::cerr << "The agent count, density (at most 6 agents/m^2) or cell size is invalid.\n";
+    return 1;
+  }
+
+  // Grow the layout until the agents fit (each attempt restarts from the seed).
+  double side = std::sqrt(settings.agents / settings.density / freeFraction(settings.layout));
+  CellGrid grid(1, 1, settings.cellSize);
+  std::vector<double> positions;
+  Random random(settings.seed);
+  for (int attempt = 0;; ++attempt) {
+    random = Random(settings.seed);
+    grid = makeLayout(settings, side, random);
+    positions = placeAgents(grid, settings.density, random);
+    const size_t placed = positions.size() / 2;
+    if (placed >= settings.agents) break;
+    if (attempt == 20) {
+      std::cerr << "Unable to place the agents.\n";
+      return 1;
+    }
+    side *= std::max(1.02, 1.01 * std::sqrt(static_cast<double>(settings.agents) / (placed + 1)));
+  }
+  // A random subset of the lattice, in a random order.
+  {
+    std::vector<size_t> order(positions.size() / 2);
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    random.shuffle(order);
+    std::vector<double> chosen(2 * settings.agents);
+    for (size_t a = 0; a < settings.agents; ++a) {
+      chosen[2 * a] = positions[2 * order[a]];
+      chosen[2 * a + 1] = positions[2 * order[a] + 1];
+    }
+    positions.swap(chosen);
+  }
+  const std::vector<std::vector<Box> > goalSets = makeGoals(grid, settings, random);
+  size_t goalCount = 0;
+  for (size_t s = 0; s < goalSets.size(); ++s) goalCount += goalSets[s].size();
+
+  const std::string folder = os::path::join(2, outDir.c_str(), name.c_str());
+  if (!os::makedirs(folder)) {
+    std::cerr << "Unable to create the folder: " << folder << "\n";
+    return 1;
+  }
+  std::ostringstream description;
+  description << "Generated by scenarioGen: layout=" << settings.layout
+              << " goals=" << settings.pattern << " agents=" << settings.agents
+              << " density=" << settings.density << " cell=" << settings.cellSize
+              << " seed=" << settings.seed;
+  const std::string navMesh = name + ".nav";
+  size_t nodeCount = 0;
+  bool written = writeNavMesh(os::path::join(2, folder.c_str(), navMesh.c_str()), grid, nodeCount);
+  written = written && writeScene(os::path::join(2, folder.c_str(), (name + "S.xml").c_str()),
+                                  navMesh, positions, settings, description.str());
+  written = written && writeBehavior(os::path::join(2, folder.c_str(), (name + "B.xml").c_str()),
+                                     navMesh, goalSets, settings);
+  written = written && writeView(os::path::join(2, folder.c_str(), (name + "V.xml").c_str()), grid);
+  const std::string project = os::path::join(2, outDir.c_str(), (name + ".xml").c_str());
+  written = written && writeProject(project, name, model);
+  if (!written) {
+    std::cerr << "Unable to write the scenario to " << folder << "\n";
+    return 1;
+  }
+  std::cout << description.str() << "\n"
+            << "  " << grid.width() << " x " << grid.height() << " cells ("
+            << grid.width() * grid.cellSize() << " m x " << grid.height() * grid.cellSize()
+            << " m), " << nodeCount << " navigation mesh nodes, " << goalCount << " goals\n"
+            << "  Project: " << project << "\n";
+  return 0;
+}
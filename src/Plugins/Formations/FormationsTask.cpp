@@ -39,6 +39,7 @@ Any questions or comments should be sent to the authors {menge,geom}@cs.unc.edu
 #include "FormationsTask.h"
 #include "FreeFormation.h"
 #include "MengeCore/BFSM/FSM.h"
+#include "MengeCore/Runtime/TraceRecorder.h"
 
 namespace Formations {
 
@@ -46,6 +47,7 @@ using Menge::BFSM::FSM;
 using Menge::BFSM::Task;
 using Menge::BFSM::TaskException;
 using Menge::BFSM::TaskFactory;
+using Menge::BFSM::TaskResources;
 
 /////////////////////////////////////////////////////////////////////
 //                   Implementation of FormationsTask
@@ -56,10 +58,19 @@ FormationsTask::FormationsTask(Formations::FormationPtr& f) : Task(), _formation
 /////////////////////////////////////////////////////////////////////
 
 void FormationsTask::doWork(const FSM* fsm) throw(TaskException) {
+  TraceScope span("FormationsTask", "task");
   _formation->mapAgentsToFormation(fsm);
 }
 /////////////////////////////////////////////////////////////////////
 
+bool FormationsTask::getResources(TaskResources& resources) const {
+  resources.addRead(TaskResources::AGENTS);
+  resources.addWrite(_formation.get());
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
 std::string FormationsTask::toString() const { return "Formation Task"; }
 
 /////////////////////////////////////////////////////////////////////
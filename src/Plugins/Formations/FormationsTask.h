@@ -60,6 +60,14 @@ class FormationsTask : public Menge::BFSM::Task {
    */
   virtual void doWork(const Menge::BFSM::FSM* fsm) throw(Menge::BFSM::TaskException);
 
+  /*!
+   @brief		The task reads the agents and writes the formation.
+
+   @param		resources		The resources to which the task adds its reads and writes.
+   @returns	True.
+   */
+  virtual bool getResources(Menge::BFSM::TaskResources& resources) const;
+
   /*!
    @brief		String representation of the task
 
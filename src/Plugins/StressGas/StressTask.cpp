@@ -2,11 +2,14 @@
 #include "StressGlobals.h"
 
 #include "MengeCore/BFSM/FSM.h"
+#include "MengeCore/Runtime/TraceRecorder.h"
 
 namespace StressGAS {
 
 using Menge::BFSM::FSM;
 using Menge::BFSM::TaskException;
+using Menge::BFSM::TaskResources;
+using Menge::TraceScope;
 
 /////////////////////////////////////////////////////////////////////
 //                   Implementation of DensityGridTask
@@ -17,11 +20,20 @@ StressTask::StressTask() : Task() {}
 /////////////////////////////////////////////////////////////////////
 
 void StressTask::doWork(const FSM* fsm) throw(TaskException) {
+  TraceScope span("StressTask", "task");
   StressGAS::STRESS_MANAGER->updateStress();
 }
 
 /////////////////////////////////////////////////////////////////////
 
+bool StressTask::getResources(TaskResources& resources) const {
+  resources.addWrite(TaskResources::AGENTS);
+  resources.addWrite(STRESS_MANAGER);
+  return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+
 std::string StressTask::toString() const { return "Stress Task"; }
 
 /////////////////////////////////////////////////////////////////////
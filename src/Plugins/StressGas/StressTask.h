@@ -59,6 +59,14 @@ class StressTask : public Menge::BFSM::Task {
    */
   virtual void doWork(const Menge::BFSM::FSM* fsm) throw(Menge::BFSM::TaskException);
 
+  /*!
+   @brief		The task writes the stress manager and the stressed agents' properties.
+
+   @param		resources		The resources to which the task adds its reads and writes.
+   @returns	True.
+   */
+  virtual bool getResources(Menge::BFSM::TaskResources& resources) const;
+
   /*!
    @brief		String representation of the task
 
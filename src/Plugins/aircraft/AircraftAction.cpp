@@ -72,18 +72,16 @@ PropertyXAction::PropertyXAction()
       _originValue(0.f),
       _scale(0.f),
       _property(NO_PROPERTY),
-      _originalMap(),
-      _lock() {}
+      _originalMap() {}
 
 /////////////////////////////////////////////////////////////////////
 
-PropertyXAction::~PropertyXAction() { _originalMap.clear(); }
+PropertyXAction::~PropertyXAction() {}
 
 /////////////////////////////////////////////////////////////////////
 
 void PropertyXAction::onEnter(BaseAgent* agent) {
   float value = (agent->_pos.x() - _xOrigin) * _scale + _originValue;
-  _lock.lock();
   switch (_property) {
     case MAX_SPEED:
       if (_undoOnExit) _originalMap[agent->_id] = agent->_maxSpeed;
@@ -117,20 +115,13 @@ void PropertyXAction::onEnter(BaseAgent* agent) {
       // NO_PROPERTY is considered a no-op.
       break;
   }
-  _lock.release();
 }
 
 /////////////////////////////////////////////////////////////////////
 
 void PropertyXAction::leaveAction(BaseAgent* agent) {
   if (_undoOnExit) {
-    _lock.lock();
-    std::map<size_t, float>::iterator itr = _originalMap.find(agent->_id);
-    assert(itr != _originalMap.end() &&
-           "An agent is exiting a state that it apparently never entered");
-    float value = itr->second;
-    _originalMap.erase(itr);
-    _lock.release();
+    float value = _originalMap[agent->_id];
     switch (_property) {
       case MAX_SPEED:
         agent->_maxSpeed = value;
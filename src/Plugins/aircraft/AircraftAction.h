@@ -25,11 +25,10 @@
 
 #include "AircraftConfig.h"
 
-#include <map>
 #include "MengeCore/BFSM/Actions/Action.h"
 #include "MengeCore/BFSM/Actions/ActionFactory.h"
+#include "MengeCore/BFSM/AgentSideTable.h"
 #include "MengeCore/BFSM/FSMEnumeration.h"
-#include "MengeCore/Runtime/SimpleLock.h"
 
 // forward declaration
 class TiXmlElement;
@@ -98,14 +97,9 @@ class EXPORT_API PropertyXAction : public Menge::BFSM::Action {
   Menge::BFSM::PropertyOperand _property;
 
   /*!
-   @brief		A mapping from agent id to the agent's property value before the action was applied.
+   @brief		The agents' property values before the action was applied.
    */
-  std::map<size_t, float> _originalMap;
-
-  /*!
-   @brief		Lock to protect _originalMap.
-   */
-  Menge::SimpleLock _lock;
+  Menge::BFSM::AgentSideTable<float> _originalMap;
 };
 
 /*!
@@ -0,0 +1,176 @@
+#ifndef __SCENE_FIXTURE_H__
+#define __SCENE_FIXTURE_H__
+
+/*!
+ @file    SceneFixture.h
+ @brief   Builds the scene specifications the simulation tests run and loads them with a
+          behavior specification into the simulator.
+ */
+
+#include "MengeCore/Math/Vector2.h"
+#include "MengeCore/menge_c_api.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace SceneFixture {
+
+/*!
+ @brief   The xml for an ORCA agent profile with the tests' common properties.
+
+ @param   name        The name of the profile.
+ @param   attributes  Additional attributes of the profile's Common element.
+ @returns The AgentProfile element.
+ */
+inline std::string profile(const std::string& name, const std::string& attributes = "") {
+  std::stringstream ss;
+  ss << "  <AgentProfile name=\"" << name << "\">\n"
+     << "    <Common max_angle_vel=\"360\" max_neighbors=\"10\" obstacleSet=\"1\""
+     << " neighbor_dist=\"5\" r=\"0.2\" class=\"1\" pref_speed=\"1.3\" max_speed=\"2\""
+     << " max_accel=\"5\" " << attributes << "/>\n"
+     << "    <ORCA tau=\"3.0\" tauObst=\"0.15\" />\n"
+     << "  </AgentProfile>\n";
+  return ss.str();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+/*!
+ @brief   The xml for an agent profile which overrides some of another profile's properties.
+
+ @param   name        The name of the profile.
+ @param   parent      The name of the inherited profile.
+ @param   attributes  The overridden attributes of the profile's Common element.
+ @returns The AgentProfile element.
+ */
+inline std::string derivedProfile(const std::string& name, const std::string& parent,
+                                  const std::string& attributes) {
+  return "  <AgentProfile name=\"" + name + "\" inherits=\"" + parent + "\">\n    <Common " +
+         attributes + " />\n  </AgentProfile>\n";
+}
+
+/////////////////////////////////////////////////////////////////////
+
+/*!
+ @brief   The xml for a generator which places agents at the given positions, in order.
+ */
+inline std::string agentsAt(const std::vector<Menge::Math::Vector2>& positions) {
+  std::stringstream ss;
+  ss << "    <Generator type=\"explicit\">\n";
+  for (size_t i = 0; i < positions.size(); ++i) {
+    ss << "      <Agent p_x=\"" << positions[i].x() << "\" p_y=\"" << positions[i].y()
+       << "\" />\n";
+  }
+  ss << "    </Generator>\n";
+  return ss.str();
+}
+
+/////////////////////////////////////////////////////////////////////
+
+/*!
+ @brief   The positions of `count` agents in a row along the x-axis, one unit apart.
+ */
+inline std::vector<Menge::Math::Vector2> row(size_t count) {
+  std::vector<Menge::Math::Vector2> positions;
+  for (size_t i = 0; i < count; ++i) {
+    positions.push_back(Menge::Math::Vector2(static_cast<float>(i), 0.f));
+  }
+  return positions;
+}
+
+/////////////////////////////////////////////////////////////////////
+
+/*!
+ @brief   The xml for a group of agents which exist from the start of the simulation.
+
+ @param   profile     The name of the agents' profile.
+ @param   state       The name of the agents' initial state.
+ @param   generator   The xml of the agents' generator.
+ @returns The AgentGroup element.
+ */
+inline std::string group(const std::string& profile, const std::string& state,
+                         const std::string& generator) {
+  return "  <AgentGroup>\n    <ProfileSelector type=\"const\" name=\"" + profile +
+         "\" />\n    <StateSelector type=\"const\" name=\"" + state + "\" />\n" + generator +
+         "  </AgentGroup>\n";
+}
+
+/////////////////////////////////////////////////////////////////////
+
+/*!
+ @brief   The xml for a source which adds agents as the simulation runs.
+
+ @param   attributes  The source's timing attributes (e.g., rate and end_time).
+ @param   profile     The name of the agents' profile.
+ @param   state       The name of the agents' initial state.
+ @param   generator   The xml of the agents' generator.
+ @returns The AgentSource element.
+ */
+inline std::string source(const std::string& attributes, const std::string& profile,
+                          const std::string& state, const std::string& generator) {
+  return "  <AgentSource " + attributes + ">\n    <ProfileSelector type=\"const\" name=\"" +
+         profile + "\" />\n    <StateSelector type=\"const\" name=\"" + state + "\" />\n" +
+         generator + "  </AgentSource>\n";
+}
+
+/////////////////////////////////////////////////////////////////////
+
+/*!
+ @brief   The xml for a scene with a time step of 0.1 seconds and no obstacles.
+
+ @param   elements    The scene's profiles, groups and sources.
+ @returns The scene specification.
+ */
+inline std::string scene(const std::string& elements) {
+  return "<?xml version=\"1.0\"?>\n"
+         "<Experiment version=\"2.0\">\n"
+         "  <SpatialQuery type=\"kd-tree\" test_visibility=\"false\" />\n"
+         "  <Common time_step=\"0.1\" />\n" +
+         elements + "</Experiment>\n";
+}
+
+/////////////////////////////////////////////////////////////////////
+
+/*!
+ @brief   The xml for a scene of agents which start in the given state at the given positions.
+ */
+inline std::string stationaryScene(const std::string& state,
+                                   const std::vector<Menge::Math::Vector2>& positions) {
+  return scene(profile("group1") + group("group1", state, agentsAt(positions)));
+}
+
+/////////////////////////////////////////////////////////////////////
+
+/*!
+ @brief   Loads the scene and behavior into the simulator with the ORCA pedestrian model.
+
+ The specifications are written to files named after the test and removed once they are loaded.
+
+ @param   name        A name for the files, unique to the test.
+ @param   sceneXml    The scene specification.
+ @param   behaviorXml The behavior specification.
+ @returns True if the simulator was initialized.
+ */
+inline bool loadSimulation(const std::string& name, const std::string& sceneXml,
+                           const std::string& behaviorXml) {
+  const std::string sceneFile = "test_" + name + "S.xml";
+  const std::string behaviorFile = "test_" + name + "B.xml";
+  {
+    std::ofstream out(sceneFile.c_str());
+    out << sceneXml;
+  }
+  {
+    std::ofstream out(behaviorFile.c_str());
+    out << behaviorXml;
+  }
+  const bool loaded = InitSimulator(behaviorFile.c_str(), sceneFile.c_str(), "orca");
+  std::remove(sceneFile.c_str());
+  std::remove(behaviorFile.c_str());
+  return loaded;
+}
+}  // namespace SceneFixture
+
+#endif  // __SCENE_FIXTURE_H__
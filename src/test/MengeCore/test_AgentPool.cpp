@@ -0,0 +1,107 @@
+#include "MengeCore/Orca/ORCAInitializer.h"
+#include "MengeCore/Orca/ORCASimulator.h"
+#include "MengeCore/menge_c_api.h"
+#include "SceneFixture.h"
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+using namespace Menge;
+using Menge::Agents::AgentHandle;
+using Menge::Agents::BaseAgent;
+using Menge::Math::Vector2;
+
+namespace {
+// Exposes the removal of agents from the pool.
+class PoolSimulator : public ORCA::Simulator {
+ public:
+  using ORCA::Simulator::removeAgent;
+};
+
+// A corridor with two agent sources; agents are retired when they reach the far end.
+std::string corridor() {
+  using namespace SceneFixture;
+  return scene(profile("walker") +
+               source("rate=\"5\" end_time=\"4\"", "walker", "Walk",
+                      agentsAt({Vector2(-4.f, -1.f), Vector2(-4.f, 1.f)})) +
+               source("rate=\"10\" start_time=\"1\" max_agents=\"3\"", "walker", "Walk",
+                      agentsAt({Vector2(-4.f, 3.f)})));
+}
+
+const char* BEHAVIOR =
+    "<?xml version=\"1.0\"?>\n"
+    "<BFSM>\n"
+    "  <GoalSet id=\"0\">\n"
+    "    <Goal type=\"AABB\" id=\"0\" min_x=\"3\" min_y=\"-2\" max_x=\"5\" max_y=\"4\"/>\n"
+    "  </GoalSet>\n"
+    "  <State name=\"Walk\" final=\"0\">\n"
+    "    <GoalSelector type=\"explicit\" goal_set=\"0\" goal=\"0\" />\n"
+    "    <VelComponent type=\"goal\" />\n"
+    "  </State>\n"
+    "  <State name=\"Gone\" final=\"1\">\n"
+    "    <GoalSelector type=\"identity\" />\n"
+    "    <VelComponent type=\"zero\" />\n"
+    "    <Action type=\"retire\" />\n"
+    "  </State>\n"
+    "  <Transition from=\"Walk\" to=\"Gone\">\n"
+    "    <Condition type=\"goal_reached\" distance=\"0.5\"/>\n"
+    "  </Transition>\n"
+    "</BFSM>\n";
+}  // namespace
+
+// Removed agents' identifiers are recycled, handles detect the reuse and agents never move.
+TEST(AgentPoolTest, recyclesIdentifiers) {
+  PoolSimulator sim;
+  ORCA::AgentInitializer init;
+  std::vector<BaseAgent*> agents;
+  for (int i = 0; i < 5; ++i) agents.push_back(sim.addAgent(Vector2(i, 0.f), &init));
+  for (size_t i = 0; i < agents.size(); ++i) EXPECT_EQ(agents[i]->_id, i);
+  const AgentHandle handle = sim.getAgentHandle(agents[3]);
+  EXPECT_EQ(sim.getAgentByHandle(handle), agents[3]);
+
+  sim.removeAgent(agents[1]);
+  sim.removeAgent(agents[3]);
+  EXPECT_EQ(sim.getNumAgents(), 3u);
+  EXPECT_EQ(sim.getAgentById(1), (BaseAgent*)0x0);
+  EXPECT_EQ(sim.getAgentById(4), agents[4]);
+  EXPECT_EQ(sim.getAgentByHandle(handle), (BaseAgent*)0x0);
+  for (size_t i = 0; i < sim.getNumAgents(); ++i) {
+    EXPECT_NE(sim.getAgent(i)->_id % 2, 1u) << "Retired agent " << sim.getAgent(i)->_id;
+  }
+
+  // The most recently released identifier is reused first.
+  BaseAgent* agent = sim.addAgent(Vector2(10.f, 0.f), &init);
+  EXPECT_EQ(agent->_id, 3u);
+  EXPECT_EQ(agent, agents[3]);
+  EXPECT_EQ(sim.getAgentByHandle(handle), (BaseAgent*)0x0);
+  EXPECT_EQ(sim.getAgentByHandle(sim.getAgentHandle(agent)), agent);
+  EXPECT_EQ(agent->_pos.x(), 10.f);
+
+  // Growing the pool doesn't move existing agents.
+  for (int i = 0; i < 3000; ++i) sim.addAgent(Vector2(0.f, i), &init);
+  EXPECT_EQ(sim.getNumAgents(), 3004u);
+  EXPECT_EQ(sim.getAgentById(0), agents[0]);
+  EXPECT_EQ(sim.getAgentById(4), agents[4]);
+  EXPECT_EQ(agents[4]->_pos.x(), 4.f);
+  EXPECT_EQ(sim.getAgentById(1)->_pos.y(), 0.f);
+}
+
+// Agent sources populate an empty scene and the retire action empties it again.
+TEST(AgentPoolTest, spawnsAndRetiresAgents) {
+  ASSERT_TRUE(SceneFixture::loadSimulation("pool", corridor(), BEHAVIOR));
+  EXPECT_EQ(AgentCount(), 0u);
+
+  size_t peak = 0;
+  int steps = 0;
+  bool running = true;
+  for (; running && steps < 1000; ++steps) {
+    running = DoStep();
+    peak = std::max(peak, AgentCount());
+  }
+  EXPECT_FALSE(running);
+  EXPECT_EQ(AgentCount(), 0u);
+  // The first source spawns 21 agents; some may have been retired before the peak.
+  EXPECT_GT(peak, 10u);
+  EXPECT_LE(peak, 24u);
+}
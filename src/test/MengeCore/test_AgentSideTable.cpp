@@ -0,0 +1,36 @@
+#include "MengeCore/BFSM/AgentSideTable.h"
+#include "gtest/gtest.h"
+
+using Menge::BFSM::AgentSideTable;
+using Menge::BFSM::AgentSideTableBase;
+
+// Tables are created with the current capacity, grow together and copies are independent.
+TEST(AgentSideTableTest, growsWithTheAgentCapacity) {
+  AgentSideTableBase::reserveAll(10);
+  const size_t capacity = AgentSideTableBase::getCapacity();
+  ASSERT_GE(capacity, 10u);
+
+  AgentSideTable<float> times(-1.f);
+  ASSERT_EQ(times.size(), capacity);
+  for (size_t i = 0; i < times.size(); ++i) EXPECT_TRUE(times.isEmpty(i));
+  times[3] = 2.5f;
+  EXPECT_FALSE(times.isEmpty(3));
+
+  AgentSideTable<float> copy(times);
+  EXPECT_EQ(copy[3], 2.5f);
+  copy.clear(3);
+  EXPECT_TRUE(copy.isEmpty(3));
+  EXPECT_EQ(times[3], 2.5f);
+
+  // Growing preserves existing values and fills new entries with the empty value.
+  AgentSideTableBase::reserveAll(capacity + 100);
+  EXPECT_EQ(times.size(), capacity + 100);
+  EXPECT_EQ(copy.size(), capacity + 100);
+  EXPECT_EQ(times[3], 2.5f);
+  EXPECT_EQ(times[capacity + 99], -1.f);
+
+  // Tables are never shrunk.
+  AgentSideTableBase::reserveAll(5);
+  EXPECT_EQ(times.size(), capacity + 100);
+  EXPECT_EQ(AgentSideTableBase::getCapacity(), capacity + 100);
+}
@@ -0,0 +1,87 @@
+#include "MengeCore/Agents/BaseAgent.h"
+#include "MengeCore/Agents/SimulatorInterface.h"
+#include "MengeCore/Core.h"
+#include "MengeCore/menge_c_api.h"
+#include "SceneFixture.h"
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+using namespace Menge;
+using Menge::Agents::BaseAgent;
+using Menge::Math::Vector2;
+
+namespace {
+// A row of seated agents which can sleep and a walker which has to pass through the row.
+std::string seatedRow() {
+  using namespace SceneFixture;
+  std::vector<Vector2> seats = row(4);
+  seats.push_back(Vector2(1.f, 8.f));
+  return scene(profile("seated", "sleep_speed=\"0.05\" sleep_delay=\"0.5\"") +
+               derivedProfile("walker", "seated", "class=\"2\" sleep_speed=\"0\"") +
+               group("seated", "Sit", agentsAt(seats)) +
+               group("walker", "Walk", agentsAt({Vector2(-12.f, 0.1f)})));
+}
+
+const char* BEHAVIOR =
+    "<?xml version=\"1.0\"?>\n"
+    "<BFSM>\n"
+    "  <GoalSet id=\"0\">\n"
+    "    <Goal type=\"point\" id=\"0\" x=\"20\" y=\"0.1\"/>\n"
+    "  </GoalSet>\n"
+    "  <State name=\"Sit\" final=\"1\">\n"
+    "    <GoalSelector type=\"identity\" />\n"
+    "    <VelComponent type=\"zero\" />\n"
+    "  </State>\n"
+    "  <State name=\"Walk\" final=\"0\">\n"
+    "    <GoalSelector type=\"explicit\" goal_set=\"0\" goal=\"0\" />\n"
+    "    <VelComponent type=\"goal\" />\n"
+    "  </State>\n"
+    "  <State name=\"Done\" final=\"1\">\n"
+    "    <GoalSelector type=\"identity\" />\n"
+    "    <VelComponent type=\"zero\" />\n"
+    "  </State>\n"
+    "  <Transition from=\"Walk\" to=\"Done\">\n"
+    "    <Condition type=\"goal_reached\" distance=\"0.2\"/>\n"
+    "  </Transition>\n"
+    "</BFSM>\n";
+
+size_t sleepingCount() {
+  size_t count = 0;
+  for (size_t i = 0; i < SIMULATOR->getNumAgents(); ++i) {
+    if (SIMULATOR->getAgent(i)->isAsleep()) ++count;
+  }
+  return count;
+}
+}  // namespace
+
+// Idle agents fall asleep, are woken by an approaching agent (which still avoids them) and fall
+// asleep again once it has passed.
+TEST(AgentSleepTest, sleepsAndWakesIdleAgents) {
+  ASSERT_TRUE(SceneFixture::loadSimulation("sleep", seatedRow(), BEHAVIOR));
+  ASSERT_EQ(AgentCount(), 6u);
+  EXPECT_EQ(sleepingCount(), 0u);
+
+  for (int i = 0; i < 10; ++i) DoStep();
+  EXPECT_EQ(sleepingCount(), 5u);
+
+  size_t fewestSleeping = 5;
+  float closest = 1e6f;
+  bool running = true;
+  int steps = 0;
+  for (; running && steps < 1000; ++steps) {
+    running = DoStep();
+    fewestSleeping = std::min(fewestSleeping, sleepingCount());
+    const BaseAgent* walker = SIMULATOR->getAgent(5);
+    for (size_t i = 0; i < 4; ++i) {
+      closest = std::min(closest, abs(SIMULATOR->getAgent(i)->_pos - walker->_pos));
+    }
+    // The distant seated agent is never disturbed.
+    EXPECT_TRUE(SIMULATOR->getAgent(4)->isAsleep());
+  }
+  EXPECT_FALSE(running);
+  EXPECT_LT(fewestSleeping, 4u);
+  EXPECT_GT(closest, 0.38f);
+  EXPECT_EQ(sleepingCount(), 5u);
+}
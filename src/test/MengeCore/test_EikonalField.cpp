@@ -0,0 +1,49 @@
+#include "MengeCore/Math/Geometry2D.h"
+#include "MengeCore/resources/EikonalField.h"
+#include "gtest/gtest.h"
+
+using namespace Menge;
+using Menge::Math::CircleShape;
+using Menge::Math::Vector2;
+
+namespace {
+// A 10x10 room with a wall at x = 5 that leaves a gap at the top (y > 7).
+void buildRoom(EikonalFieldBuilder& builder) {
+  builder.addObstacle(Vector2(0.f, 0.f), Vector2(10.f, 0.f));
+  builder.addObstacle(Vector2(10.f, 0.f), Vector2(10.f, 10.f));
+  builder.addObstacle(Vector2(10.f, 10.f), Vector2(0.f, 10.f));
+  builder.addObstacle(Vector2(0.f, 10.f), Vector2(0.f, 0.f));
+  builder.addObstacle(Vector2(5.f, 0.f), Vector2(5.f, 7.f));
+}
+}  // namespace
+
+// Without goals there is nothing to compute.
+TEST(EikonalFieldTest, requiresGoals) {
+  EikonalFieldBuilder builder(0.25f);
+  buildRoom(builder);
+  EXPECT_EQ(builder.build("no_goals"), (VectorField*)0x0);
+}
+
+// The field must route agents around the wall rather than through it.
+TEST(EikonalFieldTest, fieldFollowsShortestPath) {
+  EikonalFieldBuilder builder(0.25f);
+  buildRoom(builder);
+  builder.addGoal(new CircleShape(Vector2(8.f, 1.f), 0.5f));
+  VectorField* field = builder.build("room");
+  ASSERT_NE(field, (VectorField*)0x0);
+
+  // Left of the wall, the agent must go up to the gap.
+  Vector2 v = field->getFieldValue(Vector2(2.f, 1.f));
+  EXPECT_NEAR(abs(v), 1.f, 1e-4f);
+  EXPECT_GT(v.y(), 0.9f);
+  // Through the gap, the agent heads right.
+  v = field->getFieldValue(Vector2(4.f, 8.5f));
+  EXPECT_GT(v.x(), 0.5f);
+  // Right of the wall, the agent heads down toward the goal.
+  v = field->getFieldValue(Vector2(8.f, 5.f));
+  EXPECT_LT(v.y(), -0.9f);
+  // Inside the goal, the agent stops.
+  v = field->getFieldValue(Vector2(8.f, 1.f));
+  EXPECT_EQ(v, Vector2(0.f, 0.f));
+  field->destroy();
+}
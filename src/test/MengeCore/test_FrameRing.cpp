@@ -0,0 +1,91 @@
+#include "MengeCore/Agents/FrameRing.h"
+#include "MengeCore/Orca/ORCAInitializer.h"
+#include "MengeCore/Orca/ORCASimulator.h"
+#include "gtest/gtest.h"
+
+#include <vector>
+
+using namespace Menge;
+using Menge::Agents::FrameRingAgent;
+using Menge::Agents::FrameRingReader;
+using Menge::Agents::FrameRingWriter;
+using Menge::Agents::FrameView;
+using Menge::Math::Vector2;
+
+namespace {
+const char* RING_NAME = "mengeTestFrameRing";
+
+void moveAgents(ORCA::Simulator& sim, int frame) {
+  for (size_t i = 0; i < sim.getNumAgents(); ++i) {
+    Agents::BaseAgent* agt = sim.getAgent(i);
+    agt->_pos = Vector2(i + 0.5f * frame, -1.f * frame);
+    agt->_vel = Vector2(0.5f, -1.f);
+  }
+}
+}  // namespace
+
+// Published frames are visible to a reader until the writer laps them.
+TEST(FrameRingTest, publishedFramesAreReadable) {
+  ORCA::Simulator sim;
+  ORCA::AgentInitializer init;
+  const size_t AGT_COUNT = 12;
+  const size_t SLOTS = 4;
+  for (size_t i = 0; i < AGT_COUNT; ++i) sim.addAgent(Vector2(0.f, 0.f), &init);
+
+  FrameRingWriter writer;
+  ASSERT_TRUE(writer.open(RING_NAME, AGT_COUNT, SLOTS));
+  FrameRingReader reader;
+  ASSERT_TRUE(reader.open(RING_NAME));
+  EXPECT_EQ(reader.getSlotCount(), SLOTS);
+  EXPECT_EQ(reader.getMaxAgents(), AGT_COUNT);
+  EXPECT_EQ(reader.getLatestSequence(), 0u);
+  FrameView view;
+  EXPECT_FALSE(reader.acquireLatest(view));
+
+  const int FRAME_COUNT = 10;
+  for (int f = 0; f < FRAME_COUNT; ++f) {
+    moveAgents(sim, f);
+    writer.publish(&sim, 0x0);
+  }
+  EXPECT_EQ(reader.getLatestSequence(), static_cast<unsigned long long>(FRAME_COUNT));
+
+  // Only the last SLOTS frames are still in the ring.
+  for (int seq = 1; seq <= FRAME_COUNT; ++seq) {
+    const bool available = seq > FRAME_COUNT - static_cast<int>(SLOTS);
+    ASSERT_EQ(reader.acquire(seq, view), available) << "frame " << seq;
+    if (!available) continue;
+    ASSERT_EQ(view.agentCount, AGT_COUNT);
+    for (size_t a = 0; a < AGT_COUNT; ++a) {
+      EXPECT_EQ(view.agents[a].x, a + 0.5f * (seq - 1));
+      EXPECT_EQ(view.agents[a].y, -1.f * (seq - 1));
+      EXPECT_EQ(view.agents[a].velX, 0.5f);
+      EXPECT_EQ(view.agents[a].id, a);
+    }
+    EXPECT_TRUE(reader.validate(view));
+  }
+
+  // A view is invalidated once the writer reuses its slot.
+  ASSERT_TRUE(reader.acquireLatest(view));
+  for (size_t f = 0; f < SLOTS; ++f) writer.publish(&sim, 0x0);
+  EXPECT_FALSE(reader.validate(view));
+
+  std::vector<FrameRingAgent> agents;
+  ASSERT_TRUE(reader.copyLatest(agents, view));
+  EXPECT_EQ(view.sequence, FRAME_COUNT + SLOTS);
+  EXPECT_EQ(agents.size(), AGT_COUNT);
+}
+
+// A ring only holds its declared number of agents; extra agents are dropped.
+TEST(FrameRingTest, populationIsTruncated) {
+  ORCA::Simulator sim;
+  ORCA::AgentInitializer init;
+  for (size_t i = 0; i < 5; ++i) sim.addAgent(Vector2(0.f, 0.f), &init);
+  FrameRingWriter writer;
+  ASSERT_TRUE(writer.open(RING_NAME, 3, 2));
+  writer.publish(&sim, 0x0);
+  FrameRingReader reader;
+  ASSERT_TRUE(reader.open(RING_NAME));
+  FrameView view;
+  ASSERT_TRUE(reader.acquireLatest(view));
+  EXPECT_EQ(view.agentCount, 3u);
+}
@@ -0,0 +1,177 @@
+#include "MengeCore/BFSM/AgentSideTable.h"
+#include "MengeCore/BFSM/GoalSelectors/GoalSelectorExplicit.h"
+#include "MengeCore/BFSM/GoalSelectors/GoalSelectorRandom.h"
+#include "MengeCore/BFSM/GoalSet.h"
+#include "MengeCore/BFSM/Goals/GoalPoint.h"
+#include "MengeCore/Orca/ORCAAgent.h"
+#include "gtest/gtest.h"
+
+#include <map>
+#include <set>
+#include <vector>
+
+using Menge::Agents::BaseAgent;
+using Menge::BFSM::AgentSideTableBase;
+using Menge::BFSM::ExplicitGoalSelector;
+using Menge::BFSM::Goal;
+using Menge::BFSM::GoalSet;
+using Menge::BFSM::PointGoal;
+using Menge::BFSM::RandomGoalSelector;
+
+// Concurrent assignments never exceed the goal's capacity.
+TEST(GoalCapacityTest, concurrentAssignmentsRespectCapacity) {
+  Goal* goal = new PointGoal(0.f, 0.f);
+  goal->setCapacity(100);
+  int assigned = 0;
+#pragma omp parallel for reduction(+ : assigned)
+  for (int i = 0; i < 4000; ++i) {
+    if (goal->tryAssign()) ++assigned;
+  }
+  EXPECT_EQ(assigned, 100);
+  EXPECT_FALSE(goal->hasCapacity());
+  goal->free();
+  EXPECT_TRUE(goal->hasCapacity());
+  EXPECT_TRUE(goal->tryAssign());
+  EXPECT_FALSE(goal->tryAssign());
+  goal->destroy();
+}
+
+// Threads assigning goals from one goal set, through different selectors, fill every goal exactly
+// and the goal set's list of available goals stays consistent.
+TEST(GoalCapacityTest, concurrentAssignmentsFromASharedGoalSet) {
+  const size_t GOAL_COUNT = 10;
+  const size_t CAPACITY = 20;
+  AgentSideTableBase::reserveAll(GOAL_COUNT * CAPACITY);
+  GoalSet* goalSet = new GoalSet();
+  std::vector<Goal*> goals;
+  for (size_t i = 0; i < GOAL_COUNT; ++i) {
+    Goal* goal = new PointGoal(static_cast<float>(i), 0.f);
+    goal->setID(i);
+    goal->setCapacity(CAPACITY);
+    ASSERT_TRUE(goalSet->addGoal(i, goal));
+    goals.push_back(goal);
+  }
+  std::map<size_t, GoalSet*> goalSets;
+  goalSets[0] = goalSet;
+  RandomGoalSelector* randomSelector = new RandomGoalSelector();
+  randomSelector->setGoalSetID(0);
+  randomSelector->setGoalSet(goalSets);
+  ExplicitGoalSelector* explicitSelector = new ExplicitGoalSelector();
+  explicitSelector->setGoalSetID(0);
+  explicitSelector->setGoalID(0);
+  explicitSelector->setGoalSet(goalSets);
+
+  // Every tenth agent asks for goal 0 explicitly; there are exactly as many agents as the goals'
+  // total capacity, so only the explicit requests which arrive after goal 0 fills fail.
+  const int AGENT_COUNT = static_cast<int>(GOAL_COUNT * CAPACITY);
+  std::vector<ORCA::Agent> agents(AGENT_COUNT);
+  std::vector<Goal*> assigned(AGENT_COUNT, 0x0);
+#pragma omp parallel for schedule(dynamic, 1)
+  for (int i = 0; i < AGENT_COUNT; ++i) {
+    agents[i]._id = i;
+    std::vector<const BaseAgent*> batch(1, &agents[i]);
+    std::vector<Goal*> selected;
+    if (i % 10 != 0 || explicitSelector->assignGoals(batch, selected) == 0) {
+      randomSelector->assignGoals(batch, selected);
+    }
+    assigned[i] = selected[0];
+  }
+  std::map<Goal*, size_t> counts;
+  for (int i = 0; i < AGENT_COUNT; ++i) ++counts[assigned[i]];
+  EXPECT_EQ(counts.count(0x0), 0u);
+  for (size_t i = 0; i < GOAL_COUNT; ++i) {
+    EXPECT_EQ(counts[goals[i]], CAPACITY);
+  }
+  EXPECT_EQ(goalSet->size(), 0u);
+
+  // Freeing every assignment restores every goal to the set.
+#pragma omp parallel for
+  for (int i = 0; i < AGENT_COUNT; ++i) assigned[i]->free();
+  EXPECT_EQ(goalSet->size(), GOAL_COUNT);
+
+  randomSelector->destroy();
+  explicitSelector->destroy();
+  delete goalSet;
+}
+
+// The goal set lists exactly the goals with spare capacity, in whatever order they fill and free up.
+TEST(GoalCapacityTest, availableGoalsTrackCapacity) {
+  const size_t GOAL_COUNT = 50;
+  GoalSet* goalSet = new GoalSet();
+  std::vector<Goal*> goals;
+  for (size_t i = 0; i < GOAL_COUNT; ++i) {
+    Goal* goal = new PointGoal(static_cast<float>(i), 0.f);
+    goal->setID(i);
+    goal->setCapacity(1);
+    ASSERT_TRUE(goalSet->addGoal(i, goal));
+    goals.push_back(goal);
+  }
+  for (size_t i = 0; i < GOAL_COUNT; i += 3) EXPECT_TRUE(goals[i]->tryAssign());
+  for (size_t i = 1; i < GOAL_COUNT; i += 2) {
+    if (goals[i]->hasCapacity()) EXPECT_TRUE(goals[i]->tryAssign());
+  }
+  for (size_t i = 0; i < GOAL_COUNT; i += 9) goals[i]->free();
+
+  std::set<Goal*> listed;
+  for (size_t i = 0; i < goalSet->size(); ++i) listed.insert(goalSet->getIthGoal(i));
+  std::set<Goal*> expected;
+  for (size_t i = 0; i < GOAL_COUNT; ++i) {
+    if (goals[i]->hasCapacity()) expected.insert(goals[i]);
+  }
+  EXPECT_EQ(listed, expected);
+  EXPECT_EQ(listed.size(), goalSet->size());
+  delete goalSet;
+}
+
+// A batch which exhausts the goal set's capacity assigns as many agents as there is capacity for;
+// freed capacity is available to later batches.
+TEST(GoalCapacityTest, batchAssignmentStopsWhenCapacityRunsOut) {
+  AgentSideTableBase::reserveAll(20);
+  GoalSet* goalSet = new GoalSet();
+  for (size_t i = 0; i < 3; ++i) {
+    Goal* goal = new PointGoal(static_cast<float>(i), 0.f);
+    goal->setID(i);
+    goal->setCapacity(i + 2);
+    ASSERT_TRUE(goalSet->addGoal(i, goal));
+  }
+  std::map<size_t, GoalSet*> goalSets;
+  goalSets[0] = goalSet;
+  RandomGoalSelector* selector = new RandomGoalSelector();
+  selector->setGoalSetID(0);
+  selector->setGoalSet(goalSets);
+
+  std::vector<ORCA::Agent> agents(12);
+  std::vector<const BaseAgent*> batch;
+  for (size_t i = 0; i < agents.size(); ++i) {
+    agents[i]._id = i;
+    batch.push_back(&agents[i]);
+  }
+  std::vector<Goal*> goals;
+  // The goals have a total capacity of 2 + 3 + 4.
+  EXPECT_EQ(selector->assignGoals(batch, goals), 9u);
+  ASSERT_EQ(goals.size(), batch.size());
+  std::map<Goal*, size_t> counts;
+  for (size_t i = 0; i < goals.size(); ++i) {
+    if (goals[i] != 0x0) ++counts[goals[i]];
+  }
+  for (std::map<Goal*, size_t>::iterator itr = counts.begin(); itr != counts.end(); ++itr) {
+    if (itr->first != 0x0) {
+      EXPECT_EQ(itr->second, itr->first->getCapacity());
+    }
+  }
+  EXPECT_EQ(goalSet->size(), 0u);
+
+  // Freeing one assignment makes its goal available to the next batch.
+  size_t freed = 0;
+  while (goals[freed] == 0x0) ++freed;
+  Goal* freedGoal = goals[freed];
+  selector->freeGoal(batch[freed], freedGoal);
+  EXPECT_EQ(goalSet->size(), 1u);
+  std::vector<const BaseAgent*> late(1, batch.back());
+  EXPECT_EQ(selector->assignGoals(late, goals), 1u);
+  EXPECT_EQ(goals[0], freedGoal);
+  EXPECT_EQ(goalSet->size(), 0u);
+
+  selector->destroy();
+  delete goalSet;
+}
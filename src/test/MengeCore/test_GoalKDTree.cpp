@@ -0,0 +1,145 @@
+#include "MengeCore/BFSM/AgentSideTable.h"
+#include "MengeCore/BFSM/GoalSelectors/GoalSelectorNearest.h"
+#include "MengeCore/BFSM/GoalSet.h"
+#include "MengeCore/BFSM/Goals/GoalPoint.h"
+#include "MengeCore/Orca/ORCAAgent.h"
+#include "gtest/gtest.h"
+
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+using Menge::Agents::BaseAgent;
+using Menge::BFSM::AgentSideTableBase;
+using Menge::BFSM::Goal;
+using Menge::BFSM::GoalSet;
+using Menge::BFSM::NearestGoalSelector;
+using Menge::BFSM::PointGoal;
+using Menge::Math::Vector2;
+
+namespace {
+float random(float minVal, float maxVal) {
+  return minVal + (maxVal - minVal) * static_cast<float>(std::rand()) / RAND_MAX;
+}
+
+// The nearest (or farthest) available goal by testing every goal; ties go to the first goal.
+Goal* bruteForce(const std::vector<Goal*>& goals, const Vector2& pt, bool nearest) {
+  Goal* best = 0x0;
+  float bestDist = 0.f;
+  for (size_t i = 0; i < goals.size(); ++i) {
+    if (!goals[i]->hasCapacity()) continue;
+    const float dist = absSq(goals[i]->getCentroid() - pt);
+    if (best == 0x0 || (nearest ? dist < bestDist : dist > bestDist)) {
+      best = goals[i];
+      bestDist = dist;
+    }
+  }
+  return best;
+}
+}  // namespace
+
+// The indexed queries select the same goals as testing every goal while goals fill up and free
+// up again.
+TEST(GoalKDTreeTest, matchesLinearSearchAsGoalsFill) {
+  std::srand(11);
+  GoalSet goalSet;
+  std::vector<Goal*> goals;
+  for (size_t i = 0; i < 500; ++i) {
+    // Every tenth goal duplicates a previous position to exercise ties.
+    const Vector2 p = i % 10 == 9 ? goals[i - 5]->getCentroid()
+                                  : Vector2(random(-100.f, 100.f), random(-50.f, 50.f));
+    Goal* goal = new PointGoal(p);
+    goal->setID(i);
+    goal->setCapacity(1);
+    ASSERT_TRUE(goalSet.addGoal(i, goal));
+    goals.push_back(goal);
+  }
+  goalSet.buildIndex();
+
+  for (int i = 0; i < 2000; ++i) {
+    const Vector2 pt(random(-120.f, 120.f), random(-60.f, 60.f));
+    ASSERT_EQ(goalSet.getNearestGoal(pt), bruteForce(goals, pt, true));
+    ASSERT_EQ(goalSet.getFarthestGoal(pt), bruteForce(goals, pt, false));
+    // Fill the nearest goal; every fifth query frees a goal again.
+    Goal* nearest = goalSet.getNearestGoal(pt);
+    if (nearest != 0x0) nearest->assign(0x0);
+    if (i % 5 == 4) {
+      Goal* goal = goals[std::rand() % goals.size()];
+      if (!goal->hasCapacity()) goal->free();
+    }
+  }
+
+  // Once every goal is full, there is nothing to select.
+  for (size_t i = 0; i < goals.size(); ++i) {
+    if (goals[i]->hasCapacity()) goals[i]->assign(0x0);
+  }
+  EXPECT_EQ(goalSet.getNearestGoal(Vector2(0.f, 0.f)), static_cast<Goal*>(0x0));
+  EXPECT_EQ(goalSet.getFarthestGoal(Vector2(0.f, 0.f)), static_cast<Goal*>(0x0));
+}
+
+// Batches assigned concurrently through one selector fill every goal exactly and leave the index
+// consistent with the goals' capacity.
+TEST(GoalKDTreeTest, concurrentBatchesKeepIndexConsistent) {
+  const int BATCH_COUNT = 8;
+  const size_t BATCH_SIZE = 100;
+  AgentSideTableBase::reserveAll(BATCH_COUNT * BATCH_SIZE);
+  std::srand(7);
+  GoalSet* goalSet = new GoalSet();
+  std::vector<Goal*> goals;
+  for (size_t i = 0; i < 200; ++i) {
+    Goal* goal = new PointGoal(random(-100.f, 100.f), random(-50.f, 50.f));
+    goal->setID(i);
+    goal->setCapacity(4);
+    ASSERT_TRUE(goalSet->addGoal(i, goal));
+    goals.push_back(goal);
+  }
+  goalSet->buildIndex();
+  std::map<size_t, GoalSet*> goalSets;
+  goalSets[0] = goalSet;
+  NearestGoalSelector* selector = new NearestGoalSelector();
+  selector->setGoalSetID(0);
+  selector->setGoalSet(goalSets);
+
+  // There are exactly as many agents as the goals' total capacity.
+  std::vector<ORCA::Agent> agents(BATCH_COUNT * BATCH_SIZE);
+  std::vector<std::vector<const BaseAgent*> > batches(BATCH_COUNT);
+  for (size_t i = 0; i < agents.size(); ++i) {
+    agents[i]._id = i;
+    agents[i]._pos.set(random(-100.f, 100.f), random(-50.f, 50.f));
+    batches[i % BATCH_COUNT].push_back(&agents[i]);
+  }
+  std::vector<std::vector<Goal*> > assigned(BATCH_COUNT);
+  size_t total = 0;
+#pragma omp parallel for reduction(+ : total)
+  for (int b = 0; b < BATCH_COUNT; ++b) {
+    total += selector->assignGoals(batches[b], assigned[b]);
+  }
+  EXPECT_EQ(total, agents.size());
+  std::map<Goal*, size_t> counts;
+  for (int b = 0; b < BATCH_COUNT; ++b) {
+    for (size_t i = 0; i < assigned[b].size(); ++i) ++counts[assigned[b][i]];
+  }
+  EXPECT_EQ(counts.count(0x0), 0u);
+  for (size_t i = 0; i < goals.size(); ++i) {
+    EXPECT_EQ(counts[goals[i]], 4u);
+  }
+  EXPECT_EQ(goalSet->size(), 0u);
+  EXPECT_EQ(goalSet->getNearestGoal(Vector2(0.f, 0.f)), static_cast<Goal*>(0x0));
+
+  // Freeing the assignments makes every goal selectable again.
+#pragma omp parallel for
+  for (int b = 0; b < BATCH_COUNT; ++b) {
+    for (size_t i = 0; i < batches[b].size(); ++i) {
+      selector->freeGoal(batches[b][i], assigned[b][i]);
+    }
+  }
+  EXPECT_EQ(goalSet->size(), goals.size());
+  for (int i = 0; i < 200; ++i) {
+    const Vector2 pt(random(-120.f, 120.f), random(-60.f, 60.f));
+    ASSERT_EQ(goalSet->getNearestGoal(pt), bruteForce(goals, pt, true));
+    ASSERT_EQ(goalSet->getFarthestGoal(pt), bruteForce(goals, pt, false));
+  }
+
+  selector->destroy();
+  delete goalSet;
+}
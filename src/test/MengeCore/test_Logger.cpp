@@ -0,0 +1,113 @@
+#include "MengeCore/Runtime/Logger.h"
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Menge::Logger;
+
+namespace {
+std::string readFile(const std::string& fileName) {
+  std::ifstream f(fileName.c_str());
+  return std::string(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+}
+
+size_t countOf(const std::string& text, const std::string& pattern) {
+  size_t count = 0;
+  for (size_t pos = text.find(pattern); pos != std::string::npos;
+       pos = text.find(pattern, pos + 1)) {
+    ++count;
+  }
+  return count;
+}
+}  // namespace
+
+// Messages streamed concurrently, in pieces and across statements, are never interleaved.
+TEST(LoggerTest, concurrentMessagesAreIntact) {
+  Logger log;
+  log.setRateLimit(0, 1.f);
+  log.setFile("test_log.html");
+  const int THREADS = 6;
+  const int MESSAGES = 300;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < THREADS; ++t) {
+    threads.push_back(std::thread([&log, t, MESSAGES]() {
+      for (int m = 0; m < MESSAGES; ++m) {
+        log << Logger::WARN_MSG << "[thread " << t << " message " << m << ": ";
+        log << 0.5f << " and " << 2u << "]";
+      }
+    }));
+  }
+  for (size_t t = 0; t < threads.size(); ++t) threads[t].join();
+  log << Logger::INFO_MSG << "done";
+  log.close();
+
+  const std::string html = readFile("test_log.html");
+  for (int t = 0; t < THREADS; ++t) {
+    for (int m = 0; m < MESSAGES; m += 37) {
+      std::ostringstream expected;
+      expected << "<td class=\"war\">[thread " << t << " message " << m << ": 0.5 and 2]</td>";
+      EXPECT_EQ(countOf(html, expected.str()), 1u) << expected.str();
+    }
+  }
+  EXPECT_EQ(countOf(html, "<td class=\"war\">"), static_cast<size_t>(THREADS * MESSAGES));
+  EXPECT_EQ(countOf(html, "<td class=\"inf\">done</td>"), 1u);
+  EXPECT_NE(html.find("</html>"), std::string::npos);
+  std::remove("test_log.html");
+}
+
+// Repeated warnings beyond the limit are summarized; informational messages are never limited.
+TEST(LoggerTest, repeatedWarningsAreRateLimited) {
+  Logger log;
+  log.setRateLimit(3, 60.f);
+  log.setFile("test_log.html");
+  for (int i = 0; i < 50; ++i) {
+    log << Logger::WARN_MSG << "Agent " << i << " has no goal.";
+    log << Logger::INFO_MSG << "Agent " << i << " is fine.";
+  }
+  log.close();
+
+  const std::string html = readFile("test_log.html");
+  EXPECT_EQ(countOf(html, "has no goal."), 4u);  // Three messages and the summary.
+  EXPECT_EQ(countOf(html, "Suppressed 47 similar message(s)"), 1u);
+  EXPECT_EQ(countOf(html, "is fine."), 50u);
+  std::remove("test_log.html");
+}
+
+// Errors are on disk as soon as they end; other messages may wait for the background thread.
+TEST(LoggerTest, errorsAreWrittenImmediately) {
+  Logger log;
+  log.setFile("test_log.html");
+  log << Logger::INFO_MSG << "Starting.";
+  log << Logger::ERR_MSG << "Agent " << 3 << " left the navigation mesh.";
+  log << Logger::INFO_MSG;
+  // The row is closed by the next message's text, but the error is already in the file.
+  const std::string html = readFile("test_log.html");
+  EXPECT_EQ(countOf(html, "<td class=\"err\">Agent 3 left the navigation mesh."), 1u);
+  log.close();
+  std::remove("test_log.html");
+}
+
+// Errors are rate limited by their whole text, not by the leading piece they are streamed in.
+TEST(LoggerTest, errorsAreRateLimitedAsAWhole) {
+  Logger log;
+  log.setRateLimit(2, 60.f);
+  log.setFile("test_log.html");
+  for (int i = 0; i < 5; ++i) {
+    log << Logger::ERR_MSG << "Couldn't assign agent " << i << " a goal.";
+    log << Logger::ERR_MSG << "Couldn't assign agent " << i << " a state.";
+  }
+  log.close();
+
+  const std::string html = readFile("test_log.html");
+  EXPECT_EQ(countOf(html, "a goal."), 3u);  // Two messages and the summary.
+  EXPECT_EQ(countOf(html, "a state."), 3u);
+  const std::string summary = "Suppressed 3 similar message(s) in 60 s: Couldn't assign agent 0";
+  EXPECT_EQ(countOf(html, summary + " a goal."), 1u);
+  std::remove("test_log.html");
+}
@@ -0,0 +1,137 @@
+#include "MengeCore/resources/NavMesh.h"
+#include "MengeCore/resources/PathPlanner.h"
+#include "MengeCore/resources/Route.h"
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <fstream>
+
+using namespace Menge;
+
+namespace {
+// The navigation mesh of the navMesh example; its portals have a variety of widths.
+const char* NAV_MESH =
+    "13\n"
+    "-5.0 6.0\n"
+    "-1.0 6.0\n"
+    "1.0 6.0\n"
+    "3.0 6.0\n"
+    "-5.0 3.0\n"
+    "-1.0 3.0\n"
+    "1.0 3.0\n"
+    "3.0 3.0\n"
+    "-1.0 0.0\n"
+    "1.0 0.0\n"
+    "-1.0 -3.0\n"
+    "1.0 -3.0\n"
+    "0.0 1.5\n"
+    "\n"
+    "7\n"
+    "  1 5 0 1\n"
+    "  2 6 1 2\n"
+    "  5 6 1 3\n"
+    "  8 9 6 7\n"
+    "  5 12 3 5\n"
+    "  6 12 3 4\n"
+    "  9 12 4 6\n"
+    "\n"
+    "13\n"
+    "  0 1 0 1\n"
+    "  1 2 1 2\n"
+    "  2 3 2 3\n"
+    "  3 7 2 4\n"
+    "  7 6 2 5\n"
+    "  6 9 4 6\n"
+    "  9 11 7 7\n"
+    "  11 10 7 8\n"
+    "  10 8 7 9\n"
+    "  8 5 5 10\n"
+    "  5 4 0 11\n"
+    "  4 0 0 0\n"
+    "  8 12 5 -1\n"
+    "\n"
+    "nodeGroup\n"
+    "8\n"
+    "  -3.0 4.50\n"
+    "  4 4 5 1 0\n"
+    "  0 0 1.0\n"
+    "  1 0\n"
+    "  5 0 1 11 10 9\n"
+    "\n"
+    "  0.0 4.50\n"
+    "  4 5 6 2 1\n"
+    "  0 0 1.0\n"
+    "  3 0 1 2\n"
+    "  7 0 1 2 4 5 9 10\n"
+    "\n"
+    "  2.00 4.50\n"
+    "  4 6 7 3 2\n"
+    "  0 0 1.0\n"
+    "  1 1\n"
+    "  5 1 2 3 4 5\n"
+    "\n"
+    "  0.0 2.50\n"
+    "  3 12 6 5\n"
+    "  0.0 0.33333 0.0\n"
+    "  3 2 4 5\n"
+    "  5 4 5 9 10 12\n"
+    "\n"
+    "  0.5 1.50\n"
+    "  3 12 9 6\n"
+    "  0.0 0.33333 0.0\n"
+    "  2 5 6\n"
+    "  4 4 5 6 12\n"
+    "\n"
+    "  -0.5 1.50\n"
+    "  3 12 5 8\n"
+    "  0.0 0.33333 0.0\n"
+    "  1 4\n"
+    "  3 9 10 12\n"
+    "\n"
+    "  0.0 0.75\n"
+    "  3 12 8 9\n"
+    "  0.0 0.33333 0.0\n"
+    "  2 3 6\n"
+    "  4 5 6 8 12\n"
+    "\n"
+    "  0.0 -1.50\n"
+    "  4 10 11 9 8\n"
+    "  0.0 0.0 0.0\n"
+    "  1 3\n"
+    "  5 5 6 7 8 9\n"
+    "\n";
+}  // namespace
+
+// The cached path lengths match the lengths of the routes planned by A* for every pair of nodes;
+// nodes which can't reach the end node through wide enough portals have negative lengths.
+TEST(PathPlannerTest, pathLengthsMatchPlannedRoutes) {
+  {
+    std::ofstream out("test_planner.nav");
+    out << NAV_MESH;
+  }
+  NavMeshPtr navMesh = loadNavMesh("test_planner.nav");
+  const unsigned int N = static_cast<unsigned int>(navMesh->getNodeCount());
+  const float widths[] = {0.1f, 1.5f, 1.9f, 2.5f};
+  size_t unreachable = 0;
+  for (size_t w = 0; w < sizeof(widths) / sizeof(widths[0]); ++w) {
+    // Separate planners so that routes cached for one width are not reused for another.
+    PathPlanner planner(navMesh);
+    PathPlanner routePlanner(navMesh);
+    for (unsigned int end = 0; end < N; ++end) {
+      const float* lengths = planner.getPathLengths(end, widths[w]);
+      EXPECT_EQ(lengths, planner.getPathLengths(end, widths[w]));
+      for (unsigned int start = 0; start < N; ++start) {
+        try {
+          PortalRoute* route = routePlanner.getRoute(start, end, widths[w]);
+          EXPECT_NEAR(lengths[start], route->getLength(), 1e-4f);
+        } catch (PathPlannerException&) {
+          EXPECT_LT(lengths[start], 0.f);
+          ++unreachable;
+        }
+      }
+    }
+  }
+  // The widths have to actually cut off some of the paths.
+  EXPECT_GT(unreachable, 0u);
+  std::remove("test_planner.nav");
+}
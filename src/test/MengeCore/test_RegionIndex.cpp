@@ -0,0 +1,57 @@
+#include "MengeCore/BFSM/RegionIndex.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+using Menge::BFSM::RegionIndex;
+using Menge::Math::Vector2;
+
+namespace {
+float random(float minVal, float maxVal) {
+  return minVal + (maxVal - minVal) * static_cast<float>(std::rand()) / RAND_MAX;
+}
+}  // namespace
+
+// Every region whose bounds contain a point is listed for the point's cell; points outside all
+// regions have no cell.
+TEST(RegionIndexTest, listsAllRegionsContainingAPoint) {
+  std::srand(17);
+  RegionIndex index;
+  std::vector<Vector2> minPts, maxPts;
+  for (unsigned int r = 0; r < 200; ++r) {
+    const Vector2 minPt(random(-50.f, 50.f), random(-20.f, 80.f));
+    const Vector2 maxPt = minPt + Vector2(random(0.f, 6.f), random(0.f, 6.f));
+    EXPECT_EQ(index.addRegion(minPt, maxPt), r);
+    minPts.push_back(minPt);
+    maxPts.push_back(maxPt);
+  }
+  index.build();
+
+  size_t listed = 0;
+  for (int i = 0; i < 5000; ++i) {
+    // Half of the points are corners of the regions to exercise the region boundaries.
+    Vector2 pt(random(-60.f, 60.f), random(-30.f, 90.f));
+    if (i % 2) pt = (i % 4 == 1) ? minPts[i % minPts.size()] : maxPts[i % maxPts.size()];
+    const size_t cell = index.getCell(pt);
+    const unsigned int* begin;
+    const unsigned int* end;
+    index.getRegions(cell, begin, end);
+    EXPECT_TRUE(std::is_sorted(begin, end));
+    listed += end - begin;
+    for (unsigned int r = 0; r < minPts.size(); ++r) {
+      const bool inside = pt.x() >= minPts[r].x() && pt.x() <= maxPts[r].x() &&
+                          pt.y() >= minPts[r].y() && pt.y() <= maxPts[r].y();
+      if (inside) {
+        ASSERT_NE(cell, RegionIndex::NO_CELL);
+        EXPECT_TRUE(index.mayContain(cell, r));
+      }
+    }
+  }
+  // The grid has to actually cull regions.
+  EXPECT_LT(listed, 5000u * 10u);
+
+  EXPECT_EQ(index.getCell(Vector2(-1000.f, 0.f)), RegionIndex::NO_CELL);
+  EXPECT_FALSE(index.mayContain(RegionIndex::NO_CELL, 0));
+}
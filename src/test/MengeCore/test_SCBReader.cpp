@@ -0,0 +1,138 @@
+#include "MengeCore/Agents/SCBReader.h"
+#include "MengeCore/Agents/SCBWriter.h"
+#include "MengeCore/Orca/ORCAInitializer.h"
+#include "MengeCore/Orca/ORCASimulator.h"
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace Menge;
+using Menge::Agents::SCBReader;
+using Menge::Agents::SCBWriter;
+using Menge::Math::Vector2;
+
+namespace {
+const size_t AGT_COUNT = 23;
+const int FRAME_COUNT = 70;
+
+Vector2 agentPosition(size_t agent, int frame) {
+  return Vector2(agent * 0.5f + 0.1f * frame, 0.05f * frame - agent);
+}
+
+// Writes FRAME_COUNT frames of a simple, known trajectory.
+void writeFile(const std::string& fileName, const std::string& version) {
+  ORCA::Simulator sim;
+  ORCA::AgentInitializer init;
+  for (size_t i = 0; i < AGT_COUNT; ++i) sim.addAgent(Vector2(0.f, 0.f), &init);
+  SCBWriter writer(fileName, version, &sim, 0);
+  for (int f = 0; f < FRAME_COUNT; ++f) {
+    for (size_t i = 0; i < AGT_COUNT; ++i) {
+      Agents::BaseAgent* agt = sim.getAgent(i);
+      agt->_pos = agentPosition(i, f);
+      agt->_orient = Vector2(0.f, 1.f);
+    }
+    writer.writeFrame(0x0);
+  }
+}
+
+void truncateFile(const std::string& fileName, const std::string& outName, size_t dropBytes) {
+  std::ifstream in(fileName.c_str(), std::ios::binary);
+  std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  std::ofstream out(outName.c_str(), std::ios::binary);
+  out.write(data.data(), data.size() - dropBytes);
+}
+
+// Confirms the reader reproduces the known trajectory for frames visited out of order.
+void expectTrajectory(SCBReader& reader, float tolerance) {
+  const int frames[] = {FRAME_COUNT - 1, 0, 33, 32, 31, 5, FRAME_COUNT / 2};
+  for (int j = 0; j < 7; ++j) {
+    const int f = frames[j];
+    if (f >= static_cast<int>(reader.getFrameCount())) continue;
+    const float* data = reader.getFrame(f);
+    ASSERT_NE(data, (const float*)0x0);
+    ASSERT_EQ(reader.getFrameAgentCount(f), AGT_COUNT);
+    for (size_t a = 0; a < AGT_COUNT; ++a) {
+      const float* rec = data + a * reader.getAgentStride();
+      const Vector2 p = agentPosition(a, f);
+      EXPECT_NEAR(rec[0], p.x(), tolerance) << "frame " << f << " agent " << a;
+      EXPECT_NEAR(rec[1], p.y(), tolerance) << "frame " << f << " agent " << a;
+    }
+  }
+}
+}  // namespace
+
+// Fixed-size versions are read in place.
+TEST(SCBReaderTest, readsFixedSizeVersions) {
+  const char* versions[] = {"1.0", "2.3"};
+  for (int v = 0; v < 2; ++v) {
+    writeFile("test_read.scb", versions[v]);
+    SCBReader reader;
+    ASSERT_TRUE(reader.open("test_read.scb"));
+    EXPECT_EQ(reader.getAgentCount(), AGT_COUNT);
+    EXPECT_EQ(reader.getFrameCount(), static_cast<size_t>(FRAME_COUNT));
+    EXPECT_EQ(reader.getClassIDs() == 0x0, v == 0);
+    expectTrajectory(reader, 0.f);
+    // The second version 2.3 value is the orientation's x-component; version 1.0 stores the angle.
+    const float* frame = reader.getFrame(3);
+    EXPECT_NEAR(frame[2], v == 0 ? 1.5707963f : 0.f, 1e-6f);
+
+    // A partially written frame is ignored.
+    reader.close();
+    truncateFile("test_read.scb", "test_trunc.scb", 5);
+    ASSERT_TRUE(reader.open("test_trunc.scb"));
+    EXPECT_EQ(reader.getFrameCount(), static_cast<size_t>(FRAME_COUNT - 1));
+    expectTrajectory(reader, 0.f);
+  }
+  std::remove("test_read.scb");
+  std::remove("test_trunc.scb");
+}
+
+// Compressed files are indexed; the index can be persisted and is rejected if the file changes.
+TEST(SCBReaderTest, readsCompressedVersion) {
+  writeFile("test_read.scb", "3.0");
+  std::remove("test_read.idx");
+  const float tolerance = Agents::SCBChunkEncoder::DEFAULT_POSITION_QUANTUM * 0.5f + 1e-5f;
+  {
+    SCBReader reader;
+    ASSERT_TRUE(reader.open("test_read.scb", "test_read.idx"));
+    EXPECT_EQ(reader.getFrameCount(), static_cast<size_t>(FRAME_COUNT));
+    EXPECT_EQ(reader.getAgentStride(), 4u);
+    expectTrajectory(reader, tolerance);
+  }
+  {
+    // Loaded from the index written above.
+    SCBReader reader;
+    ASSERT_TRUE(reader.open("test_read.scb", "test_read.idx"));
+    EXPECT_EQ(reader.getFrameCount(), static_cast<size_t>(FRAME_COUNT));
+    expectTrajectory(reader, tolerance);
+  }
+  {
+    // An index whose chunks don't start at increasing frames is rejected and rebuilt. The chunks
+    // hold 32 frames; the third chunk is claimed to start at frame 16.
+    std::fstream index("test_read.idx", std::ios::in | std::ios::out | std::ios::binary);
+    const unsigned long long firstFrame = 16;
+    index.seekp(4 + 8 + 4 + 4 + 2 * 16 + 8);
+    index.write(reinterpret_cast<const char*>(&firstFrame), sizeof(firstFrame));
+    index.close();
+    SCBReader reader;
+    ASSERT_TRUE(reader.open("test_read.scb", "test_read.idx"));
+    EXPECT_EQ(reader.getFrameCount(), static_cast<size_t>(FRAME_COUNT));
+    expectTrajectory(reader, tolerance);
+  }
+  {
+    // The stale index doesn't match the truncated file; only complete chunks are reported.
+    truncateFile("test_read.scb", "test_trunc.scb", 5);
+    SCBReader reader;
+    ASSERT_TRUE(reader.open("test_trunc.scb", "test_read.idx"));
+    EXPECT_EQ(reader.getFrameCount(), 64u);
+    expectTrajectory(reader, tolerance);
+  }
+  std::remove("test_read.scb");
+  std::remove("test_trunc.scb");
+  std::remove("test_read.idx");
+}
@@ -0,0 +1,152 @@
+#include "MengeCore/Agents/SCBWriter.h"
+#include "MengeCore/Orca/ORCAInitializer.h"
+#include "MengeCore/Orca/ORCASimulator.h"
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace Menge;
+using Menge::Agents::SCBWriter;
+using Menge::Math::Vector2;
+
+namespace {
+// Advances the agents "by hand" so each frame has distinct contents.
+void moveAgents(ORCA::Simulator& sim, int frame) {
+  for (size_t i = 0; i < sim.getNumAgents(); ++i) {
+    Agents::BaseAgent* agt = sim.getAgent(i);
+    agt->_pos = Vector2(i * 0.5f + frame, frame * 0.25f - i);
+    agt->_orient = Vector2(frame % 2 == 0 ? 1.f : 0.f, frame % 2 == 0 ? 0.f : 1.f);
+  }
+}
+
+// Writes the given number of frames with a writer of the given queue depth.
+void writeFrames(const std::string& fileName, const std::string& version, size_t queueDepth,
+                 ORCA::Simulator& sim, int frameCount) {
+  SCBWriter writer(fileName, version, &sim, queueDepth);
+  for (int f = 0; f < frameCount; ++f) {
+    moveAgents(sim, f);
+    writer.writeFrame(0x0);
+  }
+}
+
+std::vector<char> readFile(const std::string& fileName) {
+  std::ifstream f(fileName.c_str(), std::ios::binary);
+  return std::vector<char>(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+}
+}  // namespace
+
+// The background writer must produce exactly the same file as synchronous output.
+TEST(SCBWriterTest, asyncMatchesSynchronous) {
+  ORCA::Simulator sim;
+  ORCA::AgentInitializer init;
+  const size_t AGT_COUNT = 37;
+  for (size_t i = 0; i < AGT_COUNT; ++i) sim.addAgent(Vector2(0.f, 0.f), &init);
+
+  const int FRAME_COUNT = 50;
+  const char* versions[] = {"1.0", "2.3"};
+  for (int v = 0; v < 2; ++v) {
+    writeFrames("test_sync.scb", versions[v], 0, sim, FRAME_COUNT);
+    writeFrames("test_async.scb", versions[v], 3, sim, FRAME_COUNT);
+    std::vector<char> syncData = readFile("test_sync.scb");
+    std::vector<char> asyncData = readFile("test_async.scb");
+    // Header: version string + agent count (2.3 adds the time step and the agent classes); every
+    // frame: 3 floats per agent (2.3 adds a fourth).
+    EXPECT_EQ(syncData.size(), 4 + sizeof(int) + FRAME_COUNT * AGT_COUNT * 3 * sizeof(float) +
+                                   (v == 1 ? sizeof(float) + AGT_COUNT * sizeof(int) +
+                                                 FRAME_COUNT * AGT_COUNT * sizeof(float)
+                                           : 0));
+    EXPECT_TRUE(syncData == asyncData) << "version " << versions[v];
+
+    // Spot check the last agent of the last frame.
+    const float* last =
+        reinterpret_cast<const float*>(&syncData[syncData.size() - (v == 1 ? 16 : 12)]);
+    EXPECT_EQ(last[0], (AGT_COUNT - 1) * 0.5f + (FRAME_COUNT - 1));
+    EXPECT_EQ(last[1], (FRAME_COUNT - 1) * 0.25f - (AGT_COUNT - 1));
+  }
+  std::remove("test_sync.scb");
+  std::remove("test_async.scb");
+}
+
+namespace {
+// Smoothly moving agents with occasional state changes, orientation wrap-around and a teleport.
+std::vector<Agents::SCBAgentRecord> syntheticFrame(size_t agentCount, int frame) {
+  std::vector<Agents::SCBAgentRecord> records(agentCount);
+  for (size_t a = 0; a < agentCount; ++a) {
+    const float t = frame * 0.1f;
+    records[a].x = 10.f * std::cos(0.05f * t + a) + (a % 7 == 0 ? 0.f : 1.3f * t);
+    records[a].y = -5.f + 0.37f * a + 0.2f * std::sin(t);
+    records[a].orientation = std::fmod(3.1f + 0.02f * t * a, 6.2831853f) - 3.1415926f;
+    records[a].stateID = static_cast<unsigned int>(a % 3 + (frame > 40 && a % 5 == 0 ? 7 : 0));
+  }
+  if (frame == 17) records[3].x = 1.0e5f;
+  return records;
+}
+
+// Decodes every complete chunk in data; returns the decoded frames.
+std::vector<std::vector<Agents::SCBAgentRecord> > decodeChunks(const std::string& data) {
+  std::vector<std::vector<Agents::SCBAgentRecord> > frames;
+  Agents::SCBChunkDecoder decoder;
+  size_t offset = 0;
+  size_t consumed = 0;
+  while (offset < data.size() &&
+         decoder.decode(data.data() + offset, data.size() - offset, consumed)) {
+    for (size_t f = 0; f < decoder.getFrameCount(); ++f) {
+      const Agents::SCBAgentRecord* rec = decoder.getFrame(f);
+      frames.push_back(std::vector<Agents::SCBAgentRecord>(rec, rec + decoder.getAgentCount()));
+    }
+    offset += consumed;
+  }
+  return frames;
+}
+}  // namespace
+
+// Version 3.0 chunks must decode to the input to within the quantization error.
+TEST(SCBWriterTest, compressedChunksRoundTrip) {
+  const size_t AGT_COUNT = 150;
+  const int FRAME_COUNT = 75;
+  std::ostringstream out;
+  Agents::SCBChunkEncoder encoder;
+  std::vector<std::vector<Agents::SCBAgentRecord> > input;
+  for (int f = 0; f < FRAME_COUNT; ++f) {
+    // The population shrinks part-way through; this must start a new chunk.
+    input.push_back(syntheticFrame(f < 50 ? AGT_COUNT : AGT_COUNT - 20, f));
+    encoder.addFrame(&input.back()[0], input.back().size(), out);
+  }
+  encoder.finish(out);
+  const std::string data = out.str();
+
+  std::vector<std::vector<Agents::SCBAgentRecord> > output = decodeChunks(data);
+  ASSERT_EQ(output.size(), input.size());
+  const float posTol = Agents::SCBChunkEncoder::DEFAULT_POSITION_QUANTUM * 0.5f + 1e-5f;
+  const float angTol = 3.1415926f / Agents::SCBChunkEncoder::DEFAULT_ORIENTATION_STEPS + 1e-5f;
+  for (size_t f = 0; f < input.size(); ++f) {
+    ASSERT_EQ(output[f].size(), input[f].size());
+    for (size_t a = 0; a < input[f].size(); ++a) {
+      const Agents::SCBAgentRecord& in = input[f][a];
+      const Agents::SCBAgentRecord& dec = output[f][a];
+      // Large coordinates lose float precision on the way back; scale the tolerance.
+      EXPECT_NEAR(dec.x, in.x, posTol * (std::fabs(in.x) > 1000.f ? 10.f : 1.f));
+      EXPECT_NEAR(dec.y, in.y, posTol);
+      float dAngle = std::fabs(dec.orientation - in.orientation);
+      if (dAngle > 3.1415926f) dAngle = 6.2831853f - dAngle;
+      EXPECT_LT(dAngle, angTol);
+      EXPECT_EQ(dec.stateID, in.stateID);
+    }
+  }
+
+  // Smooth motion compresses well below the raw 16 bytes per agent per frame.
+  const size_t rawSize = FRAME_COUNT * AGT_COUNT * sizeof(Agents::SCBAgentRecord);
+  EXPECT_LT(data.size() * 4, rawSize);
+
+  // A truncated file still yields every complete chunk (frames 0-31 and 32-49; the agent count
+  // change ends the second chunk early).
+  std::vector<std::vector<Agents::SCBAgentRecord> > partial =
+      decodeChunks(data.substr(0, data.size() - 10));
+  EXPECT_EQ(partial.size(), 50u);
+}
@@ -0,0 +1,103 @@
+#include "MengeCore/Agents/BaseAgent.h"
+#include "MengeCore/Agents/SimulatorInterface.h"
+#include "MengeCore/BFSM/FSM.h"
+#include "MengeCore/BFSM/State.h"
+#include "MengeCore/Core.h"
+#include "MengeCore/menge_c_api.h"
+#include "SceneFixture.h"
+#include "gtest/gtest.h"
+
+#include <string>
+#include <vector>
+
+using namespace Menge;
+using Menge::Agents::BaseAgent;
+using Menge::BFSM::State;
+using Menge::BFSM::StateException;
+
+namespace {
+// The goals of A and B have just enough capacity for every agent; C only has room for four.
+// Entering B halves the agents' preferred speed.
+const char* BEHAVIOR =
+    "<?xml version=\"1.0\"?>\n"
+    "<BFSM>\n"
+    "  <GoalSet id=\"0\">\n"
+    "    <Goal type=\"point\" id=\"0\" x=\"0\" y=\"5\" capacity=\"2\" />\n"
+    "    <Goal type=\"point\" id=\"1\" x=\"2\" y=\"5\" capacity=\"2\" />\n"
+    "    <Goal type=\"point\" id=\"2\" x=\"4\" y=\"5\" capacity=\"2\" />\n"
+    "  </GoalSet>\n"
+    "  <GoalSet id=\"1\">\n"
+    "    <Goal type=\"point\" id=\"0\" x=\"0\" y=\"-5\" capacity=\"3\" />\n"
+    "    <Goal type=\"point\" id=\"1\" x=\"5\" y=\"-5\" capacity=\"3\" />\n"
+    "  </GoalSet>\n"
+    "  <GoalSet id=\"2\">\n"
+    "    <Goal type=\"point\" id=\"0\" x=\"10\" y=\"0\" capacity=\"4\" />\n"
+    "  </GoalSet>\n"
+    "  <State name=\"A\" final=\"0\">\n"
+    "    <GoalSelector type=\"nearest\" goal_set=\"0\" />\n"
+    "    <VelComponent type=\"zero\" />\n"
+    "  </State>\n"
+    "  <State name=\"B\" final=\"0\">\n"
+    "    <Action type=\"scale_property\" property=\"pref_speed\" dist=\"c\" value=\"0.5\"\n"
+    "            exit_reset=\"1\" />\n"
+    "    <GoalSelector type=\"nearest\" goal_set=\"1\" />\n"
+    "    <VelComponent type=\"goal\" />\n"
+    "  </State>\n"
+    "  <State name=\"C\" final=\"0\">\n"
+    "    <GoalSelector type=\"nearest\" goal_set=\"2\" />\n"
+    "    <VelComponent type=\"zero\" />\n"
+    "  </State>\n"
+    "</BFSM>\n";
+}  // namespace
+
+// A batch of agents moves between states with the same bookkeeping as moving the agents one at a
+// time: populations, memberships, goal capacity and actions.
+TEST(StateBatchTest, movesAgentsBetweenStatesAsABatch) {
+  const std::string scene = SceneFixture::stationaryScene("A", SceneFixture::row(6));
+  ASSERT_TRUE(SceneFixture::loadSimulation("batch", scene, BEHAVIOR));
+  BFSM::FSM* fsm = ACTIVE_FSM;
+  State* a = fsm->getNode("A");
+  State* b = fsm->getNode("B");
+  State* c = fsm->getNode("C");
+  std::vector<BaseAgent*> agents;
+  for (size_t i = 0; i < SIMULATOR->getNumAgents(); ++i) agents.push_back(SIMULATOR->getAgent(i));
+  // The initial states are entered in batches as well.
+  EXPECT_EQ(a->getPopulation(), 6u);
+
+  EXPECT_EQ(fsm->forceStateTransitions(agents, b, false), 6u);
+  EXPECT_EQ(a->getPopulation(), 0u);
+  EXPECT_EQ(b->getPopulation(), 6u);
+  EXPECT_EQ(b->getMembers().size(), 6u);
+  for (size_t i = 0; i < agents.size(); ++i) {
+    EXPECT_EQ(fsm->getCurrentState(agents[i]), b);
+    EXPECT_FLOAT_EQ(agents[i]->_prefSpeed, 0.65f);
+  }
+
+  // Agents already in the state are untouched unless they are forced to re-enter it; re-entering
+  // frees their goals before new ones are selected.
+  EXPECT_EQ(fsm->forceStateTransitions(agents, b, false), 0u);
+  EXPECT_EQ(fsm->forceStateTransitions(agents, b, true), 0u);
+  EXPECT_EQ(b->getPopulation(), 6u);
+  for (size_t i = 0; i < agents.size(); ++i) EXPECT_FLOAT_EQ(agents[i]->_prefSpeed, 0.65f);
+
+  // A mixed batch: only the agents outside of A change state. Leaving B restores the speed.
+  std::vector<BaseAgent*> half(agents.begin(), agents.begin() + 3);
+  EXPECT_EQ(fsm->forceStateTransitions(half, a, false), 3u);
+  EXPECT_EQ(fsm->forceStateTransitions(agents, a, false), 3u);
+  EXPECT_EQ(a->getPopulation(), 6u);
+  EXPECT_EQ(b->getPopulation(), 0u);
+  EXPECT_EQ(a->getMembers().size(), 6u);
+  EXPECT_EQ(b->getMembers().size(), 0u);
+  for (size_t i = 0; i < agents.size(); ++i) EXPECT_FLOAT_EQ(agents[i]->_prefSpeed, 1.3f);
+
+  // C can't take every agent; the agents which could be served still enter it. Only they are
+  // recorded in C.
+  EXPECT_THROW(fsm->forceStateTransitions(agents, c, false), StateException);
+  EXPECT_EQ(c->getPopulation(), 4u);
+  EXPECT_EQ(a->getPopulation(), 0u);
+  size_t inC = 0;
+  for (size_t i = 0; i < agents.size(); ++i) {
+    if (fsm->getCurrentState(agents[i]) == c) ++inC;
+  }
+  EXPECT_EQ(inC, 4u);
+}
@@ -0,0 +1,94 @@
+#include "MengeCore/Agents/BaseAgent.h"
+#include "MengeCore/Agents/SimulatorInterface.h"
+#include "MengeCore/BFSM/FSM.h"
+#include "MengeCore/BFSM/State.h"
+#include "MengeCore/Core.h"
+#include "MengeCore/menge_c_api.h"
+#include "SceneFixture.h"
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace Menge;
+using Menge::Agents::BaseAgent;
+using Menge::Math::Vector2;
+
+namespace {
+// Agents wander between two goals; a source adds agents and the retire action removes them.
+std::string wanderers() {
+  using namespace SceneFixture;
+  std::vector<Vector2> block;
+  for (int i = 0; i < 60; ++i) block.push_back(Vector2(i % 10, i / 10));
+  return scene(profile("walker") + group("walker", "Out", agentsAt(block)) +
+               source("rate=\"4\" end_time=\"5\"", "walker", "Out",
+                      agentsAt({Vector2(-5.f, 0.f)})));
+}
+
+const char* BEHAVIOR =
+    "<?xml version=\"1.0\"?>\n"
+    "<BFSM>\n"
+    "  <GoalSet id=\"0\">\n"
+    "    <Goal type=\"AABB\" id=\"0\" min_x=\"12\" min_y=\"-2\" max_x=\"14\" max_y=\"8\"/>\n"
+    "    <Goal type=\"AABB\" id=\"1\" min_x=\"-4\" min_y=\"-2\" max_x=\"-2\" max_y=\"8\"/>\n"
+    "  </GoalSet>\n"
+    "  <State name=\"Out\" final=\"0\">\n"
+    "    <GoalSelector type=\"explicit\" goal_set=\"0\" goal=\"0\" />\n"
+    "    <VelComponent type=\"goal\" />\n"
+    "  </State>\n"
+    "  <State name=\"Back\" final=\"0\">\n"
+    "    <GoalSelector type=\"explicit\" goal_set=\"0\" goal=\"1\" />\n"
+    "    <VelComponent type=\"goal\" />\n"
+    "  </State>\n"
+    "  <State name=\"Gone\" final=\"1\">\n"
+    "    <GoalSelector type=\"identity\" />\n"
+    "    <VelComponent type=\"zero\" />\n"
+    "    <Action type=\"retire\" />\n"
+    "  </State>\n"
+    "  <Transition from=\"Out\" to=\"Back\">\n"
+    "    <Condition type=\"goal_reached\" distance=\"0.5\"/>\n"
+    "  </Transition>\n"
+    "  <Transition from=\"Back\">\n"
+    "    <Condition type=\"goal_reached\" distance=\"0.5\"/>\n"
+    "    <Target type=\"prob\">\n"
+    "      <State name=\"Out\" weight=\"1\" />\n"
+    "      <State name=\"Gone\" weight=\"1\" />\n"
+    "    </Target>\n"
+    "  </Transition>\n"
+    "</BFSM>\n";
+
+// Confirms that each state's members are exactly the agents whose current state it is.
+void expectMembership() {
+  size_t total = 0;
+  for (size_t s = 0; s < ACTIVE_FSM->getNodeCount(); ++s) {
+    BFSM::State* state = ACTIVE_FSM->getNode(s);
+    std::vector<BaseAgent*> members = state->getMembers();
+    std::vector<BaseAgent*> expected;
+    for (size_t i = 0; i < SIMULATOR->getNumAgents(); ++i) {
+      BaseAgent* agent = SIMULATOR->getAgent(i);
+      if (ACTIVE_FSM->getCurrentState(agent) == state) expected.push_back(agent);
+    }
+    std::sort(members.begin(), members.end());
+    std::sort(expected.begin(), expected.end());
+    EXPECT_EQ(members, expected) << "State " << state->getName();
+    EXPECT_EQ(state->getPopulation(), expected.size()) << "State " << state->getName();
+    total += members.size();
+  }
+  EXPECT_EQ(total, SIMULATOR->getNumAgents());
+}
+}  // namespace
+
+// The incrementally maintained state membership matches the agents' current states as agents
+// change state, are added and are retired.
+TEST(StateMembershipTest, tracksCurrentStates) {
+  ASSERT_TRUE(SceneFixture::loadSimulation("member", wanderers(), BEHAVIOR));
+  expectMembership();
+  size_t backPeak = 0;
+  for (int step = 0; step < 400; ++step) {
+    DoStep();
+    expectMembership();
+    backPeak = std::max(backPeak, ACTIVE_FSM->getNode("Back")->getPopulation());
+  }
+  EXPECT_GT(backPeak, 0u);
+}
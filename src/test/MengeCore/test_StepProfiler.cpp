@@ -0,0 +1,95 @@
+#include "MengeCore/Runtime/StepProfiler.h"
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+using namespace Menge;
+
+namespace {
+void busyWait(double seconds) {
+  typedef std::chrono::steady_clock Clock;
+  const Clock::time_point start = Clock::now();
+  while (std::chrono::duration<double>(Clock::now() - start).count() < seconds) {
+  }
+}
+
+// One "step": a serial phase followed by a parallel loop with two phases per item.
+void profiledStep() {
+  PROFILER.beginStep();
+  {
+    ProfileScope timer(StepProfiler::EVENTS);
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  {
+    ProfileRegion region(StepProfiler::NEIGHBOR_QUERY, StepProfiler::NEW_VELOCITY);
+#pragma omp parallel for
+    for (int i = 0; i < 16; ++i) {
+      ProfileLap lap;
+      busyWait(0.0002);
+      lap.lap(StepProfiler::NEIGHBOR_QUERY);
+      busyWait(0.0006);
+      lap.lap(StepProfiler::NEW_VELOCITY);
+    }
+  }
+  PROFILER.endStep();
+}
+
+std::string readFile(const std::string& fileName) {
+  std::ifstream f(fileName.c_str());
+  return std::string(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+}
+}  // namespace
+
+// Phase times are attributed to the right phases and exported in both formats.
+TEST(StepProfilerTest, attributesPhaseTimes) {
+  PROFILER.enable();
+  const int STEP_COUNT = 5;
+  for (int s = 0; s < STEP_COUNT; ++s) profiledStep();
+  PROFILER.disable();
+
+  EXPECT_EQ(PROFILER.getStepCount(), static_cast<size_t>(STEP_COUNT));
+  EXPECT_GE(PROFILER.getPhaseTime(StepProfiler::EVENTS), STEP_COUNT * 0.002);
+  EXPECT_EQ(PROFILER.getPhaseTime(StepProfiler::UPDATE), 0.0);
+  // The region's wall time is split in proportion to the busy time (1:3).
+  const double query = PROFILER.getPhaseTime(StepProfiler::NEIGHBOR_QUERY);
+  const double velocity = PROFILER.getPhaseTime(StepProfiler::NEW_VELOCITY);
+  EXPECT_GT(query, 0.0);
+  EXPECT_GT(velocity, 2.0 * query);
+
+  double busy = 0.0;
+  for (size_t t = 0; t < PROFILER.getThreadCount(); ++t) {
+    busy += PROFILER.getThreadBusyTime(t, StepProfiler::NEW_VELOCITY);
+    EXPECT_GE(PROFILER.getThreadIdleTime(t), 0.0);
+  }
+  EXPECT_GE(busy, STEP_COUNT * 16 * 0.0006);
+
+  ASSERT_TRUE(PROFILER.write("test_profile.csv"));
+  const std::string csv = readFile("test_profile.csv");
+  EXPECT_EQ(csv.find("section,name,wall_ms,wall_ms_per_step,busy_ms,idle_ms\n"), 0u);
+  EXPECT_NE(csv.find("phase,neighbor_query,"), std::string::npos);
+  EXPECT_NE(csv.find("thread,0,"), std::string::npos);
+
+  ASSERT_TRUE(PROFILER.write("test_profile.json"));
+  const std::string json = readFile("test_profile.json");
+  EXPECT_NE(json.find("\"steps\": 5"), std::string::npos);
+  EXPECT_NE(json.find("\"name\": \"new_velocity\""), std::string::npos);
+  EXPECT_NE(json.find("\"idle_ms\""), std::string::npos);
+  std::remove("test_profile.csv");
+  std::remove("test_profile.json");
+}
+
+// A disabled profiler records nothing.
+TEST(StepProfilerTest, disabledRecordsNothing) {
+  PROFILER.enable();
+  PROFILER.disable();
+  profiledStep();
+  EXPECT_EQ(PROFILER.getStepCount(), 0u);
+  for (int p = 0; p < StepProfiler::PHASE_COUNT; ++p) {
+    EXPECT_EQ(PROFILER.getPhaseTime(static_cast<StepProfiler::Phase>(p)), 0.0);
+  }
+}
@@ -0,0 +1,197 @@
+#include "MengeCore/Agents/SimulatorInterface.h"
+#include "MengeCore/BFSM/FSM.h"
+#include "MengeCore/BFSM/Tasks/Task.h"
+#include "MengeCore/Runtime/StepProfiler.h"
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace Menge;
+using Menge::Agents::AgentHandle;
+using Menge::Agents::BaseAgent;
+using Menge::BFSM::FSM;
+using Menge::BFSM::FSMFatalException;
+using Menge::BFSM::Task;
+using Menge::BFSM::TaskException;
+using Menge::BFSM::TaskFatalException;
+using Menge::BFSM::TaskResources;
+
+namespace {
+// A simulator without agents; the tasks only need an FSM.
+class EmptySimulator : public Agents::SimulatorInterface {
+ public:
+  size_t getNumAgents() const { return 0; }
+  BaseAgent* getAgent(size_t agentNo) { return 0x0; }
+  const BaseAgent* getAgent(size_t agentNo) const { return 0x0; }
+  BaseAgent* getAgentById(size_t id) { return 0x0; }
+  AgentHandle getAgentHandle(const BaseAgent* agent) const {
+    AgentHandle handle = {0, 0};
+    return handle;
+  }
+  BaseAgent* getAgentByHandle(const AgentHandle& handle) { return 0x0; }
+  void doStep() {}
+  void removeAgent(BaseAgent* agent) {}
+  bool isExpTarget(const std::string& tagName) { return false; }
+  bool setExpParam(const std::string& paramName,
+                   const std::string& value) throw(Agents::XMLParamException) {
+    return false;
+  }
+  BaseAgent* addAgent(const Math::Vector2& pos, Agents::AgentInitializer* agentInit) {
+    return 0x0;
+  }
+  bool initSpatialQuery() { return false; }
+};
+
+// Records the order in which the tasks finish, the number of tasks running at once and the peak.
+struct Journal {
+  Journal() : running(0), peak(0) {}
+  std::vector<std::string> finished;
+  int running;
+  int peak;
+};
+
+// A task which sleeps for a moment, touching the given resources.
+class SleepTask : public Task {
+ public:
+  enum Failure { NO_FAILURE, FAILURE, FATAL_FAILURE };
+
+  SleepTask(Journal* journal, const std::string& name, const void* read, const void* write,
+            Failure failure = NO_FAILURE)
+      : Task(),
+        _journal(journal),
+        _name(name),
+        _read(read),
+        _write(write),
+        _failure(failure),
+        _declared(true) {}
+
+  void undeclare() { _declared = false; }
+
+  void doWork(const FSM* fsm) throw(TaskException) {
+#pragma omp critical(SleepTask)
+    {
+      ++_journal->running;
+      _journal->peak = std::max(_journal->peak, _journal->running);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+#pragma omp critical(SleepTask)
+    {
+      --_journal->running;
+      _journal->finished.push_back(_name);
+    }
+    if (_failure == FATAL_FAILURE) throw TaskFatalException();
+    if (_failure == FAILURE) throw TaskException();
+  }
+
+  bool getResources(TaskResources& resources) const {
+    if (_read) resources.addRead(_read);
+    if (_write) resources.addWrite(_write);
+    return _declared;
+  }
+
+  std::string toString() const { return _name; }
+
+  bool isEquivalent(const Task* task) const { return false; }
+
+ private:
+  Journal* _journal;
+  std::string _name;
+  const void* _read;
+  const void* _write;
+  Failure _failure;
+  bool _declared;
+};
+
+// Stand-ins for the data the tasks touch.
+const char GRID = 0;
+const char FORMATION = 0;
+
+size_t indexOf(const std::vector<std::string>& names, const std::string& name) {
+  for (size_t i = 0; i < names.size(); ++i) {
+    if (names[i] == name) return i;
+  }
+  return names.size();
+}
+}  // namespace
+
+// Two sets of resources conflict if either one writes what the other reads or writes.
+TEST(TaskSchedulerTest, resourcesConflictOnWrites) {
+  TaskResources readAgents;
+  readAgents.addRead(TaskResources::AGENTS);
+  TaskResources alsoReadAgents;
+  alsoReadAgents.addRead(TaskResources::AGENTS);
+  alsoReadAgents.addWrite(&GRID);
+  TaskResources writeAgents;
+  writeAgents.addWrite(TaskResources::AGENTS);
+  TaskResources writeGrid;
+  writeGrid.addWrite(&GRID);
+
+  EXPECT_FALSE(readAgents.conflictsWith(alsoReadAgents));
+  EXPECT_TRUE(readAgents.conflictsWith(writeAgents));
+  EXPECT_TRUE(writeAgents.conflictsWith(readAgents));
+  EXPECT_TRUE(writeAgents.conflictsWith(writeAgents));
+  EXPECT_TRUE(alsoReadAgents.conflictsWith(writeGrid));
+  EXPECT_FALSE(writeAgents.conflictsWith(writeGrid));
+}
+
+// Independent tasks run concurrently; a task runs after the earlier tasks with which it conflicts
+// and an undeclared task runs alone. Each task's time is profiled.
+TEST(TaskSchedulerTest, runsIndependentTasksConcurrently) {
+  Journal journal;
+  EmptySimulator sim;
+  FSM fsm(&sim);
+  fsm.addTask(new SleepTask(&journal, "grid", TaskResources::AGENTS, &GRID));
+  fsm.addTask(new SleepTask(&journal, "formation", TaskResources::AGENTS, &FORMATION));
+  fsm.addTask(new SleepTask(&journal, "stress", &GRID, TaskResources::AGENTS));
+  SleepTask* legacy = new SleepTask(&journal, "legacy", 0x0, 0x0);
+  legacy->undeclare();
+  fsm.addTask(legacy);
+  fsm.addTask(new SleepTask(&journal, "late", 0x0, &FORMATION));
+
+  PROFILER.enable();
+  fsm.doTasks();
+  PROFILER.disable();
+
+  ASSERT_EQ(journal.finished.size(), 5u);
+  const std::vector<std::string>& order = journal.finished;
+  EXPECT_LT(indexOf(order, "grid"), indexOf(order, "stress"));
+  EXPECT_LT(indexOf(order, "formation"), indexOf(order, "stress"));
+  EXPECT_LT(indexOf(order, "stress"), indexOf(order, "legacy"));
+  EXPECT_LT(indexOf(order, "legacy"), indexOf(order, "late"));
+  int threadCount = 1;
+#ifdef _OPENMP
+  threadCount = omp_get_max_threads();
+#endif
+  EXPECT_EQ(journal.peak, threadCount > 1 ? 2 : 1);
+
+  EXPECT_EQ(PROFILER.getTaskCount(), 5u);
+  EXPECT_GE(PROFILER.getTaskTime("grid"), 0.015);
+  EXPECT_GE(PROFILER.getTaskTime("late"), 0.015);
+  EXPECT_EQ(PROFILER.getTaskTime("missing"), 0.0);
+}
+
+// A failing task is reported once the tasks running alongside it are done; only a fatal failure
+// stops the remaining tasks.
+TEST(TaskSchedulerTest, reportsTaskFailures) {
+  Journal journal;
+  EmptySimulator sim;
+  FSM fsm(&sim);
+  fsm.addTask(new SleepTask(&journal, "error", 0x0, &GRID, SleepTask::FAILURE));
+  fsm.addTask(new SleepTask(&journal, "next", &GRID, 0x0));
+  EXPECT_NO_THROW(fsm.doTasks());
+  EXPECT_EQ(journal.finished.size(), 2u);
+
+  journal.finished.clear();
+  fsm.addTask(new SleepTask(&journal, "fatal", 0x0, &FORMATION, SleepTask::FATAL_FAILURE));
+  fsm.addTask(new SleepTask(&journal, "after", &FORMATION, 0x0));
+  EXPECT_THROW(fsm.doTasks(), FSMFatalException);
+  EXPECT_EQ(indexOf(journal.finished, "after"), journal.finished.size());
+  EXPECT_NE(indexOf(journal.finished, "fatal"), journal.finished.size());
+}
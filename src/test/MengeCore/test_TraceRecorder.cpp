@@ -0,0 +1,83 @@
+#include "MengeCore/Runtime/StepProfiler.h"
+#include "MengeCore/Runtime/TraceRecorder.h"
+#include "gtest/gtest.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+using namespace Menge;
+
+namespace {
+// One "step": a serial phase, a parallel loop and two spans of different lengths.
+void tracedStep() {
+  TRACER.beginStep();
+  {
+    ProfileScope timer(StepProfiler::EVENTS);
+  }
+  {
+    ProfileRegion region(StepProfiler::NEIGHBOR_QUERY, StepProfiler::NEW_VELOCITY);
+#pragma omp parallel for
+    for (int i = 0; i < 8; ++i) {
+      ProfileLap lap;
+      lap.lap(StepProfiler::NEIGHBOR_QUERY);
+      lap.lap(StepProfiler::NEW_VELOCITY);
+    }
+  }
+  {
+    TraceScope span("long", "test");
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+  }
+  { TraceScope span("short", "test"); }
+  TRACER.endStep();
+}
+
+size_t countOf(const std::string& text, const std::string& pattern) {
+  size_t count = 0;
+  for (size_t i = text.find(pattern); i != std::string::npos; i = text.find(pattern, i + 1)) {
+    ++count;
+  }
+  return count;
+}
+
+std::string readFile(const std::string& fileName) {
+  std::ifstream f(fileName.c_str());
+  return std::string(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+}
+}  // namespace
+
+// Only sampled steps are recorded; short spans are filtered out.
+TEST(TraceRecorderTest, recordsSampledSteps) {
+  TRACER.enable(TraceRecorder::DEFAULT_CAPACITY, 2, 1000.0);
+  for (int s = 0; s < 6; ++s) tracedStep();
+  TRACER.disable();
+  EXPECT_EQ(TRACER.getDroppedCount(), 0u);
+
+  ASSERT_TRUE(TRACER.write("test_trace.json"));
+  const std::string json = readFile("test_trace.json");
+  EXPECT_EQ(json.find("{\"traceEvents\": ["), 0u);
+  EXPECT_EQ(countOf(json, "\"name\": \"step\""), 3u);
+  EXPECT_EQ(countOf(json, "\"name\": \"events\""), 3u);
+  EXPECT_EQ(countOf(json, "\"name\": \"long\""), 3u);
+  EXPECT_EQ(countOf(json, "\"name\": \"short\""), 0u);
+  EXPECT_GE(countOf(json, "\"name\": \"neighbor_query+new_velocity\""), 3u);
+  EXPECT_NE(json.find("\"args\": {\"neighbor_query\": "), std::string::npos);
+  std::remove("test_trace.json");
+}
+
+// Once the buffers are full, events are counted and discarded.
+TEST(TraceRecorderTest, boundsMemory) {
+  TRACER.enable(1, 1, 0.0);
+  for (int s = 0; s < 4; ++s) tracedStep();
+  TRACER.disable();
+  EXPECT_LE(TRACER.getEventCount(), TRACER.getDroppedCount());
+  EXPECT_GT(TRACER.getDroppedCount(), 0u);
+
+  // Nothing is recorded while disabled.
+  const size_t count = TRACER.getEventCount() + TRACER.getDroppedCount();
+  tracedStep();
+  EXPECT_EQ(TRACER.getEventCount() + TRACER.getDroppedCount(), count);
+}
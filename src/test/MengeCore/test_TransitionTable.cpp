@@ -0,0 +1,89 @@
+#include "MengeCore/Agents/BaseAgent.h"
+#include "MengeCore/Agents/SimulatorInterface.h"
+#include "MengeCore/BFSM/FSM.h"
+#include "MengeCore/BFSM/State.h"
+#include "MengeCore/Core.h"
+#include "MengeCore/menge_c_api.h"
+#include "SceneFixture.h"
+#include "gtest/gtest.h"
+
+#include <string>
+
+using namespace Menge;
+using Menge::Math::Vector2;
+
+namespace {
+// A -> B is automatic; B branches on compound spatial and timer conditions. C loops back to A so
+// the first agent cycles through A, B and C every step.
+const char* BEHAVIOR =
+    "<?xml version=\"1.0\"?>\n"
+    "<BFSM>\n"
+    "  <State name=\"A\" final=\"0\">\n"
+    "    <GoalSelector type=\"identity\" />\n"
+    "    <VelComponent type=\"zero\" />\n"
+    "  </State>\n"
+    "  <State name=\"B\" final=\"0\">\n"
+    "    <GoalSelector type=\"identity\" />\n"
+    "    <VelComponent type=\"zero\" />\n"
+    "  </State>\n"
+    "  <State name=\"C\" final=\"0\">\n"
+    "    <GoalSelector type=\"identity\" />\n"
+    "    <VelComponent type=\"zero\" />\n"
+    "  </State>\n"
+    "  <State name=\"D\" final=\"0\">\n"
+    "    <GoalSelector type=\"identity\" />\n"
+    "    <VelComponent type=\"zero\" />\n"
+    "  </State>\n"
+    "  <State name=\"E\" final=\"1\">\n"
+    "    <GoalSelector type=\"identity\" />\n"
+    "    <VelComponent type=\"zero\" />\n"
+    "  </State>\n"
+    "  <Transition from=\"A\" to=\"B\">\n"
+    "    <Condition type=\"auto\" />\n"
+    "  </Transition>\n"
+    "  <Transition from=\"B\" to=\"C\">\n"
+    "    <Condition type=\"and\">\n"
+    "      <Condition type=\"circle\" inside=\"1\" center_x=\"0\" center_y=\"0\" radius=\"1\" />\n"
+    "      <Condition type=\"not\">\n"
+    "        <Condition type=\"timer\" per_agent=\"0\" dist=\"c\" value=\"100\" />\n"
+    "      </Condition>\n"
+    "    </Condition>\n"
+    "  </Transition>\n"
+    "  <Transition from=\"B\" to=\"D\">\n"
+    "    <Condition type=\"or\">\n"
+    "      <Condition type=\"AABB\" inside=\"1\" min_x=\"9\" min_y=\"-1\" max_x=\"11\"\n"
+    "                 max_y=\"1\" />\n"
+    "      <Condition type=\"OBB\" inside=\"1\" pivot_x=\"-20\" pivot_y=\"0\" width=\"1\"\n"
+    "                 height=\"1\" angle=\"30\" />\n"
+    "    </Condition>\n"
+    "  </Transition>\n"
+    "  <Transition from=\"C\" to=\"A\">\n"
+    "    <Condition type=\"auto\" />\n"
+    "  </Transition>\n"
+    "  <Transition from=\"D\" to=\"E\">\n"
+    "    <Condition type=\"goal_reached\" distance=\"0.1\" />\n"
+    "  </Transition>\n"
+    "</BFSM>\n";
+
+std::string stateName(size_t agentID) {
+  return ACTIVE_FSM->getCurrentState(SIMULATOR->getAgent(agentID))->getName();
+}
+}  // namespace
+
+// The compiled transitions follow chains of transitions within a single step, stop when a state
+// is revisited and evaluate compound conditions as the conditions themselves would.
+TEST(TransitionTableTest, advancesThroughTransitionChains) {
+  // Three stationary agents; the first stands in a circle, the second in no region and the third
+  // in a box.
+  const std::string scene = SceneFixture::stationaryScene(
+      "A", {Vector2(0.f, 0.f), Vector2(5.f, 0.f), Vector2(10.f, 0.f)});
+  ASSERT_TRUE(SceneFixture::loadSimulation("table", scene, BEHAVIOR));
+  for (int step = 0; step < 3; ++step) {
+    DoStep();
+    // A -> B -> C -> A; A has already been visited so the agent stays there.
+    EXPECT_EQ(stateName(0), "A");
+    EXPECT_EQ(stateName(1), "B");
+    // A -> B -> D -> E.
+    EXPECT_EQ(stateName(2), "E");
+  }
+}
@@ -0,0 +1,86 @@
+#include "MengeCore/Agents/BaseAgent.h"
+#include "MengeCore/Agents/SimulatorInterface.h"
+#include "MengeCore/BFSM/FSM.h"
+#include "MengeCore/BFSM/State.h"
+#include "MengeCore/Core.h"
+#include "MengeCore/menge_c_api.h"
+#include "SceneFixture.h"
+#include "gtest/gtest.h"
+
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace Menge;
+
+namespace {
+// Every agent leaves Wait once the shared timer expires; the FSM updates agents every four steps
+// and Wait optionally overrides that.
+std::string behavior(const char* waitInterval) {
+  std::stringstream ss;
+  ss << "<?xml version=\"1.0\"?>\n"
+        "<BFSM update_interval=\"4\">\n"
+        "  <State name=\"Wait\" final=\"0\" update_interval=\""
+     << waitInterval
+     << "\">\n"
+        "    <GoalSelector type=\"identity\" />\n"
+        "    <VelComponent type=\"zero\" />\n"
+        "  </State>\n"
+        "  <State name=\"Done\" final=\"1\">\n"
+        "    <GoalSelector type=\"identity\" />\n"
+        "    <VelComponent type=\"zero\" />\n"
+        "  </State>\n"
+        "  <Transition from=\"Wait\" to=\"Done\">\n"
+        "    <Condition type=\"timer\" per_agent=\"0\" dist=\"c\" value=\"1.05\" />\n"
+        "  </Transition>\n"
+        "</BFSM>\n";
+  return ss.str();
+}
+
+// Runs the simulation until every agent is done and reports the step in which each agent left
+// Wait.
+std::vector<int> transitionSteps(const char* waitInterval) {
+  const std::string scene = SceneFixture::stationaryScene("Wait", SceneFixture::row(8));
+  std::vector<int> steps;
+  // The timer starts when the agents enter Wait; the global time is left over from any previous
+  // simulation until the first step.
+  SIM_TIME = 0.f;
+  EXPECT_TRUE(SceneFixture::loadSimulation("interval", scene, behavior(waitInterval)));
+  const size_t count = SIMULATOR->getNumAgents();
+  steps.assign(count, -1);
+  for (int step = 1; step <= 40; ++step) {
+    DoStep();
+    for (size_t i = 0; i < count; ++i) {
+      const BFSM::State* state = ACTIVE_FSM->getCurrentState(SIMULATOR->getAgent(i));
+      if (steps[i] < 0 && state->getName() == "Done") steps[i] = step;
+    }
+  }
+  return steps;
+}
+}  // namespace
+
+// With an update interval, the agents are updated in staggered cohorts and no transition is
+// delayed by more than the interval; a state can override the FSM's interval.
+TEST(UpdateIntervalTest, staggersAgentUpdatesWithinTheInterval) {
+  // Wait updates every agent every step, so all of them leave as soon as the timer expires.
+  const std::vector<int> immediate = transitionSteps("1");
+  ASSERT_EQ(immediate.size(), 8u);
+  const int expired = immediate[0];
+  ASSERT_GT(expired, 0);
+  for (size_t i = 0; i < immediate.size(); ++i) EXPECT_EQ(immediate[i], expired);
+  EXPECT_EQ(ACTIVE_FSM->getUpdateInterval(), 4u);
+  EXPECT_EQ(ACTIVE_FSM->getUpdateInterval(ACTIVE_FSM->getNode("Wait")), 1u);
+  EXPECT_EQ(ACTIVE_FSM->getUpdateInterval(ACTIVE_FSM->getNode("Done")), 4u);
+
+  // Wait uses the FSM's interval: four cohorts of two agents each leave in successive steps.
+  const std::vector<int> staggered = transitionSteps("0");
+  ASSERT_EQ(staggered.size(), 8u);
+  std::set<int> cohorts;
+  for (size_t i = 0; i < staggered.size(); ++i) {
+    EXPECT_GE(staggered[i], expired);
+    EXPECT_LT(staggered[i], expired + 4);
+    cohorts.insert(staggered[i]);
+  }
+  EXPECT_EQ(cohorts.size(), 4u);
+}
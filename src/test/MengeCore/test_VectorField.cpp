@@ -0,0 +1,94 @@
+#include "MengeCore/resources/VectorField.h"
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+using namespace Menge;
+using Menge::Math::Vector2;
+
+namespace {
+// Writes a small ASCII vector field (3 rows, 4 columns) whose cell values encode their addresses.
+std::string writeAsciiField() {
+  const std::string fileName = "test_field.txt";
+  std::ofstream f(fileName.c_str());
+  f << "3 4\n0.5\n-1.0 2.0\n";
+  for (int r = 0; r < 3; ++r) {
+    for (int c = 0; c < 4; ++c) {
+      f << (c + 0.25f) << " " << (r - 0.5f) << "\n";
+    }
+  }
+  return fileName;
+}
+
+VectorField* loadField(const std::string& fileName) {
+  return dynamic_cast<VectorField*>(VectorField::load(fileName));
+}
+
+// A set of query points inside, on the edges of and outside of the field.
+std::vector<Vector2> queryPoints() {
+  std::vector<Vector2> points;
+  for (float x = -2.f; x < 2.f; x += 0.13f) {
+    for (float y = 1.f; y < 4.5f; y += 0.17f) {
+      points.push_back(Vector2(x, y));
+    }
+  }
+  return points;
+}
+}  // namespace
+
+// The binary formats must reproduce the ASCII field's values and sampling.
+TEST(VectorFieldTest, binaryFieldMatchesAscii) {
+  VectorField* ascii = loadField(writeAsciiField());
+  ASSERT_NE(ascii, (VectorField*)0x0);
+  ASSERT_TRUE(ascii->writeBinary("test_field32.vfb", false));
+  ASSERT_TRUE(convertVectorField("test_field.txt", "test_field16.vfb", true));
+  VectorField* full = loadField("test_field32.vfb");
+  VectorField* half = loadField("test_field16.vfb");
+  ASSERT_NE(full, (VectorField*)0x0);
+  ASSERT_NE(half, (VectorField*)0x0);
+  EXPECT_FALSE(full->isHalfPrecision());
+  EXPECT_TRUE(half->isHalfPrecision());
+  EXPECT_EQ(full->getRowCount(), 3);
+  EXPECT_EQ(full->getColCount(), 4);
+  EXPECT_EQ(full->getCellSize(), 0.5f);
+  EXPECT_EQ(full->getMinimumPoint(), ascii->getMinimumPoint());
+
+  std::vector<Vector2> points = queryPoints();
+  for (size_t i = 0; i < points.size(); ++i) {
+    Vector2 a = ascii->getFieldValueInterp(points[i]);
+    Vector2 f = full->getFieldValueInterp(points[i]);
+    Vector2 h = half->getFieldValueInterp(points[i]);
+    EXPECT_EQ(a, f);
+    EXPECT_NEAR(a.x(), h.x(), 1e-2f);
+    EXPECT_NEAR(a.y(), h.y(), 1e-2f);
+    EXPECT_EQ(ascii->getFieldValue(points[i]), full->getFieldValue(points[i]));
+  }
+  ascii->destroy();
+  full->destroy();
+  half->destroy();
+  std::remove("test_field.txt");
+  std::remove("test_field32.vfb");
+  std::remove("test_field16.vfb");
+}
+
+// Batched sampling must produce exactly the per-point values.
+TEST(VectorFieldTest, batchSamplingMatchesPointSampling) {
+  VectorField* field = loadField(writeAsciiField());
+  ASSERT_NE(field, (VectorField*)0x0);
+  std::vector<Vector2> points = queryPoints();
+  std::vector<Vector2> nearest(points.size());
+  std::vector<Vector2> interp(points.size());
+  field->getFieldValues(&points[0], &nearest[0], points.size(), false);
+  field->getFieldValues(&points[0], &interp[0], points.size(), true);
+  for (size_t i = 0; i < points.size(); ++i) {
+    EXPECT_EQ(nearest[i], field->getFieldValue(points[i]));
+    EXPECT_EQ(interp[i], field->getFieldValueInterp(points[i]));
+  }
+  // At cell centers, interpolation reproduces the cell value.
+  Vector2 center = field->getMinimumPoint() + Vector2(1.25f, 0.75f);
+  EXPECT_EQ(field->getFieldValueInterp(center), field->getFieldValue(1, 2));
+  field->destroy();
+  std::remove("test_field.txt");
+}